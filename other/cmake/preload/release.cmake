@@ -10,6 +10,7 @@
 set(CFG_LIB_BUILD_TYPE "STATIC" CACHE STRING "" FORCE)
 set(CFG_TAG "OFF" CACHE STRING "" FORCE)
 set(CFG_TESTS_ENABLE_COVERAGE "ON" CACHE STRING "" FORCE)
+set(CFG_TESTS_PERF "OFF" CACHE STRING "" FORCE)
 set(CFG_CI "OFF" CACHE STRING "" FORCE)
 set(BUILD_TESTING TRUE CACHE BOOL "" FORCE)
 
@@ -0,0 +1,375 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_bcast.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_bcast_iapi_impl Internal API implementation */
+/** @defgroup cb_bcast_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_bcast.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_bcast_iapi_impl
+ * @{
+ */
+
+/** Read index of a cursor with no consumer attached. */
+#define CB_BCAST_DETACHED (SIZE_MAX)
+
+/**
+ * @}
+ */
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_bcast_iapi_impl
+ * @{
+ */
+
+/** Casts a pointer to a pointer to byte. */
+#define CB_BCAST_CAST(ptr) ((char *)(ptr))
+
+#ifdef CB_USE_STDATOMIC
+/** Initialization, load and store of the indexes, with acquire and release, as in the circular buffer. */
+/** @{ */
+#define CB_BCAST_INIT(variable, value)  (atomic_init(&(variable), (value)))
+#define CB_BCAST_LOAD(variable)         (atomic_load_explicit(&(variable), memory_order_acquire))
+#define CB_BCAST_STORE(variable, value) (atomic_store_explicit(&(variable), (value), memory_order_release))
+/** @} */
+/** Load, store and compare and swap of the indexes, sequentially consistent, see ::cb_bcast_attach. */
+/** @{ */
+#define CB_BCAST_LOAD_SC(variable)         (atomic_load(&(variable)))
+#define CB_BCAST_STORE_SC(variable, value) (atomic_store(&(variable), (value)))
+#define CB_BCAST_CAS_SC(variable, expected, desired) \
+    (atomic_compare_exchange_strong(&(variable), &(expected), (desired)))
+/** @} */
+#else
+/** Initialization, load and store of the indexes, without atomic support. */
+/** @{ */
+#define CB_BCAST_INIT(variable, value)  (variable) = (value)
+#define CB_BCAST_LOAD(variable)         (variable)
+#define CB_BCAST_STORE(variable, value) (variable) = (value)
+/** @} */
+/** Load, store and compare and swap of the indexes, without atomic support. */
+/** @{ */
+#define CB_BCAST_LOAD_SC(variable)         (variable)
+#define CB_BCAST_STORE_SC(variable, value) (variable) = (value)
+#define CB_BCAST_CAS_SC(variable, expected, desired) \
+    (((variable) == (expected)) ? (((variable) = (desired)), true) : false)
+/** @} */
+#endif
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_bcast_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Obtains the number of filled slots between a read index and the write index.
+ * @param[in] bcast Broadcast ring context.
+ * @param[in] read_idx The read index.
+ * @param[in] write_idx The write index.
+ * @return The number of filled slots.
+ */
+static inline size_t cb_bcast_int_filled(const cb_bcast_t * const bcast, const size_t read_idx, const size_t write_idx);
+
+/**
+ * @brief Obtains the number of filled slots for the slowest consumer attached.
+ * @param[in] bcast Broadcast ring context.
+ * @param[in] write_idx The write index.
+ * @return The number of filled slots for the slowest consumer, zero if none is attached.
+ */
+static size_t cb_bcast_int_slowest(cb_bcast_t * const bcast, const size_t write_idx);
+
+/**
+ * @brief Copies elements for a consumer, and consumes them if requested.
+ * @param[in] bcast Broadcast ring context.
+ * @param[in] cursor The cursor of the consumer.
+ * @param[out] buffer The buffer where to copy the elements.
+ * @param[in] count The number of elements to copy.
+ * @param[in] consume @c true to consume the elements copied, @c false otherwise.
+ * @return The result, as in ::cb_bcast_read.
+ */
+static cb_error_t cb_bcast_int_read(cb_bcast_t * const bcast,
+                                    const size_t cursor,
+                                    void * const buffer,
+                                    const size_t count,
+                                    const bool consume);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_bcast_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline size_t cb_bcast_int_filled(const cb_bcast_t * const bcast, const size_t read_idx, const size_t write_idx)
+{
+    return (write_idx >= read_idx) ? (write_idx - read_idx) : (bcast->buffer_length - read_idx + write_idx);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t cb_bcast_int_slowest(cb_bcast_t * const bcast, const size_t write_idx)
+{
+    size_t filled = 0U;
+
+    // The cursors are loaded after the write index was published, both sequentially consistent, see ::cb_bcast_attach.
+    for (size_t i = 0U; i < CB_BCAST_MAX_CURSORS; i++)
+    {
+        const size_t read_idx = CB_BCAST_LOAD_SC(bcast->cursors[i]);
+        if (read_idx != CB_BCAST_DETACHED)
+        {
+            const size_t cursor_filled = cb_bcast_int_filled(bcast, read_idx, write_idx);
+            filled = (cursor_filled > filled) ? (cursor_filled) : (filled);
+        }
+    }
+
+    return filled;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_bcast_int_read(cb_bcast_t * const bcast,
+                                    const size_t cursor,
+                                    void * const buffer,
+                                    const size_t count,
+                                    const bool consume)
+{
+    // Sanity check on arguments.
+    if ((bcast == NULL) || (cursor >= CB_BCAST_MAX_CURSORS) || (buffer == NULL) || (count == 0U))
+    {
+        return cb_error_invalid_args;
+    }
+    size_t read_idx = CB_BCAST_LOAD(bcast->cursors[cursor]);
+    if (read_idx == CB_BCAST_DETACHED)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Check the elements requested are available for this consumer.
+    if (count > cb_bcast_int_filled(bcast, read_idx, CB_BCAST_LOAD(bcast->write_idx)))
+    {
+        return cb_error_empty;
+    }
+
+    // Copy from the read index to the end of the linear buffer, and from its start if wrapping around.
+    const size_t fe = ((read_idx + count) > bcast->buffer_length) ? (bcast->buffer_length - read_idx) : (count);
+    (void)memcpy(buffer, CB_BCAST_CAST(bcast->buffer) + (read_idx * bcast->elem_size), fe * bcast->elem_size);
+    if (fe < count)
+    {
+        (void)memcpy(CB_BCAST_CAST(buffer) + (fe * bcast->elem_size), bcast->buffer, (count - fe) * bcast->elem_size);
+    }
+
+    // Release the slots for the producer, if consumed.
+    if (consume)
+    {
+        read_idx += count;
+        read_idx = (read_idx >= bcast->buffer_length) ? (read_idx - bcast->buffer_length) : (read_idx);
+        CB_BCAST_STORE(bcast->cursors[cursor], read_idx);
+    }
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_bcast_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t
+    cb_bcast_init(cb_bcast_t * const bcast, void * const buffer, const size_t buffer_length, const size_t elem_size)
+{
+    // Sanity check on arguments, the largest index must be distinguishable from a detached cursor.
+    if ((bcast == NULL) || (buffer == NULL) || (buffer_length <= 1U) || (buffer_length == SIZE_MAX) ||
+        (elem_size == 0U))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize.
+    bcast->buffer = buffer;
+    bcast->buffer_length = buffer_length;
+    bcast->elem_size = elem_size;
+    CB_BCAST_INIT(bcast->write_idx, 0U);
+    for (size_t i = 0U; i < CB_BCAST_MAX_CURSORS; i++)
+    {
+        CB_BCAST_INIT(bcast->cursors[i], CB_BCAST_DETACHED);
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_deinit(cb_bcast_t * const bcast)
+{
+    // Sanity check on arguments.
+    if (bcast == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Deinitialize.
+    bcast->buffer = NULL;
+    bcast->buffer_length = 0U;
+    bcast->elem_size = 0U;
+    CB_BCAST_STORE(bcast->write_idx, 0U);
+    for (size_t i = 0U; i < CB_BCAST_MAX_CURSORS; i++)
+    {
+        CB_BCAST_STORE(bcast->cursors[i], CB_BCAST_DETACHED);
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_write(cb_bcast_t * const bcast, const void * const buffer, const size_t count)
+{
+    // Sanity check on arguments.
+    if ((bcast == NULL) || (buffer == NULL) || (count == 0U))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Check the elements fit for the slowest consumer, there is a single producer, thus the write index is its own.
+    size_t write_idx = CB_BCAST_LOAD(bcast->write_idx);
+    if (count > (bcast->buffer_length - 1U - cb_bcast_int_slowest(bcast, write_idx)))
+    {
+        return cb_error_full;
+    }
+
+    // Copy to the write index up to the end of the linear buffer, and to its start if wrapping around.
+    const size_t fe = ((write_idx + count) > bcast->buffer_length) ? (bcast->buffer_length - write_idx) : (count);
+    (void)memcpy(CB_BCAST_CAST(bcast->buffer) + (write_idx * bcast->elem_size), buffer, fe * bcast->elem_size);
+    if (fe < count)
+    {
+        (void)memcpy(bcast->buffer, CB_BCAST_CAST(buffer) + (fe * bcast->elem_size), (count - fe) * bcast->elem_size);
+    }
+
+    // Publish the elements to all the consumers.
+    write_idx += count;
+    write_idx = (write_idx >= bcast->buffer_length) ? (write_idx - bcast->buffer_length) : (write_idx);
+    CB_BCAST_STORE_SC(bcast->write_idx, write_idx);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_get_unfilled(cb_bcast_t * const bcast, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((bcast == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Get number of unfilled slots for the slowest consumer.
+    *count = bcast->buffer_length - 1U - cb_bcast_int_slowest(bcast, CB_BCAST_LOAD_SC(bcast->write_idx));
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_attach(cb_bcast_t * const bcast, size_t * const cursor)
+{
+    // Sanity check on arguments.
+    if ((bcast == NULL) || (cursor == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    for (size_t i = 0U; i < CB_BCAST_MAX_CURSORS; i++)
+    {
+        // Claim a free cursor at the write index, from then on the producer is bounded by it.
+        size_t expected = CB_BCAST_DETACHED;
+        if (CB_BCAST_CAS_SC(bcast->cursors[i], expected, CB_BCAST_LOAD_SC(bcast->write_idx)))
+        {
+            // A write in progress might have checked the space before the cursor was claimed, and it might write up to
+            // the whole capacity from its write index. That write index was published before the check, thus it is
+            // observed now, and the elements from it onwards are new for this consumer, move the cursor there.
+            CB_BCAST_STORE(bcast->cursors[i], CB_BCAST_LOAD_SC(bcast->write_idx));
+            *cursor = i;
+            return cb_error_ok;
+        }
+    }
+
+    return cb_error_full;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_detach(cb_bcast_t * const bcast, const size_t cursor)
+{
+    // Sanity check on arguments.
+    if ((bcast == NULL) || (cursor >= CB_BCAST_MAX_CURSORS) ||
+        (CB_BCAST_LOAD(bcast->cursors[cursor]) == CB_BCAST_DETACHED))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Free the cursor, the producer is no longer bounded by it.
+    CB_BCAST_STORE(bcast->cursors[cursor], CB_BCAST_DETACHED);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_read(cb_bcast_t * const bcast, const size_t cursor, void * const buffer, const size_t count)
+{
+    return cb_bcast_int_read(bcast, cursor, buffer, count, true);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_peek(cb_bcast_t * const bcast, const size_t cursor, void * const buffer, const size_t count)
+{
+    return cb_bcast_int_read(bcast, cursor, buffer, count, false);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_bcast_get_filled(cb_bcast_t * const bcast, const size_t cursor, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((bcast == NULL) || (cursor >= CB_BCAST_MAX_CURSORS) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+    const size_t read_idx = CB_BCAST_LOAD(bcast->cursors[cursor]);
+    if (read_idx == CB_BCAST_DETACHED)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Get number of filled slots for the consumer.
+    *count = cb_bcast_int_filled(bcast, read_idx, CB_BCAST_LOAD(bcast->write_idx));
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
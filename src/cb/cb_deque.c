@@ -0,0 +1,308 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_deque.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_deque_iapi_impl Internal API implementation */
+/** @defgroup cb_deque_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_deque.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_deque_iapi_impl
+ * @{
+ */
+
+/** Casts a pointer to a pointer to byte. */
+#define CB_DEQUE_CAST(ptr) ((char *)(ptr))
+
+#ifdef CB_USE_STDATOMIC
+/** Initialization, load and store of the indexes, relaxed, with acquire and release, and sequentially consistent. */
+/** @{ */
+#define CB_DEQUE_INIT(variable, value)      (atomic_init(&(variable), (value)))
+#define CB_DEQUE_LOAD_RLX(variable)         (atomic_load_explicit(&(variable), memory_order_relaxed))
+#define CB_DEQUE_LOAD(variable)             (atomic_load_explicit(&(variable), memory_order_acquire))
+#define CB_DEQUE_STORE(variable, value)     (atomic_store_explicit(&(variable), (value), memory_order_release))
+#define CB_DEQUE_LOAD_SC(variable)          (atomic_load(&(variable)))
+#define CB_DEQUE_STORE_SC(variable, value)  (atomic_store(&(variable), (value)))
+#define CB_DEQUE_CAS_SC(variable, expected, desired) \
+    (atomic_compare_exchange_strong(&(variable), &(expected), (desired)))
+/** @} */
+#else
+/** Initialization, load and store of the indexes, without atomic support. */
+/** @{ */
+#define CB_DEQUE_INIT(variable, value)      (variable) = (value)
+#define CB_DEQUE_LOAD_RLX(variable)         (variable)
+#define CB_DEQUE_LOAD(variable)             (variable)
+#define CB_DEQUE_STORE(variable, value)     (variable) = (value)
+#define CB_DEQUE_LOAD_SC(variable)          (variable)
+#define CB_DEQUE_STORE_SC(variable, value)  (variable) = (value)
+#define CB_DEQUE_CAS_SC(variable, expected, desired) \
+    (((variable) == (expected)) ? (((variable) = (desired)), true) : false)
+/** @} */
+#endif
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_deque_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Obtains the number of elements between the top and the bottom.
+ *
+ * While the owner pops, the bottom can be one less than the top, in which case the deque is empty.
+ * @param[in] top The index of the top.
+ * @param[in] bottom The index of the bottom.
+ * @return The number of elements.
+ */
+static inline size_t cb_deque_int_size(const size_t top, const size_t bottom);
+
+/**
+ * @brief Obtains the address of an element in a linear buffer of a deque.
+ * @param[in] deque Deque context.
+ * @param[in] buf The linear buffer.
+ * @param[in] idx The index of the element, monotonic.
+ * @return The address of the element.
+ */
+static inline char *
+    cb_deque_int_slot(const cb_deque_t * const deque, const cb_deque_buf_t * const buf, const size_t idx);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_deque_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline size_t cb_deque_int_size(const size_t top, const size_t bottom)
+{
+    const size_t size = bottom - top;
+
+    return (size > (SIZE_MAX / 2U)) ? (0U) : (size);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline char *
+    cb_deque_int_slot(const cb_deque_t * const deque, const cb_deque_buf_t * const buf, const size_t idx)
+{
+    return CB_DEQUE_CAST(buf->buffer) + ((idx % buf->buffer_length) * deque->elem_size);
+}
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_deque_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t
+    cb_deque_init(cb_deque_t * const deque, void * const buffer, const size_t buffer_length, const size_t elem_size)
+{
+    // Sanity check on arguments, the number of elements must be distinguishable from a pop in progress.
+    if ((deque == NULL) || (buffer == NULL) || (buffer_length <= 1U) || (buffer_length > (SIZE_MAX / 2U)) ||
+        (elem_size == 0U))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize.
+    deque->elem_size = elem_size;
+    (void)memset(deque->bufs, 0, sizeof(deque->bufs));
+    deque->bufs[0U].buffer = buffer;
+    deque->bufs[0U].buffer_length = buffer_length;
+    CB_DEQUE_INIT(deque->buf_idx, 0U);
+    CB_DEQUE_INIT(deque->top, 0U);
+    CB_DEQUE_INIT(deque->bottom, 0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_deque_deinit(cb_deque_t * const deque)
+{
+    // Sanity check on arguments.
+    if (deque == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Deinitialize.
+    deque->elem_size = 0U;
+    (void)memset(deque->bufs, 0, sizeof(deque->bufs));
+    CB_DEQUE_STORE(deque->buf_idx, 0U);
+    CB_DEQUE_STORE(deque->top, 0U);
+    CB_DEQUE_STORE(deque->bottom, 0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_deque_grow(cb_deque_t * const deque, void * const buffer, const size_t buffer_length)
+{
+    // Sanity check on arguments, the current linear buffer is only changed by the owner.
+    if ((deque == NULL) || (buffer == NULL) || (buffer_length > (SIZE_MAX / 2U)))
+    {
+        return cb_error_invalid_args;
+    }
+    const size_t buf_idx = CB_DEQUE_LOAD_RLX(deque->buf_idx);
+    const cb_deque_buf_t * const buf = &deque->bufs[buf_idx];
+    if (buffer_length <= buf->buffer_length)
+    {
+        return cb_error_invalid_args;
+    }
+    if ((buf_idx + 1U) >= CB_DEQUE_MAX_BUFFERS)
+    {
+        return cb_error_full;
+    }
+
+    // Copy the elements to the same indexes in the new linear buffer, thieves keep reading the current one meanwhile.
+    cb_deque_buf_t * const next = &deque->bufs[buf_idx + 1U];
+    next->buffer = buffer;
+    next->buffer_length = buffer_length;
+    const size_t bottom = CB_DEQUE_LOAD_RLX(deque->bottom);
+    for (size_t idx = CB_DEQUE_LOAD(deque->top); idx != bottom; idx++)
+    {
+        (void)memcpy(cb_deque_int_slot(deque, next, idx), cb_deque_int_slot(deque, buf, idx), deque->elem_size);
+    }
+
+    // Publish the new linear buffer, along with the elements copied.
+    CB_DEQUE_STORE(deque->buf_idx, buf_idx + 1U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_deque_push(cb_deque_t * const deque, const void * const elem)
+{
+    // Sanity check on arguments.
+    if ((deque == NULL) || (elem == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Check there is space, the top only increases, thus the space can only be larger than observed.
+    const size_t bottom = CB_DEQUE_LOAD_RLX(deque->bottom);
+    const size_t top = CB_DEQUE_LOAD(deque->top);
+    const cb_deque_buf_t * const buf = &deque->bufs[CB_DEQUE_LOAD_RLX(deque->buf_idx)];
+    if (cb_deque_int_size(top, bottom) >= buf->buffer_length)
+    {
+        return cb_error_full;
+    }
+
+    // Copy the element and publish it to the thieves.
+    (void)memcpy(cb_deque_int_slot(deque, buf, bottom), elem, deque->elem_size);
+    CB_DEQUE_STORE(deque->bottom, bottom + 1U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_deque_pop(cb_deque_t * const deque, void * const elem)
+{
+    // Sanity check on arguments.
+    if ((deque == NULL) || (elem == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Reserve the element at the bottom before observing the top, both sequentially consistent, so that a thief either
+    // observes the reservation or its steal is observed here.
+    const size_t bottom = CB_DEQUE_LOAD_RLX(deque->bottom) - 1U;
+    const cb_deque_buf_t * const buf = &deque->bufs[CB_DEQUE_LOAD_RLX(deque->buf_idx)];
+    CB_DEQUE_STORE_SC(deque->bottom, bottom);
+    size_t top = CB_DEQUE_LOAD_SC(deque->top);
+    const size_t size = cb_deque_int_size(top, bottom + 1U);
+    if (size == 0U)
+    {
+        CB_DEQUE_STORE_SC(deque->bottom, bottom + 1U);
+        return cb_error_empty;
+    }
+
+    // With more elements the thieves can't reach this one, if it is the last one race them for it through the top.
+    (void)memcpy(elem, cb_deque_int_slot(deque, buf, bottom), deque->elem_size);
+    if (size > 1U)
+    {
+        return cb_error_ok;
+    }
+    const bool won = CB_DEQUE_CAS_SC(deque->top, top, top + 1U);
+    CB_DEQUE_STORE_SC(deque->bottom, bottom + 1U);
+
+    return (won) ? (cb_error_ok) : (cb_error_empty);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_deque_steal(cb_deque_t * const deque, void * const elem)
+{
+    // Sanity check on arguments.
+    if ((deque == NULL) || (elem == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    for (;;)
+    {
+        // Observe the top before the bottom, see ::cb_deque_pop.
+        size_t top = CB_DEQUE_LOAD_SC(deque->top);
+        const size_t bottom = CB_DEQUE_LOAD_SC(deque->bottom);
+        if (cb_deque_int_size(top, bottom) == 0U)
+        {
+            return cb_error_empty;
+        }
+
+        // Copy the element before claiming it, as once claimed the owner can overwrite it. The owner can also overwrite
+        // it during the copy, after it was claimed by others, but then the claim fails and the copy is discarded.
+        const cb_deque_buf_t * const buf = &deque->bufs[CB_DEQUE_LOAD(deque->buf_idx)];
+        (void)memcpy(elem, cb_deque_int_slot(deque, buf, top), deque->elem_size);
+        if (CB_DEQUE_CAS_SC(deque->top, top, top + 1U))
+        {
+            return cb_error_ok;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_deque_get_filled(cb_deque_t * const deque, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((deque == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Get number of elements.
+    const size_t top = CB_DEQUE_LOAD_SC(deque->top);
+    *count = cb_deque_int_size(top, CB_DEQUE_LOAD_SC(deque->bottom));
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,206 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_hist.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_hist_iapi_impl Internal API implementation */
+/** @defgroup cb_hist_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_hist.h"
+#include <string.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_hist_iapi_impl
+ * @{
+ */
+
+/** Number of linear sub-buckets in each power of two range. */
+#define CB_HIST_SUB_COUNT ((uint64_t)1U << (CB_HIST_SUB_BITS))
+
+/**
+ * @}
+ */
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_hist_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Obtains the index of the most significant bit set in a value.
+ * @param[in] value The value, must not be zero.
+ * @return The index of the most significant bit set.
+ */
+static inline uint64_t cb_hist_int_msb(const uint64_t value);
+
+/**
+ * @brief Obtains the index of the bucket for a value.
+ * @param[in] value The value.
+ * @return The index of the bucket.
+ */
+static size_t cb_hist_int_index(const uint64_t value);
+
+/**
+ * @brief Obtains the highest value that is recorded in a bucket.
+ * @param[in] index The index of the bucket.
+ * @return The highest value of the bucket.
+ */
+static uint64_t cb_hist_int_highest(const size_t index);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_hist_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline uint64_t cb_hist_int_msb(const uint64_t value)
+{
+#if defined(__GNUC__)
+    return (uint64_t)(63 - __builtin_clzll((unsigned long long)value));
+#else
+    uint64_t msb = 0U;
+    for (uint64_t v = value >> 1U; v != 0U; v >>= 1U)
+    {
+        msb++;
+    }
+    return msb;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t cb_hist_int_index(const uint64_t value)
+{
+    // Values out of range are recorded in the last bucket.
+    if (value >= ((uint64_t)1U << (CB_HIST_MAX_BITS)))
+    {
+        return CB_HIST_BUCKETS - 1U;
+    }
+    // Values in the first range are recorded with no loss of precision.
+    if (value < CB_HIST_SUB_COUNT)
+    {
+        return (size_t)value;
+    }
+
+    // Other values, the range is determined by the most significant bit and the sub-bucket by the bits that follow it.
+    const uint64_t shift = cb_hist_int_msb(value) - (CB_HIST_SUB_BITS);
+    return (size_t)(((shift + 1U) << (CB_HIST_SUB_BITS)) + ((value >> shift) - CB_HIST_SUB_COUNT));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t cb_hist_int_highest(const size_t index)
+{
+    if (index < CB_HIST_SUB_COUNT)
+    {
+        return (uint64_t)index;
+    }
+
+    const uint64_t shift = ((uint64_t)index >> (CB_HIST_SUB_BITS)) - 1U;
+    const uint64_t sub = (uint64_t)index & (CB_HIST_SUB_COUNT - 1U);
+    return ((CB_HIST_SUB_COUNT + sub) << shift) + (((uint64_t)1U << shift) - 1U);
+}
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_hist_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_hist_init(cb_hist_t * const hist)
+{
+    // Sanity check on arguments.
+    if (hist == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize.
+    (void)memset(hist->counts, 0, sizeof(hist->counts));
+    hist->total = 0U;
+    hist->min = UINT64_MAX;
+    hist->max = 0U;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_hist_record(cb_hist_t * const hist, const uint64_t value)
+{
+    // Sanity check on arguments.
+    if (hist == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Record value.
+    hist->counts[cb_hist_int_index(value)]++;
+    hist->total++;
+    hist->min = (value < hist->min) ? (value) : (hist->min);
+    hist->max = (value > hist->max) ? (value) : (hist->max);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_hist_percentile(const cb_hist_t * const hist, const double percentile, uint64_t * const value)
+{
+    // Sanity check on arguments, written so that a NaN percentile is rejected.
+    if ((hist == NULL) || (value == NULL) || !(percentile > 0.0) || (percentile > 100.0))
+    {
+        return cb_error_invalid_args;
+    }
+    if (hist->total == 0U)
+    {
+        return cb_error_empty;
+    }
+
+    // Rank of the value at the percentile, rounded up.
+    const double rank = ((double)hist->total * percentile) / 100.0;
+    uint64_t target = (uint64_t)rank;
+    target += ((double)target < rank) ? (1U) : (0U);
+    target = (target == 0U) ? (1U) : (target);
+
+    // Find the bucket where the rank falls.
+    uint64_t cumulative = 0U;
+    size_t index = 0U;
+    for (; index < (CB_HIST_BUCKETS - 1U); index++)
+    {
+        cumulative += hist->counts[index];
+        if (cumulative >= target)
+        {
+            break;
+        }
+    }
+
+    // The highest value of the bucket, but not above the maximum value recorded.
+    const uint64_t highest = cb_hist_int_highest(index);
+    *value = (highest < hist->max) ? (highest) : (hist->max);
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,151 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_lock.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_lock_iapi_impl Internal API implementation */
+/** @defgroup cb_lock_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+// For syscall, must be defined before any system header is included.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "cb/cb_lock.h"
+#ifdef CB_USE_STDATOMIC
+#include <sched.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <stdint.h>
+#endif
+#endif
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_iapi_impl
+ * @{
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+/** Hints the processor that the thread is spinning, to reduce its power and the penalty when the spin ends. */
+#define CB_LOCK_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+/** Hints the processor that the thread is spinning, to reduce its power and the penalty when the spin ends. */
+#define CB_LOCK_PAUSE() __asm__ __volatile__("yield")
+#else
+/** Hints the processor that the thread is spinning, not available on this platform. */
+#define CB_LOCK_PAUSE()
+#endif
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_iapi_impl
+ * @{
+ */
+
+/** Names of the lock strategies, in the same order as ::cb_lock_id_t. */
+static const char * const cb_lock_names[cb_lock_id_count] = {
+    "evt",
+    "ticket",
+    "adaptive",
+    "pthread",
+};
+
+#if defined(CB_USE_STDATOMIC) && defined(__linux__)
+// The state of the adaptive lock is used as the futex word.
+_Static_assert(sizeof(cb_atomic_uint) == sizeof(uint32_t), "cb_atomic_uint can't be used as a futex word");
+#endif
+
+/**
+ * @}
+ */
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_papi_impl
+ * @{
+ */
+
+#ifdef CB_USE_STDATOMIC
+/*--------------------------------------------------------------------------------------------------------------------*/
+void cb_lock_ticket_wait(cb_atomic_uint * const owner, const unsigned int ticket)
+{
+    // Spin while the previous tickets are likely to be served soon, then let the holders run.
+    for (size_t spins = 0U; atomic_load_explicit(owner, memory_order_acquire) != ticket; spins++)
+    {
+        if (spins < CB_LOCK_SPINS)
+        {
+            CB_LOCK_PAUSE();
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void cb_lock_adaptive_wait(cb_atomic_uint * const state)
+{
+    // Spin while the holder is likely to release the lock soon.
+    for (size_t spins = 0U; spins < CB_LOCK_SPINS; spins++)
+    {
+        unsigned int expected = 0U;
+        if ((atomic_load_explicit(state, memory_order_relaxed) == 0U) &&
+            atomic_compare_exchange_weak_explicit(state, &expected, 1U, memory_order_acquire, memory_order_relaxed))
+        {
+            return;
+        }
+        CB_LOCK_PAUSE();
+    }
+
+    // Mark the lock as contended, so the holder wakes a waiter when releasing it, and sleep until then. The lock is
+    // taken as contended, as other threads might still be sleeping on it.
+    while (atomic_exchange_explicit(state, 2U, memory_order_acquire) != 0U)
+    {
+#ifdef __linux__
+        (void)syscall(SYS_futex, (void *)state, FUTEX_WAIT_PRIVATE, 2U, NULL, NULL, 0);
+#else
+        (void)sched_yield();
+#endif
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void cb_lock_adaptive_wake(cb_atomic_uint * const state)
+{
+#ifdef __linux__
+    (void)syscall(SYS_futex, (void *)state, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    // Waiters yield the processor instead of sleeping, nothing to wake.
+    (void)state;
+#endif
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+const char * cb_lock_name(const cb_lock_id_t lock_id)
+{
+    return ((size_t)lock_id < (size_t)cb_lock_id_count) ? (cb_lock_names[lock_id]) : (NULL);
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,84 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_lock_prof.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_lock_prof_iapi_impl Internal API implementation */
+/** @defgroup cb_lock_prof_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_lock_prof.h"
+#include <string.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_prof_iapi_impl
+ * @{
+ */
+
+/** Names of the functions, in the same order as ::cb_fn_id_t. */
+static const char * const cb_lock_prof_fn_names[cb_fn_id_count] = {
+    "cb_write",
+    "cb_read",
+    "cb_set_watermarks",
+    "cb_get_unfilled",
+    "cb_get_filled",
+    "cb_is_empty",
+    "cb_is_full",
+    "cb_write_done",
+    "cb_read_done",
+    "cb_get_stats",
+    "cb_reset_stats",
+};
+
+/**
+ * @}
+ */
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_prof_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_lock_prof_init(cb_lock_prof_t * const prof)
+{
+    // Sanity check on arguments.
+    if (prof == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize.
+    for (size_t i = 0U; i < (size_t)cb_fn_id_count; i++)
+    {
+        (void)cb_hist_init(&prof->wait[i]);
+        (void)cb_hist_init(&prof->hold[i]);
+    }
+    (void)memset(prof->acquired, 0, sizeof(prof->acquired));
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+const char * cb_lock_prof_fn_name(const cb_fn_id_t fn)
+{
+    return ((size_t)fn < (size_t)cb_fn_id_count) ? (cb_lock_prof_fn_names[fn]) : (NULL);
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,310 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_prio.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_prio_iapi_impl Internal API implementation */
+/** @defgroup cb_prio_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_prio.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_prio_iapi_impl
+ * @{
+ */
+
+/** Bit of a level in the bitmaps. */
+#define CB_PRIO_BIT(level) ((uint_least32_t)1U << (level))
+
+/** Bitmap with the bits of all the levels set. */
+#define CB_PRIO_ALL(count) ((uint_least32_t)((CB_PRIO_BIT((count) - 1U) << 1U) - 1U))
+
+#ifdef CB_USE_STDATOMIC
+/** Initialization, load, set and clear of bits of the occupancy bitmap, sequentially consistent. */
+/** @{ */
+#define CB_PRIO_INIT(variable, value)  (atomic_init(&(variable), (value)))
+#define CB_PRIO_LOAD(variable)         (atomic_load(&(variable)))
+#define CB_PRIO_SET(variable, mask)    ((void)atomic_fetch_or(&(variable), (mask)))
+#define CB_PRIO_CLEAR(variable, mask)  ((void)atomic_fetch_and(&(variable), (uint_least32_t)~(mask)))
+/** @} */
+#else
+/** Initialization, load, set and clear of bits of the occupancy bitmap, without atomic support. */
+/** @{ */
+#define CB_PRIO_INIT(variable, value)  (variable) = (value)
+#define CB_PRIO_LOAD(variable)         (variable)
+#define CB_PRIO_SET(variable, mask)    (variable) |= (mask)
+#define CB_PRIO_CLEAR(variable, mask)  (variable) &= (uint_least32_t)~(mask)
+/** @} */
+#endif
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_prio_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Obtains the lowest level set in a bitmap, the one with the highest priority.
+ * @param[in] mask The bitmap, not zero.
+ * @return The lowest level set.
+ */
+static inline size_t cb_prio_int_lowest(const uint_least32_t mask);
+
+/**
+ * @brief Clears the bit of a level in the occupancy bitmap if it is empty.
+ *
+ * The bit is cleared before checking the level again, so that elements written at the same time are either observed
+ * here, or their producer sets the bit again after the bit was cleared here.
+ * @param[in] prio Priority rings context.
+ * @param[in] level The level.
+ */
+static void cb_prio_int_update(cb_prio_t * const prio, const size_t level);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_prio_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline size_t cb_prio_int_lowest(const uint_least32_t mask)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzl((unsigned long)mask);
+#else
+    size_t level = 0U;
+    for (uint_least32_t m = mask; (m & 1U) == 0U; m >>= 1U)
+    {
+        level++;
+    }
+    return level;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_prio_int_update(cb_prio_t * const prio, const size_t level)
+{
+    bool is_empty = false;
+
+    (void)cb_is_empty_lockfree(&prio->levels[level], &is_empty);
+    if (is_empty)
+    {
+        CB_PRIO_CLEAR(prio->occupied, CB_PRIO_BIT(level));
+        (void)cb_is_empty_lockfree(&prio->levels[level], &is_empty);
+        if (!is_empty)
+        {
+            CB_PRIO_SET(prio->occupied, CB_PRIO_BIT(level));
+        }
+    }
+}
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_prio_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_prio_init(cb_prio_t * const prio, cb_t * const levels, const size_t count)
+{
+    // Sanity check on arguments, all the levels must have elements of the same size.
+    if ((prio == NULL) || (levels == NULL) || (count == 0U) || (count > CB_PRIO_MAX_LEVELS))
+    {
+        return cb_error_invalid_args;
+    }
+    for (size_t i = 1U; i < count; i++)
+    {
+        if (levels[i].elem_size != levels[0U].elem_size)
+        {
+            return cb_error_invalid_args;
+        }
+    }
+
+    // Initialize, with the levels that have elements already.
+    prio->levels = levels;
+    prio->count = count;
+    (void)cb_prio_set_weights(prio, NULL);
+    CB_PRIO_INIT(prio->occupied, 0U);
+    for (size_t i = 0U; i < count; i++)
+    {
+        CB_PRIO_SET(prio->occupied, CB_PRIO_BIT(i));
+        cb_prio_int_update(prio, i);
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_prio_deinit(cb_prio_t * const prio)
+{
+    // Sanity check on arguments.
+    if (prio == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Deinitialize.
+    (void)cb_prio_set_weights(prio, NULL);
+    prio->levels = NULL;
+    prio->count = 0U;
+    CB_PRIO_CLEAR(prio->occupied, CB_PRIO_LOAD(prio->occupied));
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_prio_set_weights(cb_prio_t * const prio, const size_t * const weights)
+{
+    // Sanity check on arguments.
+    if (prio == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+    for (size_t i = 0U; (weights != NULL) && (i < prio->count); i++)
+    {
+        if (weights[i] == 0U)
+        {
+            return cb_error_invalid_args;
+        }
+    }
+
+    // Set the weights, and start a new round.
+    for (size_t i = 0U; i < CB_PRIO_MAX_LEVELS; i++)
+    {
+        prio->weights[i] = ((weights != NULL) && (i < prio->count)) ? (weights[i]) : (0U);
+        prio->credits[i] = prio->weights[i];
+    }
+    prio->credited = ((weights != NULL) && (prio->count > 0U)) ? (CB_PRIO_ALL(prio->count)) : (0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_prio_write(cb_prio_t * const prio, const size_t level, const void * const buffer, const size_t count)
+{
+    // Sanity check on arguments, the rest are checked by the level.
+    if ((prio == NULL) || (level >= prio->count))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Set the bit of the level after the elements are written, see ::cb_prio_int_update.
+    const cb_error_t error = cb_write(&prio->levels[level], buffer, count);
+    if (error == cb_error_ok)
+    {
+        CB_PRIO_SET(prio->occupied, CB_PRIO_BIT(level));
+    }
+
+    return error;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_prio_read(cb_prio_t * const prio,
+                        void * const buffer,
+                        const size_t count,
+                        size_t * const read,
+                        size_t * const level)
+{
+    // Sanity check on arguments.
+    if ((prio == NULL) || (buffer == NULL) || (count == 0U) || (read == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+    *read = 0U;
+
+    const bool weighted = (prio->weights[0U] != 0U);
+    uint_least32_t occupied = CB_PRIO_LOAD(prio->occupied);
+    while (occupied != 0U)
+    {
+        // With weights, the levels with credits left go first, and when none has, a new round starts.
+        uint_least32_t candidates = (weighted) ? (occupied & prio->credited) : (occupied);
+        if (candidates == 0U)
+        {
+            for (size_t i = 0U; i < prio->count; i++)
+            {
+                prio->credits[i] = prio->weights[i];
+            }
+            prio->credited = CB_PRIO_ALL(prio->count);
+            candidates = occupied;
+        }
+
+        // Read from the highest priority level that might have elements, up to its credits left with weights.
+        const size_t lvl = cb_prio_int_lowest(candidates);
+        size_t filled = 0U;
+        (void)cb_get_readable_lockfree(&prio->levels[lvl], &filled);
+        filled = (filled > count) ? (count) : (filled);
+        filled = ((weighted) && (filled > prio->credits[lvl])) ? (prio->credits[lvl]) : (filled);
+        if (filled > 0U)
+        {
+            const cb_error_t error = cb_read(&prio->levels[lvl], buffer, filled);
+            if (error != cb_error_ok)
+            {
+                return error;
+            }
+            if (weighted)
+            {
+                prio->credits[lvl] -= filled;
+                if (prio->credits[lvl] == 0U)
+                {
+                    prio->credited &= (uint_least32_t)~CB_PRIO_BIT(lvl);
+                }
+            }
+            cb_prio_int_update(prio, lvl);
+            *read = filled;
+            if (level != NULL)
+            {
+                *level = lvl;
+            }
+            return cb_error_ok;
+        }
+
+        // The level was emptied, clear its bit and try the next one.
+        cb_prio_int_update(prio, lvl);
+        occupied &= (uint_least32_t)~CB_PRIO_BIT(lvl);
+    }
+
+    return cb_error_empty;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_prio_is_empty(cb_prio_t * const prio, bool * const is_empty)
+{
+    // Sanity check on arguments.
+    if ((prio == NULL) || (is_empty == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Check the occupancy bitmap.
+    *is_empty = (CB_PRIO_LOAD(prio->occupied) == 0U);
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,194 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_shard.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_shard_iapi_impl Internal API implementation */
+/** @defgroup cb_shard_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_shard.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_shard_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Reads the elements available in a shard, up to the specified number of elements.
+ *
+ * The number of elements available is obtained without locking, if other consumers read them in the meantime, nothing
+ * is read and ::cb_error_empty is returned.
+ * @param[in] cb The shard.
+ * @param[out] buffer The buffer where to read the elements.
+ * @param[in] count The maximum number of elements to read.
+ * @param[in] steal @c true to read up to half of the elements available, rounded up, @c false to read all of them.
+ * @param[out] read The number of elements read.
+ * @return The result of ::cb_read, or ::cb_error_empty if the shard is empty.
+ */
+static cb_error_t
+    cb_shard_int_take(cb_t * const cb, void * const buffer, const size_t count, const bool steal, size_t * const read);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_shard_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t
+    cb_shard_int_take(cb_t * const cb, void * const buffer, const size_t count, const bool steal, size_t * const read)
+{
+    size_t filled = 0U;
+    (void)cb_get_readable_lockfree(cb, &filled);
+    filled = (steal) ? ((filled + 1U) / 2U) : (filled);
+    filled = (filled > count) ? (count) : (filled);
+    if (filled == 0U)
+    {
+        return cb_error_empty;
+    }
+
+    const cb_error_t error = cb_read(cb, buffer, filled);
+    *read = (error == cb_error_ok) ? (filled) : (0U);
+
+    return error;
+}
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_shard_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_shard_init(cb_shard_t * const shard, cb_t * const shards, const size_t count)
+{
+    // Sanity check on arguments, all the shards must have elements of the same size.
+    if ((shard == NULL) || (shards == NULL) || (count == 0U))
+    {
+        return cb_error_invalid_args;
+    }
+    for (size_t i = 1U; i < count; i++)
+    {
+        if (shards[i].elem_size != shards[0U].elem_size)
+        {
+            return cb_error_invalid_args;
+        }
+    }
+
+    // Initialize sharded ring.
+    shard->shards = shards;
+    shard->count = count;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_shard_deinit(cb_shard_t * const shard)
+{
+    // Sanity check on arguments.
+    if (shard == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Deinitialize sharded ring.
+    shard->shards = NULL;
+    shard->count = 0U;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_shard_write(cb_shard_t * const shard, const size_t local, const void * const buffer, const size_t count)
+{
+    // Sanity check on arguments, the rest are checked by the shard.
+    if ((shard == NULL) || (local >= shard->count))
+    {
+        return cb_error_invalid_args;
+    }
+
+    return cb_write(&shard->shards[local], buffer, count);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_shard_read(cb_shard_t * const shard,
+                         const size_t home,
+                         void * const buffer,
+                         const size_t count,
+                         size_t * const read,
+                         size_t * const from)
+{
+    // Sanity check on arguments.
+    if ((shard == NULL) || (home >= shard->count) || (buffer == NULL) || (count == 0U) || (read == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+    *read = 0U;
+
+    // Drain the home shard first, and then steal from the others, starting from the next one to spread the thieves.
+    for (size_t i = 0U; i < shard->count; i++)
+    {
+        const size_t victim = (home + i) % shard->count;
+        const cb_error_t error = cb_shard_int_take(&shard->shards[victim], buffer, count, (i != 0U), read);
+        if (error == cb_error_ok)
+        {
+            if (from != NULL)
+            {
+                *from = victim;
+            }
+            return cb_error_ok;
+        }
+        if (error != cb_error_empty)
+        {
+            return error;
+        }
+    }
+
+    return cb_error_empty;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_shard_get_filled(cb_shard_t * const shard, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((shard == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Add the elements of each shard, without locking any of them.
+    *count = 0U;
+    for (size_t i = 0U; i < shard->count; i++)
+    {
+        size_t filled = 0U;
+        (void)cb_get_filled_lockfree(&shard->shards[i], &filled);
+        *count += filled;
+    }
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
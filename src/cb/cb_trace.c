@@ -0,0 +1,116 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_trace.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_trace_iapi_impl Internal API implementation */
+/** @defgroup cb_trace_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_trace.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_trace_iapi_impl
+ * @{
+ */
+
+#ifdef CB_USE_STDATOMIC
+/** Reserves the index of the next record, records from different threads are stored in different slots. */
+#define CB_TRACE_NEXT(buf) (atomic_fetch_add_explicit(&(buf)->next, 1U, memory_order_relaxed))
+/** Obtains the number of records reserved. */
+#define CB_TRACE_COUNT(buf) (atomic_load_explicit(&(buf)->next, memory_order_relaxed))
+/** Clears the records. */
+#define CB_TRACE_CLEAR(buf) (atomic_init(&(buf)->next, 0U))
+#else
+/** Reserves the index of the next record. */
+#define CB_TRACE_NEXT(buf)  ((buf)->next++)
+/** Obtains the number of records reserved. */
+#define CB_TRACE_COUNT(buf) ((buf)->next)
+/** Clears the records. */
+#define CB_TRACE_CLEAR(buf) (buf)->next = 0U
+#endif
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_trace_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_trace_buf_init(cb_trace_buf_t * const buf, cb_trace_rec_t * const recs, const size_t capacity)
+{
+    // Sanity check on arguments.
+    if ((buf == NULL) || (recs == NULL) || (capacity == 0U))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize.
+    buf->recs = recs;
+    buf->capacity = capacity;
+    CB_TRACE_CLEAR(buf);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void cb_trace_buf_sink(const cb_trace_rec_t * const rec, void * const user_data)
+{
+    cb_trace_buf_t * const buf = (cb_trace_buf_t *)user_data;
+
+    // Records beyond the capacity are dropped, but still counted.
+    const size_t idx = CB_TRACE_NEXT(buf);
+    if (idx < buf->capacity)
+    {
+        buf->recs[idx] = *rec;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_trace_buf_hdr(const cb_trace_buf_t * const buf,
+                            const cb_t * const cb,
+                            const uint64_t ticks_per_sec,
+                            cb_trace_hdr_t * const hdr)
+{
+    // Sanity check on arguments.
+    if ((buf == NULL) || (cb == NULL) || (ticks_per_sec == 0U) || (hdr == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    const size_t next = CB_TRACE_COUNT(buf);
+    const size_t count = (next > buf->capacity) ? (buf->capacity) : (next);
+    *hdr = (cb_trace_hdr_t){
+        .magic = CB_TRACE_MAGIC,
+        .version = CB_TRACE_VERSION,
+        .rec_size = (uint16_t)sizeof(cb_trace_rec_t),
+        .buffer_length = cb->buffer_length,
+        .elem_size = cb->elem_size,
+        .ticks_per_sec = ticks_per_sec,
+        .count = count,
+        .dropped = next - count,
+    };
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
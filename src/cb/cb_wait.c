@@ -0,0 +1,510 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_wait.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_wait_iapi_impl Internal API implementation */
+/** @defgroup cb_wait_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+// For syscall and clock_gettime, must be defined before any system header is included.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "cb/cb_wait.h"
+#if defined(CB_USE_WAIT) && defined(CB_USE_STDATOMIC)
+#include <limits.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+#ifdef CB_USE_WAIT
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_wait_iapi_impl
+ * @{
+ */
+
+/** Bit of a slot in the bitmaps. */
+#define CB_WAIT_BIT(slot) ((uint_least64_t)1U << (slot))
+
+#ifdef CB_USE_STDATOMIC
+/** Initialization, load, set and take of the bitmap and counters of the wait set, sequentially consistent. */
+/** @{ */
+#define CB_WAIT_INIT(variable, value) (atomic_init(&(variable), (value)))
+#define CB_WAIT_LOAD(variable)        (atomic_load(&(variable)))
+#define CB_WAIT_SET(variable, mask)   ((void)atomic_fetch_or(&(variable), (mask)))
+#define CB_WAIT_CLEAR(variable, mask) ((void)atomic_fetch_and(&(variable), ~(uint_least64_t)(mask)))
+#define CB_WAIT_TAKE(variable)        (atomic_exchange(&(variable), 0U))
+#define CB_WAIT_ADD(variable, value)  ((void)atomic_fetch_add(&(variable), (value)))
+#define CB_WAIT_SUB(variable, value)  ((void)atomic_fetch_sub(&(variable), (value)))
+#define CB_WAIT_FENCE()               (atomic_thread_fence(memory_order_seq_cst))
+/** @} */
+#else
+/** Initialization, load, set and take of the bitmap and counters of the wait set, without atomic support. */
+/** @{ */
+#define CB_WAIT_INIT(variable, value) (variable) = (value)
+#define CB_WAIT_LOAD(variable)        (variable)
+#define CB_WAIT_SET(variable, mask)   (variable) |= (mask)
+#define CB_WAIT_CLEAR(variable, mask) (variable) &= ~(uint_least64_t)(mask)
+#define CB_WAIT_TAKE(variable)        (cb_wait_int_take(&(variable)))
+#define CB_WAIT_ADD(variable, value)  (variable) += (value)
+#define CB_WAIT_SUB(variable, value)  (variable) -= (value)
+#define CB_WAIT_FENCE()
+/** @} */
+#endif
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_wait_iapi_impl
+ * @{
+ */
+
+#if defined(CB_USE_STDATOMIC) && defined(__linux__)
+// The number of signals is used as the futex word.
+_Static_assert(sizeof(cb_atomic_uint) == sizeof(uint32_t), "cb_atomic_uint can't be used as a futex word");
+#endif
+
+/**
+ * @}
+ */
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_wait_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Obtains the lowest slot set in a bitmap.
+ * @param[in] mask The bitmap, not zero.
+ * @return The lowest slot set.
+ */
+static inline size_t cb_wait_int_lowest(const uint_least64_t mask);
+
+/**
+ * @brief Obtains the events of interest a circular buffer of a wait set is ready for.
+ * @param[in] ws Wait set context.
+ * @param[in] slot The slot of the circular buffer.
+ * @return The events ready, OR combination of ::cb_wait_evt_t.
+ */
+static cb_wait_evt_t cb_wait_int_ready(const cb_wait_t * const ws, const size_t slot);
+
+/**
+ * @brief Obtains the deadline of a wait.
+ * @param[in] timeout_ms The timeout of the wait, the deadline is not set if not positive.
+ * @param[out] deadline The deadline of the wait.
+ */
+static void cb_wait_int_deadline(const int timeout_ms, void * const deadline);
+
+/**
+ * @brief Sleeps until the wait set is signaled, or the deadline expires.
+ * @param[in] ws Wait set context.
+ * @param[in] seq The number of signals observed before the circular buffers were checked, it does not sleep if the
+ * wait set was signaled since.
+ * @param[in] timeout_ms The timeout of the wait, negative for none.
+ * @param[in] deadline The deadline of the wait, if it has a timeout.
+ * @return @c true if it might have been signaled, @c false if the deadline expired.
+ */
+static bool cb_wait_int_sleep(cb_wait_t * const ws,
+                              const unsigned int seq,
+                              const int timeout_ms,
+                              const void * const deadline);
+
+#ifndef CB_USE_STDATOMIC
+/**
+ * @brief Loads and clears a bitmap, without atomic support.
+ * @param[in] mask The bitmap.
+ * @return The bitmap before it was cleared.
+ */
+static inline uint_least64_t cb_wait_int_take(uint_least64_t * const mask);
+#endif
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_wait_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline size_t cb_wait_int_lowest(const uint_least64_t mask)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll((unsigned long long)mask);
+#else
+    size_t slot = 0U;
+    for (uint_least64_t m = mask; (m & 1U) == 0U; m >>= 1U)
+    {
+        slot++;
+    }
+    return slot;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_wait_evt_t cb_wait_int_ready(const cb_wait_t * const ws, const size_t slot)
+{
+    unsigned int events = (unsigned int)cb_wait_evt_none;
+    bool is_full = true;
+
+    if (((unsigned int)ws->events[slot] & (unsigned int)cb_wait_evt_readable) != 0U)
+    {
+        // Only the elements processed by the last stage, if any, can be read.
+        size_t readable = 0U;
+        (void)cb_get_readable_lockfree(ws->rings[slot], &readable);
+        events |= (readable == 0U) ? (0U) : ((unsigned int)cb_wait_evt_readable);
+    }
+    if (((unsigned int)ws->events[slot] & (unsigned int)cb_wait_evt_writable) != 0U)
+    {
+        (void)cb_is_full_lockfree(ws->rings[slot], &is_full);
+        events |= (is_full) ? (0U) : ((unsigned int)cb_wait_evt_writable);
+    }
+
+    return (cb_wait_evt_t)events;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_wait_int_deadline(const int timeout_ms, void * const deadline)
+{
+#ifdef CB_USE_STDATOMIC
+    struct timespec * const end = (struct timespec *)deadline;
+    if (timeout_ms > 0)
+    {
+        (void)clock_gettime(CLOCK_MONOTONIC, end);
+        end->tv_sec += timeout_ms / 1000;
+        end->tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (end->tv_nsec >= 1000000000L)
+        {
+            end->tv_sec++;
+            end->tv_nsec -= 1000000000L;
+        }
+    }
+#else
+    (void)timeout_ms;
+    (void)deadline;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool cb_wait_int_sleep(cb_wait_t * const ws,
+                              const unsigned int seq,
+                              const int timeout_ms,
+                              const void * const deadline)
+{
+#ifdef CB_USE_STDATOMIC
+    // Time left until the deadline, if any.
+    struct timespec left = {0};
+    if (timeout_ms >= 0)
+    {
+        const struct timespec * const end = (const struct timespec *)deadline;
+        struct timespec now = {0};
+        (void)clock_gettime(CLOCK_MONOTONIC, &now);
+        if ((now.tv_sec > end->tv_sec) || ((now.tv_sec == end->tv_sec) && (now.tv_nsec >= end->tv_nsec)))
+        {
+            return false;
+        }
+        left.tv_sec = end->tv_sec - now.tv_sec;
+        left.tv_nsec = end->tv_nsec - now.tv_nsec;
+        if (left.tv_nsec < 0)
+        {
+            left.tv_sec--;
+            left.tv_nsec += 1000000000L;
+        }
+    }
+
+    // Sleep while the number of signals did not change, the signals only wake sleeping threads.
+    CB_WAIT_ADD(ws->waiters, 1U);
+#ifdef __linux__
+    (void)syscall(SYS_futex, (void *)&ws->seq, FUTEX_WAIT_PRIVATE, seq, (timeout_ms >= 0) ? (&left) : (NULL), NULL, 0);
+#else
+    // Without futexes there is no word to sleep on, thus waiters poll, sleeping up to CB_WAIT_POLL_US between checks.
+    (void)seq;
+    struct timespec nap = {.tv_sec = 0, .tv_nsec = (long)CB_WAIT_POLL_US * 1000L};
+    if ((timeout_ms >= 0) && (left.tv_sec == 0) && (left.tv_nsec < nap.tv_nsec))
+    {
+        nap = left;
+    }
+    (void)nanosleep(&nap, NULL);
+#endif
+    CB_WAIT_SUB(ws->waiters, 1U);
+
+    return true;
+#else
+    // Without atomic support there is no one to signal the wait set while checking, return after a single check.
+    (void)ws;
+    (void)seq;
+    (void)timeout_ms;
+    (void)deadline;
+
+    return false;
+#endif
+}
+
+#ifndef CB_USE_STDATOMIC
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline uint_least64_t cb_wait_int_take(uint_least64_t * const mask)
+{
+    const uint_least64_t value = *mask;
+
+    *mask = 0U;
+
+    return value;
+}
+#endif
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_wait_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_wait_init(cb_wait_t * const ws)
+{
+    // Sanity check on arguments.
+    if (ws == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize.
+    for (size_t i = 0U; i < CB_WAIT_MAX_RINGS; i++)
+    {
+        ws->rings[i] = NULL;
+        ws->events[i] = cb_wait_evt_none;
+        ws->user_data[i] = NULL;
+    }
+    ws->reported = 0U;
+    CB_WAIT_INIT(ws->pending, 0U);
+    CB_WAIT_INIT(ws->seq, 0U);
+    CB_WAIT_INIT(ws->waiters, 0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_wait_deinit(cb_wait_t * const ws)
+{
+    // Sanity check on arguments.
+    if (ws == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Deinitialize, removing the circular buffers left.
+    for (size_t i = 0U; i < CB_WAIT_MAX_RINGS; i++)
+    {
+        if (ws->rings[i] != NULL)
+        {
+            (void)cb_wait_remove(ws, ws->rings[i]);
+        }
+    }
+    ws->reported = 0U;
+    (void)CB_WAIT_TAKE(ws->pending);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_wait_add(cb_wait_t * const ws, cb_t * const cb, const cb_wait_evt_t events, void * const user_data)
+{
+    // Sanity check on arguments.
+    const unsigned int all = (unsigned int)cb_wait_evt_readable | (unsigned int)cb_wait_evt_writable;
+    if ((ws == NULL) || (cb == NULL) || (cb->wait != NULL) || (events == cb_wait_evt_none) ||
+        (((unsigned int)events & ~all) != 0U))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Take the first free slot.
+    size_t slot = 0U;
+    while ((slot < CB_WAIT_MAX_RINGS) && (ws->rings[slot] != NULL))
+    {
+        slot++;
+    }
+    if (slot >= CB_WAIT_MAX_RINGS)
+    {
+        return cb_error_full;
+    }
+
+    // Register, and signal it so that the next wait checks it, as it might already be ready.
+    ws->rings[slot] = cb;
+    ws->events[slot] = events;
+    ws->user_data[slot] = user_data;
+    cb->wait = ws;
+    cb->wait_slot = slot;
+    cb_wait_signal(ws, slot);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_wait_remove(cb_wait_t * const ws, cb_t * const cb)
+{
+    // Sanity check on arguments.
+    if ((ws == NULL) || (cb == NULL) || (cb->wait != ws))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Unregister, and forget about its signals.
+    const size_t slot = cb->wait_slot;
+    ws->rings[slot] = NULL;
+    ws->events[slot] = cb_wait_evt_none;
+    ws->user_data[slot] = NULL;
+    ws->reported &= ~CB_WAIT_BIT(slot);
+    CB_WAIT_CLEAR(ws->pending, CB_WAIT_BIT(slot));
+    cb->wait = NULL;
+    cb->wait_slot = 0U;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_wait_wait(cb_wait_t * const ws,
+                        cb_wait_ready_t * const ready,
+                        const size_t max,
+                        size_t * const count,
+                        const int timeout_ms)
+{
+    // Sanity check on arguments.
+    if ((ws == NULL) || (ready == NULL) || (max == 0U) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+    *count = 0U;
+
+    // Deadline of the wait, if any.
+#ifdef CB_USE_STDATOMIC
+    struct timespec deadline = {0};
+#else
+    int deadline = 0;
+#endif
+    cb_wait_int_deadline(timeout_ms, &deadline);
+
+    for (;;)
+    {
+        // Ordered after the reads and writes of this thread, see ::cb_int_ready_limit, and before the checks, so that a
+        // signal after them changes the number of signals and the sleep returns immediately.
+        CB_WAIT_FENCE();
+        const unsigned int seq = CB_WAIT_LOAD(ws->seq);
+
+        // Check the slots signaled and those reported last time, those ready are reported again next time, and those
+        // that are not are signaled when they become ready.
+        uint_least64_t candidates = CB_WAIT_TAKE(ws->pending) | ws->reported;
+        ws->reported = 0U;
+        while (candidates != 0U)
+        {
+            const size_t slot = cb_wait_int_lowest(candidates);
+            candidates &= candidates - 1U;
+            if (ws->rings[slot] == NULL)
+            {
+                continue;
+            }
+            const cb_wait_evt_t events = cb_wait_int_ready(ws, slot);
+            if (events == cb_wait_evt_none)
+            {
+                continue;
+            }
+            ws->reported |= CB_WAIT_BIT(slot);
+            if (*count < max)
+            {
+                ready[*count].cb = ws->rings[slot];
+                ready[*count].events = events;
+                ready[*count].user_data = ws->user_data[slot];
+                (*count)++;
+            }
+        }
+        if (*count > 0U)
+        {
+            return cb_error_ok;
+        }
+
+        // Nothing ready, sleep until signaled.
+        if ((timeout_ms == 0) || !cb_wait_int_sleep(ws, seq, timeout_ms, &deadline))
+        {
+            return cb_error_empty;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+unsigned int cb_wait_signals(cb_wait_t * const ws)
+{
+    if (ws == NULL)
+    {
+        return 0U;
+    }
+
+    // Ordered after the reads and writes of this thread, as in ::cb_wait_wait.
+    CB_WAIT_FENCE();
+    return CB_WAIT_LOAD(ws->seq);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_wait_sleep(cb_wait_t * const ws, const unsigned int seq, const int timeout_ms)
+{
+    // Sanity check on arguments.
+    if (ws == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Sleep once, the caller checks its circular buffer again either way.
+#ifdef CB_USE_STDATOMIC
+    struct timespec deadline = {0};
+#else
+    int deadline = 0;
+#endif
+    cb_wait_int_deadline(timeout_ms, &deadline);
+    if (timeout_ms != 0)
+    {
+        (void)cb_wait_int_sleep(ws, seq, timeout_ms, &deadline);
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void cb_wait_signal(cb_wait_t * const ws, const size_t slot)
+{
+    // Mark the slot and count the signal before checking for sleeping threads, see ::cb_wait_wait.
+    CB_WAIT_SET(ws->pending, CB_WAIT_BIT(slot));
+    CB_WAIT_ADD(ws->seq, 1U);
+#if defined(CB_USE_STDATOMIC) && defined(__linux__)
+    if (CB_WAIT_LOAD(ws->waiters) > 0U)
+    {
+        (void)syscall(SYS_futex, (void *)&ws->seq, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+#endif
+}
+
+/**
+ * @}
+ */
+#endif
+
+/******************************************************************************************************END OF FILE*****/
@@ -30,15 +30,117 @@ extern "C" {
 #include "cb/other/version.h"
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // if __STDC_NO_ATOMICS__ is defined, then stdatomic is not supported.
 // If using clangd or clang-tidy, do not enable atomics, as they raise clang-diagnostic-error which can't be suppressed.
-#if defined(__STDC_NO_ATOMICS__) || defined(__clang__)
+// In C++ only the atomic types are needed, with the same size and alignment as in C, as the functions are built as C.
+// The types are prefixed, so that including this header doesn't declare the names of <stdatomic.h> in C++.
+#if defined(__cplusplus) && defined(CB_HEADER_ONLY)
+#error "cb/cb.h requires the library to be built as C, without CB_HEADER_ONLY defined in C++."
+#elif defined(__STDC_NO_ATOMICS__) || defined(__clang__)
+#elif defined(__cplusplus)
+extern "C++" {
+#include <atomic>
+#include <cstdint>
+}
+typedef std::atomic<bool> cb_atomic_bool;                     /**< Atomic @c bool, as @c atomic_bool in C. */
+typedef std::atomic<unsigned int> cb_atomic_uint;             /**< Atomic @c unsigned @c int, as @c atomic_uint in C. */
+typedef std::atomic<size_t> cb_atomic_size_t;                 /**< Atomic @c size_t, as @c atomic_size_t in C. */
+typedef std::atomic<uint_least32_t> cb_atomic_uint_least32_t; /**< Atomic @c uint_least32_t. */
+typedef std::atomic<uint_least64_t> cb_atomic_uint_least64_t; /**< Atomic @c uint_least64_t. */
+/** Checks that an atomic type has the size and alignment of its value type, as the lock-free types have in C. */
+#define CB_ATOMIC_LAYOUT_ASSERT(atomic_type, type)                                                                    \
+    static_assert((sizeof(atomic_type) == sizeof(type)) && (alignof(atomic_type) == sizeof(type)),                  \
+                  #atomic_type " doesn't have the layout of " #type)
+#define CB_USE_STDATOMIC
 #else
 #include <stdatomic.h>
+typedef atomic_bool cb_atomic_bool;                     /**< Atomic @c bool. */
+typedef atomic_uint cb_atomic_uint;                     /**< Atomic @c unsigned @c int. */
+typedef atomic_size_t cb_atomic_size_t;                 /**< Atomic @c size_t. */
+typedef atomic_uint_least32_t cb_atomic_uint_least32_t; /**< Atomic @c uint_least32_t. */
+typedef atomic_uint_least64_t cb_atomic_uint_least64_t; /**< Atomic @c uint_least64_t. */
+/** Checks that an atomic type has the size and alignment of its value type, as the lock-free types have in C++. */
+#define CB_ATOMIC_LAYOUT_ASSERT(atomic_type, type)                                                                    \
+    _Static_assert((sizeof(atomic_type) == sizeof(type)) && (_Alignof(atomic_type) == sizeof(type)),                \
+                   #atomic_type " doesn't have the layout of " #type)
 #define CB_USE_STDATOMIC
 #endif
 
+#ifdef CB_USE_STDATOMIC
+// The layout of cb_t must be the same in C and C++, as the functions are built as C.
+CB_ATOMIC_LAYOUT_ASSERT(cb_atomic_bool, bool);
+CB_ATOMIC_LAYOUT_ASSERT(cb_atomic_uint, unsigned int);
+CB_ATOMIC_LAYOUT_ASSERT(cb_atomic_size_t, size_t);
+CB_ATOMIC_LAYOUT_ASSERT(cb_atomic_uint_least32_t, uint_least32_t);
+CB_ATOMIC_LAYOUT_ASSERT(cb_atomic_uint_least64_t, uint_least64_t);
+#endif
+
+// If CB_USE_ASYNC is defined, asynchronous copy offload events are available, see ::cb_evt_id_write_async.
+#if defined(CB_USE_ASYNC) && !defined(CB_ASYNC_MAX_OPS)
+/** Maximum number of asynchronous read or write operations that can be pending completion at the same time. */
+#define CB_ASYNC_MAX_OPS (8U)
+#endif
+
+// If CB_USE_STATS is defined, statistics counters are kept for each circular buffer, see ::cb_get_stats.
+#if (defined(CB_USE_STATS) || defined(CB_USE_LOCKS) || defined(CB_USE_PIPELINE)) && !defined(CB_CACHE_LINE_SIZE)
+/** Size of a cache line in bytes, used to keep data updated by reads and by writes in different cache lines. */
+#define CB_CACHE_LINE_SIZE (64U)
+#endif
+
+// The alignment specifier of the members updated by reads and by writes, spelled differently in C and C++.
+#ifdef __cplusplus
+/** Alignment specifier, as spelled in C++. */
+#define CB_ALIGNAS(alignment) alignas(alignment)
+#else
+/** Alignment specifier, as spelled in C. */
+#define CB_ALIGNAS(alignment) _Alignas(alignment)
+#endif
+
+// If CB_USE_PIPELINE is defined, elements can be processed in place by stages before read, see ::cb_set_stages.
+#if defined(CB_USE_PIPELINE) && !defined(CB_MAX_STAGES)
+/** Maximum number of processing stages of a circular buffer, see ::cb_set_stages. */
+#define CB_MAX_STAGES (4U)
+#endif
+
+// If CB_USE_WAIT is defined, consumers can sleep until any of many circular buffers is ready, see ::cb_wait_wait.
+// If CB_USE_EVENTFD is defined, event loops can poll file descriptors signaled on readiness, see ::cb_set_eventfd.
+// If CB_USE_LATENCY is defined, the time elements spend in the circular buffer can be measured, see ::cb_set_latency.
+// If CB_USE_LOCK_PROF is defined, the time waiting for and holding the lock can be measured, see ::cb_set_lock_prof.
+// If CB_USE_TRACE is defined, every write and read can be recorded in a trace, see ::cb_set_trace.
+// If CB_USE_PACKED is defined, both indexes are kept in a single 64-bit word, see ::cb_t.
+#ifdef CB_USE_LATENCY
+#ifndef CB_LAT_MAX_SAMPLES
+/** Maximum number of sampled writes that can be pending to be read at the same time, others are not sampled. */
+#define CB_LAT_MAX_SAMPLES (8U)
+#endif
+#endif
+
+#ifndef CB_SNAPSHOT_RETRIES
+/** Maximum number of times the indexes are reloaded by the lock-free queries to obtain a consistent pair of them. */
+#define CB_SNAPSHOT_RETRIES (4U)
+#endif
+
+#ifndef CB_BATCH_SPINS
+/** Number of times ::cb_read_batch polls the elements while lingering before yielding or sleeping between polls. */
+#define CB_BATCH_SPINS (100U)
+#endif
+
+#ifndef CB_BATCH_SLEEP_MS
+/**
+ * Maximum time in milliseconds ::cb_read_batch sleeps between polls, when empty with a wait set or eventfd. The wait
+ * set takes precedence over the eventfd, which ::cb_read_batch does not drain, thus while the eventfd is readable from
+ * previous writes that its owner has not drained yet, it does not sleep and yields between polls instead.
+ */
+#define CB_BATCH_SLEEP_MS (1)
+#endif
+
+// If CB_USE_LOCKS is defined, built-in locks can be used instead of the lock events, see ::cb_set_lock.
+#ifdef CB_USE_LOCKS
+#include <pthread.h>
+#endif
+
 /* Exported types ----------------------------------------------------------------------------------------------------*/
 /**
  * @addtogroup cb_defs
@@ -64,9 +166,52 @@ typedef enum
     cb_evt_id_read = 0x00000001U, /**< Request to read underlying linear buffer of the circular buffer. */
     cb_evt_id_write = 0x00000002U, /**< Request to write underlying linear buffer of the circular buffer. */
     cb_evt_id_lock = 0x00000004U, /**< Request to lock circular buffer, this event can't return ::cb_error_evt. */
-    cb_evt_id_unlock = 0x00000008U /**< Request to unlock circular buffer, this event can't return ::cb_error_evt. */
+    cb_evt_id_unlock = 0x00000008U, /**< Request to unlock circular buffer, this event can't return ::cb_error_evt. */
+#ifdef CB_USE_ASYNC
+    cb_evt_id_read_async = 0x00000010U, /**< Request to start reading underlying linear buffer, see ::cb_read_done. */
+    cb_evt_id_write_async = 0x00000020U, /**< Request to start writing underlying linear buffer, see ::cb_write_done. */
+#endif
+    cb_evt_id_high_wm = 0x00000040U, /**< Fill level rose to the high watermark, can't return ::cb_error_evt. */
+    cb_evt_id_low_wm = 0x00000080U, /**< Fill level fell to the low watermark, can't return ::cb_error_evt. */
 } cb_evt_id_t;
 
+/** Identifiers of the functions that lock the circular buffer, see ::cb_set_lock_prof. */
+typedef enum
+{
+    cb_fn_id_write = 0U, /**< ::cb_write. */
+    cb_fn_id_read, /**< ::cb_read. */
+    cb_fn_id_set_watermarks, /**< ::cb_set_watermarks. */
+    cb_fn_id_get_unfilled, /**< ::cb_get_unfilled. */
+    cb_fn_id_get_filled, /**< ::cb_get_filled. */
+    cb_fn_id_is_empty, /**< ::cb_is_empty. */
+    cb_fn_id_is_full, /**< ::cb_is_full. */
+    cb_fn_id_write_done, /**< ::cb_write_done. */
+    cb_fn_id_read_done, /**< ::cb_read_done. */
+    cb_fn_id_get_stats, /**< ::cb_get_stats. */
+    cb_fn_id_reset_stats, /**< ::cb_reset_stats. */
+
+    cb_fn_id_count /**< Number of functions. */
+} cb_fn_id_t;
+
+/** Identifiers of the lock strategies, see ::cb_set_lock. */
+typedef enum
+{
+    cb_lock_id_evt = 0U, /**< Locked with the ::cb_evt_id_lock and ::cb_evt_id_unlock events, if subscribed. */
+    cb_lock_id_ticket, /**< Ticket spinlock, fair, for short critical sections with few contending threads. */
+    cb_lock_id_adaptive, /**< Spins for a while and then sleeps in the kernel until released, futex on Linux. */
+    cb_lock_id_pthread, /**< POSIX threads mutex. */
+
+    cb_lock_id_count /**< Number of lock strategies. */
+} cb_lock_id_t;
+
+/** Sides of the circular buffer that are locked, see ::cb_set_lock_split. */
+typedef enum
+{
+    cb_lock_side_all = 0U, /**< The whole circular buffer, with a single lock, unless split. */
+    cb_lock_side_write, /**< The producer side, writes and the queries on unfilled slots, if split. */
+    cb_lock_side_read, /**< The consumer side, reads and the queries on filled slots, if split. */
+} cb_lock_side_t;
+
 /** Unused event data, used for events that do not have any data. */
 typedef struct
 {
@@ -89,11 +234,55 @@ typedef struct
     void * write_ptr; /**< The write pointer where to write the data to. */
 } cb_evt_data_write_t;
 
+#ifdef CB_USE_ASYNC
+/**
+ * @brief Event data for ::cb_evt_id_read_async event.
+ *
+ * The copy is described by up to two spans, the second span is only used if the read wraps around the end of the
+ * underlying linear buffer, in which case @c wrap_bytes is not zero.
+ */
+typedef struct
+{
+    const void * read_ptr; /**< The read pointer where to read the data from. */
+    size_t bytes; /**< The number of bytes to read from @c read_ptr and write to @c buffer. */
+    void * buffer; /**< The buffer where to write data to. */
+    const void * wrap_ptr; /**< The read pointer where to read the wrapped data from, start of the linear buffer. */
+    size_t wrap_bytes; /**< The number of bytes to read from @c wrap_ptr and write to <tt>buffer + bytes</tt>. */
+    size_t seq; /**< The sequence number of the operation, to provide to ::cb_read_done on completion. */
+} cb_evt_data_read_async_t;
+
+/**
+ * @brief Event data for ::cb_evt_id_write_async event.
+ *
+ * The copy is described by up to two spans, the second span is only used if the write wraps around the end of the
+ * underlying linear buffer, in which case @c wrap_bytes is not zero.
+ */
+typedef struct
+{
+    const void * buffer; /**< Buffer The buffer where to read the data from. */
+    size_t bytes; /**< The number of bytes to read from @c buffer and write to @c write_ptr. */
+    void * write_ptr; /**< The write pointer where to write the data to. */
+    size_t wrap_bytes; /**< The number of bytes to read from <tt>buffer + bytes</tt> and write to @c wrap_ptr. */
+    void * wrap_ptr; /**< The write pointer where to write the wrapped data to, start of the linear buffer. */
+    size_t seq; /**< The sequence number of the operation, to provide to ::cb_write_done on completion. */
+} cb_evt_data_write_async_t;
+#endif
+
+/** Event data for ::cb_evt_id_high_wm and ::cb_evt_id_low_wm events. */
+typedef struct
+{
+    size_t filled; /**< The number of filled slots after the operation that crossed the watermark. */
+} cb_evt_data_wm_t;
+
 /** Event data for ::cb_evt_id_lock event. */
-typedef cb_evt_data_unused_t cb_evt_data_lock_t;
+typedef struct
+{
+    size_t unused; /**< Kept for the lock handlers that predate the sides, always zero. */
+    cb_lock_side_t side; /**< The side to lock, always ::cb_lock_side_all unless split, see ::cb_set_lock_split. */
+} cb_evt_data_lock_t;
 
 /** Event data for ::cb_evt_id_unlock event. */
-typedef cb_evt_data_unused_t cb_evt_data_unlock_t;
+typedef cb_evt_data_lock_t cb_evt_data_unlock_t;
 
 /** Event data. */
 typedef union
@@ -102,6 +291,11 @@ typedef union
     cb_evt_data_write_t write; /**< Event data for ::cb_evt_id_write event. */
     cb_evt_data_lock_t lock; /**< Event data for ::cb_evt_id_lock event. */
     cb_evt_data_unlock_t unlock; /**< Event data for ::cb_evt_id_unlock event. */
+    cb_evt_data_wm_t wm; /**< Event data for ::cb_evt_id_high_wm and ::cb_evt_id_low_wm events. */
+#ifdef CB_USE_ASYNC
+    cb_evt_data_read_async_t read_async; /**< Event data for ::cb_evt_id_read_async event. */
+    cb_evt_data_write_async_t write_async; /**< Event data for ::cb_evt_id_write_async event. */
+#endif
 } cb_evt_data_t;
 
 /** Event. */
@@ -121,6 +315,139 @@ typedef struct
  */
 typedef cb_error_t (*cb_evt_handler_t)(cb_evt_t * const evt);
 
+#ifdef CB_USE_ASYNC
+/** Asynchronous operation pending completion. */
+typedef struct
+{
+    size_t end_idx; /**< The index to publish when the operation and all the previous ones have completed. */
+    bool done; /**< @c true if the operation has completed, @c false otherwise. */
+} cb_async_op_t;
+
+/**
+ * Asynchronous operations of one direction, reads or writes, in the order they were started. The operations are
+ * started by the producer or consumer and completed by another thread, thus the sequence numbers are atomic.
+ */
+typedef struct
+{
+    cb_async_op_t ops[CB_ASYNC_MAX_OPS]; /**< Operations, indexed by their sequence number. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_size_t head; /**< The atomic sequence number of the next operation to start. */
+    cb_atomic_size_t tail; /**< The atomic sequence number of the oldest operation pending completion. */
+#else
+    size_t head; /**< Sequence number of the next operation to start. */
+    size_t tail; /**< Sequence number of the oldest operation pending completion. */
+#endif
+} cb_async_t;
+#endif
+
+#ifdef CB_USE_STATS
+/** Statistics counters of one direction, reads or writes, only updated by the thread performing the operation. */
+typedef struct
+{
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_size_t ops; /**< The atomic number of successful operations. */
+    cb_atomic_size_t elems; /**< The atomic number of elements transferred by successful operations. */
+    cb_atomic_size_t errors; /**< The atomic number of operations rejected with ::cb_error_full or ::cb_error_empty. */
+    cb_atomic_size_t wraps; /**< The atomic number of successful operations that wrapped around, with two spans. */
+    cb_atomic_size_t peak; /**< The atomic peak number of filled slots after an operation. */
+#else
+    size_t ops; /**< The number of successful operations. */
+    size_t elems; /**< The number of elements transferred by successful operations. */
+    size_t errors; /**< The number of operations rejected with ::cb_error_full or ::cb_error_empty. */
+    size_t wraps; /**< The number of successful operations that wrapped around, with two spans. */
+    size_t peak; /**< The peak number of filled slots after an operation. */
+#endif
+} cb_stats_ctrs_t;
+
+/** Statistics of a circular buffer, see ::cb_get_stats. */
+typedef struct
+{
+    size_t writes; /**< The number of successful writes. */
+    size_t reads; /**< The number of successful reads. */
+    size_t elems_written; /**< The number of elements written. */
+    size_t elems_read; /**< The number of elements read. */
+    size_t bytes_written; /**< The number of bytes written. */
+    size_t bytes_read; /**< The number of bytes read. */
+    size_t full_errors; /**< The number of writes rejected with ::cb_error_full. */
+    size_t empty_errors; /**< The number of reads rejected with ::cb_error_empty. */
+    size_t wrapped_writes; /**< The number of writes that wrapped around the end of the underlying linear buffer. */
+    size_t wrapped_reads; /**< The number of reads that wrapped around the end of the underlying linear buffer. */
+    size_t peak_filled; /**< The peak number of filled slots, sampled after each write. */
+} cb_stats_t;
+#endif
+
+#ifdef CB_USE_PIPELINE
+/** Cursor of a processing stage, in its own cache line as each stage is usually processed by a different thread. */
+typedef struct
+{
+#ifdef CB_USE_STDATOMIC
+    CB_ALIGNAS(CB_CACHE_LINE_SIZE) cb_atomic_size_t idx; /**< The atomic index up to which elements were processed. */
+#else
+    CB_ALIGNAS(CB_CACHE_LINE_SIZE) size_t idx; /**< The index up to which the stage processed elements. */
+#endif
+} cb_stage_t;
+#endif
+
+/** Clock for time measurements, returns a monotonic timestamp in any unit, e.g. nanoseconds or TSC ticks. */
+typedef uint64_t (*cb_clock_t)(void);
+
+#ifdef CB_USE_TRACE
+/** Record of a write or read in a trace, see ::cb_trace_rec_t in @c cb/cb_trace.h. */
+struct cb_trace_rec_s;
+
+/** Obtains an identifier of the calling thread for the trace records, e.g. a small index assigned to each thread. */
+typedef uint32_t (*cb_trace_thread_t)(void);
+
+/**
+ * @brief Receives the records of a trace, called after each write or read from the context of the caller.
+ *
+ * With multiple producers or consumers it is called from multiple threads at the same time, see ::cb_trace_buf_t in
+ * @c cb/cb_trace.h for a recorder that supports this.
+ * @param[in] rec The record.
+ * @param[in] user_data The user data provided in ::cb_set_trace.
+ */
+typedef void (*cb_trace_sink_t)(const struct cb_trace_rec_s * const rec, void * const user_data);
+#endif
+
+#ifdef CB_USE_LOCKS
+/** State of a built-in lock. */
+typedef struct
+{
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_uint ticket; /**< The atomic next ticket to take, for ::cb_lock_id_ticket. */
+    cb_atomic_uint owner; /**< The atomic ticket being served, for ::cb_lock_id_ticket. */
+    cb_atomic_uint state; /**< The atomic state, 0 unlocked, 1 locked and 2 contended, for ::cb_lock_id_adaptive. */
+#else
+    unsigned int ticket; /**< Unused without atomic support. */
+    unsigned int owner; /**< Unused without atomic support. */
+    unsigned int state; /**< Unused without atomic support. */
+#endif
+    pthread_mutex_t mutex; /**< The mutex, only initialized for ::cb_lock_id_pthread. */
+} cb_lock_t;
+#endif
+
+#ifdef CB_USE_LOCK_PROF
+/** Lock profiling histograms, see ::cb_lock_prof_t in @c cb/cb_lock_prof.h. */
+struct cb_lock_prof_s;
+#endif
+
+#ifdef CB_USE_WAIT
+/** Wait set where the circular buffer is registered, see ::cb_wait_t in @c cb/cb_wait.h. */
+struct cb_wait_s;
+#endif
+
+#ifdef CB_USE_LATENCY
+/** Histogram where latencies are recorded, see ::cb_hist_t in @c cb/cb_hist.h. */
+struct cb_hist_s;
+
+/** Sampled write pending to be read. */
+typedef struct
+{
+    size_t idx; /**< Index of the last element of the write. */
+    uint64_t stamp; /**< Timestamp of the write. */
+} cb_lat_sample_t;
+#endif
+
 /**
  * @brief Circular buffer context.
  *
@@ -130,6 +457,10 @@ typedef cb_error_t (*cb_evt_handler_t)(cb_evt_t * const evt);
  * The buffer is determined to be full when the write or head index is one slot behind the read or tail index.
  * The buffer is determined to be empty when the write or head index is at the same slot as the read or tail index.
  *
+ * With @c CB_USE_PACKED defined, both indexes are kept in a single 64-bit word, thus the capacity is limited to less
+ * than 2^32 elements. A pair of indexes is obtained with a single load, and each index is updated with a compare and
+ * swap that preserves the other one, which is more costly than the store of a separate index on most platforms.
+ *
  * User should not modify nor access the members of this structure directly, only through the API in this library.
  */
 typedef struct cb_s
@@ -137,13 +468,81 @@ typedef struct cb_s
     void * buffer; /**< The underlying linear buffer on which the circular buffer operates. */
     size_t buffer_length; /**< The size of @c buffer in number of elements of size @c elem_size. */
     size_t elem_size; /**< The size of each element in @c buffer. */
-#ifdef CB_USE_STDATOMIC
-    atomic_size_t read_idx; /**< The atomic read or tail index, goes from 0 to <tt>buffer_length - 1</tt>. */
-    atomic_size_t write_idx; /**< The atomic write or head index, goes from 0 to <tt>buffer_length - 1</tt>. */
+#if defined(CB_USE_PACKED) && defined(CB_USE_STDATOMIC)
+    cb_atomic_uint_least64_t idx; /**< The atomic read index in the upper 32 bits, write index in the lower 32 bits. */
+#elif defined(CB_USE_PACKED)
+    uint_least64_t idx; /**< The read index in the upper 32 bits and write index in the lower 32 bits. */
+#elif defined(CB_USE_STDATOMIC)
+    cb_atomic_size_t read_idx; /**< The atomic read or tail index, goes from 0 to <tt>buffer_length - 1</tt>. */
+    cb_atomic_size_t write_idx; /**< The atomic write or head index, goes from 0 to <tt>buffer_length - 1</tt>. */
 #else
     size_t read_idx; /**< The read or tail index, goes from 0 to <tt>buffer_length - 1</tt>. */
     size_t write_idx; /**< The write or head index, goes from 0 to <tt>buffer_length - 1</tt>. */
 #endif
+#ifdef CB_USE_ASYNC
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_size_t read_res_idx; /**< The atomic read index up to which reads were started, ahead of @c read_idx. */
+    cb_atomic_size_t write_res_idx; /**< The atomic write index up to which writes have been started. */
+#else
+    size_t read_res_idx; /**< The read index up to which reads have been started, ahead of @c read_idx. */
+    size_t write_res_idx; /**< The write index up to which writes have been started, ahead of @c write_idx. */
+#endif
+    cb_async_t read_async; /**< Asynchronous reads pending completion. */
+    cb_async_t write_async; /**< Asynchronous writes pending completion. */
+#endif
+#ifdef CB_USE_PIPELINE
+    size_t stage_count; /**< The number of processing stages, zero if elements are read as soon as written. */
+    cb_stage_t stages[CB_MAX_STAGES]; /**< The processing stages, in order, see ::cb_set_stages. */
+#endif
+#ifdef CB_USE_WAIT
+    struct cb_wait_s * wait; /**< The wait set where the circular buffer is registered, @c NULL if none. */
+    size_t wait_slot; /**< The slot of the circular buffer in @c wait. */
+#endif
+#ifdef CB_USE_EVENTFD
+    int evfd_readable; /**< Signaled when the circular buffer becomes not empty, negative if not set. */
+    int evfd_writable; /**< Signaled when the circular buffer becomes not full, negative if not set. */
+#endif
+    size_t wm_low; /**< The low watermark, in number of filled slots. */
+    size_t wm_high; /**< The high watermark, in number of filled slots, zero if watermarks are not set. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_bool wm_above; /**< Atomic flag, @c true if high watermark event was raised and low was not raised yet. */
+#else
+    bool wm_above; /**< Flag, @c true if high watermark event was raised and low was not raised yet. */
+#endif
+#ifdef CB_USE_STATS
+    CB_ALIGNAS(CB_CACHE_LINE_SIZE) cb_stats_ctrs_t stats_write; /**< Statistics counters updated by writes. */
+    CB_ALIGNAS(CB_CACHE_LINE_SIZE) cb_stats_ctrs_t stats_read; /**< Statistics counters updated by reads. */
+#endif
+#ifdef CB_USE_LATENCY
+    cb_clock_t lat_clock; /**< Clock for latency measurements, @c NULL if latencies are not measured. */
+    struct cb_hist_s * lat_hist; /**< Histogram where latencies are recorded. */
+    size_t lat_period; /**< One of every @c lat_period writes is sampled. */
+    size_t lat_count; /**< Number of writes since the last sampled write. */
+    cb_lat_sample_t lat_samples[CB_LAT_MAX_SAMPLES]; /**< Sampled writes pending to be read. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_size_t lat_head; /**< Atomic counter of sampled writes, only updated by writes. */
+    cb_atomic_size_t lat_tail; /**< Atomic counter of sampled writes read, only updated by reads. */
+#else
+    size_t lat_head; /**< Counter of sampled writes, only updated by writes. */
+    size_t lat_tail; /**< Counter of sampled writes read, only updated by reads. */
+#endif
+#endif
+#ifdef CB_USE_LOCK_PROF
+    cb_clock_t prof_clock; /**< Clock for lock profiling, @c NULL if the lock is not profiled. */
+    struct cb_lock_prof_s * prof; /**< Lock profiling histograms. */
+#endif
+#ifdef CB_USE_TRACE
+    cb_clock_t trace_clock; /**< Clock for the trace records, @c NULL if not tracing. */
+    cb_trace_thread_t trace_thread; /**< Identifier of the calling thread for the trace records, can be @c NULL. */
+    cb_trace_sink_t trace_sink; /**< Receives the trace records, @c NULL if not tracing. */
+    void * trace_user_data; /**< User data passed to @c trace_sink. */
+#endif
+#ifdef CB_USE_LOCKS
+    cb_lock_id_t lock_id; /**< The lock strategy, ::cb_lock_id_evt to lock with events. */
+    CB_ALIGNAS(CB_CACHE_LINE_SIZE) cb_lock_t lock_write; /**< The built-in lock, of the producer side if split. */
+    CB_ALIGNAS(CB_CACHE_LINE_SIZE) cb_lock_t lock_read; /**< The built-in lock of the consumer side, if split. */
+#endif
+    bool lock_split; /**< @c true if producers and consumers lock separately, see ::cb_set_lock_split. */
     cb_evt_handler_t evt_handler; /**< Event handler, can be @c NULL if not suscribed to events. */
     cb_evt_id_t evt_sub; /**< Suscribed events, OR combination of ::cb_evt_id_t or ::cb_evt_id_none. */
     void * evt_user_data; /**< Event handler user data, will be passed to @c evt_handler when trigerred. */
@@ -169,6 +568,16 @@ typedef struct cb_s
  * @{
  */
 
+#ifdef CB_HEADER_ONLY
+/** Linkage of the functions, with @c CB_HEADER_ONLY defined they are defined in @c cb/cb_impl.h as @c static @c inline
+ * in every C translation unit that includes this header, and no library is required for them. */
+#define CB_API static inline
+#else
+/** Linkage of the functions, without @c CB_HEADER_ONLY defined they have external linkage and are compiled once in
+ * @c cb/cb.c, thus the library must be linked to use them. */
+#define CB_API
+#endif
+
 /**
  * @}
  */
@@ -183,7 +592,8 @@ typedef struct cb_s
  * @brief Initializes a circular buffer.
  * @param[in] cb The circular buffer context to initialize.
  * @param[in] buffer The underlying linear buffer for the circular buffer, with one extra element than intended size.
- * @param[in] buffer_length The size of @c buffer in number of elements of size @c elem_size.
+ * @param[in] buffer_length The size of @c buffer in number of elements of size @c elem_size, at most @c UINT32_MAX
+ * with @c CB_USE_PACKED defined.
  * @param[in] elem_size The size of each element in @c buffer.
  * @param[in] evt_handler Event handler, can be @c NULL if not suscribed to events.
  * @param[in] evt_sub Suscribed events, OR combination of ::cb_evt_id_t or ::cb_evt_id_none.
@@ -191,41 +601,164 @@ typedef struct cb_s
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
  */
-cb_error_t cb_init(cb_t * const cb,
-                   void * const buffer,
-                   const size_t buffer_length,
-                   const size_t elem_size,
-                   const cb_evt_handler_t evt_handler,
-                   const cb_evt_id_t evt_sub,
-                   void * const evt_user_data);
+CB_API cb_error_t cb_init(cb_t * const cb,
+                          void * const buffer,
+                          const size_t buffer_length,
+                          const size_t elem_size,
+                          const cb_evt_handler_t evt_handler,
+                          const cb_evt_id_t evt_sub,
+                          void * const evt_user_data);
 
 /**
  * @brief Writes the specified number of elements to the circular buffer.
  *
  * If all the elements do not fit, nothing is written to the circular buffer.
+ *
+ * If subscribed to ::cb_evt_id_write_async, the write is only started, and the elements are not available for reading
+ * until ::cb_write_done is called for it, @p buffer must remain valid until then.
  * @param[in] cb The initialized circular buffer context.
  * @param[in] buffer The buffer with the elements to write to @p cb.
  * @param[in] count The number of elements in @p buffer.
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
- * @retval ::cb_error_full The circular buffer is full or can't fit @p count elements.
+ * @retval ::cb_error_full The circular buffer is full or can't fit @p count elements, or too many writes are pending.
  * @retval ::cb_error_evt An error ocurred in the event handler.
  */
-cb_error_t cb_write(cb_t * const cb, const void * const buffer, const size_t count);
+CB_API cb_error_t cb_write(cb_t * const cb, const void * const buffer, const size_t count);
 
 /**
  * @brief Reads the specified number of elements from the circular buffer.
  *
  * If the circular buffer does not have the specified number of elements, nothing is read from it.
+ *
+ * If subscribed to ::cb_evt_id_read_async, the read is only started, and @p buffer must remain valid and is not
+ * written completely until ::cb_read_done is called for it.
  * @param[in] cb The initialized circular buffer context.
  * @param[in] buffer The buffer where the elements read from @p cb will be written to.
  * @param[in] count The number of elements to read from @p cb.
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
  * @retval ::cb_error_empty The circular buffer is empty or does not have @p count elements.
+ * @retval ::cb_error_full Too many reads are pending completion.
+ * @retval ::cb_error_evt An error ocurred in the event handler.
+ */
+CB_API cb_error_t cb_read(cb_t * const cb, void * const buffer, const size_t count);
+
+/**
+ * @brief Reads a batch of elements from the circular buffer, as many as it has between a minimum and a maximum, waiting
+ * up to a linger time for the minimum to be written.
+ *
+ * Reading batches amortizes the cost of each read under light load, while the linger time bounds the latency added to
+ * the elements written meanwhile. Once the minimum exists, the elements are read with ::cb_read, up to the maximum.
+ * Once the linger time expired, what exists is read once with ::cb_read_partial, up to the maximum, and fewer than the
+ * minimum. While lingering it polls the number of elements without lock, spinning ::CB_BATCH_SPINS times and then
+ * yielding between polls, or sleeping up to ::CB_BATCH_SLEEP_MS if empty and in a wait set or with a readable file
+ * descriptor set by ::cb_set_eventfd. Without clock, it does not linger and reads what exists.
+ *
+ * If subscribed to ::cb_evt_id_read_async, the read is only started, as in ::cb_read.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] buffer The buffer where the elements read from @p cb will be written to, of at least @p max elements.
+ * @param[in] min The minimum number of elements to wait for, from 1 to @p max.
+ * @param[in] max The maximum number of elements to read.
+ * @param[out] read The number of elements read, zero on error.
+ * @param[in] clock The clock for the linger time, can be @c NULL not to linger.
+ * @param[in] linger The maximum time to wait for @p min elements, in the units of @p clock.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty The circular buffer remained empty until the linger time expired.
+ * @retval ::cb_error_full Too many reads are pending completion.
+ * @retval ::cb_error_evt An error ocurred in the event handler.
+ */
+CB_API cb_error_t cb_read_batch(cb_t * const cb,
+                                void * const buffer,
+                                const size_t min,
+                                const size_t max,
+                                size_t * const read,
+                                const cb_clock_t clock,
+                                const uint64_t linger);
+
+/**
+ * @brief Writes as many elements to the circular buffer as fit, up to the specified number.
+ *
+ * Unlike ::cb_write, a circular buffer that can't fit all the elements is written partially instead of failing, from
+ * the start of @p buffer, thus producers can write the rest later without retrying the elements already written.
+ *
+ * If subscribed to ::cb_evt_id_write_async, the write is only started, as in ::cb_write.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] buffer The buffer with the elements to write to @p cb.
+ * @param[in] count The maximum number of elements in @p buffer to write.
+ * @param[out] written The number of elements written, zero on error.
+ * @retval ::cb_error_ok Success, at least one element was written.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_full The circular buffer is full, or too many writes are pending.
+ * @retval ::cb_error_evt An error ocurred in the event handler.
+ */
+CB_API cb_error_t
+    cb_write_partial(cb_t * const cb, const void * const buffer, const size_t count, size_t * const written);
+
+/**
+ * @brief Reads as many elements from the circular buffer as it has, up to the specified number.
+ *
+ * Unlike ::cb_read, a circular buffer that does not have all the elements is read partially instead of failing, to the
+ * start of @p buffer, thus consumers can drain it without querying the number of elements first.
+ *
+ * If subscribed to ::cb_evt_id_read_async, the read is only started, as in ::cb_read.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] buffer The buffer where the elements read from @p cb will be written to.
+ * @param[in] count The maximum number of elements to read from @p cb.
+ * @param[out] read The number of elements read, zero on error.
+ * @retval ::cb_error_ok Success, at least one element was read.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty The circular buffer is empty.
+ * @retval ::cb_error_full Too many reads are pending completion.
  * @retval ::cb_error_evt An error ocurred in the event handler.
  */
-cb_error_t cb_read(cb_t * const cb, void * const buffer, const size_t count);
+CB_API cb_error_t cb_read_partial(cb_t * const cb, void * const buffer, const size_t count, size_t * const read);
+
+#ifdef CB_USE_UNCHECKED
+/**
+ * @brief Writes the specified number of elements to the circular buffer, as ::cb_write but without checking the
+ * arguments, for hot loops where they are known to be valid.
+ *
+ * The behaviour is undefined if @p cb is not initialized, if @p buffer is @c NULL or if @p count is zero.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] buffer The buffer with the elements to write to @p cb.
+ * @param[in] count The number of elements in @p buffer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_full The circular buffer is full or can't fit @p count elements, or too many writes are pending.
+ * @retval ::cb_error_evt An error ocurred in the event handler.
+ */
+CB_API cb_error_t cb_write_unchecked(cb_t * const cb, const void * const buffer, const size_t count);
+
+/**
+ * @brief Reads the specified number of elements from the circular buffer, as ::cb_read but without checking the
+ * arguments, for hot loops where they are known to be valid.
+ *
+ * The behaviour is undefined if @p cb is not initialized, if @p buffer is @c NULL or if @p count is zero.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] buffer The buffer where the elements read from @p cb will be written to.
+ * @param[in] count The number of elements to read from @p cb.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_empty The circular buffer is empty or does not have @p count elements.
+ * @retval ::cb_error_full Too many reads are pending completion.
+ * @retval ::cb_error_evt An error ocurred in the event handler.
+ */
+CB_API cb_error_t cb_read_unchecked(cb_t * const cb, void * const buffer, const size_t count);
+#endif
+
+/**
+ * @brief Sets the watermarks for the ::cb_evt_id_high_wm and ::cb_evt_id_low_wm events.
+ *
+ * The events are edge-triggered with hysteresis, ::cb_evt_id_high_wm is raised by ::cb_write when the number of filled
+ * slots reaches @p high, and it is not raised again until ::cb_evt_id_low_wm is raised by ::cb_read when the number of
+ * filled slots falls to @p low, and vice versa. The events are raised while locked, after the operation completes.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] low The low watermark, in number of filled slots, less than @p high.
+ * @param[in] high The high watermark, in number of filled slots, at most the capacity of the circular buffer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_set_watermarks(cb_t * const cb, const size_t low, const size_t high);
 
 /**
  * @brief Gets the number of elements that can be written to the buffer before it becomes full.
@@ -234,7 +767,7 @@ cb_error_t cb_read(cb_t * const cb, void * const buffer, const size_t count);
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
  */
-cb_error_t cb_get_unfilled(cb_t * const cb, size_t * const count);
+CB_API cb_error_t cb_get_unfilled(cb_t * const cb, size_t * const count);
 
 /**
  * @brief Gets the number of elements that can be read from the buffer before it becomes empty.
@@ -243,7 +776,7 @@ cb_error_t cb_get_unfilled(cb_t * const cb, size_t * const count);
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
  */
-cb_error_t cb_get_filled(cb_t * const cb, size_t * const count);
+CB_API cb_error_t cb_get_filled(cb_t * const cb, size_t * const count);
 
 /**
  * @brief Determines if a buffer is empty and no more data can be written to it.
@@ -252,7 +785,7 @@ cb_error_t cb_get_filled(cb_t * const cb, size_t * const count);
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
  */
-cb_error_t cb_is_empty(cb_t * const cb, bool * const is_empty);
+CB_API cb_error_t cb_is_empty(cb_t * const cb, bool * const is_empty);
 
 /**
  * @brief Determines if a buffer is full and no more data can be written to it.
@@ -261,7 +794,294 @@ cb_error_t cb_is_empty(cb_t * const cb, bool * const is_empty);
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
  */
-cb_error_t cb_is_full(cb_t * const cb, bool * const is_full);
+CB_API cb_error_t cb_is_full(cb_t * const cb, bool * const is_full);
+
+/**
+ * @brief Gets the number of unfilled slots as ::cb_get_unfilled, but without lock nor events.
+ *
+ * The lock-free queries never wait for producers nor consumers, and can be called at any time from any thread, e.g. by
+ * monitoring threads polling many circular buffers. The indexes are reloaded until a pair that existed at the same time
+ * is obtained, up to ::CB_SNAPSHOT_RETRIES times, and the result is always within the capacity of the circular buffer.
+ * It can be outdated by the time it is returned, thus it is approximate with multiple producers or consumers. Requires
+ * atomics if there are producers or consumers at the same time.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[out] count The number of unfilled slots in @p cb.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_get_unfilled_lockfree(cb_t * const cb, size_t * const count);
+
+/**
+ * @brief Gets the number of filled slots as ::cb_get_filled, but without lock nor events.
+ *
+ * See ::cb_get_unfilled_lockfree for the guarantees of the lock-free queries.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[out] count The number of filled slots in @p cb.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_get_filled_lockfree(cb_t * const cb, size_t * const count);
+
+/**
+ * @brief Determines if a buffer is empty as ::cb_is_empty, but without lock nor events.
+ *
+ * See ::cb_get_unfilled_lockfree for the guarantees of the lock-free queries.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[out] is_empty On success, @c true if empty and @c false otherwise.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_is_empty_lockfree(cb_t * const cb, bool * const is_empty);
+
+/**
+ * @brief Determines if a buffer is full as ::cb_is_full, but without lock nor events.
+ *
+ * See ::cb_get_unfilled_lockfree for the guarantees of the lock-free queries.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[out] is_full On success, @c true if full and @c false otherwise.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_is_full_lockfree(cb_t * const cb, bool * const is_full);
+
+/**
+ * @brief Gets the number of elements that can be read, as ::cb_get_filled_lockfree but without the elements not yet
+ * processed by the last processing stage, see ::cb_set_stages.
+ *
+ * Callers that read as many elements as this function reports, e.g. to drain the circular buffer, must use it instead
+ * of ::cb_get_filled_lockfree, as ::cb_read can't obtain the elements still in the stages. Without stages both are
+ * the same. See ::cb_get_unfilled_lockfree for the guarantees of the lock-free queries.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[out] count The number of elements that can be read from @p cb.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_get_readable_lockfree(cb_t * const cb, size_t * const count);
+
+/**
+ * @brief Sets whether producers and consumers lock separately, a two-lock circular buffer.
+ *
+ * If split, writes, ::cb_write_done, ::cb_get_unfilled and ::cb_is_full lock only the producer side, and reads,
+ * ::cb_read_done, ::cb_get_filled and ::cb_is_empty lock only the consumer side, thus writers only wait for writers and
+ * readers only for readers, each side sees the progress of the other through the atomic indexes. The lock events are
+ * raised with the side in ::cb_evt_data_lock_t, and the functions that access both sides lock the producer side first
+ * and then the consumer side. If a built-in lock is set, see ::cb_set_lock, each side has its own.
+ *
+ * Requires atomics if there are producers and consumers at the same time. This function must not be called at the same
+ * time as other functions of the circular buffer.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] split @c true to lock each side separately, @c false to lock the whole circular buffer, the default.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_set_lock_split(cb_t * const cb, const bool split);
+
+#ifdef CB_USE_PIPELINE
+/**
+ * @brief Sets the number of processing stages that elements go through, in place, between written and read.
+ *
+ * Each stage has a cursor in the same underlying linear buffer, the first stage processes the elements written, each
+ * other stage processes the elements processed by the previous one, and reads only obtain the elements processed by the
+ * last stage, thus elements are handed from stage to stage without copies. The space available for writes is still
+ * bounded by the reads. See ::cb_stage_claim and ::cb_stage_release.
+ *
+ * The elements already in the circular buffer go through all the stages too. The number of filled slots reported by
+ * the functions of the circular buffer includes the elements not yet processed by the last stage, and so do the
+ * watermarks. This function must not be called at the same time as other functions of the circular buffer.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] count The number of stages, at most ::CB_MAX_STAGES, zero to read elements as soon as written.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_set_stages(cb_t * const cb, const size_t count);
+
+/**
+ * @brief Obtains the next elements available for a processing stage, to be processed in place.
+ *
+ * The elements are contiguous in the underlying linear buffer, if they wrap around its end, the elements from its
+ * start are obtained after releasing these ones. The elements can be modified in place until released with
+ * ::cb_stage_release, and can be released in several batches. Only one thread can process each stage at the same time,
+ * no lock nor events are involved.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] stage The stage, from zero to the number of stages set minus one.
+ * @param[out] elems The first element available.
+ * @param[out] count The number of elements available from @p elems onwards, zero if none.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty There are no elements available for the stage.
+ */
+CB_API cb_error_t cb_stage_claim(cb_t * const cb, const size_t stage, void ** const elems, size_t * const count);
+
+/**
+ * @brief Hands the elements processed by a stage over to the next stage, or to the reads if it is the last stage.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] stage The stage, from zero to the number of stages set minus one.
+ * @param[in] count The number of elements processed, at most the number of elements available for the stage.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_stage_release(cb_t * const cb, const size_t stage, const size_t count);
+#endif
+
+#ifdef CB_USE_ASYNC
+/**
+ * @brief Signals the completion of an asynchronous write started with a ::cb_evt_id_write_async event.
+ *
+ * Writes are published, that is, made available for reading, in the order they were started. If a write completes
+ * before previous ones, it is published along with them when they complete.
+ *
+ * When subscribed to lock events, this function must not be called from within the event handler. Otherwise it can
+ * be called from within it, if the copy completes at once, or from another thread concurrently with the producer and
+ * consumer, as long as the writes are completed by one thread at a time, e.g. a single completion thread or interrupt.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] seq The sequence number of the write, as provided in the event.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_write_done(cb_t * const cb, const size_t seq);
+
+/**
+ * @brief Signals the completion of an asynchronous read started with a ::cb_evt_id_read_async event.
+ *
+ * Reads are published, that is, their slots are made available for writing, in the order they were started. If a
+ * read completes before previous ones, it is published along with them when they complete.
+ *
+ * When subscribed to lock events, this function must not be called from within the event handler. Otherwise it can
+ * be called from within it, if the copy completes at once, or from another thread concurrently with the producer and
+ * consumer, as long as the reads are completed by one thread at a time, e.g. a single completion thread or interrupt.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] seq The sequence number of the read, as provided in the event.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_read_done(cb_t * const cb, const size_t seq);
+#endif
+
+#ifdef CB_USE_STATS
+/**
+ * @brief Gets a snapshot of the statistics of the circular buffer.
+ *
+ * The counters are updated with relaxed atomic operations by the thread performing each operation, if not locked
+ * the snapshot might not be consistent across counters.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[out] stats The snapshot of the statistics.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_get_stats(cb_t * const cb, cb_stats_t * const stats);
+
+/**
+ * @brief Resets the statistics of the circular buffer.
+ *
+ * If not locked, operations performed at the same time might not be accounted for.
+ * @param[in] cb The initialized circular buffer context.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_reset_stats(cb_t * const cb);
+#endif
+
+#ifdef CB_USE_LATENCY
+/**
+ * @brief Sets the measurement of the time elements spend in the circular buffer.
+ *
+ * One of every @c period writes is sampled, the write is stamped with @c clock and, when the last element of that
+ * write is read, the difference with the time of the read is recorded in @c hist. At most ::CB_LAT_MAX_SAMPLES
+ * sampled writes can be pending to be read, further writes are not sampled until one of them is read.
+ *
+ * The histogram is only updated by reads, it should be queried from the reading context or while locked. This function
+ * must not be called at the same time as writes or reads.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] clock The clock, or @c NULL along with @c hist to stop measuring latencies.
+ * @param[in] hist The initialized histogram, or @c NULL along with @c clock to stop measuring latencies.
+ * @param[in] period One of every @c period writes is sampled, @c 1 to sample all writes.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_set_latency(cb_t * const cb,
+                                 const cb_clock_t clock,
+                                 struct cb_hist_s * const hist,
+                                 const size_t period);
+#endif
+
+#ifdef CB_USE_LOCK_PROF
+/**
+ * @brief Sets the profiling of the time spent waiting for the lock and holding it, for each function.
+ *
+ * For each of the functions in ::cb_fn_id_t, the time from the start of the ::cb_evt_id_lock event until its end is
+ * recorded as wait time, and from then until the start of the ::cb_evt_id_unlock event as hold time. The histograms
+ * of a function are only updated while holding the lock by that function, thus they should be queried while locked.
+ * This function must not be called at the same time as other functions of the circular buffer.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] clock The clock, or @c NULL along with @c prof to stop profiling.
+ * @param[in] prof The initialized lock profiling histograms, or @c NULL along with @c clock to stop profiling.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_set_lock_prof(cb_t * const cb, const cb_clock_t clock, struct cb_lock_prof_s * const prof);
+#endif
+
+#ifdef CB_USE_TRACE
+/**
+ * @brief Sets the tracing of every write and read, for later analysis or replay.
+ *
+ * Each ::cb_write and ::cb_read is stamped with @c clock when called and, when it returns, a ::cb_trace_rec_t with its
+ * thread, number of elements, fill level and result is passed to @c sink, including those rejected as full or empty.
+ * This function must not be called at the same time as writes or reads.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] clock The clock, or @c NULL along with @c sink to stop tracing.
+ * @param[in] thread Obtains the identifier of the calling thread, can be @c NULL to record zero instead.
+ * @param[in] sink Receives the trace records, or @c NULL along with @c clock to stop tracing.
+ * @param[in] user_data User data passed to @c sink, can be @c NULL.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_set_trace(cb_t * const cb,
+                               const cb_clock_t clock,
+                               const cb_trace_thread_t thread,
+                               const cb_trace_sink_t sink,
+                               void * const user_data);
+#endif
+
+#ifdef CB_USE_EVENTFD
+/**
+ * @brief Sets the file descriptors signaled when the circular buffer becomes readable or writable, for event loops.
+ *
+ * The readable one is signaled by the write that makes the circular buffer go from empty to not empty, and the
+ * writable one by the read that makes it go from full to not full, writing the 8-byte increment of an @c eventfd to
+ * them, thus writes and reads in the steady state make no system calls. They are usually created with
+ * <tt>eventfd(0, EFD_NONBLOCK)</tt> and added to an @c epoll set, other platforms can use the write end of a pipe.
+ *
+ * As they are only signaled on the edges, on readiness the consumer must first read the file descriptor to reset it
+ * and then read the circular buffer until empty, and the producer write until full, before waiting again. With
+ * processing stages, see ::cb_set_stages, the readable one is signaled by the last stage instead, when it releases
+ * the elements to a circular buffer read until empty. They are owned by the user and not closed by ::cb_deinit. This
+ * function must not be called at the same time as writes or reads.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] readable_fd The file descriptor signaled when the circular buffer becomes not empty, negative for none.
+ * @param[in] writable_fd The file descriptor signaled when the circular buffer becomes not full, negative for none.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+CB_API cb_error_t cb_set_eventfd(cb_t * const cb, const int readable_fd, const int writable_fd);
+#endif
+
+#ifdef CB_USE_LOCKS
+/**
+ * @brief Sets a built-in lock strategy, used instead of the ::cb_evt_id_lock and ::cb_evt_id_unlock events.
+ *
+ * The uncontended paths of the built-in locks are inlined in each function that locks, the lock events are not
+ * raised while one is set and writes and reads do not take the path without events, see ::cb_lock_id_t for the
+ * strategies. The lock is ::cb_lock_id_evt after ::cb_init, and ::cb_deinit releases the resources of the lock set.
+ * This function must not be called at the same time as other functions of the circular buffer.
+ * @param[in] cb The initialized circular buffer context.
+ * @param[in] lock_id The lock strategy, ::cb_lock_id_evt to lock with the events again.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid, the strategy is not supported
+ * without atomics or the mutex could not be initialized.
+ */
+CB_API cb_error_t cb_set_lock(cb_t * const cb, const cb_lock_id_t lock_id);
+#endif
 
 /**
  * @brief Deinitializes a circular buffer.
@@ -269,7 +1089,7 @@ cb_error_t cb_is_full(cb_t * const cb, bool * const is_full);
  * @retval ::cb_error_ok Success.
  * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
  */
-cb_error_t cb_deinit(cb_t * const cb);
+CB_API cb_error_t cb_deinit(cb_t * const cb);
 
 /**
  * @}
@@ -283,6 +1103,10 @@ cb_error_t cb_deinit(cb_t * const cb);
 }
 #endif /* __cplusplus */
 
+#ifdef CB_HEADER_ONLY
+#include "cb/cb_impl.h"
+#endif
+
 #endif /* CB_H */
 
 /******************************************************************************************************END OF FILE*****/
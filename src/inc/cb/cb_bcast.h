@@ -0,0 +1,189 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_bcast.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef CB_BCAST_H
+#define CB_BCAST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_bcast Broadcast rings
+ *
+ * Provides circular buffers with a single producer and multiple consumers where each consumer reads every element, each
+ * consumer has its own read cursor and the elements are written only once. The space available to the producer is
+ * bounded by the slowest cursor, and consumers can attach and detach at any time.
+ *
+ * @{
+ */
+
+/** @defgroup cb_bcast_defs Definitions */
+/** @defgroup cb_bcast_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb.h"
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_bcast_defs
+ * @{
+ */
+
+#ifndef CB_BCAST_MAX_CURSORS
+/** Maximum number of consumers attached to a broadcast ring at the same time. */
+#define CB_BCAST_MAX_CURSORS (8U)
+#endif
+
+/**
+ * @brief Broadcast ring context.
+ *
+ * As in ::cb_t, the underlying linear buffer must have an additional element more than the intended size, and the
+ * indexes go from 0 to <tt>buffer_length - 1</tt>. The user should not access its members directly.
+ */
+typedef struct
+{
+    void * buffer; /**< The underlying linear buffer on which the broadcast ring operates. */
+    size_t buffer_length; /**< The size of @c buffer in number of elements of size @c elem_size. */
+    size_t elem_size; /**< The size of each element in @c buffer. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_size_t write_idx; /**< The atomic write or head index. */
+    cb_atomic_size_t cursors[CB_BCAST_MAX_CURSORS]; /**< The atomic read index of each consumer, @c SIZE_MAX if free. */
+#else
+    size_t write_idx; /**< The write or head index. */
+    size_t cursors[CB_BCAST_MAX_CURSORS]; /**< The read index of each consumer, @c SIZE_MAX if free. */
+#endif
+} cb_bcast_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_bcast_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a broadcast ring, with no consumers attached.
+ * @param[in] bcast The broadcast ring context to initialize.
+ * @param[in] buffer The underlying linear buffer, with one extra element than intended size.
+ * @param[in] buffer_length The size of @p buffer in number of elements of size @p elem_size.
+ * @param[in] elem_size The size of each element in @p buffer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t
+    cb_bcast_init(cb_bcast_t * const bcast, void * const buffer, const size_t buffer_length, const size_t elem_size);
+
+/**
+ * @brief Deinitializes a broadcast ring, detaching all the consumers.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_bcast_deinit(cb_bcast_t * const bcast);
+
+/**
+ * @brief Writes the specified number of elements, for all the consumers attached.
+ *
+ * If all the elements do not fit for the slowest consumer, nothing is written. Without consumers attached the elements
+ * are discarded, the whole capacity is always available. Only one producer can write at the same time. The write index
+ * is published with sequentially consistent ordering, so consumers attaching at the same time are never overrun.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @param[in] buffer The buffer with the elements to write.
+ * @param[in] count The number of elements in @p buffer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_full The elements do not fit for the slowest consumer.
+ */
+cb_error_t cb_bcast_write(cb_bcast_t * const bcast, const void * const buffer, const size_t count);
+
+/**
+ * @brief Gets the number of elements that can be written before the slowest consumer is full.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @param[out] count The number of unfilled slots for the slowest consumer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_bcast_get_unfilled(cb_bcast_t * const bcast, size_t * const count);
+
+/**
+ * @brief Attaches a consumer, which reads the elements written from then on.
+ *
+ * It can be called at any time, from any thread, including while the producer writes.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @param[out] cursor The cursor of the consumer, for the other functions of the consumer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_full There are already ::CB_BCAST_MAX_CURSORS consumers attached.
+ */
+cb_error_t cb_bcast_attach(cb_bcast_t * const bcast, size_t * const cursor);
+
+/**
+ * @brief Detaches a consumer, the elements it did not read no longer bound the producer.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @param[in] cursor The cursor of the consumer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid, or the consumer is not attached.
+ */
+cb_error_t cb_bcast_detach(cb_bcast_t * const bcast, const size_t cursor);
+
+/**
+ * @brief Reads the specified number of elements for a consumer, without affecting other consumers.
+ *
+ * If not all the elements are available, nothing is read. Only one thread can read for each consumer at the same time.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @param[in] cursor The cursor of the consumer.
+ * @param[out] buffer The buffer where to read the elements.
+ * @param[in] count The number of elements to read.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid, or the consumer is not attached.
+ * @retval ::cb_error_empty The elements are not available for the consumer.
+ */
+cb_error_t cb_bcast_read(cb_bcast_t * const bcast, const size_t cursor, void * const buffer, const size_t count);
+
+/**
+ * @brief Copies the specified number of elements for a consumer as ::cb_bcast_read, but without consuming them.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @param[in] cursor The cursor of the consumer.
+ * @param[out] buffer The buffer where to copy the elements.
+ * @param[in] count The number of elements to copy.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid, or the consumer is not attached.
+ * @retval ::cb_error_empty The elements are not available for the consumer.
+ */
+cb_error_t cb_bcast_peek(cb_bcast_t * const bcast, const size_t cursor, void * const buffer, const size_t count);
+
+/**
+ * @brief Gets the number of elements that can be read by a consumer.
+ * @param[in] bcast The initialized broadcast ring context.
+ * @param[in] cursor The cursor of the consumer.
+ * @param[out] count The number of filled slots for the consumer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid, or the consumer is not attached.
+ */
+cb_error_t cb_bcast_get_filled(cb_bcast_t * const bcast, const size_t cursor, size_t * const count);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_BCAST_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,474 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_coro.hpp
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef CB_CORO_HPP
+#define CB_CORO_HPP
+
+/** @addtogroup cb_coro Coroutines
+ *
+ * Provides C++20 awaitables to read and write circular buffers from coroutines, with <tt>co_await ring.read(n)</tt>
+ * and <tt>co_await ring.write(span)</tt>, that suspend the coroutine while the circular buffer is empty or full and
+ * resume it once the peer made progress. Suspended operations are parked in an executor, which retries them and
+ * resumes their coroutines once they complete, a single-threaded scheduler is provided and others can be plugged in,
+ * e.g. one that retries them when the file descriptors of ::cb_set_eventfd are signaled in an event loop. The
+ * circular buffers are written and read through the C functions, thus the library must not be built with
+ * @c CB_HEADER_ONLY defined, and the peers can be plain C code in other threads.
+ *
+ * @{
+ */
+
+/** @defgroup cb_coro_defs Definitions */
+/** @defgroup cb_coro_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb.h"
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef CB_HEADER_ONLY
+#error "cb/cb_coro.hpp requires the library to be built as C, without CB_HEADER_ONLY defined."
+#endif
+
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+namespace cb
+{
+/**
+ * @addtogroup cb_coro_defs
+ * @{
+ */
+
+/** Operation on a circular buffer suspended in a coroutine, parked in an executor until it completes. */
+class awaiter
+{
+public:
+    /** Destructor. */
+    virtual ~awaiter() = default;
+
+    /**
+     * @brief Attempts to complete the operation, without blocking.
+     * @return @c true if it completed, successfully or with error, @c false if it must be attempted again later.
+     */
+    virtual bool try_complete() noexcept = 0;
+
+    /**
+     * @brief Obtains the circular buffer of the operation, for executors that retry operations by circular buffer.
+     * @return The circular buffer.
+     */
+    cb_t & buffer() const noexcept
+    {
+        return cb_;
+    }
+
+    /**
+     * @brief Obtains the coroutine suspended on the operation, to resume once it completes.
+     * @return The coroutine.
+     */
+    std::coroutine_handle<> handle() const noexcept
+    {
+        return handle_;
+    }
+
+protected:
+    /**
+     * @brief Constructor.
+     * @param[in] cb The circular buffer of the operation.
+     */
+    explicit awaiter(cb_t & cb) noexcept : cb_(cb)
+    {
+    }
+
+    cb_t & cb_; /**< The circular buffer of the operation. */
+    std::coroutine_handle<> handle_; /**< The coroutine suspended on the operation, if any. */
+};
+
+/**
+ * @brief Executor of the coroutines, where the operations that can't complete are parked.
+ *
+ * An executor must call ::cb::awaiter::try_complete of the operations parked until they complete, and then resume
+ * their coroutine, at the latest after the peers wrote or read the circular buffer.
+ */
+class executor
+{
+public:
+    /** Destructor. */
+    virtual ~executor() = default;
+
+    /**
+     * @brief Schedules a coroutine to be resumed.
+     * @param[in] handle The coroutine.
+     */
+    virtual void post(std::coroutine_handle<> handle) = 0;
+
+    /**
+     * @brief Parks an operation that could not complete, its coroutine is suspended until it does.
+     * @param[in] op The operation, valid until its coroutine is resumed.
+     */
+    virtual void park(awaiter & op) = 0;
+};
+
+/**
+ * @brief Coroutine run by a ::cb::scheduler, started once spawned in it, and destroyed by it when finished.
+ *
+ * Exceptions that escape the coroutine terminate the program.
+ */
+class task
+{
+public:
+    /** Promise of the coroutine. */
+    struct promise_type
+    {
+        /** Creates the task of the coroutine. */
+        task get_return_object() noexcept
+        {
+            return task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        /** Starts suspended, until spawned. */
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        /** Ends suspended, to be destroyed by the scheduler. */
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+        /** Returns nothing. */
+        void return_void() noexcept
+        {
+        }
+        /** Terminates on exceptions. */
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+
+    /** Move constructor. */
+    task(task && other) noexcept : handle_(std::exchange(other.handle_, {}))
+    {
+    }
+
+    task(const task &) = delete;
+    task & operator=(const task &) = delete;
+    task & operator=(task &&) = delete;
+
+    /** Destructor, destroys the coroutine if it was not spawned. */
+    ~task()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    /**
+     * @brief Releases the coroutine, to be spawned.
+     * @return The coroutine.
+     */
+    std::coroutine_handle<> release() noexcept
+    {
+        return std::exchange(handle_, {});
+    }
+
+private:
+    /** Constructor, from the promise. */
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> handle_; /**< The coroutine, until spawned. */
+};
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_coro_papi
+ * @{
+ */
+
+/**
+ * @brief Single-threaded executor, for tests and benchmarks.
+ *
+ * Resumes the coroutines ready in order, and after them retries the operations parked in the order they were parked,
+ * yielding the processor when none completes so that peers in other threads make progress. Its functions must be
+ * called from the thread that runs it.
+ */
+class scheduler final : public executor
+{
+public:
+    scheduler() = default;
+    scheduler(const scheduler &) = delete;
+    scheduler & operator=(const scheduler &) = delete;
+
+    /** Destructor, destroys the coroutines that did not finish. */
+    ~scheduler() override
+    {
+        for (awaiter * const op : parked_)
+        {
+            ready_.push_back(op->handle());
+        }
+        for (const std::coroutine_handle<> handle : ready_)
+        {
+            handle.destroy();
+        }
+    }
+
+    /**
+     * @brief Spawns a coroutine, started by ::cb::scheduler::run.
+     * @param[in] coro The coroutine.
+     */
+    void spawn(task coro)
+    {
+        post(coro.release());
+    }
+
+    /**
+     * @brief Runs the coroutines spawned until all of them finished.
+     *
+     * It does not return if the coroutines wait on circular buffers that no thread is going to write nor read.
+     */
+    void run()
+    {
+        while (!ready_.empty() || !parked_.empty())
+        {
+            // Resume the coroutines ready, those that finished are destroyed.
+            while (!ready_.empty())
+            {
+                const std::coroutine_handle<> handle = ready_.front();
+                ready_.pop_front();
+                handle.resume();
+                if (handle.done())
+                {
+                    handle.destroy();
+                }
+            }
+
+            // Retry the operations parked, the coroutines resumed or the peers in other threads made progress.
+            bool progress = false;
+            for (std::size_t i = 0U; i < parked_.size();)
+            {
+                if (parked_[i]->try_complete())
+                {
+                    ready_.push_back(parked_[i]->handle());
+                    parked_.erase(parked_.begin() + static_cast<std::ptrdiff_t>(i));
+                    progress = true;
+                }
+                else
+                {
+                    i++;
+                }
+            }
+            if (!progress && !parked_.empty())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /** See ::cb::executor::post. */
+    void post(std::coroutine_handle<> handle) override
+    {
+        ready_.push_back(handle);
+    }
+
+    /** See ::cb::executor::park. */
+    void park(awaiter & op) override
+    {
+        parked_.push_back(&op);
+    }
+
+private:
+    std::deque<std::coroutine_handle<>> ready_; /**< The coroutines ready to be resumed. */
+    std::vector<awaiter *> parked_; /**< The operations parked, in the order they were parked. */
+};
+
+/**
+ * @brief Circular buffer read and written from coroutines with elements of a type.
+ *
+ * The circular buffer is initialized and owned by the user, with elements of the size of @p T, and each of its sides
+ * must have a single reader or writer at the same time, as for ::cb_read and ::cb_write.
+ * @tparam T The type of the elements, trivially copyable.
+ */
+template <typename T>
+class ring
+{
+public:
+    /** Operation that reads a number of elements, all or none, as ::cb_read. */
+    class read_awaiter final : public awaiter
+    {
+    public:
+        /** Constructor. */
+        read_awaiter(ring & owner, const std::size_t count)
+            : awaiter(owner.cb_), exec_(owner.exec_),
+              valid_((count > 0U) && (count < cb_.buffer_length) && (cb_.elem_size == sizeof(T)))
+        {
+            if (valid_)
+            {
+                elems_.resize(count);
+            }
+        }
+
+        /** Attempts to read the elements, and parks the operation if they do not exist yet. */
+        bool await_ready() noexcept
+        {
+            return try_complete();
+        }
+
+        /** Parks the operation. */
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            handle_ = handle;
+            exec_.park(*this);
+        }
+
+        /**
+         * @brief Obtains the elements read.
+         * @return The elements read, or none if the number of elements is zero, larger than the capacity of the
+         * circular buffer, or its elements are not of the size of @p T.
+         */
+        std::vector<T> await_resume() noexcept
+        {
+            return std::move(elems_);
+        }
+
+        /** See ::cb::awaiter::try_complete. */
+        bool try_complete() noexcept override
+        {
+            if (!valid_)
+            {
+                return true;
+            }
+            const cb_error_t error = cb_read(&cb_, elems_.data(), elems_.size());
+            if (error == cb_error_empty)
+            {
+                return false;
+            }
+            if (error != cb_error_ok)
+            {
+                elems_.clear();
+            }
+            return true;
+        }
+
+    private:
+        executor & exec_; /**< The executor where the operation is parked. */
+        const bool valid_; /**< If the number of elements and their size are valid for the circular buffer. */
+        std::vector<T> elems_; /**< Where to read the elements, of the number of elements to read. */
+    };
+
+    /** Operation that writes a number of elements, all or none, as ::cb_write. */
+    class write_awaiter final : public awaiter
+    {
+    public:
+        /** Constructor. */
+        write_awaiter(ring & owner, const std::span<const T> elems) noexcept
+            : awaiter(owner.cb_), exec_(owner.exec_), elems_(elems)
+        {
+        }
+
+        /** Attempts to write the elements, and parks the operation if they do not fit yet. */
+        bool await_ready() noexcept
+        {
+            return try_complete();
+        }
+
+        /** Parks the operation. */
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            handle_ = handle;
+            exec_.park(*this);
+        }
+
+        /**
+         * @brief Obtains the result of the write.
+         * @retval ::cb_error_ok Success.
+         * @retval ::cb_error_invalid_args The number of elements is zero, larger than the capacity of the circular
+         * buffer, or its elements are not of the size of @p T.
+         * @return Otherwise, the error of ::cb_write.
+         */
+        cb_error_t await_resume() const noexcept
+        {
+            return error_;
+        }
+
+        /** See ::cb::awaiter::try_complete. */
+        bool try_complete() noexcept override
+        {
+            if (elems_.empty() || (elems_.size() >= cb_.buffer_length) || (cb_.elem_size != sizeof(T)))
+            {
+                error_ = cb_error_invalid_args;
+                return true;
+            }
+            error_ = cb_write(&cb_, elems_.data(), elems_.size());
+            return (error_ != cb_error_full);
+        }
+
+    private:
+        executor & exec_; /**< The executor where the operation is parked. */
+        const std::span<const T> elems_; /**< The elements to write. */
+        cb_error_t error_ = cb_error_ok; /**< The result of the write. */
+    };
+
+    /**
+     * @brief Constructor.
+     * @param[in] cb The initialized circular buffer, with elements of the size of @p T.
+     * @param[in] exec The executor where the operations that can't complete are parked.
+     */
+    ring(cb_t & cb, executor & exec) noexcept : cb_(cb), exec_(exec)
+    {
+    }
+
+    /**
+     * @brief Reads a number of elements, suspending the coroutine until they exist.
+     * @param[in] count The number of elements, at most the capacity of the circular buffer.
+     * @return The awaitable, resulting in the elements read.
+     */
+    read_awaiter read(const std::size_t count)
+    {
+        return read_awaiter(*this, count);
+    }
+
+    /**
+     * @brief Writes elements, suspending the coroutine until they fit, which must stay valid until then.
+     * @param[in] elems The elements, at most the capacity of the circular buffer.
+     * @return The awaitable, resulting in the result of the write.
+     */
+    write_awaiter write(const std::span<const T> elems) noexcept
+    {
+        return write_awaiter(*this, elems);
+    }
+
+private:
+    cb_t & cb_; /**< The circular buffer. */
+    executor & exec_; /**< The executor where the operations that can't complete are parked. */
+};
+
+/**
+ * @}
+ */
+} // namespace cb
+
+/**
+ * @}
+ */
+
+#endif /* CB_CORO_HPP */
+
+/******************************************************************************************************END OF FILE*****/
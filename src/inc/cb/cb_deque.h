@@ -0,0 +1,175 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_deque.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef CB_DEQUE_H
+#define CB_DEQUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_deque Work-stealing deques
+ *
+ * Provides Chase-Lev work-stealing deques over linear buffers supplied by the user, as the circular buffers. The owner
+ * thread pushes and pops elements at the bottom, last in first out, while other threads steal elements from the top,
+ * first in first out, without locks. When full, the owner can grow the deque into a larger linear buffer.
+ *
+ * @{
+ */
+
+/** @defgroup cb_deque_defs Definitions */
+/** @defgroup cb_deque_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb.h"
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_deque_defs
+ * @{
+ */
+
+#ifndef CB_DEQUE_MAX_BUFFERS
+/** Maximum number of linear buffers of a deque, the one it is initialized with and those it grows into. */
+#define CB_DEQUE_MAX_BUFFERS (8U)
+#endif
+
+/** Linear buffer of a deque, not modified once in use, as thieves might still be reading from previous ones. */
+typedef struct
+{
+    void * buffer; /**< The linear buffer. */
+    size_t buffer_length; /**< The size of @c buffer in number of elements. */
+} cb_deque_buf_t;
+
+/**
+ * @brief Work-stealing deque context.
+ *
+ * The indexes of the top and the bottom increase monotonically, wrapping around, and each element is at its index
+ * modulo the length of the current linear buffer, thus all of its elements are used. The user should not access its
+ * members directly.
+ */
+typedef struct
+{
+    size_t elem_size; /**< The size of each element in the linear buffers. */
+    cb_deque_buf_t bufs[CB_DEQUE_MAX_BUFFERS]; /**< The linear buffers, in the order they were used. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_size_t buf_idx; /**< The atomic index in @c bufs of the current linear buffer. */
+    cb_atomic_size_t top; /**< The atomic index of the top, where thieves steal. */
+    cb_atomic_size_t bottom; /**< The atomic index of the bottom, where the owner pushes and pops. */
+#else
+    size_t buf_idx; /**< The index in @c bufs of the current linear buffer. */
+    size_t top; /**< The index of the top, where thieves steal. */
+    size_t bottom; /**< The index of the bottom, where the owner pushes and pops. */
+#endif
+} cb_deque_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_deque_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a work-stealing deque, empty.
+ * @param[in] deque The deque context to initialize.
+ * @param[in] buffer The linear buffer, all its elements are used.
+ * @param[in] buffer_length The size of @p buffer in number of elements of size @p elem_size.
+ * @param[in] elem_size The size of each element in @p buffer.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t
+    cb_deque_init(cb_deque_t * const deque, void * const buffer, const size_t buffer_length, const size_t elem_size);
+
+/**
+ * @brief Deinitializes a work-stealing deque, from then on the linear buffers used by it can be released.
+ * @param[in] deque The initialized deque context.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_deque_deinit(cb_deque_t * const deque);
+
+/**
+ * @brief Grows a work-stealing deque into a larger linear buffer, to be called by the owner thread.
+ *
+ * The elements are copied to the new linear buffer, and the previous one must remain valid until the deque is
+ * deinitialized, as thieves might still be reading from it. It can be called at most
+ * <tt>::CB_DEQUE_MAX_BUFFERS - 1</tt> times.
+ * @param[in] deque The initialized deque context.
+ * @param[in] buffer The new linear buffer.
+ * @param[in] buffer_length The size of @p buffer in number of elements, larger than the current one.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_full The deque already used ::CB_DEQUE_MAX_BUFFERS linear buffers.
+ */
+cb_error_t cb_deque_grow(cb_deque_t * const deque, void * const buffer, const size_t buffer_length);
+
+/**
+ * @brief Pushes an element at the bottom, to be called by the owner thread.
+ * @param[in] deque The initialized deque context.
+ * @param[in] elem The element to push.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_full The deque is full, see ::cb_deque_grow.
+ */
+cb_error_t cb_deque_push(cb_deque_t * const deque, const void * const elem);
+
+/**
+ * @brief Pops the element at the bottom, the last one pushed, to be called by the owner thread.
+ * @param[in] deque The initialized deque context.
+ * @param[out] elem The element popped.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty The deque is empty, or its last element was stolen at the same time.
+ */
+cb_error_t cb_deque_pop(cb_deque_t * const deque, void * const elem);
+
+/**
+ * @brief Steals the element at the top, the first one pushed, from any thread.
+ *
+ * It is lock-free, if other thieves steal the same element at the same time, it is retried with the next element.
+ * @param[in] deque The initialized deque context.
+ * @param[out] elem The element stolen.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty The deque is empty.
+ */
+cb_error_t cb_deque_steal(cb_deque_t * const deque, void * const elem);
+
+/**
+ * @brief Gets the number of elements in a work-stealing deque, from any thread.
+ *
+ * The number might be outdated if the deque is being pushed, popped or stolen from.
+ * @param[in] deque The initialized deque context.
+ * @param[out] count The number of elements.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_deque_get_filled(cb_deque_t * const deque, size_t * const count);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_DEQUE_H */
+
+/******************************************************************************************************END OF FILE*****/
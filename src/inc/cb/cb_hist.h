@@ -0,0 +1,118 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_hist.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+// Outside of the guard, with CB_HEADER_ONLY it includes this header in turn, which must be complete by then.
+#include "cb/cb.h"
+#ifndef CB_HIST_H
+#define CB_HIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_hist Histograms
+ *
+ * Provides log-linear histograms, each power of two range of values is split in linear sub-buckets, thus the
+ * relative error of the values reported is bounded regardless of their magnitude.
+ *
+ * @{
+ */
+
+/** @defgroup cb_hist_defs Definitions */
+/** @defgroup cb_hist_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_hist_defs
+ * @{
+ */
+
+#ifndef CB_HIST_SUB_BITS
+/** Number of bits of the linear sub-buckets in each power of two range, the relative error is 2^-CB_HIST_SUB_BITS. */
+#define CB_HIST_SUB_BITS (4U)
+#endif
+
+#ifndef CB_HIST_MAX_BITS
+/** Number of bits of the largest value tracked, values equal or above 2^CB_HIST_MAX_BITS are in the last bucket. */
+#define CB_HIST_MAX_BITS (40U)
+#endif
+
+/** Number of buckets of a histogram. */
+#define CB_HIST_BUCKETS (((CB_HIST_MAX_BITS) - (CB_HIST_SUB_BITS) + 1U) << (CB_HIST_SUB_BITS))
+
+/** Histogram context. */
+typedef struct cb_hist_s
+{
+    uint64_t counts[CB_HIST_BUCKETS]; /**< The number of values recorded in each bucket. */
+    uint64_t total; /**< The number of values recorded. */
+    uint64_t min; /**< The minimum value recorded. */
+    uint64_t max; /**< The maximum value recorded. */
+} cb_hist_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_hist_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a histogram, can also be used to clear all the values recorded.
+ * @param[in] hist The histogram context to initialize.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_hist_init(cb_hist_t * const hist);
+
+/**
+ * @brief Records a value in a histogram.
+ * @param[in] hist The initialized histogram context.
+ * @param[in] value The value to record.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_hist_record(cb_hist_t * const hist, const uint64_t value);
+
+/**
+ * @brief Obtains the value at a percentile of the values recorded in a histogram.
+ *
+ * The value reported is the highest value of the bucket where the percentile falls, limited to the maximum value
+ * recorded, e.g. @c 50.0, @c 99.0 and @c 99.9 for p50, p99 and p999 respectively.
+ * @param[in] hist The initialized histogram context.
+ * @param[in] percentile The percentile, in the range <tt>(0.0, 100.0]</tt>.
+ * @param[out] value The value at the percentile.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty No values have been recorded in the histogram.
+ */
+cb_error_t cb_hist_percentile(const cb_hist_t * const hist, const double percentile, uint64_t * const value);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_HIST_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,2717 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_impl.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef CB_IMPL_H
+#define CB_IMPL_H
+
+/** @defgroup cb_iapi_impl Internal API implementation */
+/** @defgroup cb_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb.h"
+#if defined(CB_USE_LATENCY) || defined(CB_USE_LOCK_PROF)
+#include "cb/cb_hist.h"
+#endif
+#ifdef CB_USE_LOCK_PROF
+#include "cb/cb_lock_prof.h"
+#endif
+#ifdef CB_USE_TRACE
+#include "cb/cb_trace.h"
+#endif
+#ifdef CB_USE_LOCKS
+#include "cb/cb_lock.h"
+#endif
+#ifdef CB_USE_WAIT
+#include "cb/cb_wait.h"
+#endif
+#ifdef CB_USE_EVENTFD
+#include <poll.h>
+#include <unistd.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#endif
+#include <string.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_iapi_impl
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_iapi_impl
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_iapi_impl
+ * @{
+ */
+
+#ifdef CB_USE_STDATOMIC
+/** Critical variable assignment, load and store operations, with atomic support. Each variable is stored by one side
+ * only and published to the other, thus acquire and release suffice, and sequentially consistent stores are avoided
+ * as they are a full barrier on most platforms, the most costly part of writes and reads of few elements. */
+/** @{ */
+#define CB_CRIT_VAR_INIT(variable, value)  (atomic_init(&(variable), (value)))
+#define CB_CRIT_VAR_LOAD(variable)         (atomic_load_explicit(&(variable), memory_order_acquire))
+#define CB_CRIT_VAR_STORE(variable, value) (atomic_store_explicit(&(variable), (value), memory_order_release))
+#define CB_CRIT_VAR_CAS(variable, expected, desired) \
+    (atomic_compare_exchange_strong(&(variable), &(expected), (desired)))
+/** @} */
+/** Sequentially consistent fence, orders a store to a critical variable before a later load of another one. */
+#define CB_CRIT_FENCE() (atomic_thread_fence(memory_order_seq_cst))
+#else
+/** Critical variable assignment, load and store operations, without atomic support. */
+/** @{ */
+#define CB_CRIT_VAR_INIT(variable, value)  (variable) = (value)
+#define CB_CRIT_VAR_LOAD(variable)         (variable)
+#define CB_CRIT_VAR_STORE(variable, value) (variable) = (value)
+#define CB_CRIT_VAR_CAS(variable, expected, desired) \
+    (((variable) == (expected)) ? (((variable) = (desired)), true) : false)
+/** @} */
+/** Sequentially consistent fence, not needed without atomic support. */
+#define CB_CRIT_FENCE()
+#endif
+
+#ifdef CB_USE_STATS
+#ifdef CB_USE_STDATOMIC
+/**
+ * @brief Adds to a statistics counter, only updated by one thread at a time, thus without read-modify-write.
+ * @param[in] ctr The counter.
+ * @param[in] value The value to add.
+ */
+#define CB_STATS_ADD(ctr, value)                                                                                     \
+    (atomic_store_explicit(&(ctr), atomic_load_explicit(&(ctr), memory_order_relaxed) + (value), memory_order_relaxed))
+
+/**
+ * @brief Sets a statistics counter to the maximum of its value and the value provided.
+ * @param[in] ctr The counter.
+ * @param[in] value The value.
+ */
+#define CB_STATS_MAX(ctr, value)                                                                                     \
+    do                                                                                                               \
+    {                                                                                                                \
+        if ((value) > atomic_load_explicit(&(ctr), memory_order_relaxed))                                            \
+        {                                                                                                            \
+            atomic_store_explicit(&(ctr), (value), memory_order_relaxed);                                            \
+        }                                                                                                            \
+    } while (false)
+
+/**
+ * @brief Reads a statistics counter.
+ * @param[in] ctr The counter.
+ * @return The value of the counter.
+ */
+#define CB_STATS_GET(ctr) (atomic_load_explicit(&(ctr), memory_order_relaxed))
+
+/**
+ * @brief Clears a statistics counter.
+ * @param[in] ctr The counter.
+ */
+#define CB_STATS_CLEAR(ctr) (atomic_store_explicit(&(ctr), 0U, memory_order_relaxed))
+#else
+/** Statistics counters operations, without atomic support. */
+/** @{ */
+#define CB_STATS_ADD(ctr, value) (ctr) += (value)
+#define CB_STATS_MAX(ctr, value)                                                                                     \
+    do                                                                                                               \
+    {                                                                                                                \
+        if ((value) > (ctr))                                                                                         \
+        {                                                                                                            \
+            (ctr) = (value);                                                                                         \
+        }                                                                                                            \
+    } while (false)
+#define CB_STATS_GET(ctr)   (ctr)
+#define CB_STATS_CLEAR(ctr) (ctr) = 0U
+/** @} */
+#endif
+#else
+/** Statistics counters operations, compiled out if statistics are not enabled. */
+/** @{ */
+#define CB_STATS_ADD(ctr, value)
+#define CB_STATS_MAX(ctr, value)
+/** @} */
+#endif
+
+/** 
+ * @brief Casts a pointer to void to pointer to char for pointer arithmetic in units of one.
+ * @param[in] ptr The pointer to void to cast.
+ * @return The pointer to void to cast.
+ */
+#define CB_CAST(ptr) ((char *)(ptr))
+
+/** 
+ * @brief Casts a pointer to void to pointer to const char for pointer arithmetic in units of one.
+ * @param[in] ptr The pointer to void to cast.
+ * @return The pointer to void to cast.
+ */
+#define CB_CONST_CAST(ptr) ((const char *)(ptr))
+
+/** 
+ * @brief Checks if a circular buffer is subscribed to an event or multiple events specified.
+ * @param[in] cb The circular buffer.
+ * @param[in] evt The event or events to check if subscribed.
+ * @return @c true if subscribed to all the events specified and @c false if not.
+ */
+#define CB_IS_SUB(cb, evt) (((cb)->evt_sub & (evt)) == (evt))
+
+#ifdef CB_USE_LOCK_PROF
+/**
+ * @brief Checks if the lock is not profiled.
+ * @param[in] cb Circular buffer context.
+ * @return @c true if the lock is not profiled, @c false otherwise.
+ */
+#define CB_NO_PROF(cb) ((cb)->prof_clock == NULL)
+#else
+/** Checks if the lock is not profiled, always @c true if lock profiling is not enabled. */
+#define CB_NO_PROF(cb) (true)
+#endif
+
+#ifdef CB_USE_LOCKS
+/**
+ * @brief Checks if no built-in lock is set.
+ * @param[in] cb Circular buffer context.
+ * @return @c true if no built-in lock is set, @c false otherwise.
+ */
+#define CB_NO_LOCK(cb) ((cb)->lock_id == cb_lock_id_evt)
+#else
+/** Checks if no built-in lock is set, always @c true if built-in locks are not enabled. */
+#define CB_NO_LOCK(cb) (true)
+#endif
+
+/**
+ * @brief Checks if no events are subscribed, the lock is not profiled and no built-in lock is set, for the
+ * specialized write and read paths.
+ * @param[in] cb Circular buffer context.
+ * @return @c true if the specialized write and read paths can be taken, @c false otherwise.
+ */
+#define CB_NO_EVT(cb) (((cb)->evt_sub == cb_evt_id_none) && CB_NO_PROF(cb) && CB_NO_LOCK(cb))
+
+#ifdef CB_USE_PACKED
+/** Loads and stores of the published read and write indexes, packed in a single word, see ::cb_int_idx_store. */
+/** @{ */
+#define CB_READ_IDX_LOAD(cb)          ((size_t)(CB_CRIT_VAR_LOAD((cb)->idx) >> 32U))
+#define CB_WRITE_IDX_LOAD(cb)         ((size_t)(CB_CRIT_VAR_LOAD((cb)->idx) & UINT32_MAX))
+#define CB_READ_IDX_STORE(cb, value)  (cb_int_idx_store((cb), true, (value)))
+#define CB_WRITE_IDX_STORE(cb, value) (cb_int_idx_store((cb), false, (value)))
+/** @} */
+#else
+/** Loads and stores of the published read and write indexes. */
+/** @{ */
+#define CB_READ_IDX_LOAD(cb)          (CB_CRIT_VAR_LOAD((cb)->read_idx))
+#define CB_WRITE_IDX_LOAD(cb)         (CB_CRIT_VAR_LOAD((cb)->write_idx))
+#define CB_READ_IDX_STORE(cb, value)  (CB_CRIT_VAR_STORE((cb)->read_idx, (value)))
+#define CB_WRITE_IDX_STORE(cb, value) (CB_CRIT_VAR_STORE((cb)->write_idx, (value)))
+/** @} */
+#endif
+
+#ifdef CB_USE_PIPELINE
+/** Checks if the elements go through processing stages before they can be read, see ::cb_set_stages. */
+#define CB_HAS_STAGES(cb) ((cb)->stage_count > 0U)
+/** Loads the index up to which elements can be read, the one of the last processing stage, see ::cb_set_stages. */
+#define CB_READ_LIM_LOAD(cb) \
+    (((cb)->stage_count == 0U) ? (CB_WRITE_IDX_LOAD(cb)) : (CB_CRIT_VAR_LOAD((cb)->stages[(cb)->stage_count - 1U].idx)))
+#else
+/** Checks if the elements go through processing stages before they can be read, always @c false if not enabled. */
+#define CB_HAS_STAGES(cb) (false)
+/** Loads the index up to which elements can be read, the published write index. */
+#define CB_READ_LIM_LOAD(cb) (CB_WRITE_IDX_LOAD(cb))
+#endif
+
+#ifdef CB_USE_WAIT
+/** Checks if the circular buffer is in a wait set, see ::cb_wait_add. */
+#define CB_HAS_WAIT(cb) ((cb)->wait != NULL)
+#else
+/** Checks if the circular buffer is in a wait set, always @c false if wait sets are not enabled. */
+#define CB_HAS_WAIT(cb) (false)
+#endif
+
+#ifdef CB_USE_EVENTFD
+/** Checks if the circular buffer has readiness file descriptors, see ::cb_set_eventfd. */
+#define CB_HAS_EVENTFD(cb) (((cb)->evfd_readable >= 0) || ((cb)->evfd_writable >= 0))
+#else
+/** Checks if the circular buffer has readiness file descriptors, always @c false if they are not enabled. */
+#define CB_HAS_EVENTFD(cb) (false)
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+/** Hints the processor that it is spinning, see ::cb_read_batch. */
+#define CB_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+/** Hints the processor that it is spinning, see ::cb_read_batch. */
+#define CB_PAUSE() __asm__ __volatile__("yield")
+#else
+/** Hints the processor that it is spinning, nothing on other architectures. */
+#define CB_PAUSE()
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+/** Yields the processor to other threads, see ::cb_read_batch. */
+#define CB_YIELD() ((void)sched_yield())
+#else
+/** Yields the processor to other threads, nothing without a scheduler to yield to. */
+#define CB_YIELD()
+#endif
+
+#ifdef CB_USE_ASYNC
+/** Loads of the indexes up to which writes and reads have been started, see ::cb_async_t. */
+/** @{ */
+#define CB_WRITE_RES_IDX_LOAD(cb) (CB_CRIT_VAR_LOAD((cb)->write_res_idx))
+#define CB_READ_RES_IDX_LOAD(cb)  (CB_CRIT_VAR_LOAD((cb)->read_res_idx))
+/** @} */
+#else
+/** Loads of the indexes up to which writes and reads have been started, same as the published ones. */
+/** @{ */
+#define CB_WRITE_RES_IDX_LOAD(cb) (CB_WRITE_IDX_LOAD(cb))
+#define CB_READ_RES_IDX_LOAD(cb)  (CB_READ_IDX_LOAD(cb))
+/** @} */
+#endif
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_iapi_impl
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Triggers a ::cb_evt_id_read event, or falls back to the internal implementation if not subscribed.
+ * @param[in] cb Circular buffer context.
+ * @param[in] read_ptr The read pointer where to read the data from.
+ * @param[in] bytes The number of bytes to read from @p read_ptr and write to @p buffer.
+ * @param[in] buffer The buffer where to write data to.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_evt The handling of the event resulted in error.
+ */
+static cb_error_t
+    cb_evt_read(const cb_t * const cb, const void * const read_ptr, const size_t bytes, void * const buffer);
+
+/**
+ * @brief Triggers a ::cb_evt_id_write event, or falls back to the internal implementation if not subscribed.
+ * @param[in] cb Circular buffer context.
+ * @param[in] buffer The buffer where to read the data from.
+ * @param[in] bytes The number of bytes to read from @p buffer and write to @p write_ptr.
+ * @param[in] write_ptr The write pointer where to write the data to.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_evt The handling of the event resulted in error.
+ */
+static cb_error_t
+    cb_evt_write(const cb_t * const cb, const void * const buffer, const size_t bytes, void * const write_ptr);
+
+/**
+ * @brief Locks the circular buffer for a function, the side of the function only if split, see ::cb_set_lock_split.
+ * @param[in] cb Circular buffer context.
+ * @param[in] fn The function that locks, for the side to lock and lock profiling.
+ */
+static void cb_evt_lock(cb_t * const cb, const cb_fn_id_t fn);
+
+/**
+ * @brief Unlocks the circular buffer for a function, the side of the function only if split.
+ * @param[in] cb Circular buffer context.
+ * @param[in] fn The function that unlocks, for the side to unlock and lock profiling.
+ */
+static void cb_evt_unlock(cb_t * const cb, const cb_fn_id_t fn);
+
+/**
+ * @brief Obtains the side locked by a function.
+ * @param[in] cb Circular buffer context.
+ * @param[in] fn The function.
+ * @return The side, ::cb_lock_side_all if not split or if the function accesses both sides.
+ */
+static inline cb_lock_side_t cb_int_lock_side(const cb_t * const cb, const cb_fn_id_t fn);
+
+/**
+ * @brief Takes the built-in lock of a side if set, otherwise triggers a ::cb_evt_id_lock event if subscribed.
+ * @param[in] cb Circular buffer context.
+ * @param[in] side The side to lock.
+ */
+static inline void cb_int_lock(cb_t * const cb, const cb_lock_side_t side);
+
+/**
+ * @brief Releases the built-in lock of a side if set, otherwise triggers a ::cb_evt_id_unlock event if subscribed.
+ * @param[in] cb Circular buffer context.
+ * @param[in] side The side to unlock.
+ */
+static inline void cb_int_unlock(cb_t * const cb, const cb_lock_side_t side);
+
+#ifdef CB_USE_LOCKS
+/**
+ * @brief Takes a built-in lock, the contended paths are in @c cb/cb_lock.h.
+ * @param[in] lock_id The lock strategy.
+ * @param[in] lock The lock.
+ */
+static inline void cb_int_lock_take(const cb_lock_id_t lock_id, cb_lock_t * const lock);
+
+/**
+ * @brief Releases a built-in lock.
+ * @param[in] lock_id The lock strategy.
+ * @param[in] lock The lock.
+ */
+static inline void cb_int_lock_release(const cb_lock_id_t lock_id, cb_lock_t * const lock);
+#endif
+
+/**
+ * @brief Triggers a ::cb_evt_id_high_wm event if subscribed and the high watermark was reached after a write.
+ * @param[in] cb Circular buffer context.
+ * @param[in] filled The number of filled slots after the write.
+ */
+static void cb_evt_high_wm(cb_t * const cb, const size_t filled);
+
+/**
+ * @brief Triggers a ::cb_evt_id_low_wm event if subscribed and the low watermark was reached after a read.
+ * @param[in] cb Circular buffer context.
+ * @param[in] filled The number of filled slots after the read.
+ */
+static void cb_evt_low_wm(cb_t * const cb, const size_t filled);
+
+#ifdef CB_USE_ASYNC
+/**
+ * @brief Triggers a ::cb_evt_id_read_async event to start a read of up to two spans.
+ * @param[in] cb Circular buffer context.
+ * @param[in] read_idx The read index where to start reading from.
+ * @param[in] fbytes The number of bytes to read from @p read_idx.
+ * @param[in] sbytes The number of bytes to read from the start index, zero if the read does not wrap.
+ * @param[in] buffer The buffer where to write data to.
+ * @param[in] end_idx The read index to publish when the read completes.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_full Too many reads are pending completion.
+ * @retval ::cb_error_evt The handling of the event resulted in error.
+ */
+static cb_error_t cb_evt_read_async(cb_t * const cb,
+                                    const size_t read_idx,
+                                    const size_t fbytes,
+                                    const size_t sbytes,
+                                    void * const buffer,
+                                    const size_t end_idx);
+
+/**
+ * @brief Triggers a ::cb_evt_id_write_async event to start a write of up to two spans.
+ * @param[in] cb Circular buffer context.
+ * @param[in] buffer The buffer where to read the data from.
+ * @param[in] fbytes The number of bytes to write at @p write_idx.
+ * @param[in] sbytes The number of bytes to write at the start index, zero if the write does not wrap.
+ * @param[in] write_idx The write index where to start writing to.
+ * @param[in] end_idx The write index to publish when the write completes.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_full Too many writes are pending completion.
+ * @retval ::cb_error_evt The handling of the event resulted in error.
+ */
+static cb_error_t cb_evt_write_async(cb_t * const cb,
+                                     const void * const buffer,
+                                     const size_t fbytes,
+                                     const size_t sbytes,
+                                     const size_t write_idx,
+                                     const size_t end_idx);
+
+/**
+ * @brief Marks an asynchronous operation as completed and obtains the index to publish, if any.
+ * @param[in] async The asynchronous operations of a direction.
+ * @param[in] seq The sequence number of the completed operation.
+ * @param[out] end_idx The index to publish, only valid if @c true is returned.
+ * @return @c true if the oldest operations have completed and @p end_idx must be published, @c false otherwise.
+ */
+static bool cb_int_async_done(cb_async_t * const async, const size_t seq, size_t * const end_idx);
+#endif
+
+/**
+ * @brief Accounts for a successful write in the statistics, compiled out if statistics are not enabled.
+ * @param[in] cb Circular buffer context.
+ * @param[in] count The number of elements written.
+ * @param[in] wrapped @c true if the write wrapped around, @c false otherwise.
+ * @param[in] filled The number of filled slots after the write.
+ */
+static inline void cb_int_stats_write(cb_t * const cb, const size_t count, const bool wrapped, const size_t filled);
+
+/**
+ * @brief Accounts for a successful read in the statistics, compiled out if statistics are not enabled.
+ * @param[in] cb Circular buffer context.
+ * @param[in] count The number of elements read.
+ * @param[in] wrapped @c true if the read wrapped around, @c false otherwise.
+ */
+static inline void cb_int_stats_read(cb_t * const cb, const size_t count, const bool wrapped);
+
+/**
+ * @brief Samples a write for latency measurements, compiled out if latencies are not enabled.
+ *
+ * Must be called before the write index is published, so the sample is visible to the read of its elements.
+ * @param[in] cb Circular buffer context.
+ * @param[in] end_idx The write index after the write.
+ */
+static inline void cb_int_lat_write(cb_t * const cb, const size_t end_idx);
+
+/**
+ * @brief Records the latencies of the sampled writes read, compiled out if latencies are not enabled.
+ * @param[in] cb Circular buffer context.
+ * @param[in] end_idx The read index after the read.
+ * @param[in] count The number of elements read.
+ */
+static inline void cb_int_lat_read(cb_t * const cb, const size_t end_idx, const size_t count);
+
+/**
+ * @brief Signals the wait set and the readable file descriptor if the read limit advancing made the circular buffer go
+ * from empty to not empty, compiled out if neither wait sets nor readiness file descriptors are enabled.
+ *
+ * Must be called after the read limit is published, see ::CB_READ_LIM_LOAD. It is ordered before the check with a
+ * fence, and so is the check of the consumer, after its last read or in ::cb_wait_wait, thus either the consumer
+ * observes the elements, or this observes the consumer read up to them and signals it.
+ * @param[in] cb Circular buffer context.
+ * @param[in] start_idx The read limit before it advanced.
+ */
+static inline void cb_int_ready_limit(cb_t * const cb, const size_t start_idx);
+
+/**
+ * @brief Signals the readable edge after a write, see ::cb_int_ready_limit, unless there are processing stages, in
+ * which case the elements written can't be read yet and the last stage signals it in ::cb_stage_release.
+ * @param[in] cb Circular buffer context.
+ * @param[in] start_idx The write index before the write.
+ */
+static inline void cb_int_ready_write(cb_t * const cb, const size_t start_idx);
+
+/**
+ * @brief Signals the wait set and the writable file descriptor if a read made the circular buffer go from full to not
+ * full, compiled out if neither wait sets nor readiness file descriptors are enabled, see ::cb_int_ready_limit.
+ * @param[in] cb Circular buffer context.
+ * @param[in] start_idx The read index before the read.
+ */
+static inline void cb_int_ready_read(cb_t * const cb, const size_t start_idx);
+
+#ifdef CB_USE_EVENTFD
+/**
+ * @brief Signals a readiness file descriptor, if set, writing the 8-byte increment of an @c eventfd to it.
+ * @param[in] fd The file descriptor, negative if not set.
+ */
+static inline void cb_int_eventfd_signal(const int fd);
+#endif
+
+/**
+ * @brief Backs off while ::cb_read_batch lingers, spinning first, then sleeping if empty and able to be woken up when
+ * written, otherwise yielding.
+ *
+ * Only the write to an empty circular buffer signals the wait set and the readable file descriptor, thus it only sleeps
+ * when empty, and for ::CB_BATCH_SLEEP_MS at most as the linger time is in the units of another clock.
+ * @param[in] cb Circular buffer context.
+ * @param[in] readable The number of elements that could be read when last polled.
+ * @param[in] spins The number of times it backed off before.
+ * @param[in] seq The number of signals of the wait set before polling, see ::cb_wait_signals.
+ */
+static inline void
+    cb_int_batch_wait(cb_t * const cb, const size_t readable, const size_t spins, const unsigned int seq);
+
+#ifdef CB_USE_STATS
+/**
+ * @brief Clears all the statistics counters.
+ * @param[in] cb Circular buffer context.
+ */
+static void cb_int_stats_clear(cb_t * const cb);
+#endif
+
+/**
+ * @brief Obtains the number of filled slots in the circular buffer between the indexes specified.
+ * @param[in] cb Circular buffer context.
+ * @param[in] read_idx The read index.
+ * @param[in] write_idx The write index.
+ * @param[out] felems The number of filled elements from the read index to first write or end index, can be @c NULL.
+ * @param[out] selems The number of filled elements from the start index to write index, can be @c NULL.
+ * @return The number of filled slots.
+ */
+static size_t cb_int_get_filled(const cb_t * const cb,
+                                const size_t read_idx,
+                                const size_t write_idx,
+                                size_t * const felems,
+                                size_t * const selems);
+
+/**
+ * @brief Obtains the number of unfilled slots in the circular buffer between the indexes specified.
+ * @param[in] cb Circular buffer context.
+ * @param[in] read_idx The read index.
+ * @param[in] write_idx The write index.
+ * @param[out] felems The number of unfilled elements from the write index to first read or end index, can be @c NULL.
+ * @param[out] selems The number of unfilled elements from the start index to read index, can be @c NULL.
+ * @return The number of unfilled slots.
+ */
+static size_t cb_int_get_unfilled(const cb_t * const cb,
+                                  const size_t read_idx,
+                                  const size_t write_idx,
+                                  size_t * const felems,
+                                  size_t * const selems);
+
+#ifdef CB_USE_PACKED
+/**
+ * @brief Stores the read or write index in the packed word, preserving the other index, see ::CB_READ_IDX_STORE.
+ * @param[in] cb Circular buffer context.
+ * @param[in] read @c true to store the read index, @c false to store the write index.
+ * @param[in] value The index to store.
+ */
+static inline void cb_int_idx_store(cb_t * const cb, const bool read, const size_t value);
+#endif
+
+/**
+ * @brief Loads a pair of indexes that existed at the same time without lock, see ::cb_get_unfilled_lockfree.
+ * @param[in] cb Circular buffer context.
+ * @param[in] filled @c true for the indexes of the filled slots, @c false for those of the unfilled slots.
+ * @param[in] readable If @c true along with @p filled, the write index is the read limit, see ::CB_READ_LIM_LOAD.
+ * @param[out] read_idx The read index, reserved by reads in progress if @p filled is @c true.
+ * @param[out] write_idx The write index, reserved by writes in progress if @p filled is @c false.
+ */
+static inline void cb_int_snapshot(cb_t * const cb,
+                                   const bool filled,
+                                   const bool readable,
+                                   size_t * const read_idx,
+                                   size_t * const write_idx);
+
+/**
+ * @brief Writes elements to the circular buffer without events nor lock, see ::CB_NO_EVT.
+ * @param[in] cb Circular buffer context.
+ * @param[in] buffer The elements to write.
+ * @param[in] requested The number of elements to write.
+ * @param[out] written If not @c NULL, as many elements as fit are written and their number stored here, see
+ * ::cb_write_partial, otherwise all or none are written.
+ * @return The result of the write, as in ::cb_write.
+ */
+static inline cb_error_t cb_int_write_noevt(cb_t * const cb,
+                                            const void * const buffer,
+                                            const size_t requested,
+                                            size_t * const written);
+
+/**
+ * @brief Reads elements from the circular buffer without events nor lock, see ::CB_NO_EVT.
+ * @param[in] cb Circular buffer context.
+ * @param[out] buffer The buffer where to read the elements.
+ * @param[in] requested The number of elements to read.
+ * @param[out] read If not @c NULL, as many elements as exist are read and their number stored here, see
+ * ::cb_read_partial, otherwise all or none are read.
+ * @return The result of the read, as in ::cb_read.
+ */
+static inline cb_error_t
+    cb_int_read_noevt(cb_t * const cb, void * const buffer, const size_t requested, size_t * const read);
+
+/**
+ * @brief Writes elements to the circular buffer, see ::cb_write.
+ * @param[in] cb Circular buffer context.
+ * @param[in] buffer The elements to write.
+ * @param[in] requested The number of elements to write.
+ * @param[in] check If @c true the arguments are checked, otherwise they are assumed to be valid.
+ * @param[out] written If not @c NULL, as many elements as fit are written and their number stored here, see
+ * ::cb_write_partial, otherwise all or none are written.
+ * @return The result of the write, as in ::cb_write.
+ */
+static inline cb_error_t cb_int_write(cb_t * const cb,
+                                      const void * const buffer,
+                                      const size_t requested,
+                                      const bool check,
+                                      size_t * const written);
+
+/**
+ * @brief Reads elements from the circular buffer, see ::cb_read.
+ * @param[in] cb Circular buffer context.
+ * @param[out] buffer The buffer where to read the elements.
+ * @param[in] requested The number of elements to read.
+ * @param[in] check If @c true the arguments are checked, otherwise they are assumed to be valid.
+ * @param[out] read If not @c NULL, as many elements as exist are read and their number stored here, see
+ * ::cb_read_partial, otherwise all or none are read.
+ * @return The result of the read, as in ::cb_read.
+ */
+static inline cb_error_t cb_int_read(cb_t * const cb,
+                                     void * const buffer,
+                                     const size_t requested,
+                                     const bool check,
+                                     size_t * const read);
+
+#ifdef CB_USE_TRACE
+/**
+ * @brief Passes the record of a write or read to the trace sink, if tracing.
+ * @param[in] cb Circular buffer context, can be @c NULL.
+ * @param[in] fn The function, either ::cb_fn_id_write or ::cb_fn_id_read.
+ * @param[in] count The number of elements requested.
+ * @param[in] stamp The timestamp of the start of the operation.
+ * @param[in] result The result of the operation.
+ */
+static void cb_int_trace(cb_t * const cb,
+                         const cb_fn_id_t fn,
+                         const size_t count,
+                         const uint64_t stamp,
+                         const cb_error_t result);
+#endif
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t
+    cb_evt_read(const cb_t * const cb, const void * const read_ptr, const size_t bytes, void * const buffer)
+{
+    // Check if subscribed to event, and call event handler if so.
+    if (CB_IS_SUB(cb, cb_evt_id_read))
+    {
+        cb_evt_t evt = {
+            .cb = cb,
+            .user_data = cb->evt_user_data,
+            .id = cb_evt_id_read,
+            .data.read = {.read_ptr = read_ptr, .bytes = bytes, .buffer = buffer},
+        };
+        return cb->evt_handler(&evt);
+    }
+
+    // Otherwise, use built-in implementation.
+    (void)memcpy(buffer, read_ptr, bytes);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t
+    cb_evt_write(const cb_t * const cb, const void * const buffer, const size_t bytes, void * const write_ptr)
+{
+    // Check if subscribed to event, and call event handler if so.
+    if (CB_IS_SUB(cb, cb_evt_id_write))
+    {
+        cb_evt_t evt = {
+            .cb = cb,
+            .user_data = cb->evt_user_data,
+            .id = cb_evt_id_write,
+            .data.write = {.buffer = buffer, .bytes = bytes, .write_ptr = write_ptr},
+        };
+        return cb->evt_handler(&evt);
+    }
+
+    // Otherwise, use built-in implementation.
+    (void)memcpy(write_ptr, buffer, bytes);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_evt_lock(cb_t * const cb, const cb_fn_id_t fn)
+{
+#ifdef CB_USE_LOCK_PROF
+    const uint64_t start = (cb->prof_clock != NULL) ? (cb->prof_clock()) : (0U);
+#endif
+
+    // If split and the function accesses both sides, lock both, always in the same order to avoid deadlocks.
+    const cb_lock_side_t side = cb_int_lock_side(cb, fn);
+    if (cb->lock_split && (side == cb_lock_side_all))
+    {
+        cb_int_lock(cb, cb_lock_side_write);
+        cb_int_lock(cb, cb_lock_side_read);
+    }
+    else
+    {
+        cb_int_lock(cb, side);
+    }
+
+#ifdef CB_USE_LOCK_PROF
+    // Record the time waiting for the lock, the lock is held from here onwards.
+    if (cb->prof_clock != NULL)
+    {
+        cb->prof->acquired[fn] = cb->prof_clock();
+        (void)cb_hist_record(&cb->prof->wait[fn], cb->prof->acquired[fn] - start);
+    }
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_evt_unlock(cb_t * const cb, const cb_fn_id_t fn)
+{
+#ifdef CB_USE_LOCK_PROF
+    // Record the time holding the lock, before releasing it.
+    if (cb->prof_clock != NULL)
+    {
+        (void)cb_hist_record(&cb->prof->hold[fn], cb->prof_clock() - cb->prof->acquired[fn]);
+    }
+#endif
+
+    // Unlock in the reverse order of locking.
+    const cb_lock_side_t side = cb_int_lock_side(cb, fn);
+    if (cb->lock_split && (side == cb_lock_side_all))
+    {
+        cb_int_unlock(cb, cb_lock_side_read);
+        cb_int_unlock(cb, cb_lock_side_write);
+    }
+    else
+    {
+        cb_int_unlock(cb, side);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline cb_lock_side_t cb_int_lock_side(const cb_t * const cb, const cb_fn_id_t fn)
+{
+    if (!cb->lock_split)
+    {
+        return cb_lock_side_all;
+    }
+
+    // The side of the reserved index each function reads or updates, the other index is only read when published.
+    switch (fn)
+    {
+        case cb_fn_id_write:
+        case cb_fn_id_write_done:
+        case cb_fn_id_get_unfilled:
+        case cb_fn_id_is_full:
+        {
+            return cb_lock_side_write;
+        }
+
+        case cb_fn_id_read:
+        case cb_fn_id_read_done:
+        case cb_fn_id_get_filled:
+        case cb_fn_id_is_empty:
+        {
+            return cb_lock_side_read;
+        }
+
+        default:
+        {
+            return cb_lock_side_all;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_lock(cb_t * const cb, const cb_lock_side_t side)
+{
+#ifdef CB_USE_LOCKS
+    // A built-in lock takes precedence over the lock event.
+    if (!CB_NO_LOCK(cb))
+    {
+        cb_int_lock_take(cb->lock_id, (side == cb_lock_side_read) ? (&cb->lock_read) : (&cb->lock_write));
+    }
+    else
+#endif
+    if (CB_IS_SUB(cb, cb_evt_id_lock))
+    {
+        cb_evt_t evt = {
+            .cb = cb,
+            .user_data = cb->evt_user_data,
+            .id = cb_evt_id_lock,
+            .data.lock.side = side,
+        };
+        (void)cb->evt_handler(&evt);
+    }
+
+    // Internal implementation assumes no locking mechanisms.
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_unlock(cb_t * const cb, const cb_lock_side_t side)
+{
+#ifdef CB_USE_LOCKS
+    // A built-in lock takes precedence over the unlock event.
+    if (!CB_NO_LOCK(cb))
+    {
+        cb_int_lock_release(cb->lock_id, (side == cb_lock_side_read) ? (&cb->lock_read) : (&cb->lock_write));
+    }
+    else
+#endif
+    if (CB_IS_SUB(cb, cb_evt_id_unlock))
+    {
+        cb_evt_t evt = {
+            .cb = cb,
+            .user_data = cb->evt_user_data,
+            .id = cb_evt_id_unlock,
+            .data.unlock.side = side,
+        };
+        (void)cb->evt_handler(&evt);
+    }
+
+    // Internal implementation assumes no locking mechanisms.
+}
+
+#ifdef CB_USE_LOCKS
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_lock_take(const cb_lock_id_t lock_id, cb_lock_t * const lock)
+{
+    switch (lock_id)
+    {
+#ifdef CB_USE_STDATOMIC
+        case cb_lock_id_ticket:
+        {
+            // Take a ticket, and wait for it to be served only if the lock is held.
+            const unsigned int ticket = atomic_fetch_add_explicit(&lock->ticket, 1U, memory_order_relaxed);
+            if (atomic_load_explicit(&lock->owner, memory_order_acquire) != ticket)
+            {
+                cb_lock_ticket_wait(&lock->owner, ticket);
+            }
+        }
+        break;
+
+        case cb_lock_id_adaptive:
+        {
+            // Take the lock if unlocked, otherwise spin and sleep until released.
+            unsigned int expected = 0U;
+            if (!atomic_compare_exchange_strong_explicit(
+                    &lock->state, &expected, 1U, memory_order_acquire, memory_order_relaxed))
+            {
+                cb_lock_adaptive_wait(&lock->state);
+            }
+        }
+        break;
+#endif
+
+        case cb_lock_id_pthread:
+        {
+            (void)pthread_mutex_lock(&lock->mutex);
+        }
+        break;
+
+        default:
+        {
+            // Not a built-in lock, nothing to do.
+        }
+        break;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_lock_release(const cb_lock_id_t lock_id, cb_lock_t * const lock)
+{
+    switch (lock_id)
+    {
+#ifdef CB_USE_STDATOMIC
+        case cb_lock_id_ticket:
+        {
+            // Serve the next ticket, only the holder updates it, thus without read-modify-write.
+            atomic_store_explicit(
+                &lock->owner, atomic_load_explicit(&lock->owner, memory_order_relaxed) + 1U, memory_order_release);
+        }
+        break;
+
+        case cb_lock_id_adaptive:
+        {
+            // Release the lock, and wake a waiter only if contended.
+            if (atomic_exchange_explicit(&lock->state, 0U, memory_order_release) == 2U)
+            {
+                cb_lock_adaptive_wake(&lock->state);
+            }
+        }
+        break;
+#endif
+
+        case cb_lock_id_pthread:
+        {
+            (void)pthread_mutex_unlock(&lock->mutex);
+        }
+        break;
+
+        default:
+        {
+            // Not a built-in lock, nothing to do.
+        }
+        break;
+    }
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_evt_high_wm(cb_t * const cb, const size_t filled)
+{
+    // Check if subscribed to event, and if the watermark was reached, in which case, only the first thread to change
+    // the watermark state raises the event.
+    bool above = false;
+    if (CB_IS_SUB(cb, cb_evt_id_high_wm) && (cb->wm_high > 0U) && (filled >= cb->wm_high) &&
+        CB_CRIT_VAR_CAS(cb->wm_above, above, true))
+    {
+        cb_evt_t evt = {
+            .cb = cb,
+            .user_data = cb->evt_user_data,
+            .id = cb_evt_id_high_wm,
+            .data.wm.filled = filled,
+        };
+        (void)cb->evt_handler(&evt);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_evt_low_wm(cb_t * const cb, const size_t filled)
+{
+    // Check if subscribed to event, and if the watermark was reached, in which case, only the first thread to change
+    // the watermark state raises the event.
+    bool above = true;
+    if (CB_IS_SUB(cb, cb_evt_id_low_wm) && (filled <= cb->wm_low) && CB_CRIT_VAR_CAS(cb->wm_above, above, false))
+    {
+        cb_evt_t evt = {
+            .cb = cb,
+            .user_data = cb->evt_user_data,
+            .id = cb_evt_id_low_wm,
+            .data.wm.filled = filled,
+        };
+        (void)cb->evt_handler(&evt);
+    }
+}
+
+#ifdef CB_USE_ASYNC
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_read_async(cb_t * const cb,
+                                    const size_t read_idx,
+                                    const size_t fbytes,
+                                    const size_t sbytes,
+                                    void * const buffer,
+                                    const size_t end_idx)
+{
+    cb_async_t * const async = &cb->read_async;
+
+    // Check there is room to track the operation until it completes.
+    const size_t seq = CB_CRIT_VAR_LOAD(async->head);
+    if ((seq - CB_CRIT_VAR_LOAD(async->tail)) >= CB_ASYNC_MAX_OPS)
+    {
+        return cb_error_full;
+    }
+
+    // Track and account for the operation prior to triggering the event, as it could complete at any point after it,
+    // even from within the event handler.
+    cb_async_op_t * const op = &async->ops[seq % CB_ASYNC_MAX_OPS];
+    op->end_idx = end_idx;
+    op->done = false;
+    CB_CRIT_VAR_STORE(async->head, seq + 1U);
+
+    cb_evt_t evt = {
+        .cb = cb,
+        .user_data = cb->evt_user_data,
+        .id = cb_evt_id_read_async,
+        .data.read_async = {.read_ptr = CB_CAST(cb->buffer) + (read_idx * cb->elem_size),
+                            .bytes = fbytes,
+                            .buffer = buffer,
+                            .wrap_ptr = cb->buffer,
+                            .wrap_bytes = sbytes,
+                            .seq = seq},
+    };
+    const cb_error_t error = cb->evt_handler(&evt);
+    if (error != cb_error_ok)
+    {
+        // Operation not started, it can't have completed.
+        CB_CRIT_VAR_STORE(async->head, seq);
+    }
+
+    return error;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_write_async(cb_t * const cb,
+                                     const void * const buffer,
+                                     const size_t fbytes,
+                                     const size_t sbytes,
+                                     const size_t write_idx,
+                                     const size_t end_idx)
+{
+    cb_async_t * const async = &cb->write_async;
+
+    // Check there is room to track the operation until it completes.
+    const size_t seq = CB_CRIT_VAR_LOAD(async->head);
+    if ((seq - CB_CRIT_VAR_LOAD(async->tail)) >= CB_ASYNC_MAX_OPS)
+    {
+        return cb_error_full;
+    }
+
+    // Track and account for the operation prior to triggering the event, as it could complete at any point after it,
+    // even from within the event handler.
+    cb_async_op_t * const op = &async->ops[seq % CB_ASYNC_MAX_OPS];
+    op->end_idx = end_idx;
+    op->done = false;
+    CB_CRIT_VAR_STORE(async->head, seq + 1U);
+
+    cb_evt_t evt = {
+        .cb = cb,
+        .user_data = cb->evt_user_data,
+        .id = cb_evt_id_write_async,
+        .data.write_async = {.buffer = buffer,
+                             .bytes = fbytes,
+                             .write_ptr = CB_CAST(cb->buffer) + (write_idx * cb->elem_size),
+                             .wrap_bytes = sbytes,
+                             .wrap_ptr = cb->buffer,
+                             .seq = seq},
+    };
+    const cb_error_t error = cb->evt_handler(&evt);
+    if (error != cb_error_ok)
+    {
+        // Operation not started, it can't have completed.
+        CB_CRIT_VAR_STORE(async->head, seq);
+    }
+
+    return error;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool cb_int_async_done(cb_async_t * const async, const size_t seq, size_t * const end_idx)
+{
+    bool publish = false;
+
+    // Mark operation as completed.
+    async->ops[seq % CB_ASYNC_MAX_OPS].done = true;
+
+    // Retire the oldest operations for as long as they are completed, the last one retired determines the index. The
+    // slots are released to the thread starting operations with the tail, once cleared.
+    const size_t head = CB_CRIT_VAR_LOAD(async->head);
+    size_t tail = CB_CRIT_VAR_LOAD(async->tail);
+    while ((tail != head) && (async->ops[tail % CB_ASYNC_MAX_OPS].done))
+    {
+        *end_idx = async->ops[tail % CB_ASYNC_MAX_OPS].end_idx;
+        async->ops[tail % CB_ASYNC_MAX_OPS].done = false;
+        tail++;
+        publish = true;
+    }
+    CB_CRIT_VAR_STORE(async->tail, tail);
+
+    return publish;
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_stats_write(cb_t * const cb, const size_t count, const bool wrapped, const size_t filled)
+{
+#ifdef CB_USE_STATS
+    CB_STATS_ADD(cb->stats_write.ops, 1U);
+    CB_STATS_ADD(cb->stats_write.elems, count);
+    CB_STATS_ADD(cb->stats_write.wraps, (wrapped) ? (1U) : (0U));
+    CB_STATS_MAX(cb->stats_write.peak, filled);
+#else
+    (void)cb;
+    (void)count;
+    (void)wrapped;
+    (void)filled;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_stats_read(cb_t * const cb, const size_t count, const bool wrapped)
+{
+#ifdef CB_USE_STATS
+    CB_STATS_ADD(cb->stats_read.ops, 1U);
+    CB_STATS_ADD(cb->stats_read.elems, count);
+    CB_STATS_ADD(cb->stats_read.wraps, (wrapped) ? (1U) : (0U));
+#else
+    (void)cb;
+    (void)count;
+    (void)wrapped;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_lat_write(cb_t * const cb, const size_t end_idx)
+{
+#ifdef CB_USE_LATENCY
+    if (cb->lat_clock == NULL)
+    {
+        return;
+    }
+
+    // Check if this write is sampled, if there is no space for the sample, the next write is sampled instead.
+    cb->lat_count++;
+    const size_t head = CB_CRIT_VAR_LOAD(cb->lat_head);
+    if ((cb->lat_count < cb->lat_period) || ((head - CB_CRIT_VAR_LOAD(cb->lat_tail)) >= CB_LAT_MAX_SAMPLES))
+    {
+        return;
+    }
+    cb->lat_count = 0U;
+
+    // Stamp the last element of the write.
+    cb_lat_sample_t * const sample = &cb->lat_samples[head % CB_LAT_MAX_SAMPLES];
+    sample->idx = ((end_idx == 0U) ? (cb->buffer_length) : (end_idx)) - 1U;
+    sample->stamp = cb->lat_clock();
+    CB_CRIT_VAR_STORE(cb->lat_head, head + 1U);
+#else
+    (void)cb;
+    (void)end_idx;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_lat_read(cb_t * const cb, const size_t end_idx, const size_t count)
+{
+#ifdef CB_USE_LATENCY
+    if (cb->lat_clock == NULL)
+    {
+        return;
+    }
+
+    // Record the sampled writes whose last element was read, these are always the oldest samples pending.
+    const size_t head = CB_CRIT_VAR_LOAD(cb->lat_head);
+    size_t tail = CB_CRIT_VAR_LOAD(cb->lat_tail);
+    uint64_t now = 0U;
+    for (; tail != head; tail++)
+    {
+        const cb_lat_sample_t * const sample = &cb->lat_samples[tail % CB_LAT_MAX_SAMPLES];
+        if (((end_idx + cb->buffer_length - 1U - sample->idx) % cb->buffer_length) >= count)
+        {
+            break;
+        }
+        now = (now == 0U) ? (cb->lat_clock()) : (now);
+        (void)cb_hist_record(cb->lat_hist, now - sample->stamp);
+    }
+    CB_CRIT_VAR_STORE(cb->lat_tail, tail);
+#else
+    (void)cb;
+    (void)end_idx;
+    (void)count;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_ready_write(cb_t * const cb, const size_t start_idx)
+{
+    if (!CB_HAS_STAGES(cb))
+    {
+        cb_int_ready_limit(cb, start_idx);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_ready_limit(cb_t * const cb, const size_t start_idx)
+{
+#if defined(CB_USE_WAIT) || defined(CB_USE_EVENTFD)
+    // Without the fence, the consumer could miss the elements and this could miss that it read up to them.
+    if (CB_HAS_WAIT(cb) || CB_HAS_EVENTFD(cb))
+    {
+        CB_CRIT_FENCE();
+        if (CB_READ_RES_IDX_LOAD(cb) == start_idx)
+        {
+#ifdef CB_USE_WAIT
+            if (CB_HAS_WAIT(cb))
+            {
+                cb_wait_signal(cb->wait, cb->wait_slot);
+            }
+#endif
+#ifdef CB_USE_EVENTFD
+            cb_int_eventfd_signal(cb->evfd_readable);
+#endif
+        }
+    }
+#else
+    (void)cb;
+    (void)start_idx;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_ready_read(cb_t * const cb, const size_t start_idx)
+{
+#if defined(CB_USE_WAIT) || defined(CB_USE_EVENTFD)
+    // The circular buffer was full before the read if the producer did not write past the slot before it since.
+    if (CB_HAS_WAIT(cb) || CB_HAS_EVENTFD(cb))
+    {
+        CB_CRIT_FENCE();
+        if (CB_WRITE_RES_IDX_LOAD(cb) == ((start_idx == 0U) ? (cb->buffer_length - 1U) : (start_idx - 1U)))
+        {
+#ifdef CB_USE_WAIT
+            if (CB_HAS_WAIT(cb))
+            {
+                cb_wait_signal(cb->wait, cb->wait_slot);
+            }
+#endif
+#ifdef CB_USE_EVENTFD
+            cb_int_eventfd_signal(cb->evfd_writable);
+#endif
+        }
+    }
+#else
+    (void)cb;
+    (void)start_idx;
+#endif
+}
+
+#ifdef CB_USE_EVENTFD
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_eventfd_signal(const int fd)
+{
+    // The counter of an eventfd does not overflow in practice, and a pipe that is full is already readable.
+    const uint64_t one = 1U;
+    if (fd >= 0)
+    {
+        const ssize_t written = write(fd, &one, sizeof(one));
+        (void)written;
+    }
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_batch_wait(cb_t * const cb, const size_t readable, const size_t spins, const unsigned int seq)
+{
+    if (spins < CB_BATCH_SPINS)
+    {
+        CB_PAUSE();
+        (void)seq;
+        return;
+    }
+
+#ifdef CB_USE_WAIT
+    if ((readable == 0U) && CB_HAS_WAIT(cb))
+    {
+        (void)cb_wait_sleep(cb->wait, seq, CB_BATCH_SLEEP_MS);
+        return;
+    }
+#else
+    (void)seq;
+#endif
+#ifdef CB_USE_EVENTFD
+    if ((readable == 0U) && (cb->evfd_readable >= 0))
+    {
+        // The file descriptor is drained by its owner, while it is readable from a previous write poll returns at once.
+        struct pollfd pfd = {.fd = cb->evfd_readable, .events = POLLIN, .revents = 0};
+        if (poll(&pfd, 1U, CB_BATCH_SLEEP_MS) <= 0)
+        {
+            return;
+        }
+    }
+#endif
+    (void)cb;
+    (void)readable;
+    CB_YIELD();
+}
+
+#ifdef CB_USE_STATS
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_int_stats_clear(cb_t * const cb)
+{
+    cb_stats_ctrs_t * const ctrs[] = {&cb->stats_write, &cb->stats_read};
+
+    for (size_t i = 0U; i < (sizeof(ctrs) / sizeof(*ctrs)); i++)
+    {
+        CB_STATS_CLEAR(ctrs[i]->ops);
+        CB_STATS_CLEAR(ctrs[i]->elems);
+        CB_STATS_CLEAR(ctrs[i]->errors);
+        CB_STATS_CLEAR(ctrs[i]->wraps);
+        CB_STATS_CLEAR(ctrs[i]->peak);
+    }
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t cb_int_get_filled(const cb_t * const cb,
+                                const size_t read_idx,
+                                const size_t write_idx,
+                                size_t * const felems,
+                                size_t * const selems)
+{
+    // If empty, then nothing is filled.
+    if (write_idx == read_idx)
+    {
+        *felems = 0U;
+        *selems = 0U;
+    }
+    // If full, everything is filled.
+    else if (((write_idx == (cb->buffer_length - 1U)) ? (0U) : (write_idx + 1U)) == read_idx)
+    {
+        *felems = (read_idx < write_idx) ? ((write_idx) - (read_idx)) : ((cb->buffer_length) - (read_idx));
+        *selems = (read_idx > write_idx) ? (write_idx) : (0U);
+    }
+    // Check if the elements from read index to end index and start index to write index are filled.
+    else if (write_idx < read_idx)
+    {
+        *felems = cb->buffer_length - read_idx;
+        *selems = write_idx;
+    }
+    // Otherwise, the elements between read index and write index are filled.
+    else
+    {
+        *felems = write_idx - read_idx;
+        *selems = 0U;
+    }
+
+    return *felems + *selems;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t cb_int_get_unfilled(const cb_t * const cb,
+                                  const size_t read_idx,
+                                  const size_t write_idx,
+                                  size_t * const felems,
+                                  size_t * const selems)
+{
+    const size_t read_idx_lim = (read_idx == 0U) ? (cb->buffer_length - 1U) : (read_idx - 1U);
+
+    // If empty, then everything is unfilled.
+    if (write_idx == read_idx)
+    {
+        *felems = (read_idx_lim < write_idx) ? (cb->buffer_length - write_idx) : (read_idx_lim - write_idx);
+        *selems = (write_idx > read_idx_lim) ? (read_idx_lim) : (0U);
+    }
+    // If full, nothing is unfilled.
+    else if (write_idx == read_idx_lim)
+    {
+        *felems = 0U;
+        *selems = 0U;
+    }
+    // Check if the elements from write index to end index and start index to read limit index are filled.
+    else if (read_idx_lim < write_idx)
+    {
+        *felems = cb->buffer_length - write_idx;
+        *selems = read_idx_lim;
+    }
+    // Otherwise, the elements between read limit index and write index are filled.
+    else
+    {
+        *felems = read_idx_lim - write_idx;
+        *selems = 0U;
+    }
+
+    return *felems + *selems;
+}
+
+#ifdef CB_USE_PACKED
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_idx_store(cb_t * const cb, const bool read, const size_t value)
+{
+    const uint_least64_t mask = (read) ? ((uint_least64_t)UINT32_MAX) : ((uint_least64_t)UINT32_MAX << 32U);
+    const uint_least64_t shifted = (read) ? ((uint_least64_t)value << 32U) : ((uint_least64_t)value);
+#ifdef CB_USE_STDATOMIC
+    // The other side can store its index at the same time, thus the word is replaced only if it did not change since
+    // it was loaded. The release on success publishes the elements written or read before the index.
+    uint_least64_t idx = atomic_load_explicit(&cb->idx, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(
+        &cb->idx, &idx, (idx & mask) | shifted, memory_order_release, memory_order_relaxed))
+    {
+    }
+#else
+    cb->idx = (cb->idx & mask) | shifted;
+#endif
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void cb_int_snapshot(cb_t * const cb,
+                                   const bool filled,
+                                   const bool readable,
+                                   size_t * const read_idx,
+                                   size_t * const write_idx)
+{
+    // With stages, the read limit is the cursor of the last stage, loaded as the write index as it only advances too.
+    const bool limit = filled && readable && CB_HAS_STAGES(cb);
+#if defined(CB_USE_PACKED) && !defined(CB_USE_ASYNC)
+    // Both indexes are in the same word, thus a single load is a pair that existed at the same time.
+    if (!limit)
+    {
+        const uint_least64_t idx = CB_CRIT_VAR_LOAD(cb->idx);
+        *read_idx = (size_t)(idx >> 32U);
+        *write_idx = (size_t)(idx & UINT32_MAX);
+        return;
+    }
+#endif
+    // The write index is loaded before and after the read index, if it did not change then both existed at the time the
+    // read index was loaded. Otherwise retry, and after the retries use the last pair, its count is within capacity.
+    size_t write_prev =
+        (limit) ? (CB_READ_LIM_LOAD(cb)) : ((filled) ? (CB_WRITE_IDX_LOAD(cb)) : (CB_WRITE_RES_IDX_LOAD(cb)));
+    for (size_t retries = 0U;; retries++)
+    {
+        *read_idx = (filled) ? (CB_READ_RES_IDX_LOAD(cb)) : (CB_READ_IDX_LOAD(cb));
+        *write_idx =
+            (limit) ? (CB_READ_LIM_LOAD(cb)) : ((filled) ? (CB_WRITE_IDX_LOAD(cb)) : (CB_WRITE_RES_IDX_LOAD(cb)));
+        if ((*write_idx == write_prev) || (retries >= CB_SNAPSHOT_RETRIES))
+        {
+            break;
+        }
+        write_prev = *write_idx;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline cb_error_t cb_int_write_noevt(cb_t * const cb,
+                                            const void * const buffer,
+                                            const size_t requested,
+                                            size_t * const written)
+{
+    // Same as the write with events, without locking nor dispatching events, only the copies and index updates.
+    size_t fe = 0U;
+    size_t se = 0U;
+    const size_t start_idx = CB_WRITE_RES_IDX_LOAD(cb);
+    size_t write_idx = start_idx;
+    const size_t unfilled = cb_int_get_unfilled(cb, CB_READ_IDX_LOAD(cb), write_idx, &fe, &se);
+    const size_t count = ((written != NULL) && (requested > unfilled)) ? (unfilled) : (requested);
+    if ((count == 0U) || (count > unfilled))
+    {
+        CB_STATS_ADD(cb->stats_write.errors, 1U);
+        return cb_error_full;
+    }
+    size_t we = count;
+
+    // Calculate number of bytes of first and second writes, and write them.
+    fe = (we > fe) ? (fe) : (we);
+    we -= fe;
+    fe *= cb->elem_size;
+    se = we * cb->elem_size;
+    (void)memcpy(CB_CAST(cb->buffer) + (write_idx * cb->elem_size), buffer, fe);
+    if (se > 0U)
+    {
+        (void)memcpy(cb->buffer, CB_CONST_CAST(buffer) + fe, se);
+    }
+
+    // Update write index and buffer details.
+    write_idx += count;
+    write_idx = (write_idx >= cb->buffer_length) ? (write_idx - cb->buffer_length) : (write_idx);
+    cb_int_lat_write(cb, write_idx);
+#ifdef CB_USE_ASYNC
+    CB_CRIT_VAR_STORE(cb->write_res_idx, write_idx);
+#endif
+    CB_WRITE_IDX_STORE(cb, write_idx);
+    cb_int_ready_write(cb, start_idx);
+    cb_int_stats_write(cb, count, (se > 0U), cb->buffer_length - 1U - (unfilled - count));
+    if (written != NULL)
+    {
+        *written = count;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline cb_error_t
+    cb_int_read_noevt(cb_t * const cb, void * const buffer, const size_t requested, size_t * const read)
+{
+    // Same as the read with events, without locking nor dispatching events, only the copies and index updates.
+    size_t fe = 0U;
+    size_t se = 0U;
+    const size_t start_idx = CB_READ_RES_IDX_LOAD(cb);
+    size_t read_idx = start_idx;
+    const size_t filled = cb_int_get_filled(cb, read_idx, CB_READ_LIM_LOAD(cb), &fe, &se);
+    const size_t count = ((read != NULL) && (requested > filled)) ? (filled) : (requested);
+    if ((count == 0U) || (count > filled))
+    {
+        CB_STATS_ADD(cb->stats_read.errors, 1U);
+        return cb_error_empty;
+    }
+    size_t re = count;
+
+    // Calculate number of bytes of first and second reads, and read them.
+    fe = (re > fe) ? (fe) : (re);
+    re -= fe;
+    fe *= cb->elem_size;
+    se = re * cb->elem_size;
+    (void)memcpy(buffer, CB_CAST(cb->buffer) + (read_idx * cb->elem_size), fe);
+    if (se > 0U)
+    {
+        (void)memcpy(CB_CAST(buffer) + fe, cb->buffer, se);
+    }
+
+    // Update read index and buffer details.
+    read_idx += count;
+    read_idx = (read_idx >= cb->buffer_length) ? (read_idx - cb->buffer_length) : (read_idx);
+#ifdef CB_USE_ASYNC
+    CB_CRIT_VAR_STORE(cb->read_res_idx, read_idx);
+#endif
+    CB_READ_IDX_STORE(cb, read_idx);
+    cb_int_ready_read(cb, start_idx);
+    cb_int_lat_read(cb, read_idx, count);
+    cb_int_stats_read(cb, count, (se > 0U));
+    if (read != NULL)
+    {
+        *read = count;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline cb_error_t cb_int_write(cb_t * const cb,
+                                      const void * const buffer,
+                                      const size_t requested,
+                                      const bool check,
+                                      size_t * const written)
+{
+    // Sanity check for arguments, unless done by the caller.
+    if (check && ((cb == NULL) || (buffer == NULL) || (requested == 0U)))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Without events there is nothing to dispatch, take the specialized path.
+    if (CB_NO_EVT(cb))
+    {
+        return cb_int_write_noevt(cb, buffer, requested, written);
+    }
+
+    // Lock buffer for writing, in a single-producer single-consumer scenario nothing else can be writing by design
+    // thus a user provided lock is not necessary, in other scenarios, the user needs to provide a lock to guarantee
+    // that multiple threads are not writing at the same time. With this in consideration, we can guarantee that
+    // here onwards there will only be a single thread executing the write process.
+    cb_evt_lock(cb, cb_fn_id_write);
+
+    // Get number of unfilled slots and check if requested amount fits in the buffer, if a read is performed at the
+    // same time, this means that more space would become available but has no direct implication on the write as
+    // in any case case we are guaranteeing the amount of elements requested for write fit. Partial writes write as
+    // many as fit, and fail only if none does.
+    size_t fe = 0U;
+    size_t se = 0U;
+    const size_t start_idx = CB_WRITE_RES_IDX_LOAD(cb);
+    size_t write_idx = start_idx;
+    const size_t unfilled = cb_int_get_unfilled(cb, CB_READ_IDX_LOAD(cb), write_idx, &fe, &se);
+    const size_t count = ((written != NULL) && (requested > unfilled)) ? (unfilled) : (requested);
+    if ((count == 0U) || (count > unfilled))
+    {
+        CB_STATS_ADD(cb->stats_write.errors, 1U);
+        cb_evt_unlock(cb, cb_fn_id_write);
+        return cb_error_full;
+    }
+    size_t we = count;
+
+    // Calculate number of bytes of first and second writes, the second one only if the write wraps around.
+    fe = (we > fe) ? (fe) : (we);
+    we -= fe;
+    fe *= cb->elem_size;
+    se = we * cb->elem_size;
+
+#ifdef CB_USE_ASYNC
+    // If subscribed to asynchronous writes, start the write, the write index is published when it completes.
+    if (CB_IS_SUB(cb, cb_evt_id_write_async))
+    {
+        size_t end_idx = write_idx + count;
+        end_idx = (end_idx >= cb->buffer_length) ? (end_idx - cb->buffer_length) : (end_idx);
+        const cb_error_t error = cb_evt_write_async(cb, buffer, fe, se, write_idx, end_idx);
+        if (error == cb_error_ok)
+        {
+            cb_int_lat_write(cb, end_idx);
+            CB_CRIT_VAR_STORE(cb->write_res_idx, end_idx);
+            cb_int_stats_write(cb, count, (se > 0U), cb->buffer_length - 1U - (unfilled - count));
+            cb_evt_high_wm(cb, cb->buffer_length - 1U - (unfilled - count));
+            if (written != NULL)
+            {
+                *written = count;
+            }
+        }
+        cb_evt_unlock(cb, cb_fn_id_write);
+        return error;
+    }
+#endif
+
+    // Perform first write.
+    cb_error_t error = cb_evt_write(cb, buffer, fe, CB_CAST(cb->buffer) + (write_idx * cb->elem_size));
+    if (error != cb_error_ok)
+    {
+        cb_evt_unlock(cb, cb_fn_id_write);
+        return error;
+    }
+
+    // Perform second write if any, from the start index till the read index at most.
+    if (se > 0U)
+    {
+        error = cb_evt_write(cb, CB_CONST_CAST(buffer) + fe, se, cb->buffer);
+        if (error != cb_error_ok)
+        {
+            cb_evt_unlock(cb, cb_fn_id_write);
+            return error;
+        }
+    }
+
+    // Update write index.
+    write_idx += count;
+    write_idx = (write_idx >= cb->buffer_length) ? (write_idx - cb->buffer_length) : (write_idx);
+
+    // Sample the write for latency measurements and update buffer details.
+    cb_int_lat_write(cb, write_idx);
+#ifdef CB_USE_ASYNC
+    CB_CRIT_VAR_STORE(cb->write_res_idx, write_idx);
+#endif
+    CB_WRITE_IDX_STORE(cb, write_idx);
+    cb_int_ready_write(cb, start_idx);
+
+    // Account for the write and check the high watermark with the number of filled slots after it.
+    cb_int_stats_write(cb, count, (se > 0U), cb->buffer_length - 1U - (unfilled - count));
+    cb_evt_high_wm(cb, cb->buffer_length - 1U - (unfilled - count));
+
+    // Unlock buffer after writing and updating variables.
+    cb_evt_unlock(cb, cb_fn_id_write);
+    if (written != NULL)
+    {
+        *written = count;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline cb_error_t cb_int_read(cb_t * const cb,
+                                     void * const buffer,
+                                     const size_t requested,
+                                     const bool check,
+                                     size_t * const read)
+{
+    // Sanity check for arguments, unless done by the caller.
+    if (check && ((cb == NULL) || (buffer == NULL) || (requested == 0U)))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Without events there is nothing to dispatch, take the specialized path.
+    if (CB_NO_EVT(cb))
+    {
+        return cb_int_read_noevt(cb, buffer, requested, read);
+    }
+
+    // Lock buffer for reading, in a single-producer single-consumer scenario nothing else can be reading by design
+    // thus a user provided lock is not necessary, in other scenarios, the user needs to provide a lock to guarantee
+    // that multiple threads are not reading at the same time. With this in consideration, we can guarantee that
+    // here onwards there will only be a single thread executing the read process.
+    cb_evt_lock(cb, cb_fn_id_read);
+
+    // Get number of filled slots and check if requested amount fits in the buffer, if a write is performed at the
+    // same time, this means that more data would become available but has no direct implication on the read as
+    // in any case case we are guaranteeing the amount of elements requested for read exist. Partial reads read as
+    // many as exist, and fail only if none does.
+    size_t fe = 0U;
+    size_t se = 0U;
+    const size_t start_idx = CB_READ_RES_IDX_LOAD(cb);
+    size_t read_idx = start_idx;
+    const size_t filled = cb_int_get_filled(cb, read_idx, CB_READ_LIM_LOAD(cb), &fe, &se);
+    const size_t count = ((read != NULL) && (requested > filled)) ? (filled) : (requested);
+    if ((count == 0U) || (count > filled))
+    {
+        CB_STATS_ADD(cb->stats_read.errors, 1U);
+        cb_evt_unlock(cb, cb_fn_id_read);
+        return cb_error_empty;
+    }
+    size_t re = count;
+
+    // The watermarks count the elements not yet processed by the last stage too, up to the published write index as
+    // the writes do, whereas reads only obtain the elements up to the last stage.
+    size_t wm_filled = filled;
+    if (CB_HAS_STAGES(cb))
+    {
+        size_t wm_fe = 0U;
+        size_t wm_se = 0U;
+        wm_filled = cb_int_get_filled(cb, read_idx, CB_WRITE_IDX_LOAD(cb), &wm_fe, &wm_se);
+    }
+
+    // Calculate number of bytes of first and second reads, the second one only if the read wraps around.
+    fe = (re > fe) ? (fe) : (re);
+    re -= fe;
+    fe *= cb->elem_size;
+    se = re * cb->elem_size;
+
+#ifdef CB_USE_ASYNC
+    // If subscribed to asynchronous reads, start the read, the read index is published when it completes.
+    if (CB_IS_SUB(cb, cb_evt_id_read_async))
+    {
+        size_t end_idx = read_idx + count;
+        end_idx = (end_idx >= cb->buffer_length) ? (end_idx - cb->buffer_length) : (end_idx);
+        const cb_error_t error = cb_evt_read_async(cb, read_idx, fe, se, buffer, end_idx);
+        if (error == cb_error_ok)
+        {
+            CB_CRIT_VAR_STORE(cb->read_res_idx, end_idx);
+            cb_int_lat_read(cb, end_idx, count);
+            cb_int_stats_read(cb, count, (se > 0U));
+            cb_evt_low_wm(cb, wm_filled - count);
+            if (read != NULL)
+            {
+                *read = count;
+            }
+        }
+        cb_evt_unlock(cb, cb_fn_id_read);
+        return error;
+    }
+#endif
+
+    // Perform first read.
+    cb_error_t error = cb_evt_read(cb, CB_CAST(cb->buffer) + (read_idx * cb->elem_size), fe, buffer);
+    if (error != cb_error_ok)
+    {
+        cb_evt_unlock(cb, cb_fn_id_read);
+        return error;
+    }
+
+    // Perform second read if any.
+    if (se > 0U)
+    {
+        error = cb_evt_read(cb, cb->buffer, se, CB_CAST(buffer) + fe);
+        if (error != cb_error_ok)
+        {
+            cb_evt_unlock(cb, cb_fn_id_read);
+            return error;
+        }
+    }
+
+    // Update write index.
+    read_idx += count;
+    read_idx = (read_idx >= cb->buffer_length) ? (read_idx - cb->buffer_length) : (read_idx);
+
+    // Update buffer details.
+#ifdef CB_USE_ASYNC
+    CB_CRIT_VAR_STORE(cb->read_res_idx, read_idx);
+#endif
+    CB_READ_IDX_STORE(cb, read_idx);
+    cb_int_ready_read(cb, start_idx);
+
+    // Account for the read and check the low watermark with the number of filled slots after it.
+    cb_int_lat_read(cb, read_idx, count);
+    cb_int_stats_read(cb, count, (se > 0U));
+    cb_evt_low_wm(cb, wm_filled - count);
+
+    // Unlock buffer after writing and updating variables.
+    cb_evt_unlock(cb, cb_fn_id_read);
+    if (read != NULL)
+    {
+        *read = count;
+    }
+
+    return cb_error_ok;
+}
+
+#ifdef CB_USE_TRACE
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cb_int_trace(cb_t * const cb,
+                         const cb_fn_id_t fn,
+                         const size_t count,
+                         const uint64_t stamp,
+                         const cb_error_t result)
+{
+    if ((cb == NULL) || (cb->trace_sink == NULL))
+    {
+        return;
+    }
+
+    // The fill level is obtained without lock, it might be already outdated with multiple producers or consumers.
+    size_t fe = 0U;
+    size_t se = 0U;
+    size_t read_idx = 0U;
+    size_t write_idx = 0U;
+    cb_int_snapshot(cb, true, false, &read_idx, &write_idx);
+    const size_t filled = cb_int_get_filled(cb, read_idx, write_idx, &fe, &se);
+    const cb_trace_rec_t rec = {
+        .stamp = stamp,
+        .thread = (cb->trace_thread != NULL) ? (cb->trace_thread()) : (0U),
+        .count = (count > UINT32_MAX) ? (UINT32_MAX) : ((uint32_t)count),
+        .filled = (filled > UINT32_MAX) ? (UINT32_MAX) : ((uint32_t)filled),
+        .fn = (uint8_t)fn,
+        .result = (uint8_t)result,
+        .reserved = 0U,
+    };
+    cb->trace_sink(&rec, cb->trace_user_data);
+}
+#endif
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_init(cb_t * const cb,
+                          void * const buffer,
+                          const size_t buffer_length,
+                          const size_t elem_size,
+                          const cb_evt_handler_t evt_handler,
+                          const cb_evt_id_t evt_sub,
+                          void * const evt_user_data)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (buffer == NULL) || (buffer_length <= 1U) || (elem_size == 0U) ||
+#if defined(CB_USE_PACKED) && (SIZE_MAX > UINT32_MAX)
+        (buffer_length > UINT32_MAX) ||
+#endif
+        ((evt_sub == cb_evt_id_none) && (evt_handler != NULL)) ||
+        ((evt_sub != cb_evt_id_none) && (evt_handler == NULL))
+#ifdef CB_USE_ASYNC
+        || ((evt_sub & (cb_evt_id_read | cb_evt_id_read_async)) == (cb_evt_id_read | cb_evt_id_read_async)) ||
+        ((evt_sub & (cb_evt_id_write | cb_evt_id_write_async)) == (cb_evt_id_write | cb_evt_id_write_async))
+#endif
+    )
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize.
+    cb->buffer = buffer;
+    cb->buffer_length = buffer_length;
+    cb->elem_size = elem_size;
+#ifdef CB_USE_PACKED
+    CB_CRIT_VAR_INIT(cb->idx, 0U);
+#else
+    CB_CRIT_VAR_INIT(cb->read_idx, 0U);
+    CB_CRIT_VAR_INIT(cb->write_idx, 0U);
+#endif
+#ifdef CB_USE_ASYNC
+    CB_CRIT_VAR_INIT(cb->read_res_idx, 0U);
+    CB_CRIT_VAR_INIT(cb->write_res_idx, 0U);
+    (void)memset(cb->read_async.ops, 0, sizeof(cb->read_async.ops));
+    (void)memset(cb->write_async.ops, 0, sizeof(cb->write_async.ops));
+    CB_CRIT_VAR_INIT(cb->read_async.head, 0U);
+    CB_CRIT_VAR_INIT(cb->read_async.tail, 0U);
+    CB_CRIT_VAR_INIT(cb->write_async.head, 0U);
+    CB_CRIT_VAR_INIT(cb->write_async.tail, 0U);
+#endif
+    cb->wm_low = 0U;
+    cb->wm_high = 0U;
+    CB_CRIT_VAR_INIT(cb->wm_above, false);
+#ifdef CB_USE_STATS
+    cb_int_stats_clear(cb);
+#endif
+#ifdef CB_USE_LATENCY
+    cb->lat_clock = NULL;
+    cb->lat_hist = NULL;
+    cb->lat_period = 0U;
+    cb->lat_count = 0U;
+    CB_CRIT_VAR_INIT(cb->lat_head, 0U);
+    CB_CRIT_VAR_INIT(cb->lat_tail, 0U);
+#endif
+#ifdef CB_USE_LOCK_PROF
+    cb->prof_clock = NULL;
+    cb->prof = NULL;
+#endif
+#ifdef CB_USE_TRACE
+    cb->trace_clock = NULL;
+    cb->trace_thread = NULL;
+    cb->trace_sink = NULL;
+    cb->trace_user_data = NULL;
+#endif
+#ifdef CB_USE_LOCKS
+    cb->lock_id = cb_lock_id_evt;
+    cb_lock_t * const locks[] = {&cb->lock_write, &cb->lock_read};
+    for (size_t i = 0U; i < (sizeof(locks) / sizeof(*locks)); i++)
+    {
+        CB_CRIT_VAR_INIT(locks[i]->ticket, 0U);
+        CB_CRIT_VAR_INIT(locks[i]->owner, 0U);
+        CB_CRIT_VAR_INIT(locks[i]->state, 0U);
+    }
+#endif
+#ifdef CB_USE_PIPELINE
+    cb->stage_count = 0U;
+    for (size_t i = 0U; i < CB_MAX_STAGES; i++)
+    {
+        CB_CRIT_VAR_INIT(cb->stages[i].idx, 0U);
+    }
+#endif
+#ifdef CB_USE_WAIT
+    cb->wait = NULL;
+    cb->wait_slot = 0U;
+#endif
+#ifdef CB_USE_EVENTFD
+    cb->evfd_readable = -1;
+    cb->evfd_writable = -1;
+#endif
+    cb->lock_split = false;
+    cb->evt_handler = evt_handler;
+    cb->evt_sub = evt_sub;
+    cb->evt_user_data = evt_user_data;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_write(cb_t * const cb, const void * const buffer, const size_t count)
+{
+#ifdef CB_USE_TRACE
+    // Stamp the write when called, so it can be replayed with the same timing.
+    const uint64_t stamp = ((cb != NULL) && (cb->trace_clock != NULL)) ? (cb->trace_clock()) : (0U);
+    const cb_error_t error = cb_int_write(cb, buffer, count, true, NULL);
+    cb_int_trace(cb, cb_fn_id_write, count, stamp, error);
+    return error;
+#else
+    return cb_int_write(cb, buffer, count, true, NULL);
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_read(cb_t * const cb, void * const buffer, const size_t count)
+{
+#ifdef CB_USE_TRACE
+    // Stamp the read when called, so it can be replayed with the same timing.
+    const uint64_t stamp = ((cb != NULL) && (cb->trace_clock != NULL)) ? (cb->trace_clock()) : (0U);
+    const cb_error_t error = cb_int_read(cb, buffer, count, true, NULL);
+    cb_int_trace(cb, cb_fn_id_read, count, stamp, error);
+    return error;
+#else
+    return cb_int_read(cb, buffer, count, true, NULL);
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_read_batch(cb_t * const cb,
+                                void * const buffer,
+                                const size_t min,
+                                const size_t max,
+                                size_t * const read,
+                                const cb_clock_t clock,
+                                const uint64_t linger)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (buffer == NULL) || (read == NULL) || (min == 0U) || (min > max))
+    {
+        return cb_error_invalid_args;
+    }
+    *read = 0U;
+
+    const uint64_t start = (clock != NULL) ? (clock()) : (0U);
+    for (size_t spins = 0U;; spins++)
+    {
+        // Once the linger time expired, read what exists up to the maximum in a single transfer.
+        if ((clock == NULL) || ((clock() - start) >= linger))
+        {
+            return cb_read_partial(cb, buffer, max, read);
+        }
+
+        // The signals are counted before polling, so a write to the empty circular buffer after it does not sleep.
+#ifdef CB_USE_WAIT
+        const unsigned int seq = CB_HAS_WAIT(cb) ? (cb_wait_signals(cb->wait)) : (0U);
+#else
+        const unsigned int seq = 0U;
+#endif
+        size_t readable = 0U;
+        (void)cb_get_readable_lockfree(cb, &readable);
+
+        // Linger until the minimum exists, if other consumers read them meanwhile observe the elements again.
+        if (readable >= min)
+        {
+            readable = (readable > max) ? (max) : (readable);
+            const cb_error_t error = cb_read(cb, buffer, readable);
+            if (error != cb_error_empty)
+            {
+                *read = (error == cb_error_ok) ? (readable) : (0U);
+                return error;
+            }
+        }
+        cb_int_batch_wait(cb, readable, spins, seq);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t
+    cb_write_partial(cb_t * const cb, const void * const buffer, const size_t count, size_t * const written)
+{
+    // Sanity check on arguments, the rest are checked when writing.
+    if (written == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+    *written = 0U;
+
+#ifdef CB_USE_TRACE
+    // Traced with the number of elements written, so it can be replayed with ::cb_write.
+    const uint64_t stamp = ((cb != NULL) && (cb->trace_clock != NULL)) ? (cb->trace_clock()) : (0U);
+    const cb_error_t error = cb_int_write(cb, buffer, count, true, written);
+    cb_int_trace(cb, cb_fn_id_write, (error == cb_error_ok) ? (*written) : (count), stamp, error);
+    return error;
+#else
+    return cb_int_write(cb, buffer, count, true, written);
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_read_partial(cb_t * const cb, void * const buffer, const size_t count, size_t * const read)
+{
+    // Sanity check on arguments, the rest are checked when reading.
+    if (read == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+    *read = 0U;
+
+#ifdef CB_USE_TRACE
+    // Traced with the number of elements read, so it can be replayed with ::cb_read.
+    const uint64_t stamp = ((cb != NULL) && (cb->trace_clock != NULL)) ? (cb->trace_clock()) : (0U);
+    const cb_error_t error = cb_int_read(cb, buffer, count, true, read);
+    cb_int_trace(cb, cb_fn_id_read, (error == cb_error_ok) ? (*read) : (count), stamp, error);
+    return error;
+#else
+    return cb_int_read(cb, buffer, count, true, read);
+#endif
+}
+
+#ifdef CB_USE_UNCHECKED
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_write_unchecked(cb_t * const cb, const void * const buffer, const size_t count)
+{
+#ifdef CB_USE_TRACE
+    const uint64_t stamp = (cb->trace_clock != NULL) ? (cb->trace_clock()) : (0U);
+    const cb_error_t error = cb_int_write(cb, buffer, count, false, NULL);
+    cb_int_trace(cb, cb_fn_id_write, count, stamp, error);
+    return error;
+#else
+    return cb_int_write(cb, buffer, count, false, NULL);
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_read_unchecked(cb_t * const cb, void * const buffer, const size_t count)
+{
+#ifdef CB_USE_TRACE
+    const uint64_t stamp = (cb->trace_clock != NULL) ? (cb->trace_clock()) : (0U);
+    const cb_error_t error = cb_int_read(cb, buffer, count, false, NULL);
+    cb_int_trace(cb, cb_fn_id_read, count, stamp, error);
+    return error;
+#else
+    return cb_int_read(cb, buffer, count, false, NULL);
+#endif
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_watermarks(cb_t * const cb, const size_t low, const size_t high)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (low >= high) || (high > (cb->buffer_length - 1U)))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_set_watermarks);
+    // Set watermarks, with the state for the events computed from the current number of filled slots.
+    size_t felems = 0U;
+    size_t selems = 0U;
+    const size_t filled = cb_int_get_filled(
+        cb, CB_READ_RES_IDX_LOAD(cb), CB_WRITE_IDX_LOAD(cb), &felems, &selems);
+    cb->wm_low = low;
+    cb->wm_high = high;
+    CB_CRIT_VAR_STORE(cb->wm_above, (filled >= high));
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_set_watermarks);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_get_unfilled(cb_t * const cb, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_get_unfilled);
+    // Get number of unfilled slots.
+    size_t felems = 0U;
+    size_t selems = 0U;
+    *count = cb_int_get_unfilled(
+        cb, CB_READ_IDX_LOAD(cb), CB_WRITE_RES_IDX_LOAD(cb), &felems, &selems);
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_get_unfilled);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_get_filled(cb_t * const cb, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_get_filled);
+    // Get number of filled slots.
+    size_t felems = 0U;
+    size_t selems = 0U;
+    *count = cb_int_get_filled(
+        cb, CB_READ_RES_IDX_LOAD(cb), CB_WRITE_IDX_LOAD(cb), &felems, &selems);
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_get_filled);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_is_empty(cb_t * const cb, bool * const is_empty)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (is_empty == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_is_empty);
+    // Check if number of filled slots is zero to determine empty.
+    size_t felems = 0U;
+    size_t selems = 0U;
+    *is_empty = (cb_int_get_filled(cb,
+                                   CB_READ_RES_IDX_LOAD(cb),
+                                   CB_WRITE_IDX_LOAD(cb),
+                                   &felems,
+                                   &selems) == 0U);
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_is_empty);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_is_full(cb_t * const cb, bool * const is_full)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (is_full == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_is_full);
+    // Check if number of unfilled slots is zero to determine full.
+    size_t felems = 0U;
+    size_t selems = 0U;
+    *is_full = (cb_int_get_unfilled(cb,
+                                    CB_READ_IDX_LOAD(cb),
+                                    CB_WRITE_RES_IDX_LOAD(cb),
+                                    &felems,
+                                    &selems) == 0U);
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_is_full);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_get_unfilled_lockfree(cb_t * const cb, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Load the indexes without lock, and get number of unfilled slots.
+    size_t read_idx = 0U;
+    size_t write_idx = 0U;
+    size_t felems = 0U;
+    size_t selems = 0U;
+    cb_int_snapshot(cb, false, false, &read_idx, &write_idx);
+    *count = cb_int_get_unfilled(cb, read_idx, write_idx, &felems, &selems);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_get_filled_lockfree(cb_t * const cb, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Load the indexes without lock, and get number of filled slots.
+    size_t read_idx = 0U;
+    size_t write_idx = 0U;
+    size_t felems = 0U;
+    size_t selems = 0U;
+    cb_int_snapshot(cb, true, false, &read_idx, &write_idx);
+    *count = cb_int_get_filled(cb, read_idx, write_idx, &felems, &selems);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_is_empty_lockfree(cb_t * const cb, bool * const is_empty)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (is_empty == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Load the indexes without lock, and check if number of filled slots is zero to determine empty.
+    size_t read_idx = 0U;
+    size_t write_idx = 0U;
+    size_t felems = 0U;
+    size_t selems = 0U;
+    cb_int_snapshot(cb, true, false, &read_idx, &write_idx);
+    *is_empty = (cb_int_get_filled(cb, read_idx, write_idx, &felems, &selems) == 0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_is_full_lockfree(cb_t * const cb, bool * const is_full)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (is_full == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Load the indexes without lock, and check if number of unfilled slots is zero to determine full.
+    size_t read_idx = 0U;
+    size_t write_idx = 0U;
+    size_t felems = 0U;
+    size_t selems = 0U;
+    cb_int_snapshot(cb, false, false, &read_idx, &write_idx);
+    *is_full = (cb_int_get_unfilled(cb, read_idx, write_idx, &felems, &selems) == 0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_get_readable_lockfree(cb_t * const cb, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Load the indexes without lock, and get number of filled slots up to the read limit.
+    size_t read_idx = 0U;
+    size_t limit_idx = 0U;
+    size_t felems = 0U;
+    size_t selems = 0U;
+    cb_int_snapshot(cb, true, true, &read_idx, &limit_idx);
+    *count = cb_int_get_filled(cb, read_idx, limit_idx, &felems, &selems);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_lock_split(cb_t * const cb, const bool split)
+{
+    // Sanity check on arguments.
+    if (cb == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Set whether each side is locked separately.
+    cb->lock_split = split;
+
+    return cb_error_ok;
+}
+
+#ifdef CB_USE_PIPELINE
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_stages(cb_t * const cb, const size_t count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (count > CB_MAX_STAGES))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Start all the stages from the read index, so that the elements in the circular buffer go through all of them.
+    const size_t read_idx = CB_READ_RES_IDX_LOAD(cb);
+    for (size_t i = 0U; i < count; i++)
+    {
+        CB_CRIT_VAR_STORE(cb->stages[i].idx, read_idx);
+    }
+    cb->stage_count = count;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_stage_claim(cb_t * const cb, const size_t stage, void ** const elems, size_t * const count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (stage >= cb->stage_count) || (elems == NULL) || (count == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // The first stage is gated by the writes, the rest by the previous stage, only the contiguous elements are claimed.
+    size_t fe = 0U;
+    size_t se = 0U;
+    const size_t stage_idx = CB_CRIT_VAR_LOAD(cb->stages[stage].idx);
+    const size_t limit_idx = (stage == 0U) ? (CB_WRITE_IDX_LOAD(cb)) : (CB_CRIT_VAR_LOAD(cb->stages[stage - 1U].idx));
+    (void)cb_int_get_filled(cb, stage_idx, limit_idx, &fe, &se);
+    *elems = CB_CAST(cb->buffer) + (stage_idx * cb->elem_size);
+    *count = fe;
+
+    return (fe == 0U) ? (cb_error_empty) : (cb_error_ok);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_stage_release(cb_t * const cb, const size_t stage, const size_t count)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (stage >= cb->stage_count))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Check the elements are available for the stage, they can wrap around if claimed in several times.
+    size_t fe = 0U;
+    size_t se = 0U;
+    const size_t stage_idx = CB_CRIT_VAR_LOAD(cb->stages[stage].idx);
+    const size_t limit_idx = (stage == 0U) ? (CB_WRITE_IDX_LOAD(cb)) : (CB_CRIT_VAR_LOAD(cb->stages[stage - 1U].idx));
+    if (count > cb_int_get_filled(cb, stage_idx, limit_idx, &fe, &se))
+    {
+        return cb_error_invalid_args;
+    }
+    // Publish the elements to the next stage, or to the reads.
+    size_t next_idx = stage_idx + count;
+    next_idx = (next_idx >= cb->buffer_length) ? (next_idx - cb->buffer_length) : (next_idx);
+    CB_CRIT_VAR_STORE(cb->stages[stage].idx, next_idx);
+    // The last stage advances the read limit instead of the writes, thus it signals the readable edge.
+    if (stage == (cb->stage_count - 1U))
+    {
+        cb_int_ready_limit(cb, stage_idx);
+    }
+
+    return cb_error_ok;
+}
+#endif
+
+#ifdef CB_USE_ASYNC
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_write_done(cb_t * const cb, const size_t seq)
+{
+    // Sanity check on arguments.
+    if (cb == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_write_done);
+    // Check the sequence number belongs to a write pending completion.
+    const size_t tail = CB_CRIT_VAR_LOAD(cb->write_async.tail);
+    if ((seq - tail) >= (CB_CRIT_VAR_LOAD(cb->write_async.head) - tail))
+    {
+        cb_evt_unlock(cb, cb_fn_id_write_done);
+        return cb_error_invalid_args;
+    }
+    // Complete write and publish the write index if all the previous writes have completed too.
+    size_t write_idx = 0U;
+    if (cb_int_async_done(&cb->write_async, seq, &write_idx))
+    {
+        const size_t start_idx = CB_WRITE_IDX_LOAD(cb);
+        CB_WRITE_IDX_STORE(cb, write_idx);
+        cb_int_ready_write(cb, start_idx);
+    }
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_write_done);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_read_done(cb_t * const cb, const size_t seq)
+{
+    // Sanity check on arguments.
+    if (cb == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_read_done);
+    // Check the sequence number belongs to a read pending completion.
+    const size_t tail = CB_CRIT_VAR_LOAD(cb->read_async.tail);
+    if ((seq - tail) >= (CB_CRIT_VAR_LOAD(cb->read_async.head) - tail))
+    {
+        cb_evt_unlock(cb, cb_fn_id_read_done);
+        return cb_error_invalid_args;
+    }
+    // Complete read and publish the read index if all the previous reads have completed too.
+    size_t read_idx = 0U;
+    if (cb_int_async_done(&cb->read_async, seq, &read_idx))
+    {
+        const size_t start_idx = CB_READ_IDX_LOAD(cb);
+        CB_READ_IDX_STORE(cb, read_idx);
+        cb_int_ready_read(cb, start_idx);
+    }
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_read_done);
+
+    return cb_error_ok;
+}
+#endif
+
+#ifdef CB_USE_STATS
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_get_stats(cb_t * const cb, cb_stats_t * const stats)
+{
+    // Sanity check on arguments.
+    if ((cb == NULL) || (stats == NULL))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_get_stats);
+    // Take snapshot of the counters.
+    stats->writes = CB_STATS_GET(cb->stats_write.ops);
+    stats->reads = CB_STATS_GET(cb->stats_read.ops);
+    stats->elems_written = CB_STATS_GET(cb->stats_write.elems);
+    stats->elems_read = CB_STATS_GET(cb->stats_read.elems);
+    stats->bytes_written = stats->elems_written * cb->elem_size;
+    stats->bytes_read = stats->elems_read * cb->elem_size;
+    stats->full_errors = CB_STATS_GET(cb->stats_write.errors);
+    stats->empty_errors = CB_STATS_GET(cb->stats_read.errors);
+    stats->wrapped_writes = CB_STATS_GET(cb->stats_write.wraps);
+    stats->wrapped_reads = CB_STATS_GET(cb->stats_read.wraps);
+    stats->peak_filled = CB_STATS_GET(cb->stats_write.peak);
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_get_stats);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_reset_stats(cb_t * const cb)
+{
+    // Sanity check on arguments.
+    if (cb == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Lock.
+    cb_evt_lock(cb, cb_fn_id_reset_stats);
+    // Clear the counters.
+    cb_int_stats_clear(cb);
+    // Unlock.
+    cb_evt_unlock(cb, cb_fn_id_reset_stats);
+
+    return cb_error_ok;
+}
+#endif
+
+#ifdef CB_USE_LATENCY
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_latency(cb_t * const cb,
+                                 const cb_clock_t clock,
+                                 struct cb_hist_s * const hist,
+                                 const size_t period)
+{
+    // Sanity check on arguments, the clock and the histogram are either both provided or both not provided.
+    if ((cb == NULL) || ((clock == NULL) != (hist == NULL)) || ((clock != NULL) && (period == 0U)))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Set latency measurements, discarding any sampled writes pending.
+    cb->lat_clock = clock;
+    cb->lat_hist = hist;
+    cb->lat_period = period;
+    cb->lat_count = 0U;
+    CB_CRIT_VAR_STORE(cb->lat_head, 0U);
+    CB_CRIT_VAR_STORE(cb->lat_tail, 0U);
+
+    return cb_error_ok;
+}
+#endif
+
+#ifdef CB_USE_LOCK_PROF
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_lock_prof(cb_t * const cb, const cb_clock_t clock, struct cb_lock_prof_s * const prof)
+{
+    // Sanity check on arguments, the clock and the histograms are either both provided or both not provided.
+    if ((cb == NULL) || ((clock == NULL) != (prof == NULL)))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Set lock profiling.
+    cb->prof_clock = clock;
+    cb->prof = prof;
+
+    return cb_error_ok;
+}
+#endif
+
+#ifdef CB_USE_TRACE
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_trace(cb_t * const cb,
+                               const cb_clock_t clock,
+                               const cb_trace_thread_t thread,
+                               const cb_trace_sink_t sink,
+                               void * const user_data)
+{
+    // Sanity check on arguments, the clock and the sink are either both provided or both not provided.
+    if ((cb == NULL) || ((clock == NULL) != (sink == NULL)))
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Set tracing.
+    cb->trace_clock = clock;
+    cb->trace_thread = thread;
+    cb->trace_sink = sink;
+    cb->trace_user_data = user_data;
+
+    return cb_error_ok;
+}
+#endif
+
+#ifdef CB_USE_EVENTFD
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_eventfd(cb_t * const cb, const int readable_fd, const int writable_fd)
+{
+    // Sanity check on arguments.
+    if (cb == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Set the readiness file descriptors, negative ones are not signaled.
+    cb->evfd_readable = (readable_fd >= 0) ? (readable_fd) : (-1);
+    cb->evfd_writable = (writable_fd >= 0) ? (writable_fd) : (-1);
+
+    return cb_error_ok;
+}
+#endif
+
+#ifdef CB_USE_LOCKS
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_set_lock(cb_t * const cb, const cb_lock_id_t lock_id)
+{
+    // Sanity check on arguments, the spinning locks require atomics.
+    if ((cb == NULL) || ((size_t)lock_id >= (size_t)cb_lock_id_count)
+#ifndef CB_USE_STDATOMIC
+        || (lock_id == cb_lock_id_ticket) || (lock_id == cb_lock_id_adaptive)
+#endif
+    )
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Initialize the mutexes of both sides before using them, and destroy them when not used anymore.
+    if ((lock_id == cb_lock_id_pthread) && (cb->lock_id != cb_lock_id_pthread))
+    {
+        if (pthread_mutex_init(&cb->lock_write.mutex, NULL) != 0)
+        {
+            return cb_error_invalid_args;
+        }
+        if (pthread_mutex_init(&cb->lock_read.mutex, NULL) != 0)
+        {
+            (void)pthread_mutex_destroy(&cb->lock_write.mutex);
+            return cb_error_invalid_args;
+        }
+    }
+    else if ((lock_id != cb_lock_id_pthread) && (cb->lock_id == cb_lock_id_pthread))
+    {
+        (void)pthread_mutex_destroy(&cb->lock_write.mutex);
+        (void)pthread_mutex_destroy(&cb->lock_read.mutex);
+    }
+    else
+    {
+        // Nothing to initialize nor destroy.
+    }
+
+    // Set lock, unlocked.
+    cb->lock_id = lock_id;
+    cb_lock_t * const locks[] = {&cb->lock_write, &cb->lock_read};
+    for (size_t i = 0U; i < (sizeof(locks) / sizeof(*locks)); i++)
+    {
+        CB_CRIT_VAR_STORE(locks[i]->ticket, 0U);
+        CB_CRIT_VAR_STORE(locks[i]->owner, 0U);
+        CB_CRIT_VAR_STORE(locks[i]->state, 0U);
+    }
+
+    return cb_error_ok;
+}
+#endif
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+CB_API cb_error_t cb_deinit(cb_t * const cb)
+{
+    // Sanity check for arguments.
+    if (cb == NULL)
+    {
+        return cb_error_invalid_args;
+    }
+
+    // Deinitialize.
+    cb->buffer = NULL;
+    cb->buffer_length = 0U;
+    cb->elem_size = 0U;
+    CB_READ_IDX_STORE(cb, 0U);
+    CB_WRITE_IDX_STORE(cb, 0U);
+#ifdef CB_USE_ASYNC
+    CB_CRIT_VAR_STORE(cb->read_res_idx, 0U);
+    CB_CRIT_VAR_STORE(cb->write_res_idx, 0U);
+    (void)memset(cb->read_async.ops, 0, sizeof(cb->read_async.ops));
+    (void)memset(cb->write_async.ops, 0, sizeof(cb->write_async.ops));
+    CB_CRIT_VAR_STORE(cb->read_async.head, 0U);
+    CB_CRIT_VAR_STORE(cb->read_async.tail, 0U);
+    CB_CRIT_VAR_STORE(cb->write_async.head, 0U);
+    CB_CRIT_VAR_STORE(cb->write_async.tail, 0U);
+#endif
+    cb->wm_low = 0U;
+    cb->wm_high = 0U;
+    CB_CRIT_VAR_STORE(cb->wm_above, false);
+#ifdef CB_USE_STATS
+    cb_int_stats_clear(cb);
+#endif
+#ifdef CB_USE_LATENCY
+    cb->lat_clock = NULL;
+    cb->lat_hist = NULL;
+    cb->lat_period = 0U;
+    cb->lat_count = 0U;
+    CB_CRIT_VAR_STORE(cb->lat_head, 0U);
+    CB_CRIT_VAR_STORE(cb->lat_tail, 0U);
+#endif
+#ifdef CB_USE_LOCK_PROF
+    cb->prof_clock = NULL;
+    cb->prof = NULL;
+#endif
+#ifdef CB_USE_TRACE
+    cb->trace_clock = NULL;
+    cb->trace_thread = NULL;
+    cb->trace_sink = NULL;
+    cb->trace_user_data = NULL;
+#endif
+#ifdef CB_USE_LOCKS
+    (void)cb_set_lock(cb, cb_lock_id_evt);
+#endif
+#ifdef CB_USE_PIPELINE
+    cb->stage_count = 0U;
+#endif
+#ifdef CB_USE_WAIT
+    if (cb->wait != NULL)
+    {
+        (void)cb_wait_remove(cb->wait, cb);
+    }
+#endif
+#ifdef CB_USE_EVENTFD
+    cb->evfd_readable = -1;
+    cb->evfd_writable = -1;
+#endif
+    cb->lock_split = false;
+    cb->evt_handler = NULL;
+    cb->evt_sub = cb_evt_id_none;
+    cb->evt_user_data = NULL;
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+#endif /* CB_IMPL_H */
+
+/******************************************************************************************************END OF FILE*****/
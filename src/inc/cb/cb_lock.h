@@ -0,0 +1,96 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_lock.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+// Outside of the guard, with CB_HEADER_ONLY it includes this header in turn, which must be complete by then.
+#include "cb/cb.h"
+#ifndef CB_LOCK_H
+#define CB_LOCK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_lock Lock strategies
+ *
+ * Provides the contended paths of the built-in locks of a circular buffer, the uncontended paths are inlined in the
+ * functions of the circular buffer, requires @c CB_USE_LOCKS to be defined, see ::cb_set_lock.
+ *
+ * @{
+ */
+
+/** @defgroup cb_lock_defs Definitions */
+/** @defgroup cb_lock_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+/* Exported constants ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_defs
+ * @{
+ */
+
+#ifndef CB_LOCK_SPINS
+/** Number of times a contended lock is polled before yielding the processor or sleeping until released. */
+#define CB_LOCK_SPINS (100U)
+#endif
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_papi
+ * @{
+ */
+
+#ifdef CB_USE_STDATOMIC
+/**
+ * @brief Waits for a ticket of a ::cb_lock_id_t ticket lock to be served, spinning and then yielding the processor.
+ * @param[in] owner The ticket being served.
+ * @param[in] ticket The ticket taken.
+ */
+void cb_lock_ticket_wait(cb_atomic_uint * const owner, const unsigned int ticket);
+
+/**
+ * @brief Takes a contended ::cb_lock_id_adaptive lock, spinning and then sleeping until it is released.
+ * @param[in] state The state of the lock, 0 unlocked, 1 locked and 2 contended.
+ */
+void cb_lock_adaptive_wait(cb_atomic_uint * const state);
+
+/**
+ * @brief Wakes a thread sleeping on a contended ::cb_lock_id_adaptive lock, after it was released.
+ * @param[in] state The state of the lock.
+ */
+void cb_lock_adaptive_wake(cb_atomic_uint * const state);
+#endif
+
+/**
+ * @brief Obtains the name of a lock strategy, for reporting purposes.
+ * @param[in] lock_id The lock strategy.
+ * @return The name of the lock strategy, or @c NULL if @c lock_id is not valid.
+ */
+const char * cb_lock_name(const cb_lock_id_t lock_id);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_LOCK_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,88 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_lock_prof.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+// Outside of the guard, with CB_HEADER_ONLY it includes this header in turn, which must be complete by then.
+#include "cb/cb.h"
+#ifndef CB_LOCK_PROF_H
+#define CB_LOCK_PROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_lock_prof Lock profiling
+ *
+ * Provides histograms of the time spent waiting for the lock of a circular buffer and holding it, for each of the
+ * functions that lock it, requires @c CB_USE_LOCK_PROF to be defined, see ::cb_set_lock_prof.
+ *
+ * @{
+ */
+
+/** @defgroup cb_lock_prof_defs Definitions */
+/** @defgroup cb_lock_prof_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb_hist.h"
+
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_prof_defs
+ * @{
+ */
+
+/** Lock profiling histograms, the user should only access @c wait and @c hold, and only while locked. */
+typedef struct cb_lock_prof_s
+{
+    cb_hist_t wait[cb_fn_id_count]; /**< Histograms of the time waiting for the lock, for each ::cb_fn_id_t. */
+    cb_hist_t hold[cb_fn_id_count]; /**< Histograms of the time holding the lock, for each ::cb_fn_id_t. */
+    uint64_t acquired[cb_fn_id_count]; /**< Time at which the lock was last acquired, for each ::cb_fn_id_t. */
+} cb_lock_prof_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_lock_prof_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes the lock profiling histograms, can also be used to clear all the times recorded.
+ * @param[in] prof The lock profiling histograms to initialize.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_lock_prof_init(cb_lock_prof_t * const prof);
+
+/**
+ * @brief Obtains the name of a function, for reporting purposes.
+ * @param[in] fn The function.
+ * @return The name of the function, or @c NULL if @c fn is not valid.
+ */
+const char * cb_lock_prof_fn_name(const cb_fn_id_t fn);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_LOCK_PROF_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,171 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_prio.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef CB_PRIO_H
+#define CB_PRIO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_prio Priority rings
+ *
+ * Provides priority queues made of a circular buffer for each priority level, written with a priority and read by a
+ * single consumer from the highest priority level with elements, strictly or weighted so that lower priority levels
+ * are not starved. An occupancy bitmap with a bit for each level finds the next level with elements in a single
+ * operation, instead of querying each of the levels.
+ *
+ * @{
+ */
+
+/** @defgroup cb_prio_defs Definitions */
+/** @defgroup cb_prio_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb.h"
+#include <stdint.h>
+
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_prio_defs
+ * @{
+ */
+
+#ifndef CB_PRIO_MAX_LEVELS
+/** Maximum number of priority levels, at most the number of bits of the occupancy bitmap. */
+#define CB_PRIO_MAX_LEVELS (32U)
+#endif
+#if CB_PRIO_MAX_LEVELS > 32U
+#error "CB_PRIO_MAX_LEVELS can't be larger than the number of bits of the occupancy bitmap."
+#endif
+
+/**
+ * @brief Priority rings context.
+ *
+ * The levels are circular buffers initialized by the user, with elements of the same size, level zero being the
+ * highest priority. The user should not access its members directly.
+ */
+typedef struct
+{
+    cb_t * levels; /**< The levels, from the highest priority to the lowest. */
+    size_t count; /**< The number of levels in @c levels. */
+    size_t weights[CB_PRIO_MAX_LEVELS]; /**< The weight of each level, all zero to read strictly by priority. */
+    size_t credits[CB_PRIO_MAX_LEVELS]; /**< The elements left to read from each level in the current round. */
+    uint_least32_t credited; /**< Bitmap of the levels with credits left in the current round. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_uint_least32_t occupied; /**< The atomic bitmap of the levels that might have elements. */
+#else
+    uint_least32_t occupied; /**< The bitmap of the levels that might have elements. */
+#endif
+} cb_prio_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_prio_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes priority rings over an array of initialized circular buffers, read strictly by priority.
+ * @param[in] prio The priority rings context to initialize.
+ * @param[in] levels The levels, initialized circular buffers with elements of the same size, owned by the user.
+ * @param[in] count The number of levels in @p levels, at most ::CB_PRIO_MAX_LEVELS.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_prio_init(cb_prio_t * const prio, cb_t * const levels, const size_t count);
+
+/**
+ * @brief Deinitializes priority rings, the levels are not deinitialized.
+ * @param[in] prio The initialized priority rings context.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_prio_deinit(cb_prio_t * const prio);
+
+/**
+ * @brief Sets the weights of the levels for weighted fair reads, or reads strictly by priority.
+ *
+ * With weights, the levels are read in rounds, in each round a level with elements is read before the levels of lower
+ * priority only until as many elements as its weight have been read from it, and a new round starts once the levels
+ * with elements have read all their weight. Thus each level obtains a share of the reads proportional to its weight,
+ * and lower priority levels are not starved. It must be called from the consumer.
+ * @param[in] prio The initialized priority rings context.
+ * @param[in] weights The weight of each level, non-zero, or @c NULL to read strictly by priority, the default.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_prio_set_weights(cb_prio_t * const prio, const size_t * const weights);
+
+/**
+ * @brief Writes the specified number of elements to the level of the priority specified, as ::cb_write.
+ *
+ * Multiple producers can write to different levels at the same time, writes to the same level at the same time must
+ * be locked, e.g. with the built-in locks of ::cb_set_lock or with the lock events.
+ * @param[in] prio The initialized priority rings context.
+ * @param[in] level The priority of the elements, zero being the highest.
+ * @param[in] buffer The buffer with the elements to write.
+ * @param[in] count The number of elements in @p buffer.
+ * @return The result of ::cb_write on the level, or ::cb_error_invalid_args if @p level is not a level.
+ */
+cb_error_t cb_prio_write(cb_prio_t * const prio, const size_t level, const void * const buffer, const size_t count);
+
+/**
+ * @brief Reads up to the specified number of elements from the highest priority level with elements.
+ *
+ * The elements read in each call are from a single level and in order, and there can only be one consumer at the same
+ * time. With weights, see ::cb_prio_set_weights, the number of elements read is also limited by the weight left.
+ * @param[in] prio The initialized priority rings context.
+ * @param[out] buffer The buffer where to read the elements.
+ * @param[in] count The maximum number of elements to read.
+ * @param[out] read The number of elements read.
+ * @param[out] level The level the elements were read from, can be @c NULL.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty All the levels are empty.
+ * @return Otherwise, the error of ::cb_read on a level.
+ */
+cb_error_t cb_prio_read(cb_prio_t * const prio,
+                        void * const buffer,
+                        const size_t count,
+                        size_t * const read,
+                        size_t * const level);
+
+/**
+ * @brief Checks if all the levels are empty, from the occupancy bitmap, without querying the levels.
+ *
+ * The result might be outdated if the levels are being written or read.
+ * @param[in] prio The initialized priority rings context.
+ * @param[out] is_empty @c true if all the levels are empty, @c false otherwise.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_prio_is_empty(cb_prio_t * const prio, bool * const is_empty);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_PRIO_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,140 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_shard.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef CB_SHARD_H
+#define CB_SHARD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_shard Sharded rings
+ *
+ * Provides sets of circular buffers, or shards, usually one for each processor or producer thread, so that producers
+ * and consumers on different processors do not contend on the same circular buffer. Producers write to their local
+ * shard, and consumers read from their home shard first and steal batches from the other shards when it is empty. The
+ * order of the elements is preserved within each shard, but not across shards.
+ *
+ * @{
+ */
+
+/** @defgroup cb_shard_defs Definitions */
+/** @defgroup cb_shard_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cb/cb.h"
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_shard_defs
+ * @{
+ */
+
+/**
+ * @brief Sharded ring context.
+ *
+ * The shards are circular buffers initialized by the user, with elements of the same size. As the home consumer and
+ * the consumers stealing from a shard read from it at the same time, its reads must be locked, e.g. with the built-in
+ * locks of ::cb_set_lock or with the lock events. The user should not access its members directly.
+ */
+typedef struct
+{
+    cb_t * shards; /**< The shards. */
+    size_t count; /**< The number of shards in @c shards. */
+} cb_shard_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_shard_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a sharded ring over an array of initialized circular buffers.
+ * @param[in] shard The sharded ring context to initialize.
+ * @param[in] shards The shards, initialized circular buffers with elements of the same size, owned by the user.
+ * @param[in] count The number of shards in @p shards.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_shard_init(cb_shard_t * const shard, cb_t * const shards, const size_t count);
+
+/**
+ * @brief Deinitializes a sharded ring, the shards are not deinitialized.
+ * @param[in] shard The initialized sharded ring context.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_shard_deinit(cb_shard_t * const shard);
+
+/**
+ * @brief Writes the specified number of elements to the local shard of the producer, as ::cb_write.
+ * @param[in] shard The initialized sharded ring context.
+ * @param[in] local The local shard of the producer, e.g. the processor it runs on modulo the number of shards.
+ * @param[in] buffer The buffer with the elements to write.
+ * @param[in] count The number of elements in @p buffer.
+ * @return The result of ::cb_write on the local shard, or ::cb_error_invalid_args if @p local is not a shard.
+ */
+cb_error_t cb_shard_write(cb_shard_t * const shard, const size_t local, const void * const buffer, const size_t count);
+
+/**
+ * @brief Reads up to the specified number of elements, from the home shard of the consumer or stolen from another one.
+ *
+ * All the elements available up to @p count are read from the home shard. If it is empty, the other shards are tried
+ * in order from the next one, and up to half of the elements of the first shard with elements are stolen, so that its
+ * home consumer keeps the other half. The elements read in each call are from a single shard and in order.
+ * @param[in] shard The initialized sharded ring context.
+ * @param[in] home The home shard of the consumer.
+ * @param[out] buffer The buffer where to read the elements.
+ * @param[in] count The maximum number of elements to read.
+ * @param[out] read The number of elements read.
+ * @param[out] from The shard the elements were read from, can be @c NULL.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty All the shards are empty.
+ * @return Otherwise, the error of ::cb_read on a shard.
+ */
+cb_error_t cb_shard_read(cb_shard_t * const shard,
+                         const size_t home,
+                         void * const buffer,
+                         const size_t count,
+                         size_t * const read,
+                         size_t * const from);
+
+/**
+ * @brief Gets the number of elements in all the shards, from the lock-free queries of each shard.
+ *
+ * The shards are not queried at the same time, the number might be outdated if they are being written or read.
+ * @param[in] shard The initialized sharded ring context.
+ * @param[out] count The number of filled slots in all the shards.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_shard_get_filled(cb_shard_t * const shard, size_t * const count);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_SHARD_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,145 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_trace.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+// Outside of the guard, with CB_HEADER_ONLY it includes this header in turn, which must be complete by then.
+#include "cb/cb.h"
+#ifndef CB_TRACE_H
+#define CB_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_trace Tracing
+ *
+ * Provides a recorder of the traces of a circular buffer in memory, safe to use from multiple threads at the same
+ * time, along with the header of the binary trace format, requires @c CB_USE_TRACE to be defined, see ::cb_set_trace.
+ *
+ * A binary trace is a ::cb_trace_hdr_t followed by @c count records ::cb_trace_rec_t, in the byte order of the machine
+ * that recorded it.
+ *
+ * @{
+ */
+
+/** @defgroup cb_trace_defs Definitions */
+/** @defgroup cb_trace_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_trace_defs
+ * @{
+ */
+
+/** Magic number of the binary trace format, 'CBTR' in little endian. */
+#define CB_TRACE_MAGIC   (0x52544243U)
+/** Version of the binary trace format. */
+#define CB_TRACE_VERSION (1U)
+
+/** Record of a write or read in a trace, with a fixed layout of 24 bytes so traces can be stored as they are. For
+ * ::cb_write_partial and ::cb_read_partial, @c count is the number of elements transferred if they succeed. */
+typedef struct cb_trace_rec_s
+{
+    uint64_t stamp; /**< Timestamp of the start of the operation. */
+    uint32_t thread; /**< Identifier of the calling thread, zero if not provided, see ::cb_trace_thread_t. */
+    uint32_t count; /**< Number of elements requested, or transferred if partial, saturated to @c UINT32_MAX. */
+    uint32_t filled; /**< Number of filled slots at the end of the operation, saturated to @c UINT32_MAX. */
+    uint8_t fn; /**< Function, either ::cb_fn_id_write or ::cb_fn_id_read. */
+    uint8_t result; /**< Result of the operation, as ::cb_error_t. */
+    uint16_t reserved; /**< Reserved, always zero. */
+} cb_trace_rec_t;
+
+/** Header of a binary trace, with a fixed layout of 48 bytes. */
+typedef struct
+{
+    uint32_t magic; /**< Magic number, ::CB_TRACE_MAGIC. */
+    uint16_t version; /**< Version of the format, ::CB_TRACE_VERSION. */
+    uint16_t rec_size; /**< Size of each record, in bytes. */
+    uint64_t buffer_length; /**< The size of the underlying linear buffer of the circular buffer, in elements. */
+    uint64_t elem_size; /**< The size of each element of the circular buffer, in bytes. */
+    uint64_t ticks_per_sec; /**< Number of ticks of the clock per second, e.g. @c 1000000000 for nanoseconds. */
+    uint64_t count; /**< Number of records after the header. */
+    uint64_t dropped; /**< Number of records that were dropped when recording. */
+} cb_trace_hdr_t;
+
+/** Recorder of traces in memory, the user should not access its members directly. */
+typedef struct
+{
+    cb_trace_rec_t * recs; /**< Records. */
+    size_t capacity; /**< Maximum number of records. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_size_t next; /**< Atomic index of the next record, can go beyond @c capacity. */
+#else
+    size_t next; /**< Index of the next record, can go beyond @c capacity. */
+#endif
+} cb_trace_buf_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_trace_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a recorder of traces in memory, can also be used to discard all the records.
+ * @param[in] buf The recorder to initialize.
+ * @param[in] recs The memory for the records.
+ * @param[in] capacity The maximum number of records, further records are dropped.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_trace_buf_init(cb_trace_buf_t * const buf, cb_trace_rec_t * const recs, const size_t capacity);
+
+/**
+ * @brief Trace sink that stores the records in a recorder, to use with ::cb_set_trace along with the recorder as
+ * user data, it can be called from multiple threads at the same time.
+ * @param[in] rec The record.
+ * @param[in] user_data The initialized recorder, ::cb_trace_buf_t.
+ */
+void cb_trace_buf_sink(const cb_trace_rec_t * const rec, void * const user_data);
+
+/**
+ * @brief Obtains the header of the binary trace of the records in a recorder, the records follow it in the trace.
+ *
+ * Must not be called at the same time as the writes and reads being traced, as records might be partially stored.
+ * @param[in] buf The initialized recorder.
+ * @param[in] cb The initialized circular buffer context that was traced.
+ * @param[in] ticks_per_sec The number of ticks per second of the clock provided in ::cb_set_trace.
+ * @param[out] hdr The header.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_trace_buf_hdr(const cb_trace_buf_t * const buf,
+                            const cb_t * const cb,
+                            const uint64_t ticks_per_sec,
+                            cb_trace_hdr_t * const hdr);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_TRACE_H */
+
+/******************************************************************************************************END OF FILE*****/
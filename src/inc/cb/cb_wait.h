@@ -0,0 +1,223 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_wait.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+// Outside of the guard, with CB_HEADER_ONLY it includes this header in turn, which must be complete by then.
+#include "cb/cb.h"
+#ifndef CB_WAIT_H
+#define CB_WAIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @addtogroup cb_wait Wait sets
+ *
+ * Provides wait sets, where a thread registers many circular buffers and sleeps until any of them is ready to be read
+ * or written, receiving the list of those ready, as @c epoll. Writes and reads signal the wait set only when they make
+ * a circular buffer go from empty to not empty or from full to not full, and only those signaled and those reported
+ * ready before are checked, thus waiting costs in proportion to the circular buffers ready, not to those registered.
+ * Requires @c CB_USE_WAIT to be defined.
+ *
+ * @{
+ */
+
+/** @defgroup cb_wait_defs Definitions */
+/** @defgroup cb_wait_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include <stdint.h>
+
+#ifdef CB_USE_WAIT
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_wait_defs
+ * @{
+ */
+
+#ifndef CB_WAIT_MAX_RINGS
+/** Maximum number of circular buffers in a wait set, at most the number of bits of its bitmaps. */
+#define CB_WAIT_MAX_RINGS (64U)
+#endif
+#if CB_WAIT_MAX_RINGS > 64U
+#error "CB_WAIT_MAX_RINGS can't be larger than the number of bits of the bitmaps of the wait set."
+#endif
+
+#ifndef CB_WAIT_POLL_US
+/** Microseconds a waiting thread sleeps between checks on platforms without futexes, where waits poll. */
+#define CB_WAIT_POLL_US (100U)
+#endif
+#if CB_WAIT_POLL_US >= 1000000U
+#error "CB_WAIT_POLL_US must be less than a second."
+#endif
+
+/** Readiness events of a circular buffer in a wait set. */
+typedef enum
+{
+    cb_wait_evt_none = 0x00U, /**< No event. */
+    cb_wait_evt_readable = 0x01U, /**< Has elements to read, signaled when a write makes it not empty. */
+    cb_wait_evt_writable = 0x02U, /**< Has space to write, signaled when a read makes it not full. */
+} cb_wait_evt_t;
+
+/** Circular buffer ready, reported by ::cb_wait_wait. */
+typedef struct
+{
+    cb_t * cb; /**< The circular buffer. */
+    cb_wait_evt_t events; /**< The events ready, OR combination of ::cb_wait_evt_t. */
+    void * user_data; /**< The user data given when the circular buffer was added to the wait set. */
+} cb_wait_ready_t;
+
+/**
+ * @brief Wait set context.
+ *
+ * The user should not access its members directly.
+ */
+typedef struct cb_wait_s
+{
+    cb_t * rings[CB_WAIT_MAX_RINGS]; /**< The circular buffers registered, @c NULL for free slots. */
+    cb_wait_evt_t events[CB_WAIT_MAX_RINGS]; /**< The events of interest of each circular buffer. */
+    void * user_data[CB_WAIT_MAX_RINGS]; /**< The user data of each circular buffer. */
+    uint_least64_t reported; /**< Bitmap of the slots reported ready by the last wait, checked again by the next. */
+#ifdef CB_USE_STDATOMIC
+    cb_atomic_uint_least64_t pending; /**< The atomic bitmap of the slots signaled since the last wait. */
+    cb_atomic_uint seq; /**< The atomic number of signals, the word waiters sleep on. */
+    cb_atomic_uint waiters; /**< The atomic number of threads sleeping, signals only wake them if any. */
+#else
+    uint_least64_t pending; /**< The bitmap of the slots signaled since the last wait. */
+    unsigned int seq; /**< The number of signals. */
+    unsigned int waiters; /**< Unused without atomic support. */
+#endif
+} cb_wait_t;
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_wait_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a wait set, without circular buffers.
+ * @param[in] ws The wait set context to initialize.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_wait_init(cb_wait_t * const ws);
+
+/**
+ * @brief Deinitializes a wait set, removing its circular buffers.
+ * @param[in] ws The initialized wait set context.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_wait_deinit(cb_wait_t * const ws);
+
+/**
+ * @brief Adds a circular buffer to a wait set.
+ *
+ * A circular buffer can be in a single wait set, and it must not be written nor read while being added or removed,
+ * ::cb_deinit removes it from its wait set. It is reported ready by the next wait if it already is.
+ * @param[in] ws The initialized wait set context.
+ * @param[in] cb The initialized circular buffer, not in a wait set.
+ * @param[in] events The events of interest, OR combination of ::cb_wait_evt_t, not ::cb_wait_evt_none.
+ * @param[in] user_data User data reported along with the circular buffer, can be @c NULL.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_full The wait set already has ::CB_WAIT_MAX_RINGS circular buffers.
+ */
+cb_error_t cb_wait_add(cb_wait_t * const ws, cb_t * const cb, const cb_wait_evt_t events, void * const user_data);
+
+/**
+ * @brief Removes a circular buffer from a wait set.
+ * @param[in] ws The initialized wait set context.
+ * @param[in] cb The circular buffer, in @p ws.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_wait_remove(cb_wait_t * const ws, cb_t * const cb);
+
+/**
+ * @brief Waits until at least one of the circular buffers of a wait set is ready, or the timeout expires.
+ *
+ * The circular buffers ready are reported in the order they were added, and those reported are checked again by the
+ * next wait, thus a circular buffer does not need to be drained to be reported again, as the level-triggered mode of
+ * @c epoll. Only a thread can wait on a wait set at the same time. On Linux it sleeps on a futex until signaled, on
+ * other platforms it polls, sleeping up to ::CB_WAIT_POLL_US between checks. Without atomic support, it does not sleep
+ * and returns after checking the circular buffers once.
+ * @param[in] ws The initialized wait set context.
+ * @param[out] ready Where to report the circular buffers ready.
+ * @param[in] max The maximum number of circular buffers to report in @p ready, those left are reported next time.
+ * @param[out] count The number of circular buffers reported in @p ready.
+ * @param[in] timeout_ms The maximum time to wait in milliseconds, zero to return immediately, negative to wait
+ * indefinitely.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ * @retval ::cb_error_empty No circular buffer was ready before the timeout expired.
+ */
+cb_error_t cb_wait_wait(cb_wait_t * const ws,
+                        cb_wait_ready_t * const ready,
+                        const size_t max,
+                        size_t * const count,
+                        const int timeout_ms);
+
+/**
+ * @brief Obtains the number of signals of a wait set, to sleep with ::cb_wait_sleep until the next one.
+ *
+ * It must be called before checking the circular buffer waited on, it is ordered after the reads and writes of the
+ * thread, thus a signal after the check changes the number of signals and the sleep returns immediately.
+ * @param[in] ws The initialized wait set context.
+ * @return The number of signals.
+ */
+unsigned int cb_wait_signals(cb_wait_t * const ws);
+
+/**
+ * @brief Sleeps until the wait set is signaled since ::cb_wait_signals returned @p seq, or the timeout expires.
+ *
+ * Unlike ::cb_wait_wait, it neither checks nor reports the circular buffers, thus threads waiting on a single circular
+ * buffer of the wait set, e.g. ::cb_read_batch, can sleep on it along with the thread waiting on the whole wait set.
+ * Without atomic support, it returns immediately.
+ * @param[in] ws The initialized wait set context.
+ * @param[in] seq The number of signals returned by ::cb_wait_signals before the check.
+ * @param[in] timeout_ms The maximum time to sleep in milliseconds, negative to sleep until signaled.
+ * @retval ::cb_error_ok Success, signaled or not.
+ * @retval ::cb_error_invalid_args At least one of the arguments provided is invalid.
+ */
+cb_error_t cb_wait_sleep(cb_wait_t * const ws, const unsigned int seq, const int timeout_ms);
+
+/**
+ * @brief Signals that a circular buffer of a wait set might be ready, waking the thread waiting if any.
+ *
+ * Called by writes and reads when they make the circular buffer go from empty to not empty or from full to not full,
+ * and by the last processing stage instead of the writes if there are stages, it does not need to be called by the
+ * user.
+ * @param[in] ws The initialized wait set context.
+ * @param[in] slot The slot of the circular buffer in @p ws.
+ */
+void cb_wait_signal(cb_wait_t * const ws, const size_t slot);
+
+/**
+ * @}
+ */
+#endif
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_WAIT_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,295 @@
+/**
+ ***********************************************************************************************************************
+ * @file        bench.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup bench_iapi_impl Internal API implementation */
+/** @defgroup bench_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "bench.h"
+#include "cb/other/version.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup bench_iapi_impl
+ * @{
+ */
+
+/** Default minimum time to measure each case, in milliseconds. */
+#define BENCH_DEF_MIN_TIME_MS (20U)
+
+/**
+ * @}
+ */
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup bench_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Prints the usage of a benchmark.
+ * @param[in] suite The name of the benchmark suite.
+ * @param[in] opts The additional options.
+ * @param[in] opts_count The number of additional options.
+ */
+static void bench_int_usage(const char * const suite, const bench_opt_t * const opts, const size_t opts_count);
+
+/**
+ * @brief Prints the value of a field.
+ * @param[in] bench The benchmark context.
+ * @param[in] field The field.
+ */
+static void bench_int_print_value(const bench_t * const bench, const bench_field_t * const field);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup bench_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void bench_int_usage(const char * const suite, const bench_opt_t * const opts, const size_t opts_count)
+{
+    (void)fprintf(stderr,
+                  "usage: %s [--format csv|json] [--out FILE] [--min-time-ms N] [--quick] [options]\n"
+                  "  --format       Output format, defaults to 'csv'.\n"
+                  "  --out          Output file, defaults to the standard output.\n"
+                  "  --min-time-ms  Minimum time to measure each case, defaults to %u.\n"
+                  "  --quick        Run a reduced set of cases.\n",
+                  suite,
+                  BENCH_DEF_MIN_TIME_MS);
+    for (size_t i = 0U; i < opts_count; i++)
+    {
+        // Options without default value describe the default in their help.
+        const int pad = 13 - (int)strlen(opts[i].name);
+        if (opts[i].value[0U] != '\0')
+        {
+            (void)fprintf(stderr, "  --%s%*s%s, defaults to '%s'.\n", opts[i].name, pad, "", opts[i].help, opts[i].value);
+        }
+        else
+        {
+            (void)fprintf(stderr, "  --%s%*s%s.\n", opts[i].name, pad, "", opts[i].help);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void bench_int_print_value(const bench_t * const bench, const bench_field_t * const field)
+{
+    switch (field->type)
+    {
+        case bench_type_str:
+        {
+            const char * const quote = (bench->format == bench_format_json) ? ("\"") : ("");
+            (void)fprintf(bench->out, "%s%s%s", quote, field->value.str, quote);
+        }
+        break;
+
+        case bench_type_u64:
+        {
+            (void)fprintf(bench->out, "%llu", (unsigned long long)field->value.u64);
+        }
+        break;
+
+        case bench_type_f64:
+        default:
+        {
+            (void)fprintf(bench->out, "%.3f", field->value.f64);
+        }
+        break;
+    }
+}
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup bench_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+bool bench_init(bench_t * const bench,
+                const char * const suite,
+                const int argc,
+                char ** const argv,
+                bench_opt_t * const opts,
+                const size_t opts_count)
+{
+    bench->suite = suite;
+    bench->format = bench_format_csv;
+    bench->out = stdout;
+    bench->min_time_ns = (uint64_t)BENCH_DEF_MIN_TIME_MS * 1000000U;
+    bench->quick = false;
+    bench->count = 0U;
+
+    // Parse arguments.
+    for (int i = 1; i < argc; i++)
+    {
+        const bool has_value = ((i + 1) < argc);
+        if ((strcmp(argv[i], "--format") == 0) && has_value)
+        {
+            i++;
+            if (strcmp(argv[i], "csv") == 0)
+            {
+                bench->format = bench_format_csv;
+            }
+            else if (strcmp(argv[i], "json") == 0)
+            {
+                bench->format = bench_format_json;
+            }
+            else
+            {
+                bench_int_usage(suite, opts, opts_count);
+                return false;
+            }
+        }
+        else if ((strcmp(argv[i], "--out") == 0) && has_value)
+        {
+            i++;
+            bench->out = fopen(argv[i], "w");
+            if (bench->out == NULL)
+            {
+                (void)fprintf(stderr, "%s: can't open '%s'\n", suite, argv[i]);
+                return false;
+            }
+        }
+        else if ((strcmp(argv[i], "--min-time-ms") == 0) && has_value)
+        {
+            i++;
+            bench->min_time_ns = (uint64_t)strtoull(argv[i], NULL, 10) * 1000000U;
+        }
+        else if (strcmp(argv[i], "--quick") == 0)
+        {
+            bench->quick = true;
+        }
+        else
+        {
+            // Additional options of the benchmark.
+            size_t opt = 0U;
+            while ((opt < opts_count) &&
+                   !((strncmp(argv[i], "--", 2U) == 0) && (strcmp(&argv[i][2U], opts[opt].name) == 0) && has_value))
+            {
+                opt++;
+            }
+            if (opt == opts_count)
+            {
+                bench_int_usage(suite, opts, opts_count);
+                return false;
+            }
+            i++;
+            opts[opt].value = argv[i];
+        }
+    }
+
+    // Header of the output, the library version allows to compare results between versions.
+    if (bench->format == bench_format_json)
+    {
+        (void)fprintf(bench->out,
+                      "{\n  \"suite\": \"%s\",\n  \"version\": \"%s\",\n  \"commit\": \"%s\",\n"
+                      "  \"build\": \"%s\",\n  \"results\": [",
+                      suite,
+                      CB_VERSION,
+                      CB_COMMIT_HASH,
+                      CB_BUILD);
+    }
+
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void bench_report(bench_t * const bench, const bench_field_t * const fields, const size_t count)
+{
+    if (bench->format == bench_format_json)
+    {
+        (void)fprintf(bench->out, "%s\n    {", (bench->count == 0U) ? ("") : (","));
+        for (size_t i = 0U; i < count; i++)
+        {
+            (void)fprintf(bench->out, "%s\"%s\": ", (i == 0U) ? ("") : (", "), fields[i].key);
+            bench_int_print_value(bench, &fields[i]);
+        }
+        (void)fprintf(bench->out, "}");
+    }
+    else
+    {
+        // The header row is printed along with the first result, the version is added to each row.
+        if (bench->count == 0U)
+        {
+            (void)fprintf(bench->out, "suite,version");
+            for (size_t i = 0U; i < count; i++)
+            {
+                (void)fprintf(bench->out, ",%s", fields[i].key);
+            }
+            (void)fprintf(bench->out, "\n");
+        }
+        (void)fprintf(bench->out, "%s,%s", bench->suite, CB_VERSION);
+        for (size_t i = 0U; i < count; i++)
+        {
+            (void)fprintf(bench->out, ",");
+            bench_int_print_value(bench, &fields[i]);
+        }
+        (void)fprintf(bench->out, "\n");
+    }
+    (void)fflush(bench->out);
+
+    bench->count++;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void bench_deinit(bench_t * const bench)
+{
+    if (bench->format == bench_format_json)
+    {
+        (void)fprintf(bench->out, "\n  ]\n}\n");
+    }
+    if (bench->out != stdout)
+    {
+        (void)fclose(bench->out);
+    }
+    bench->out = NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void bench_clobber(const void * const ptr)
+{
+#if defined(__GNUC__)
+    __asm__ volatile("" : : "g"(ptr) : "memory");
+#else
+    static const void * volatile sink;
+    sink = ptr;
+#endif
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,175 @@
+/**
+ ***********************************************************************************************************************
+ * @file        bench.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef BENCH_H
+#define BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @defgroup bench_defs Definitions */
+/** @defgroup bench_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+// MISRA Justification:
+// This header is necessary just for the benchmarks.
+// cppcheck-suppress misra-c2012-21.6
+#include <stdio.h>
+
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup bench_defs
+ * @{
+ */
+
+/** Output formats of the results. */
+typedef enum
+{
+    bench_format_csv = 0U, /**< Comma separated values, with a header row. */
+    bench_format_json, /**< JSON object, with the results in an array. */
+} bench_format_t;
+
+/** Types of the values of the fields of a result. */
+typedef enum
+{
+    bench_type_str = 0U, /**< String. */
+    bench_type_u64, /**< Unsigned integer. */
+    bench_type_f64, /**< Floating point. */
+} bench_type_t;
+
+/** Field of a result, all the results of a benchmark must have the same fields in the same order. */
+typedef struct
+{
+    const char * key; /**< Name of the field. */
+    bench_type_t type; /**< Type of the value. */
+    union
+    {
+        const char * str; /**< Value, if @c type is ::bench_type_str. */
+        uint64_t u64; /**< Value, if @c type is ::bench_type_u64. */
+        double f64; /**< Value, if @c type is ::bench_type_f64. */
+    } value; /**< Value of the field. */
+} bench_field_t;
+
+/** Additional option of a benchmark, given as <tt>--name VALUE</tt> in the command line. */
+typedef struct
+{
+    const char * name; /**< Name of the option, without the leading dashes. */
+    const char * help; /**< Description of the option, for the usage. */
+    const char * value; /**< Value of the option, the default value before ::bench_init is called. */
+} bench_opt_t;
+
+/** Benchmark context. */
+typedef struct
+{
+    const char * suite; /**< Name of the benchmark suite. */
+    bench_format_t format; /**< Output format. */
+    FILE * out; /**< Output stream. */
+    uint64_t min_time_ns; /**< Minimum time to measure each case, in nanoseconds. */
+    bool quick; /**< If @c true, run a reduced set of cases. */
+    size_t count; /**< Number of results reported. */
+} bench_t;
+
+/**
+ * @}
+ */
+
+/* Exported macro ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup bench_papi
+ * @{
+ */
+
+/** Initializers for the fields of a result. */
+/** @{ */
+#define BENCH_STR(k, v) {.key = (k), .type = bench_type_str, .value.str = (v)}
+#define BENCH_U64(k, v) {.key = (k), .type = bench_type_u64, .value.u64 = (uint64_t)(v)}
+#define BENCH_F64(k, v) {.key = (k), .type = bench_type_f64, .value.f64 = (double)(v)}
+/** @} */
+
+/**
+ * @brief Calculates the number of elements in an array.
+ * @param[in] array The array.
+ * @return The number of elements in an array.
+ */
+#define BENCH_ARRAY_DIM(array) (sizeof((array)) / sizeof(*(array)))
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup bench_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a benchmark from the command line arguments, prints the usage on invalid arguments.
+ *
+ * The arguments supported are <tt>--format csv|json</tt>, <tt>--out FILE</tt>, <tt>--min-time-ms N</tt> and
+ * <tt>--quick</tt>, defaults to CSV on the standard output, with a minimum of 20ms for each case, along with the
+ * additional options of the benchmark.
+ * @param[in] bench The benchmark context to initialize.
+ * @param[in] suite The name of the benchmark suite.
+ * @param[in] argc The number of arguments.
+ * @param[in] argv The arguments.
+ * @param[in,out] opts The additional options, their values are updated from the arguments, can be @c NULL.
+ * @param[in] opts_count The number of additional options.
+ * @return @c true on success, @c false on invalid arguments.
+ */
+bool bench_init(bench_t * const bench,
+                const char * const suite,
+                const int argc,
+                char ** const argv,
+                bench_opt_t * const opts,
+                const size_t opts_count);
+
+/**
+ * @brief Reports a result.
+ * @param[in] bench The benchmark context.
+ * @param[in] fields The fields of the result.
+ * @param[in] count The number of fields.
+ */
+void bench_report(bench_t * const bench, const bench_field_t * const fields, const size_t count);
+
+/**
+ * @brief Finalizes the output and deinitializes a benchmark.
+ * @param[in] bench The benchmark context.
+ */
+void bench_deinit(bench_t * const bench);
+
+/**
+ * @brief Obtains a monotonic timestamp.
+ * @return The timestamp, in nanoseconds.
+ */
+uint64_t bench_now_ns(void);
+
+/**
+ * @brief Prevents the compiler from optimizing away the computation of the memory pointed to.
+ * @param[in] ptr The memory.
+ */
+void bench_clobber(const void * const ptr);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* BENCH_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,403 @@
+/**
+ ***********************************************************************************************************************
+ * @file        bench_cb.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_benchmarks Benchmarks */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "bench.h"
+#include "cb/cb.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/** Capacity of the circular buffer, intended to fit in a level of the memory hierarchy. */
+typedef struct
+{
+    const char * name; /**< Name of the level. */
+    size_t bytes; /**< Size in bytes of the underlying linear buffer. */
+} tier_t;
+
+/** Query function of the circular buffer, wrapped with a common signature. */
+typedef struct
+{
+    const char * name; /**< Name of the function. */
+    cb_error_t (*fn)(cb_t * const cb); /**< Wrapper of the function. */
+} query_t;
+
+/* Private define ----------------------------------------------------------------------------------------------------*/
+#if defined(BENCH_UNCHECKED)
+/** Name of the suite, the unchecked functions are reported apart so they can be compared. */
+#define SUITE_NAME "bench_cb_unchecked"
+/** Functions to write and read, and their names. */
+#define BENCH_WRITE      cb_write_unchecked
+#define BENCH_READ       cb_read_unchecked
+#define BENCH_WRITE_NAME "cb_write_unchecked"
+#define BENCH_READ_NAME  "cb_read_unchecked"
+#elif defined(CB_HEADER_ONLY)
+/** Name of the suite, the header-only build is reported apart so both can be compared. */
+#define SUITE_NAME "bench_cb_header_only"
+#else
+/** Name of the suite. */
+#define SUITE_NAME "bench_cb"
+#endif
+#ifndef BENCH_WRITE
+/** Functions to write and read, and their names. */
+#define BENCH_WRITE      cb_write
+#define BENCH_READ       cb_read
+#define BENCH_WRITE_NAME "cb_write"
+#define BENCH_READ_NAME  "cb_read"
+#endif
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Sizes of the elements, in bytes. */
+static const size_t elem_sizes[] = {1U, 2U, 4U, 8U, 16U, 32U, 64U, 128U, 256U};
+/** Sizes of the elements, in bytes, in quick mode. */
+static const size_t elem_sizes_quick[] = {1U, 16U, 256U};
+/** Number of elements written or read on each operation. */
+static const size_t batches[] = {1U, 4U, 16U, 64U};
+/** Number of elements written or read on each operation, in quick mode. */
+static const size_t batches_quick[] = {1U, 16U};
+/** Capacities of the circular buffer, the last one is skipped in quick mode. */
+static const tier_t tiers[] = {
+    {"L1", 16U * 1024U},
+    {"L2", 256U * 1024U},
+    {"DRAM", 64U * 1024U * 1024U},
+};
+/** Sink for the results of the query functions. */
+static size_t query_sink;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Circular buffer event handler, performs the same work as the built-in implementations. */
+static cb_error_t bench_evt_handler(cb_evt_t * const evt);
+/** Wrappers of the query functions. */
+/** @{ */
+static cb_error_t query_get_filled(cb_t * const cb);
+static cb_error_t query_get_unfilled(cb_t * const cb);
+static cb_error_t query_is_empty(cb_t * const cb);
+static cb_error_t query_is_full(cb_t * const cb);
+/** @} */
+
+/**
+ * @addtogroup cb_benchmarks
+ * @{
+ */
+
+/**
+ * @brief Benchmarks ::cb_write and ::cb_read, filling and draining the circular buffer on each round.
+ * @param[in] bench The benchmark context.
+ * @param[in] elem_size The size of the elements.
+ * @param[in] batch The number of elements written or read on each operation.
+ * @param[in] tier The capacity of the circular buffer.
+ * @param[in] wrap If @c true, operations periodically wrap around, otherwise they never do.
+ * @param[in] events If @c true, subscribe to the read, write, lock and unlock events.
+ * @return @c true on success, @c false otherwise.
+ */
+static bool bench_write_read(bench_t * const bench,
+                             const size_t elem_size,
+                             const size_t batch,
+                             const tier_t * const tier,
+                             const bool wrap,
+                             const bool events);
+
+/**
+ * @brief Benchmarks the query functions, on a circular buffer half filled.
+ * @param[in] bench The benchmark context.
+ * @param[in] events If @c true, subscribe to the read, write, lock and unlock events.
+ * @return @c true on success, @c false otherwise.
+ */
+static bool bench_queries(bench_t * const bench, const bool events);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static cb_error_t bench_evt_handler(cb_evt_t * const evt)
+{
+    switch (evt->id)
+    {
+        case cb_evt_id_read:
+        {
+            (void)memcpy(evt->data.read.buffer, evt->data.read.read_ptr, evt->data.read.bytes);
+        }
+        break;
+
+        case cb_evt_id_write:
+        {
+            (void)memcpy(evt->data.write.write_ptr, evt->data.write.buffer, evt->data.write.bytes);
+        }
+        break;
+
+        default:
+        {
+            // Lock and unlock, nothing to do, only the cost of the event is measured.
+        }
+        break;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t query_get_filled(cb_t * const cb)
+{
+    size_t count = 0U;
+    const cb_error_t error = cb_get_filled(cb, &count);
+    query_sink += count;
+    return error;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t query_get_unfilled(cb_t * const cb)
+{
+    size_t count = 0U;
+    const cb_error_t error = cb_get_unfilled(cb, &count);
+    query_sink += count;
+    return error;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t query_is_empty(cb_t * const cb)
+{
+    bool is_empty = false;
+    const cb_error_t error = cb_is_empty(cb, &is_empty);
+    query_sink += (is_empty) ? (1U) : (0U);
+    return error;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t query_is_full(cb_t * const cb)
+{
+    bool is_full = false;
+    const cb_error_t error = cb_is_full(cb, &is_full);
+    query_sink += (is_full) ? (1U) : (0U);
+    return error;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool bench_write_read(bench_t * const bench,
+                             const size_t elem_size,
+                             const size_t batch,
+                             const tier_t * const tier,
+                             const bool wrap,
+                             const bool events)
+{
+    // Number of slots aligned to the batch, so operations never wrap, or offset by half a batch so they do.
+    size_t length = ((tier->bytes / elem_size) / batch) * batch;
+    length += (wrap) ? (batch / 2U) : (0U);
+    if ((length / batch) < 2U)
+    {
+        // Not enough space for this combination, skip it.
+        return true;
+    }
+    const size_t ops_per_round = (length - 1U) / batch;
+
+    // Allocate and initialize buffers.
+    uint8_t * const ring = malloc(length * elem_size);
+    uint8_t * const src = malloc(batch * elem_size);
+    uint8_t * const dst = malloc(batch * elem_size);
+    cb_t cb;
+    bool ok = (ring != NULL) && (src != NULL) && (dst != NULL);
+    if (ok)
+    {
+        (void)memset(ring, 0, length * elem_size);
+        (void)memset(src, 0xA5, batch * elem_size);
+        ok = (cb_init(&cb,
+                      ring,
+                      length,
+                      elem_size,
+                      (events) ? (bench_evt_handler) : (NULL),
+                      (events) ? (cb_evt_id_read | cb_evt_id_write | cb_evt_id_lock | cb_evt_id_unlock)
+                               : (cb_evt_id_none),
+                      NULL) == cb_error_ok);
+    }
+
+    // Measure rounds of filling and draining the circular buffer, the first one is a warm up.
+    uint64_t write_ns = 0U;
+    uint64_t read_ns = 0U;
+    uint64_t rounds = 0U;
+    for (bool warm_up = true; ok && (warm_up || ((write_ns + read_ns) < bench->min_time_ns)); warm_up = false)
+    {
+        const uint64_t t0 = bench_now_ns();
+        for (size_t i = 0U; ok && (i < ops_per_round); i++)
+        {
+            ok = (BENCH_WRITE(&cb, src, batch) == cb_error_ok);
+        }
+        const uint64_t t1 = bench_now_ns();
+        for (size_t i = 0U; ok && (i < ops_per_round); i++)
+        {
+            ok = (BENCH_READ(&cb, dst, batch) == cb_error_ok);
+        }
+        const uint64_t t2 = bench_now_ns();
+        bench_clobber(dst);
+
+        if (!warm_up)
+        {
+            write_ns += t1 - t0;
+            read_ns += t2 - t1;
+            rounds++;
+        }
+    }
+
+    // Number of operations that wrapped around, the same for writes and reads, starting after the warm up.
+    const uint64_t ops = rounds * ops_per_round;
+    uint64_t splits = 0U;
+    for (uint64_t i = 0U, idx = (ops_per_round * batch) % length; i < ops; i++)
+    {
+        splits += ((idx + batch) > length) ? (1U) : (0U);
+        idx = (idx + batch) % length;
+    }
+
+    // Report.
+    for (size_t op = 0U; ok && (op < 2U); op++)
+    {
+        const uint64_t ns = (op == 0U) ? (write_ns) : (read_ns);
+        const bench_field_t fields[] = {
+            BENCH_STR("op", (op == 0U) ? (BENCH_WRITE_NAME) : (BENCH_READ_NAME)),
+            BENCH_U64("elem_size", elem_size),
+            BENCH_U64("batch", batch),
+            BENCH_U64("capacity_bytes", (length - 1U) * elem_size),
+            BENCH_STR("tier", tier->name),
+            BENCH_STR("pattern", (wrap) ? ("wrap") : ("nowrap")),
+            BENCH_U64("events", (events) ? (1U) : (0U)),
+            BENCH_U64("ops", ops),
+            BENCH_F64("split_pct", (100.0 * (double)splits) / (double)ops),
+            BENCH_F64("ns_per_op", (double)ns / (double)ops),
+            BENCH_F64("ns_per_elem", (double)ns / (double)(ops * batch)),
+            BENCH_F64("mb_per_s", ((double)(ops * batch * elem_size) * 1000.0) / ((double)ns * 1.048576)),
+        };
+        bench_report(bench, fields, BENCH_ARRAY_DIM(fields));
+    }
+    if (!ok)
+    {
+        (void)fprintf(stderr, "%s: write/read failed, elem_size %zu batch %zu\n", bench->suite, elem_size, batch);
+    }
+
+    free(ring);
+    free(src);
+    free(dst);
+
+    return ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool bench_queries(bench_t * const bench, const bool events)
+{
+    static const query_t queries[] = {
+        {"cb_get_filled", query_get_filled},
+        {"cb_get_unfilled", query_get_unfilled},
+        {"cb_is_empty", query_is_empty},
+        {"cb_is_full", query_is_full},
+    };
+    static uint64_t ring[1024U + 1U];
+    static const uint64_t src[512U] = {0U};
+    cb_t cb;
+
+    // Initialize circular buffer, half filled.
+    bool ok = (cb_init(&cb,
+                       ring,
+                       BENCH_ARRAY_DIM(ring),
+                       sizeof(*ring),
+                       (events) ? (bench_evt_handler) : (NULL),
+                       (events) ? (cb_evt_id_read | cb_evt_id_write | cb_evt_id_lock | cb_evt_id_unlock)
+                                : (cb_evt_id_none),
+                       NULL) == cb_error_ok);
+    ok = ok && (cb_write(&cb, src, BENCH_ARRAY_DIM(src)) == cb_error_ok);
+
+    for (size_t q = 0U; ok && (q < BENCH_ARRAY_DIM(queries)); q++)
+    {
+        // Double the number of calls until the minimum time is reached.
+        uint64_t calls = 1024U;
+        uint64_t ns = 0U;
+        for (;; calls *= 2U)
+        {
+            const uint64_t t0 = bench_now_ns();
+            for (uint64_t i = 0U; ok && (i < calls); i++)
+            {
+                ok = (queries[q].fn(&cb) == cb_error_ok);
+            }
+            ns = bench_now_ns() - t0;
+            if ((!ok) || (ns >= bench->min_time_ns))
+            {
+                break;
+            }
+        }
+        bench_clobber(&query_sink);
+
+        const bench_field_t fields[] = {
+            BENCH_STR("op", queries[q].name),
+            BENCH_U64("elem_size", sizeof(*ring)),
+            BENCH_U64("batch", 0U),
+            BENCH_U64("capacity_bytes", sizeof(ring) - sizeof(*ring)),
+            BENCH_STR("tier", "L1"),
+            BENCH_STR("pattern", "-"),
+            BENCH_U64("events", (events) ? (1U) : (0U)),
+            BENCH_U64("ops", calls),
+            BENCH_F64("split_pct", 0.0),
+            BENCH_F64("ns_per_op", (double)ns / (double)calls),
+            BENCH_F64("ns_per_elem", 0.0),
+            BENCH_F64("mb_per_s", 0.0),
+        };
+        bench_report(bench, fields, BENCH_ARRAY_DIM(fields));
+    }
+
+    return ok;
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Runs all the single-threaded benchmarks of the circular buffer.
+ * @param[in] argc The number of arguments.
+ * @param[in] argv The arguments, see ::bench_init.
+ * @return Zero on success, non-zero otherwise.
+ */
+int main(int argc, char ** argv)
+{
+    bench_t bench;
+    if (!bench_init(&bench, SUITE_NAME, argc, argv, NULL, 0U))
+    {
+        return EXIT_FAILURE;
+    }
+
+    const size_t * const sizes = (bench.quick) ? (elem_sizes_quick) : (elem_sizes);
+    const size_t sizes_count = (bench.quick) ? (BENCH_ARRAY_DIM(elem_sizes_quick)) : (BENCH_ARRAY_DIM(elem_sizes));
+    const size_t * const counts = (bench.quick) ? (batches_quick) : (batches);
+    const size_t counts_count = (bench.quick) ? (BENCH_ARRAY_DIM(batches_quick)) : (BENCH_ARRAY_DIM(batches));
+    const size_t tiers_count = BENCH_ARRAY_DIM(tiers) - ((bench.quick) ? (1U) : (0U));
+
+    bool ok = true;
+    for (size_t e = 0U; ok && (e < 2U); e++)
+    {
+        const bool events = (e == 1U);
+        for (size_t t = 0U; ok && (t < tiers_count); t++)
+        {
+            for (size_t s = 0U; ok && (s < sizes_count); s++)
+            {
+                for (size_t b = 0U; ok && (b < counts_count); b++)
+                {
+                    ok = bench_write_read(&bench, sizes[s], counts[b], &tiers[t], false, events);
+                    // With a single element per operation, writes and reads never wrap around.
+                    if (ok && (counts[b] > 1U))
+                    {
+                        ok = bench_write_read(&bench, sizes[s], counts[b], &tiers[t], true, events);
+                    }
+                }
+            }
+        }
+        ok = ok && bench_queries(&bench, events);
+    }
+
+    bench_deinit(&bench);
+
+    return (ok) ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
+
+/******************************************************************************************************END OF FILE*****/
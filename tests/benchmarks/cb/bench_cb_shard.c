@@ -0,0 +1,381 @@
+/**
+ ***********************************************************************************************************************
+ * @file        bench_cb_shard.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_shard_benchmarks Benchmarks */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+// Required for the thread affinity functions.
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "cb/cb_shard.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/** Lock state of a shard, passed as user data to the event handler, one mutex for each side. */
+typedef struct
+{
+    pthread_mutex_t mutex[2U]; /**< Mutexes, for writes and for reads. */
+} lock_state_t;
+
+/** Context of the threads of a run. */
+typedef struct
+{
+    cb_shard_t * shard; /**< Sharded ring, with a single shard if all the threads share a circular buffer. */
+    pthread_barrier_t * start; /**< Barrier to start all threads at the same time. */
+    atomic_size_t * consumed; /**< Number of messages consumed by all consumers. */
+    size_t total; /**< Number of messages to produce by all producers. */
+    size_t messages; /**< Number of messages to produce by this thread. */
+    size_t batch; /**< Number of messages written or read in each operation. */
+    size_t first; /**< First message produced by this thread. */
+    size_t local; /**< Local shard of the producer, or home shard of the consumer. */
+    int cpu; /**< Processor to pin the thread to, negative if not pinned. */
+    uint64_t checksum; /**< Sum of the messages consumed by this thread. */
+    uint64_t stolen; /**< Number of messages consumed by this thread from other shards than its home shard. */
+    bool ok; /**< @c true if the thread was successful. */
+} thread_ctx_t;
+
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Maximum number of producer and consumer pairs. */
+#define MAX_PAIRS (64U)
+/** Maximum number of messages written or read in each operation. */
+#define MAX_BATCH (256U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Event handler of the locks of the shards. */
+static cb_error_t lock_evt_handler(cb_evt_t * const evt);
+/** Pins the calling thread to a processor, if not negative. */
+static bool pin_thread(const int cpu);
+/** Thread functions. */
+/** @{ */
+static void * producer_func(void * ptr);
+static void * consumer_func(void * ptr);
+/** @} */
+/**
+ * @brief Measures the throughput of producer and consumer pairs, with a shard for each pair or all sharing one.
+ * @param[in] bench The benchmark context.
+ * @param[in] pairs The number of producer and consumer pairs, the producer and consumer of each pair share a processor.
+ * @param[in] sharded @c true for a shard for each pair, @c false for a single circular buffer shared by all.
+ * @param[in] cpus The processors of the pairs, negative if not pinned.
+ * @param[in] messages The number of messages to produce by all producers.
+ * @param[in] batch The number of messages written or read in each operation.
+ * @param[in] capacity The capacity of each shard, in messages.
+ * @return @c true on success, @c false otherwise.
+ */
+static bool bench_scaling(bench_t * const bench,
+                          const size_t pairs,
+                          const bool sharded,
+                          const int * const cpus,
+                          const size_t messages,
+                          const size_t batch,
+                          const size_t capacity);
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static cb_error_t lock_evt_handler(cb_evt_t * const evt)
+{
+    lock_state_t * const state = (lock_state_t *)evt->user_data;
+    const size_t side = (evt->data.lock.side == cb_lock_side_read) ? (1U) : (0U);
+
+    if (evt->id == cb_evt_id_lock)
+    {
+        (void)pthread_mutex_lock(&state->mutex[side]);
+    }
+    else if (evt->id == cb_evt_id_unlock)
+    {
+        (void)pthread_mutex_unlock(&state->mutex[side]);
+    }
+    else
+    {
+        return cb_error_evt;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool pin_thread(const int cpu)
+{
+    if (cpu < 0)
+    {
+        return true;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((size_t)cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer_func(void * ptr)
+{
+    thread_ctx_t * const ctx = (thread_ctx_t *)ptr;
+    uint64_t msgs[MAX_BATCH];
+
+    ctx->ok = pin_thread(ctx->cpu);
+    (void)pthread_barrier_wait(ctx->start);
+
+    for (size_t sent = 0U; ctx->ok && (sent < ctx->messages); sent += ctx->batch)
+    {
+        for (size_t i = 0U; i < ctx->batch; i++)
+        {
+            msgs[i] = (uint64_t)(ctx->first + sent + i);
+        }
+        for (;;)
+        {
+            const cb_error_t error = cb_shard_write(ctx->shard, ctx->local, msgs, ctx->batch);
+            if (error == cb_error_ok)
+            {
+                break;
+            }
+            ctx->ok = (error == cb_error_full);
+            if (!ctx->ok)
+            {
+                break;
+            }
+            // The consumer of the pair shares the processor, let it drain the shard.
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * consumer_func(void * ptr)
+{
+    thread_ctx_t * const ctx = (thread_ctx_t *)ptr;
+    uint64_t msgs[MAX_BATCH];
+
+    ctx->ok = pin_thread(ctx->cpu);
+    (void)pthread_barrier_wait(ctx->start);
+
+    // Consume until all the messages have been consumed, by this or other consumers.
+    while (ctx->ok && (atomic_load_explicit(ctx->consumed, memory_order_relaxed) < ctx->total))
+    {
+        size_t read = 0U;
+        size_t from = 0U;
+        const cb_error_t error = cb_shard_read(ctx->shard, ctx->local, msgs, ctx->batch, &read, &from);
+        if (error == cb_error_ok)
+        {
+            for (size_t i = 0U; i < read; i++)
+            {
+                ctx->checksum += msgs[i];
+            }
+            ctx->stolen += (from != ctx->local) ? (read) : (0U);
+            (void)atomic_fetch_add_explicit(ctx->consumed, read, memory_order_relaxed);
+        }
+        else
+        {
+            ctx->ok = (error == cb_error_empty);
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool bench_scaling(bench_t * const bench,
+                          const size_t pairs,
+                          const bool sharded,
+                          const int * const cpus,
+                          const size_t messages,
+                          const size_t batch,
+                          const size_t capacity)
+{
+    const size_t count = (sharded) ? (pairs) : (1U);
+    // Each producer sends the same number of messages, a multiple of the batch.
+    const size_t per_producer = ((messages / pairs) / batch) * batch;
+    const size_t total = per_producer * pairs;
+
+    // Initialize the shards, locked through the events as consumers steal from other shards, and the sharded ring.
+    static cb_t shards[MAX_PAIRS];
+    static lock_state_t states[MAX_PAIRS];
+    uint64_t * const rings = malloc(count * (capacity + 1U) * sizeof(uint64_t));
+    bool ok = (rings != NULL);
+    for (size_t s = 0U; ok && (s < count); s++)
+    {
+        (void)pthread_mutex_init(&states[s].mutex[0U], NULL);
+        (void)pthread_mutex_init(&states[s].mutex[1U], NULL);
+        ok = (cb_init(&shards[s],
+                      &rings[s * (capacity + 1U)],
+                      capacity + 1U,
+                      sizeof(uint64_t),
+                      lock_evt_handler,
+                      cb_evt_id_lock | cb_evt_id_unlock,
+                      &states[s]) == cb_error_ok) &&
+             (cb_set_lock_split(&shards[s], true) == cb_error_ok);
+    }
+    cb_shard_t shard;
+    ok = ok && (cb_shard_init(&shard, shards, count) == cb_error_ok);
+
+    // Start all threads at the same time, along with this one, the producer and the consumer of a pair together.
+    pthread_barrier_t start;
+    (void)pthread_barrier_init(&start, NULL, (unsigned int)((2U * pairs) + 1U));
+    atomic_size_t consumed;
+    atomic_init(&consumed, 0U);
+    static pthread_t ids[2U * MAX_PAIRS];
+    static thread_ctx_t ctxs[2U * MAX_PAIRS];
+    size_t started = 0U;
+    for (size_t t = 0U; ok && (t < (2U * pairs)); t++)
+    {
+        const bool producer = (t < pairs);
+        const size_t pair = (producer) ? (t) : (t - pairs);
+        ctxs[t] = (thread_ctx_t){
+            .shard = &shard,
+            .start = &start,
+            .consumed = &consumed,
+            .total = total,
+            .messages = per_producer,
+            .batch = batch,
+            .first = pair * per_producer,
+            .local = (sharded) ? (pair) : (0U),
+            .cpu = cpus[pair],
+        };
+        ok = (pthread_create(&ids[t], NULL, (producer) ? (producer_func) : (consumer_func), &ctxs[t]) == 0);
+        started += (ok) ? (1U) : (0U);
+    }
+    if (!ok)
+    {
+        // Threads can't be joined if not all started, as they would wait forever at the barrier.
+        (void)fprintf(stderr, "%s: can't initialize shards or create threads\n", bench->suite);
+        exit(EXIT_FAILURE);
+    }
+
+    (void)pthread_barrier_wait(&start);
+    const uint64_t t0 = bench_now_ns();
+    for (size_t t = 0U; t < started; t++)
+    {
+        (void)pthread_join(ids[t], NULL);
+    }
+    const uint64_t ns = bench_now_ns() - t0;
+
+    // Check all messages were consumed, only once.
+    uint64_t checksum = 0U;
+    uint64_t stolen = 0U;
+    for (size_t t = 0U; t < (2U * pairs); t++)
+    {
+        ok = ok && ctxs[t].ok;
+        checksum += ctxs[t].checksum;
+        stolen += ctxs[t].stolen;
+    }
+    ok = ok && (checksum == (((uint64_t)total * ((uint64_t)total - 1U)) / 2U));
+
+    const bench_field_t fields[] = {
+        BENCH_STR("mode", (sharded) ? ("sharded") : ("shared")),
+        BENCH_U64("pairs", pairs),
+        BENCH_U64("shards", count),
+        BENCH_U64("batch", batch),
+        BENCH_U64("capacity", capacity),
+        BENCH_U64("ops", total),
+        BENCH_U64("elapsed_ns", ns),
+        BENCH_F64("ops_per_s", ((double)total * 1e9) / (double)ns),
+        BENCH_U64("stolen", stolen),
+    };
+    if (ok)
+    {
+        bench_report(bench, fields, BENCH_ARRAY_DIM(fields));
+    }
+    else
+    {
+        (void)fprintf(stderr, "%s: %zu pairs %s failed\n", bench->suite, pairs, (sharded) ? ("sharded") : ("shared"));
+    }
+
+    (void)pthread_barrier_destroy(&start);
+    (void)cb_shard_deinit(&shard);
+    for (size_t s = 0U; s < count; s++)
+    {
+        (void)cb_deinit(&shards[s]);
+        (void)pthread_mutex_destroy(&states[s].mutex[0U]);
+        (void)pthread_mutex_destroy(&states[s].mutex[1U]);
+    }
+    free(rings);
+
+    return ok;
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Runs the scaling benchmarks of the sharded rings, against a single circular buffer shared by all the threads.
+ * @param[in] argc The number of arguments.
+ * @param[in] argv The arguments, see ::bench_init and the additional options below.
+ * @return Zero on success, non-zero otherwise.
+ */
+int main(int argc, char ** argv)
+{
+    bench_opt_t opts[] = {
+        {"pairs", "Maximum number of producer and consumer pairs, defaults to one for each processor", ""},
+        {"messages", "Number of messages in each run, defaults to 1000000, or 100000 if quick", ""},
+        {"batch", "Number of messages in each operation", "16"},
+        {"capacity", "Capacity of each shard, in messages", "1024"},
+        {"pin", "Pin each pair to a processor, 'yes' or 'no'", "yes"},
+    };
+    bench_t bench;
+    if (!bench_init(&bench, "bench_cb_shard", argc, argv, opts, BENCH_ARRAY_DIM(opts)))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Processors available to the process, a pair is pinned to each of them.
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int cpus[MAX_PAIRS];
+    size_t cpus_count = 0U;
+    const bool pin = (strcmp(opts[4U].value, "yes") == 0);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; (cpu < CPU_SETSIZE) && (cpus_count < MAX_PAIRS); cpu++)
+        {
+            if (CPU_ISSET((size_t)cpu, &set))
+            {
+                cpus[cpus_count++] = (pin) ? (cpu) : (-1);
+            }
+        }
+    }
+    // More pairs than processors are pinned round robin, or not pinned at all if the processors are unknown.
+    for (size_t c = cpus_count; c < MAX_PAIRS; c++)
+    {
+        cpus[c] = (cpus_count > 0U) ? (cpus[c % cpus_count]) : (-1);
+    }
+    cpus_count = (cpus_count == 0U) ? (1U) : (cpus_count);
+
+    const size_t pairs = (opts[0U].value[0U] != '\0') ? ((size_t)strtoull(opts[0U].value, NULL, 10)) : (cpus_count);
+    const size_t messages = (opts[1U].value[0U] != '\0') ? ((size_t)strtoull(opts[1U].value, NULL, 10))
+                            : (bench.quick)               ? (100000U)
+                                                          : (1000000U);
+    const size_t batch = (size_t)strtoull(opts[2U].value, NULL, 10);
+    const size_t capacity = (size_t)strtoull(opts[3U].value, NULL, 10);
+    if ((pairs == 0U) || (pairs > MAX_PAIRS) || (batch == 0U) || (batch > MAX_BATCH) || (capacity < batch) ||
+        (messages < (pairs * batch)))
+    {
+        (void)fprintf(stderr, "bench_cb_shard: invalid pairs, messages, batch or capacity\n");
+        return EXIT_FAILURE;
+    }
+
+    // Doubling the number of pairs up to the maximum, shared first and then sharded, so both scale side by side.
+    bool ok = true;
+    for (size_t p = 1U; ok && (p <= pairs); p = (p == pairs) ? (p + 1U) : (((2U * p) > pairs) ? (pairs) : (2U * p)))
+    {
+        ok = bench_scaling(&bench, p, false, cpus, messages, batch, capacity) &&
+             bench_scaling(&bench, p, true, cpus, messages, batch, capacity);
+    }
+
+    bench_deinit(&bench);
+
+    return (ok) ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,1003 @@
+/**
+ ***********************************************************************************************************************
+ * @file        bench_cb_threads.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_threads_benchmarks Benchmarks */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+// Required for the thread affinity functions.
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "cb/cb.h"
+#include "cb/cb_hist.h"
+#include "cb/cb_lock.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/** Lock strategy, plugged in through the lock and unlock events of the circular buffer, or built into it. */
+typedef struct
+{
+    const char * name; /**< Name of the strategy. */
+    cb_evt_handler_t evt_handler; /**< Event handler, @c NULL if the strategy does not lock or is built-in. */
+    cb_lock_id_t lock_id; /**< Built-in lock, ::cb_lock_id_evt if plugged in through the events. */
+    bool mpmc; /**< @c true if it supports multiple producers or consumers, @c false otherwise. */
+} lock_t;
+
+/** State of the lock strategies, passed as user data to the event handlers, one for each side if split. */
+typedef struct
+{
+    pthread_mutex_t mutex[2U]; /**< Mutexes, for the mutex strategy. */
+    atomic_flag flag[2U]; /**< Flags, for the spin strategy. */
+} lock_state_t;
+
+/** Scenario, the number of producers and consumers sharing a circular buffer. */
+typedef struct
+{
+    const char * name; /**< Name of the scenario. */
+    size_t producers; /**< Number of producers. */
+    size_t consumers; /**< Number of consumers. */
+} scenario_t;
+
+/** Placement of the threads in the processors. */
+typedef enum
+{
+    placement_none = 0U, /**< Not pinned, the scheduler decides. */
+    placement_same_core, /**< All threads pinned to the same logical processor. */
+    placement_smt, /**< Producers and consumers on SMT siblings of the same physical core. */
+    placement_same_socket, /**< Threads on different physical cores of the same socket. */
+    placement_cross_socket, /**< Producers and consumers on different sockets. */
+    placement_custom, /**< Threads pinned to the list of processors provided. */
+
+    placement_count /**< Number of placements. */
+} placement_t;
+
+/** Logical processor and its topology. */
+typedef struct
+{
+    int cpu; /**< Logical processor. */
+    int core; /**< Physical core. */
+    int pkg; /**< Socket. */
+} cpu_info_t;
+
+/** Context of the threads of a run. */
+typedef struct
+{
+    cb_t * cb; /**< Circular buffer, from producers to consumers, or requests in ping-pong. */
+    cb_t * resp; /**< Circular buffer for responses in ping-pong. */
+    pthread_barrier_t * start; /**< Barrier to start all threads at the same time. */
+    atomic_size_t * consumed; /**< Number of messages consumed by all consumers. */
+    size_t total; /**< Number of messages to produce by all producers. */
+    size_t messages; /**< Number of messages to produce by this thread. */
+    size_t batch; /**< Number of messages written or read in each operation. */
+    size_t first; /**< First message produced by this thread. */
+    int cpu; /**< Processor to pin the thread to, negative if not pinned. */
+    uint64_t checksum; /**< Sum of the messages consumed by this thread. */
+    uint64_t retries; /**< Number of operations that were retried, full on writes and empty on reads. */
+    cb_hist_t * hist; /**< Histogram of the round trips, in ping-pong. */
+    bool ok; /**< @c true if the thread was successful. */
+} thread_ctx_t;
+
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Maximum number of threads in a scenario. */
+#define MAX_THREADS (4U)
+/** Maximum number of logical processors considered. */
+#define MAX_CPUS    (256U)
+/** Maximum number of messages written or read in each operation. */
+#define MAX_BATCH   (256U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** If @c true, threads yield the processor when retrying, otherwise they spin. */
+static bool retry_yield;
+/** If @c true, producers and consumers lock separately, see ::cb_set_lock_split. */
+static bool lock_split;
+/** Names of the placements. */
+static const char * const placement_names[placement_count] = {
+    "none",
+    "same-core",
+    "smt",
+    "same-socket",
+    "cross-socket",
+    "custom",
+};
+/** Scenarios, the same as in the concurrency tests. */
+static const scenario_t scenarios[] = {
+    {"1p1c", 1U, 1U},
+    {"1p2c", 1U, 2U},
+    {"2p1c", 2U, 1U},
+    {"2p2c", 2U, 2U},
+};
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Event handlers of the lock strategies. */
+/** @{ */
+static cb_error_t lock_mutex_evt_handler(cb_evt_t * const evt);
+static cb_error_t lock_spin_evt_handler(cb_evt_t * const evt);
+/** @} */
+/** Lock strategies, add new ones here. */
+static const lock_t locks[] = {
+    {"atomic", NULL, cb_lock_id_evt, false},
+    {"mutex", lock_mutex_evt_handler, cb_lock_id_evt, true},
+    {"spin", lock_spin_evt_handler, cb_lock_id_evt, true},
+    {"ticket", NULL, cb_lock_id_ticket, true},
+    {"adaptive", NULL, cb_lock_id_adaptive, true},
+    {"pthread", NULL, cb_lock_id_pthread, true},
+};
+
+/** Waits before retrying an operation on a full or empty circular buffer. */
+static inline void retry_wait(void);
+/** Pins the calling thread to a processor, if not negative. */
+static bool pin_thread(const int cpu);
+/** Loads the topology of the logical processors available to the process. */
+static size_t topology_load(cpu_info_t * const cpus, const size_t max);
+/** Parses a comma separated list of processors. */
+static size_t cpus_parse(const char * const list, int * const cpus, const size_t max);
+/** Formats a list of processors, comma separated. */
+static void cpus_format(const int * const cpus, const size_t count, char * const str, const size_t size);
+/** Thread functions. */
+/** @{ */
+static void * producer_func(void * ptr);
+static void * consumer_func(void * ptr);
+static void * ping_func(void * ptr);
+static void * pong_func(void * ptr);
+/** @} */
+
+/**
+ * @addtogroup cb_threads_benchmarks
+ * @{
+ */
+
+/**
+ * @brief Resolves the processors of the threads of a placement, producers first and then consumers.
+ * @param[in] placement The placement.
+ * @param[in] topo The topology of the logical processors available.
+ * @param[in] topo_count The number of logical processors available.
+ * @param[in] producers The number of producers.
+ * @param[in] consumers The number of consumers.
+ * @param[out] cpus The processors of the threads, negative if not pinned.
+ * @return @c true if the placement is possible in this machine, @c false otherwise.
+ */
+static bool placement_resolve(const placement_t placement,
+                              const cpu_info_t * const topo,
+                              const size_t topo_count,
+                              const size_t producers,
+                              const size_t consumers,
+                              int * const cpus);
+
+/**
+ * @brief Measures the throughput, in messages per second, of producers and consumers sharing a circular buffer.
+ * @param[in] bench The benchmark context.
+ * @param[in] scenario The scenario.
+ * @param[in] lock The lock strategy.
+ * @param[in] placement The name of the placement.
+ * @param[in] cpus The processors of the threads.
+ * @param[in] messages The number of messages to produce.
+ * @param[in] batch The number of messages in each operation.
+ * @param[in] capacity The capacity of the circular buffer, in messages.
+ * @return @c true on success, @c false otherwise.
+ */
+static bool bench_throughput(bench_t * const bench,
+                             const scenario_t * const scenario,
+                             const lock_t * const lock,
+                             const char * const placement,
+                             const int * const cpus,
+                             const size_t messages,
+                             const size_t batch,
+                             const size_t capacity);
+
+/**
+ * @brief Measures the round trip latency of a message between two threads, with a circular buffer for each direction.
+ * @param[in] bench The benchmark context.
+ * @param[in] lock The lock strategy.
+ * @param[in] placement The name of the placement.
+ * @param[in] cpus The processors of the threads.
+ * @param[in] round_trips The number of round trips.
+ * @param[in] capacity The capacity of the circular buffers, in messages.
+ * @return @c true on success, @c false otherwise.
+ */
+static bool bench_pingpong(bench_t * const bench,
+                           const lock_t * const lock,
+                           const char * const placement,
+                           const int * const cpus,
+                           const size_t round_trips,
+                           const size_t capacity);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static cb_error_t lock_mutex_evt_handler(cb_evt_t * const evt)
+{
+    lock_state_t * const state = (lock_state_t *)evt->user_data;
+    const size_t side = (evt->data.lock.side == cb_lock_side_read) ? (1U) : (0U);
+
+    if (evt->id == cb_evt_id_lock)
+    {
+        (void)pthread_mutex_lock(&state->mutex[side]);
+    }
+    else if (evt->id == cb_evt_id_unlock)
+    {
+        (void)pthread_mutex_unlock(&state->mutex[side]);
+    }
+    else
+    {
+        return cb_error_evt;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t lock_spin_evt_handler(cb_evt_t * const evt)
+{
+    lock_state_t * const state = (lock_state_t *)evt->user_data;
+    const size_t side = (evt->data.lock.side == cb_lock_side_read) ? (1U) : (0U);
+
+    if (evt->id == cb_evt_id_lock)
+    {
+        while (atomic_flag_test_and_set_explicit(&state->flag[side], memory_order_acquire))
+        {
+            retry_wait();
+        }
+    }
+    else if (evt->id == cb_evt_id_unlock)
+    {
+        atomic_flag_clear_explicit(&state->flag[side], memory_order_release);
+    }
+    else
+    {
+        return cb_error_evt;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static inline void retry_wait(void)
+{
+    if (retry_yield)
+    {
+        (void)sched_yield();
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool pin_thread(const int cpu)
+{
+    if (cpu < 0)
+    {
+        return true;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((size_t)cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t topology_load(cpu_info_t * const cpus, const size_t max)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0)
+    {
+        return 0U;
+    }
+
+    size_t count = 0U;
+    for (int cpu = 0; (cpu < CPU_SETSIZE) && (count < max); cpu++)
+    {
+        if (!CPU_ISSET((size_t)cpu, &set))
+        {
+            continue;
+        }
+
+        // Read core and socket from sysfs, if not available assume each processor is a core in the same socket.
+        static const char * const files[] = {"core_id", "physical_package_id"};
+        int values[2U] = {cpu, 0};
+        for (size_t f = 0U; f < BENCH_ARRAY_DIM(files); f++)
+        {
+            char path[128U];
+            (void)snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, files[f]);
+            FILE * const file = fopen(path, "r");
+            if (file != NULL)
+            {
+                if (fscanf(file, "%d", &values[f]) != 1)
+                {
+                    values[f] = (f == 0U) ? (cpu) : (0);
+                }
+                (void)fclose(file);
+            }
+        }
+        cpus[count].cpu = cpu;
+        cpus[count].core = values[0U];
+        cpus[count].pkg = values[1U];
+        count++;
+    }
+
+    return count;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t cpus_parse(const char * const list, int * const cpus, const size_t max)
+{
+    size_t count = 0U;
+    const char * str = list;
+    while ((*str != '\0') && (count < max))
+    {
+        char * end = NULL;
+        cpus[count++] = (int)strtol(str, &end, 10);
+        str = (*end == ',') ? (end + 1) : (end);
+        if (end == str)
+        {
+            break;
+        }
+    }
+    return count;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cpus_format(const int * const cpus, const size_t count, char * const str, const size_t size)
+{
+    size_t len = 0U;
+    str[0U] = '\0';
+    for (size_t i = 0U; (i < count) && (len < size); i++)
+    {
+        const int written = (cpus[i] < 0) ? (snprintf(&str[len], size - len, "%s-", (i == 0U) ? ("") : (" ")))
+                                           : (snprintf(&str[len], size - len, "%s%d", (i == 0U) ? ("") : (" "), cpus[i]));
+        len += (written > 0) ? ((size_t)written) : (0U);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool placement_resolve(const placement_t placement,
+                              const cpu_info_t * const topo,
+                              const size_t topo_count,
+                              const size_t producers,
+                              const size_t consumers,
+                              int * const cpus)
+{
+    const size_t threads = producers + consumers;
+    if (topo_count == 0U)
+    {
+        return false;
+    }
+
+    switch (placement)
+    {
+        case placement_none:
+        {
+            for (size_t t = 0U; t < threads; t++)
+            {
+                cpus[t] = -1;
+            }
+            return true;
+        }
+
+        case placement_same_core:
+        {
+            for (size_t t = 0U; t < threads; t++)
+            {
+                cpus[t] = topo[0U].cpu;
+            }
+            return true;
+        }
+
+        case placement_smt:
+        {
+            // Producers on a logical processor and consumers on a sibling of the same physical core.
+            for (size_t a = 0U; a < topo_count; a++)
+            {
+                for (size_t b = a + 1U; b < topo_count; b++)
+                {
+                    if ((topo[a].core == topo[b].core) && (topo[a].pkg == topo[b].pkg))
+                    {
+                        for (size_t t = 0U; t < threads; t++)
+                        {
+                            cpus[t] = (t < producers) ? (topo[a].cpu) : (topo[b].cpu);
+                        }
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        case placement_same_socket:
+        case placement_cross_socket:
+        {
+            // Collect one logical processor of each physical core, for the socket of the producers and consumers.
+            int pcores[MAX_THREADS];
+            int ccores[MAX_THREADS];
+            size_t pcount = 0U;
+            size_t ccount = 0U;
+            const int ppkg = topo[0U].pkg;
+            int cpkg = ppkg;
+            if (placement == placement_cross_socket)
+            {
+                for (size_t i = 0U; (i < topo_count) && (cpkg == ppkg); i++)
+                {
+                    cpkg = topo[i].pkg;
+                }
+                if (cpkg == ppkg)
+                {
+                    return false;
+                }
+            }
+            for (size_t i = 0U; i < topo_count; i++)
+            {
+                bool seen = false;
+                for (size_t j = 0U; j < i; j++)
+                {
+                    seen = seen || ((topo[j].core == topo[i].core) && (topo[j].pkg == topo[i].pkg));
+                }
+                if (!seen && (topo[i].pkg == ppkg) && (pcount < MAX_THREADS))
+                {
+                    pcores[pcount++] = topo[i].cpu;
+                }
+                if (!seen && (topo[i].pkg == cpkg) && (ccount < MAX_THREADS))
+                {
+                    ccores[ccount++] = topo[i].cpu;
+                }
+            }
+
+            if (placement == placement_same_socket)
+            {
+                // All threads on different cores of the same socket, round robin if there are not enough cores.
+                if (pcount < 2U)
+                {
+                    return false;
+                }
+                for (size_t t = 0U; t < threads; t++)
+                {
+                    cpus[t] = pcores[t % pcount];
+                }
+            }
+            else
+            {
+                for (size_t t = 0U; t < threads; t++)
+                {
+                    cpus[t] = (t < producers) ? (pcores[t % pcount]) : (ccores[(t - producers) % ccount]);
+                }
+            }
+            return true;
+        }
+
+        case placement_custom:
+        case placement_count:
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer_func(void * ptr)
+{
+    thread_ctx_t * const ctx = (thread_ctx_t *)ptr;
+    uint64_t msgs[MAX_BATCH];
+
+    ctx->ok = pin_thread(ctx->cpu);
+    (void)pthread_barrier_wait(ctx->start);
+
+    for (size_t sent = 0U; ctx->ok && (sent < ctx->messages); sent += ctx->batch)
+    {
+        for (size_t i = 0U; i < ctx->batch; i++)
+        {
+            msgs[i] = (uint64_t)(ctx->first + sent + i);
+        }
+        for (;;)
+        {
+            const cb_error_t error = cb_write(ctx->cb, msgs, ctx->batch);
+            if (error == cb_error_ok)
+            {
+                break;
+            }
+            ctx->ok = (error == cb_error_full);
+            if (!ctx->ok)
+            {
+                break;
+            }
+            ctx->retries++;
+            retry_wait();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * consumer_func(void * ptr)
+{
+    thread_ctx_t * const ctx = (thread_ctx_t *)ptr;
+    uint64_t msgs[MAX_BATCH];
+
+    ctx->ok = pin_thread(ctx->cpu);
+    (void)pthread_barrier_wait(ctx->start);
+
+    // Consume until all the messages have been consumed, by this or other consumers.
+    while (ctx->ok && (atomic_load_explicit(ctx->consumed, memory_order_relaxed) < ctx->total))
+    {
+        const cb_error_t error = cb_read(ctx->cb, msgs, ctx->batch);
+        if (error == cb_error_ok)
+        {
+            for (size_t i = 0U; i < ctx->batch; i++)
+            {
+                ctx->checksum += msgs[i];
+            }
+            (void)atomic_fetch_add_explicit(ctx->consumed, ctx->batch, memory_order_relaxed);
+        }
+        else
+        {
+            ctx->ok = (error == cb_error_empty);
+            ctx->retries++;
+            retry_wait();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * ping_func(void * ptr)
+{
+    thread_ctx_t * const ctx = (thread_ctx_t *)ptr;
+
+    ctx->ok = pin_thread(ctx->cpu);
+    (void)pthread_barrier_wait(ctx->start);
+
+    for (size_t i = 0U; ctx->ok && (i < ctx->messages); i++)
+    {
+        const uint64_t start = bench_now_ns();
+        uint64_t msg = (uint64_t)i;
+
+        // Send request, then wait for the response.
+        cb_error_t error = cb_write(ctx->cb, &msg, 1U);
+        while (error == cb_error_full)
+        {
+            ctx->retries++;
+            retry_wait();
+            error = cb_write(ctx->cb, &msg, 1U);
+        }
+        if (error == cb_error_ok)
+        {
+            error = cb_read(ctx->resp, &msg, 1U);
+            while (error == cb_error_empty)
+            {
+                ctx->retries++;
+                retry_wait();
+                error = cb_read(ctx->resp, &msg, 1U);
+            }
+        }
+
+        ctx->ok = (error == cb_error_ok) && (msg == (uint64_t)i);
+        (void)cb_hist_record(ctx->hist, bench_now_ns() - start);
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * pong_func(void * ptr)
+{
+    thread_ctx_t * const ctx = (thread_ctx_t *)ptr;
+
+    ctx->ok = pin_thread(ctx->cpu);
+    (void)pthread_barrier_wait(ctx->start);
+
+    for (size_t i = 0U; ctx->ok && (i < ctx->messages); i++)
+    {
+        uint64_t msg = 0U;
+
+        // Wait for request, then send it back as response.
+        cb_error_t error = cb_read(ctx->cb, &msg, 1U);
+        while (error == cb_error_empty)
+        {
+            ctx->retries++;
+            retry_wait();
+            error = cb_read(ctx->cb, &msg, 1U);
+        }
+        if (error == cb_error_ok)
+        {
+            error = cb_write(ctx->resp, &msg, 1U);
+            while (error == cb_error_full)
+            {
+                ctx->retries++;
+                retry_wait();
+                error = cb_write(ctx->resp, &msg, 1U);
+            }
+        }
+
+        ctx->ok = (error == cb_error_ok);
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool bench_throughput(bench_t * const bench,
+                             const scenario_t * const scenario,
+                             const lock_t * const lock,
+                             const char * const placement,
+                             const int * const cpus,
+                             const size_t messages,
+                             const size_t batch,
+                             const size_t capacity)
+{
+    const size_t threads = scenario->producers + scenario->consumers;
+    // Each producer sends the same number of messages, a multiple of the batch.
+    const size_t per_producer = ((messages / scenario->producers) / batch) * batch;
+    const size_t total = per_producer * scenario->producers;
+
+    // Initialize circular buffer with the lock strategy.
+    uint64_t * const ring = malloc((capacity + 1U) * sizeof(uint64_t));
+    lock_state_t state = {.flag = {ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT}};
+    (void)pthread_mutex_init(&state.mutex[0U], NULL);
+    (void)pthread_mutex_init(&state.mutex[1U], NULL);
+    cb_t cb;
+    (void)memset(&cb, 0, sizeof(cb));
+    bool ok = (ring != NULL) &&
+              (cb_init(&cb,
+                       ring,
+                       capacity + 1U,
+                       sizeof(uint64_t),
+                       lock->evt_handler,
+                       (lock->evt_handler != NULL) ? (cb_evt_id_lock | cb_evt_id_unlock) : (cb_evt_id_none),
+                       &state) == cb_error_ok) &&
+              (cb_set_lock(&cb, lock->lock_id) == cb_error_ok) && (cb_set_lock_split(&cb, lock_split) == cb_error_ok);
+
+    // Start all threads at the same time, along with this one.
+    pthread_barrier_t start;
+    (void)pthread_barrier_init(&start, NULL, (unsigned int)(threads + 1U));
+    atomic_size_t consumed;
+    atomic_init(&consumed, 0U);
+    pthread_t ids[MAX_THREADS];
+    thread_ctx_t ctxs[MAX_THREADS];
+    size_t started = 0U;
+    for (size_t t = 0U; ok && (t < threads); t++)
+    {
+        const bool producer = (t < scenario->producers);
+        ctxs[t] = (thread_ctx_t){
+            .cb = &cb,
+            .start = &start,
+            .consumed = &consumed,
+            .total = total,
+            .messages = per_producer,
+            .batch = batch,
+            .first = t * per_producer,
+            .cpu = cpus[t],
+        };
+        ok = (pthread_create(&ids[t], NULL, (producer) ? (producer_func) : (consumer_func), &ctxs[t]) == 0);
+        started += (ok) ? (1U) : (0U);
+    }
+    if (!ok)
+    {
+        // Threads can't be joined if not all started, as they would wait forever at the barrier.
+        (void)fprintf(stderr, "%s: can't create threads\n", bench->suite);
+        exit(EXIT_FAILURE);
+    }
+
+    (void)pthread_barrier_wait(&start);
+    const uint64_t t0 = bench_now_ns();
+    for (size_t t = 0U; t < started; t++)
+    {
+        (void)pthread_join(ids[t], NULL);
+    }
+    const uint64_t ns = bench_now_ns() - t0;
+
+    // Check all messages were consumed, only once.
+    uint64_t checksum = 0U;
+    uint64_t write_retries = 0U;
+    uint64_t read_retries = 0U;
+    for (size_t t = 0U; t < threads; t++)
+    {
+        ok = ok && ctxs[t].ok;
+        checksum += ctxs[t].checksum;
+        write_retries += (t < scenario->producers) ? (ctxs[t].retries) : (0U);
+        read_retries += (t < scenario->producers) ? (0U) : (ctxs[t].retries);
+    }
+    ok = ok && (checksum == (((uint64_t)total * ((uint64_t)total - 1U)) / 2U));
+
+    char cpus_str[64U];
+    cpus_format(cpus, threads, cpus_str, sizeof(cpus_str));
+    const bench_field_t fields[] = {
+        BENCH_STR("mode", "throughput"),
+        BENCH_STR("scenario", scenario->name),
+        BENCH_STR("lock", lock->name),
+        BENCH_STR("split", (lock_split) ? ("yes") : ("no")),
+        BENCH_STR("placement", placement),
+        BENCH_STR("cpus", cpus_str),
+        BENCH_STR("retry", (retry_yield) ? ("yield") : ("spin")),
+        BENCH_U64("batch", batch),
+        BENCH_U64("capacity", capacity),
+        BENCH_U64("ops", total),
+        BENCH_U64("elapsed_ns", ns),
+        BENCH_F64("ops_per_s", ((double)total * 1e9) / (double)ns),
+        BENCH_U64("write_retries", write_retries),
+        BENCH_U64("read_retries", read_retries),
+        BENCH_U64("p50_ns", 0U),
+        BENCH_U64("p99_ns", 0U),
+        BENCH_U64("p999_ns", 0U),
+    };
+    if (ok)
+    {
+        bench_report(bench, fields, BENCH_ARRAY_DIM(fields));
+    }
+    else
+    {
+        (void)fprintf(stderr, "%s: %s with %s lock failed\n", bench->suite, scenario->name, lock->name);
+    }
+
+    (void)pthread_barrier_destroy(&start);
+    (void)cb_deinit(&cb);
+    (void)pthread_mutex_destroy(&state.mutex[0U]);
+    (void)pthread_mutex_destroy(&state.mutex[1U]);
+    free(ring);
+
+    return ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool bench_pingpong(bench_t * const bench,
+                           const lock_t * const lock,
+                           const char * const placement,
+                           const int * const cpus,
+                           const size_t round_trips,
+                           const size_t capacity)
+{
+    // Initialize circular buffers for requests and responses with the lock strategy, and the histogram.
+    uint64_t * const rings = malloc(2U * (capacity + 1U) * sizeof(uint64_t));
+    lock_state_t states[2U] = {{.flag = {ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT}},
+                               {.flag = {ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT}}};
+    cb_t cbs[2U];
+    (void)memset(cbs, 0, sizeof(cbs));
+    static cb_hist_t hist;
+    bool ok = (rings != NULL) && (cb_hist_init(&hist) == cb_error_ok);
+    for (size_t i = 0U; ok && (i < 2U); i++)
+    {
+        (void)pthread_mutex_init(&states[i].mutex[0U], NULL);
+        (void)pthread_mutex_init(&states[i].mutex[1U], NULL);
+        ok = (cb_init(&cbs[i],
+                      &rings[i * (capacity + 1U)],
+                      capacity + 1U,
+                      sizeof(uint64_t),
+                      lock->evt_handler,
+                      (lock->evt_handler != NULL) ? (cb_evt_id_lock | cb_evt_id_unlock) : (cb_evt_id_none),
+                      &states[i]) == cb_error_ok) &&
+             (cb_set_lock(&cbs[i], lock->lock_id) == cb_error_ok) &&
+             (cb_set_lock_split(&cbs[i], lock_split) == cb_error_ok);
+    }
+
+    pthread_barrier_t start;
+    (void)pthread_barrier_init(&start, NULL, 3U);
+    pthread_t ids[2U];
+    thread_ctx_t ctxs[2U];
+    for (size_t t = 0U; ok && (t < 2U); t++)
+    {
+        ctxs[t] = (thread_ctx_t){
+            .cb = &cbs[0U],
+            .resp = &cbs[1U],
+            .start = &start,
+            .messages = round_trips,
+            .cpu = cpus[t],
+            .hist = &hist,
+        };
+        ok = (pthread_create(&ids[t], NULL, (t == 0U) ? (ping_func) : (pong_func), &ctxs[t]) == 0);
+        if (!ok)
+        {
+            (void)fprintf(stderr, "%s: can't create threads\n", bench->suite);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    (void)pthread_barrier_wait(&start);
+    const uint64_t t0 = bench_now_ns();
+    for (size_t t = 0U; t < 2U; t++)
+    {
+        (void)pthread_join(ids[t], NULL);
+        ok = ok && ctxs[t].ok;
+    }
+    const uint64_t ns = bench_now_ns() - t0;
+
+    uint64_t p50 = 0U;
+    uint64_t p99 = 0U;
+    uint64_t p999 = 0U;
+    ok = ok && (cb_hist_percentile(&hist, 50.0, &p50) == cb_error_ok) &&
+         (cb_hist_percentile(&hist, 99.0, &p99) == cb_error_ok) &&
+         (cb_hist_percentile(&hist, 99.9, &p999) == cb_error_ok);
+
+    char cpus_str[64U];
+    cpus_format(cpus, 2U, cpus_str, sizeof(cpus_str));
+    const bench_field_t fields[] = {
+        BENCH_STR("mode", "pingpong"),
+        BENCH_STR("scenario", "1p1c"),
+        BENCH_STR("lock", lock->name),
+        BENCH_STR("split", (lock_split) ? ("yes") : ("no")),
+        BENCH_STR("placement", placement),
+        BENCH_STR("cpus", cpus_str),
+        BENCH_STR("retry", (retry_yield) ? ("yield") : ("spin")),
+        BENCH_U64("batch", 1U),
+        BENCH_U64("capacity", capacity),
+        BENCH_U64("ops", round_trips),
+        BENCH_U64("elapsed_ns", ns),
+        BENCH_F64("ops_per_s", ((double)round_trips * 1e9) / (double)ns),
+        BENCH_U64("write_retries", 0U),
+        BENCH_U64("read_retries", ctxs[0U].retries + ctxs[1U].retries),
+        BENCH_U64("p50_ns", p50),
+        BENCH_U64("p99_ns", p99),
+        BENCH_U64("p999_ns", p999),
+    };
+    if (ok)
+    {
+        bench_report(bench, fields, BENCH_ARRAY_DIM(fields));
+    }
+    else
+    {
+        (void)fprintf(stderr, "%s: ping-pong with %s lock failed\n", bench->suite, lock->name);
+    }
+
+    (void)pthread_barrier_destroy(&start);
+    for (size_t i = 0U; i < 2U; i++)
+    {
+        (void)cb_deinit(&cbs[i]);
+        (void)pthread_mutex_destroy(&states[i].mutex[0U]);
+        (void)pthread_mutex_destroy(&states[i].mutex[1U]);
+    }
+    free(rings);
+
+    return ok;
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Runs the multi-threaded benchmarks of the circular buffer, for each scenario, lock strategy and placement.
+ * @param[in] argc The number of arguments.
+ * @param[in] argv The arguments, see ::bench_init and the additional options below.
+ * @return Zero on success, non-zero otherwise.
+ */
+int main(int argc, char ** argv)
+{
+    bench_opt_t opts[] = {
+        {"placement", "Comma separated placements, 'none', 'same-core', 'smt', 'same-socket', 'cross-socket'", "all"},
+        {"cpus", "Comma separated processors for the threads, producers first, overrides the placements", ""},
+        {"lock",
+         "Comma separated lock strategies, 'atomic', 'mutex' or 'spin' with events, or 'ticket', 'adaptive' or "
+         "'pthread' built-in",
+         "all"},
+        {"retry", "Retry policy on full or empty, 'spin', 'yield' or 'auto' to yield if threads share a processor",
+         "auto"},
+        {"messages", "Number of messages in throughput runs, defaults to 1000000, or 100000 if quick", ""},
+        {"round-trips", "Number of round trips in ping-pong runs, defaults to 100000, or 10000 if quick", ""},
+        {"batch", "Number of messages in each operation in throughput runs", "1"},
+        {"capacity", "Capacity of the circular buffers, in messages", "1024"},
+        {"split", "Lock producers and consumers separately, 'no', 'yes' or 'all' for both", "all"},
+    };
+    bench_t bench;
+    if (!bench_init(&bench, "bench_cb_threads", argc, argv, opts, BENCH_ARRAY_DIM(opts)))
+    {
+        return EXIT_FAILURE;
+    }
+    const char * const opt_placement = opts[0U].value;
+    const char * const opt_cpus = opts[1U].value;
+    const char * const opt_lock = opts[2U].value;
+    const char * const opt_retry = opts[3U].value;
+    const size_t messages = (opts[4U].value[0U] != '\0') ? ((size_t)strtoull(opts[4U].value, NULL, 10))
+                            : (bench.quick)               ? (100000U)
+                                                          : (1000000U);
+    const size_t round_trips = (opts[5U].value[0U] != '\0') ? ((size_t)strtoull(opts[5U].value, NULL, 10))
+                               : (bench.quick)               ? (10000U)
+                                                             : (100000U);
+    const size_t batch = (size_t)strtoull(opts[6U].value, NULL, 10);
+    const size_t capacity = (size_t)strtoull(opts[7U].value, NULL, 10);
+    const char * const opt_split = opts[8U].value;
+    if ((batch == 0U) || (batch > MAX_BATCH) || (capacity < batch) || (messages < (2U * batch)) ||
+        (round_trips == 0U))
+    {
+        (void)fprintf(stderr, "bench_cb_threads: invalid messages, round trips, batch or capacity\n");
+        return EXIT_FAILURE;
+    }
+
+    // Topology of the processors available, and custom list of processors if any.
+    static cpu_info_t topo[MAX_CPUS];
+    const size_t topo_count = topology_load(topo, MAX_CPUS);
+    int custom[MAX_THREADS];
+    const size_t custom_count = cpus_parse(opt_cpus, custom, MAX_THREADS);
+
+    bool ok = true;
+    for (size_t p = 0U; ok && (p < placement_count); p++)
+    {
+        const placement_t placement = (placement_t)p;
+        if (((custom_count > 0U) != (placement == placement_custom)) ||
+            ((custom_count == 0U) && (strcmp(opt_placement, "all") != 0) &&
+             (strstr(opt_placement, placement_names[p]) == NULL)))
+        {
+            continue;
+        }
+        int cpus[MAX_THREADS];
+        if ((placement != placement_custom) &&
+            !placement_resolve(placement, topo, topo_count, scenarios[0U].producers, scenarios[0U].consumers, cpus))
+        {
+            (void)fprintf(stderr, "bench_cb_threads: placement '%s' not possible, skipped\n", placement_names[p]);
+            continue;
+        }
+
+        for (size_t l = 0U; ok && (l < BENCH_ARRAY_DIM(locks)); l++)
+        {
+            if ((strcmp(opt_lock, "all") != 0) && (strstr(opt_lock, locks[l].name) == NULL))
+            {
+                continue;
+            }
+
+            // With and without split locks, if the strategy locks at all.
+            for (size_t split = 0U; ok && (split < 2U); split++)
+            {
+                lock_split = (split == 1U);
+                if ((lock_split && !locks[l].mpmc) || ((strcmp(opt_split, "all") != 0) &&
+                                                       (strcmp(opt_split, (lock_split) ? ("yes") : ("no")) != 0)))
+                {
+                    continue;
+                }
+
+                // Throughput for each scenario, then ping-pong.
+                for (size_t s = 0U; ok && (s <= BENCH_ARRAY_DIM(scenarios)); s++)
+                {
+                    const bool pingpong = (s == BENCH_ARRAY_DIM(scenarios));
+                    const scenario_t * const scenario = (pingpong) ? (&scenarios[0U]) : (&scenarios[s]);
+                    const size_t threads = scenario->producers + scenario->consumers;
+                    if ((!locks[l].mpmc) && (threads > 2U))
+                    {
+                        continue;
+                    }
+
+                    if (placement == placement_custom)
+                    {
+                        for (size_t t = 0U; t < MAX_THREADS; t++)
+                        {
+                            cpus[t] = custom[t % custom_count];
+                        }
+                    }
+                    else
+                    {
+                        (void)placement_resolve(placement, topo, topo_count, scenario->producers, scenario->consumers, cpus);
+                    }
+
+                    // Spinning is pathological if threads share a processor, yield instead unless told otherwise.
+                    bool shared = (placement == placement_none) && (topo_count < threads);
+                    for (size_t a = 0U; (placement != placement_none) && (a < threads); a++)
+                    {
+                        for (size_t b = a + 1U; b < threads; b++)
+                        {
+                            shared = shared || (cpus[a] == cpus[b]);
+                        }
+                    }
+                    retry_yield = (strcmp(opt_retry, "yield") == 0) || ((strcmp(opt_retry, "auto") == 0) && shared);
+
+                    ok = (pingpong)
+                             ? (bench_pingpong(&bench, &locks[l], placement_names[p], cpus, round_trips, capacity))
+                             : (bench_throughput(
+                                   &bench, scenario, &locks[l], placement_names[p], cpus, messages, batch, capacity));
+                }
+            }
+        }
+    }
+
+    bench_deinit(&bench);
+
+    return (ok) ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,474 @@
+/**
+ ***********************************************************************************************************************
+ * @file        perf_cb.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_perf Performance Regression Gate */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "bench.h"
+#include "cb/cb.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/** Case of the performance regression gate. */
+typedef struct
+{
+    size_t elem_size; /**< Size of the elements, in bytes. */
+    size_t batch; /**< Number of elements written or read on each operation. */
+    bool wrap; /**< If @c true, operations periodically wrap around, otherwise they never do. */
+} perf_case_t;
+
+/** Result of a case, for writes or reads, and its baseline. */
+typedef struct
+{
+    char name[64U]; /**< Name of the result, <tt>op/elem_size/batch/pattern</tt>. */
+    double calib_ns; /**< Median time per step of the calibration loop, in nanoseconds. */
+    double ns_per_elem; /**< Median time per element, in nanoseconds. */
+    double normalized; /**< Median time per element, relative to the calibration loop measured along with it. */
+    double baseline; /**< Normalized time in the baseline, negative if not in the baseline. */
+} perf_result_t;
+
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Capacity of the circular buffer, in bytes, small enough to stay in the L1 cache. */
+#define PERF_RING_BYTES   (16U * 1024U)
+/** Number of steps of the calibration loop between timestamps. */
+#define PERF_CALIB_STEPS  (100000U)
+/** Maximum number of repetitions of each case. */
+#define PERF_MAX_REPS     (31U)
+/** Number of times a case that regressed is measured again before reporting the regression. */
+#define PERF_RETRIES      (2U)
+/** Maximum number of lines in the baseline file. */
+#define PERF_MAX_BASELINE (256U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Fixed subset of cases, changing it requires recording a new baseline. */
+static const perf_case_t cases[] = {
+    {1U, 1U, false},
+    {1U, 16U, false},
+    {1U, 16U, true},
+    {8U, 1U, false},
+    {8U, 16U, false},
+    {8U, 16U, true},
+    {64U, 1U, false},
+    {64U, 16U, false},
+    {64U, 16U, true},
+};
+/** Results, a write and a read for each case. */
+static perf_result_t results[2U * BENCH_ARRAY_DIM(cases)];
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_perf
+ * @{
+ */
+
+/**
+ * @brief Measures the calibration loop, a chain of dependent multiplications whose time depends only on the clock of
+ * the processor, to normalize results across machines.
+ * @param[in] bench The benchmark context.
+ * @return The time per step of the chain, in nanoseconds.
+ */
+static double perf_calibrate(const bench_t * const bench);
+
+/**
+ * @brief Calculates the median of some values, sorting them.
+ * @param[in,out] values The values.
+ * @param[in] count The number of values.
+ * @return The median.
+ */
+static double perf_median(double * const values, const size_t count);
+
+/**
+ * @brief Measures ::cb_write and ::cb_read for a case, filling and draining the circular buffer on each round.
+ *
+ * The calibration loop is measured right before each repetition and each repetition is normalized against it, so
+ * that both are equally affected by changes in the frequency of the processor or by other processes.
+ * @param[in] bench The benchmark context.
+ * @param[in] perf_case The case.
+ * @param[in] reps The number of repetitions, the median is taken.
+ * @param[out] wr The result for the writes.
+ * @param[out] rd The result for the reads.
+ * @return @c true on success, @c false otherwise.
+ */
+static bool perf_measure(const bench_t * const bench,
+                         const perf_case_t * const perf_case,
+                         const size_t reps,
+                         perf_result_t * const wr,
+                         perf_result_t * const rd);
+
+/**
+ * @brief Checks if a result regressed relative to its baseline.
+ * @param[in] result The result.
+ * @param[in] tolerance The maximum slowdown allowed relative to the baseline, as a percentage.
+ * @return @c true if the result is in the baseline and regressed, @c false otherwise.
+ */
+static bool perf_regressed(const perf_result_t * const result, const double tolerance);
+
+/**
+ * @brief Loads the baselines of a build type into the results.
+ * @param[in] path The path to the baseline file.
+ * @param[in] build The build type.
+ * @return @c true on success, @c false if the file could not be opened.
+ */
+static bool perf_baseline_load(const char * const path, const char * const build);
+
+/**
+ * @brief Stores the results as the baselines of a build type, keeping the baselines of other build types.
+ * @param[in] path The path to the baseline file.
+ * @param[in] build The build type.
+ * @return @c true on success, @c false if the file could not be written.
+ */
+static bool perf_baseline_store(const char * const path, const char * const build);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static double perf_calibrate(const bench_t * const bench)
+{
+    // Seed not known at compile time, so the chain can't be computed by the compiler.
+    static volatile uint64_t seed = 1U;
+    uint64_t value = seed;
+    uint64_t ns = 0U;
+    uint64_t steps = 0U;
+
+    while (ns < bench->min_time_ns)
+    {
+        const uint64_t t0 = bench_now_ns();
+        for (size_t i = 0U; i < PERF_CALIB_STEPS; i++)
+        {
+            value = (value * 6364136223846793005U) + 1442695040888963407U;
+        }
+        bench_clobber(&value);
+        ns += bench_now_ns() - t0;
+        steps += PERF_CALIB_STEPS;
+    }
+    seed = value;
+
+    return (double)ns / (double)steps;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static double perf_median(double * const values, const size_t count)
+{
+    // Insertion sort, there are only a few values.
+    for (size_t i = 1U; i < count; i++)
+    {
+        const double value = values[i];
+        size_t j = i;
+        for (; (j > 0U) && (values[j - 1U] > value); j--)
+        {
+            values[j] = values[j - 1U];
+        }
+        values[j] = value;
+    }
+
+    return ((count % 2U) == 1U) ? (values[count / 2U]) : ((values[(count / 2U) - 1U] + values[count / 2U]) / 2.0);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool perf_measure(const bench_t * const bench,
+                         const perf_case_t * const perf_case,
+                         const size_t reps,
+                         perf_result_t * const wr,
+                         perf_result_t * const rd)
+{
+    // Same shape as in the benchmarks, aligned to the batch so operations never wrap, or offset so they do.
+    const size_t batch = perf_case->batch;
+    const size_t length = (((PERF_RING_BYTES / perf_case->elem_size) / batch) * batch) +
+                          ((perf_case->wrap) ? (batch / 2U) : (0U));
+    const size_t ops_per_round = (length - 1U) / batch;
+
+    uint8_t * const ring = malloc(length * perf_case->elem_size);
+    uint8_t * const src = malloc(batch * perf_case->elem_size);
+    uint8_t * const dst = malloc(batch * perf_case->elem_size);
+    cb_t cb;
+    bool ok = (ring != NULL) && (src != NULL) && (dst != NULL);
+    if (ok)
+    {
+        (void)memset(src, 0xA5, batch * perf_case->elem_size);
+        ok = (cb_init(&cb, ring, length, perf_case->elem_size, NULL, cb_evt_id_none, NULL) == cb_error_ok);
+    }
+
+    // Samples of each repetition: calibration, writes, reads, normalized writes and normalized reads.
+    double samples[5U][PERF_MAX_REPS];
+    for (size_t r = 0U; ok && (r <= reps); r++)
+    {
+        const double calib_ns = perf_calibrate(bench);
+        uint64_t wns = 0U;
+        uint64_t rns = 0U;
+        uint64_t elems = 0U;
+        while (ok && ((wns + rns) < bench->min_time_ns))
+        {
+            const uint64_t t0 = bench_now_ns();
+            for (size_t i = 0U; ok && (i < ops_per_round); i++)
+            {
+                ok = (cb_write(&cb, src, batch) == cb_error_ok);
+            }
+            const uint64_t t1 = bench_now_ns();
+            for (size_t i = 0U; ok && (i < ops_per_round); i++)
+            {
+                ok = (cb_read(&cb, dst, batch) == cb_error_ok);
+            }
+            const uint64_t t2 = bench_now_ns();
+            bench_clobber(dst);
+
+            wns += t1 - t0;
+            rns += t2 - t1;
+            elems += ops_per_round * batch;
+        }
+
+        // The first repetition is a warm up.
+        if (r > 0U)
+        {
+            samples[0U][r - 1U] = calib_ns;
+            samples[1U][r - 1U] = (double)wns / (double)elems;
+            samples[2U][r - 1U] = (double)rns / (double)elems;
+            samples[3U][r - 1U] = samples[1U][r - 1U] / calib_ns;
+            samples[4U][r - 1U] = samples[2U][r - 1U] / calib_ns;
+        }
+    }
+
+    // The median filters out the repetitions disturbed by other processes.
+    if (ok)
+    {
+        wr->calib_ns = perf_median(samples[0U], reps);
+        rd->calib_ns = wr->calib_ns;
+        wr->ns_per_elem = perf_median(samples[1U], reps);
+        rd->ns_per_elem = perf_median(samples[2U], reps);
+        wr->normalized = perf_median(samples[3U], reps);
+        rd->normalized = perf_median(samples[4U], reps);
+    }
+
+    free(ring);
+    free(src);
+    free(dst);
+
+    return ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool perf_regressed(const perf_result_t * const result, const double tolerance)
+{
+    return (result->baseline > 0.0) && (result->normalized > (result->baseline * (1.0 + (tolerance / 100.0))));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool perf_baseline_load(const char * const path, const char * const build)
+{
+    FILE * const file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    char line[256U];
+    while (fgets(line, (int)sizeof(line), file) != NULL)
+    {
+        // Lines are 'build,name,normalized', skip comments and the header.
+        char line_build[64U];
+        char line_name[64U];
+        double normalized = 0.0;
+        if ((line[0U] == '#') || (sscanf(line, "%63[^,],%63[^,],%lf", line_build, line_name, &normalized) != 3) ||
+            (strcmp(line_build, build) != 0))
+        {
+            continue;
+        }
+        for (size_t i = 0U; i < BENCH_ARRAY_DIM(results); i++)
+        {
+            if (strcmp(results[i].name, line_name) == 0)
+            {
+                results[i].baseline = normalized;
+            }
+        }
+    }
+    (void)fclose(file);
+
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static bool perf_baseline_store(const char * const path, const char * const build)
+{
+    // Keep the lines of the other build types, the file might not exist yet.
+    static char kept[PERF_MAX_BASELINE][256U];
+    size_t kept_count = 0U;
+    FILE * file = fopen(path, "r");
+    if (file != NULL)
+    {
+        char line[256U];
+        while ((fgets(line, (int)sizeof(line), file) != NULL) && (kept_count < PERF_MAX_BASELINE))
+        {
+            const size_t len = strlen(build);
+            if ((line[0U] != '#') && (strncmp(line, "build,", 6U) != 0) &&
+                !((strncmp(line, build, len) == 0) && (line[len] == ',')))
+            {
+                (void)strcpy(kept[kept_count++], line);
+            }
+        }
+        (void)fclose(file);
+    }
+
+    file = fopen(path, "w");
+    if (file == NULL)
+    {
+        return false;
+    }
+    (void)fprintf(file,
+                  "# Baselines of the performance regression gate of the circular buffer, times per element relative\n"
+                  "# to the calibration loop, record them again with '--mode record' after intended changes.\n"
+                  "build,name,normalized\n");
+    for (size_t i = 0U; i < kept_count; i++)
+    {
+        (void)fputs(kept[i], file);
+    }
+    for (size_t i = 0U; i < BENCH_ARRAY_DIM(results); i++)
+    {
+        (void)fprintf(file, "%s,%s,%.4f\n", build, results[i].name, results[i].normalized);
+    }
+
+    return fclose(file) == 0;
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Runs the performance regression gate, compares a fixed subset of the benchmarks of ::cb_write and ::cb_read
+ * against the baselines, or records new baselines.
+ * @param[in] argc The number of arguments.
+ * @param[in] argv The arguments, see ::bench_init and the additional options below.
+ * @return Zero if there are no regressions, non-zero otherwise.
+ */
+int main(int argc, char ** argv)
+{
+    bench_opt_t opts[] = {
+        {"mode", "Either 'check' to compare against the baselines or 'record' to store new baselines", "check"},
+        {"baseline", "Path to the baseline file", "perf_cb_baseline.csv"},
+        {"build", "Build type of the baselines to compare against or record", "Release"},
+        {"tolerance", "Maximum slowdown allowed relative to the baselines, as a percentage", "30"},
+        {"reps", "Number of repetitions of each case, the median is taken", "7"},
+    };
+    bench_t bench;
+    if (!bench_init(&bench, "perf_cb", argc, argv, opts, BENCH_ARRAY_DIM(opts)))
+    {
+        return EXIT_FAILURE;
+    }
+    const bool record = (strcmp(opts[0U].value, "record") == 0);
+    const char * const baseline = opts[1U].value;
+    const char * const build = opts[2U].value;
+    const double tolerance = strtod(opts[3U].value, NULL);
+    const size_t reps = (size_t)strtoull(opts[4U].value, NULL, 10);
+    if ((!record && (strcmp(opts[0U].value, "check") != 0)) || (tolerance <= 0.0) || (reps == 0U) ||
+        (reps > PERF_MAX_REPS))
+    {
+        (void)fprintf(stderr, "perf_cb: invalid mode, tolerance or repetitions\n");
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+    for (size_t c = 0U; ok && (c < BENCH_ARRAY_DIM(cases)); c++)
+    {
+        for (size_t op = 0U; op < 2U; op++)
+        {
+            (void)snprintf(results[(2U * c) + op].name,
+                           sizeof(results[0U].name),
+                           "%s/%zu/%zu/%s",
+                           (op == 0U) ? ("cb_write") : ("cb_read"),
+                           cases[c].elem_size,
+                           cases[c].batch,
+                           (cases[c].wrap) ? ("wrap") : ("nowrap"));
+            results[(2U * c) + op].baseline = -1.0;
+        }
+        ok = perf_measure(&bench, &cases[c], reps, &results[2U * c], &results[(2U * c) + 1U]);
+    }
+    if (!ok)
+    {
+        (void)fprintf(stderr, "perf_cb: write/read failed\n");
+        bench_deinit(&bench);
+        return EXIT_FAILURE;
+    }
+    // Record new baselines, or compare against the current ones.
+    if (record)
+    {
+        ok = perf_baseline_store(baseline, build);
+        if (!ok)
+        {
+            (void)fprintf(stderr, "perf_cb: can't write baseline file '%s'\n", baseline);
+        }
+    }
+    else if (!perf_baseline_load(baseline, build))
+    {
+        (void)fprintf(stderr, "perf_cb: can't read baseline file '%s'\n", baseline);
+        ok = false;
+    }
+    else
+    {
+        // Measure again the cases that regressed and keep the best, a real regression persists but noise does not.
+        for (size_t c = 0U; ok && (c < BENCH_ARRAY_DIM(cases)); c++)
+        {
+            for (size_t retry = 0U; ok && (retry < PERF_RETRIES); retry++)
+            {
+                perf_result_t * const wr = &results[2U * c];
+                perf_result_t * const rd = &results[(2U * c) + 1U];
+                if (!perf_regressed(wr, tolerance) && !perf_regressed(rd, tolerance))
+                {
+                    break;
+                }
+                perf_result_t again[2U] = {*wr, *rd};
+                ok = perf_measure(&bench, &cases[c], reps, &again[0U], &again[1U]);
+                *wr = (again[0U].normalized < wr->normalized) ? (again[0U]) : (*wr);
+                *rd = (again[1U].normalized < rd->normalized) ? (again[1U]) : (*rd);
+            }
+        }
+    }
+
+    size_t regressions = 0U;
+    size_t missing = 0U;
+    for (size_t i = 0U; ok && (i < BENCH_ARRAY_DIM(results)); i++)
+    {
+        const perf_result_t * const result = &results[i];
+        const bool present = (result->baseline > 0.0);
+        const double change_pct = (present) ? (((result->normalized / result->baseline) - 1.0) * 100.0) : (0.0);
+        const char * status = "recorded";
+        if (!record)
+        {
+            status = (!present) ? ("missing") : (perf_regressed(result, tolerance)) ? ("regression") : ("ok");
+            regressions += (perf_regressed(result, tolerance)) ? (1U) : (0U);
+            missing += (present) ? (0U) : (1U);
+        }
+
+        const bench_field_t fields[] = {
+            BENCH_STR("build", build),
+            BENCH_STR("name", result->name),
+            BENCH_F64("calib_ns", result->calib_ns),
+            BENCH_F64("ns_per_elem", result->ns_per_elem),
+            BENCH_F64("normalized", result->normalized),
+            BENCH_F64("baseline", (present) ? (result->baseline) : (0.0)),
+            BENCH_F64("change_pct", change_pct),
+            BENCH_STR("status", status),
+        };
+        bench_report(&bench, fields, BENCH_ARRAY_DIM(fields));
+    }
+    bench_deinit(&bench);
+
+    if (regressions > 0U)
+    {
+        (void)fprintf(stderr, "perf_cb: %zu regressions over %.1f%% for '%s' builds\n", regressions, tolerance, build);
+    }
+    if (missing > 0U)
+    {
+        (void)fprintf(stderr, "perf_cb: %zu cases without baseline for '%s' builds, record them\n", missing, build);
+    }
+
+    return (ok && (regressions == 0U) && (missing == 0U)) ? (EXIT_SUCCESS) : (EXIT_FAILURE);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,446 @@
+/**
+ ***********************************************************************************************************************
+ * @file        replay_cb.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_replay Trace Replay */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+// Required for the barriers and sleep functions.
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "cb/cb.h"
+#include "cb/cb_hist.h"
+#include "cb/cb_trace.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/** Results of the replay of the operations of a function. */
+typedef struct
+{
+    uint64_t ops; /**< Number of operations. */
+    uint64_t elems; /**< Number of elements requested. */
+    uint64_t traced_ok; /**< Number of operations that succeeded in the trace. */
+    uint64_t traced_rejected; /**< Number of operations rejected as full or empty in the trace. */
+    uint64_t replayed_ok; /**< Number of operations that succeeded in the replay. */
+    uint64_t replayed_rejected; /**< Number of operations rejected as full or empty in the replay. */
+    uint64_t mismatches; /**< Number of operations with a different result in the replay than in the trace. */
+} replay_stats_t;
+
+/** Context of a replay thread, which replays the records of a traced thread. */
+typedef struct
+{
+    cb_t * cb; /**< Circular buffer. */
+    pthread_barrier_t * start; /**< Barrier to start all threads at the same time. */
+    const uint64_t * start_ns; /**< Time at which the replay starts, set after the barrier. */
+    const cb_trace_rec_t ** recs; /**< Records of the traced thread, in order. */
+    size_t count; /**< Number of records. */
+    uint64_t first_stamp; /**< Timestamp of the first record of the trace. */
+    double ns_per_tick; /**< Nanoseconds per tick of the clock of the trace, divided by the speed. */
+    bool timed; /**< If @c true, records are replayed at their time, otherwise as fast as possible. */
+    uint8_t * buffer; /**< Buffer for the elements written or read. */
+    replay_stats_t stats[2U]; /**< Results for writes and reads. */
+    cb_hist_t lateness; /**< Histogram of the delay of each operation relative to its time, in nanoseconds. */
+} replay_ctx_t;
+
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Maximum number of traced threads. */
+#define MAX_THREADS   (16U)
+/** Waits longer than this, in nanoseconds, sleep instead of spinning. */
+#define SLEEP_MIN_NS  (200000U)
+/** Margin before the time of a record, in nanoseconds, when sleeping. */
+#define SLEEP_MARGIN_NS (100000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Lock of the circular buffer, if there are multiple producers or consumers. */
+static atomic_flag lock = ATOMIC_FLAG_INIT;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Circular buffer event handler, spin lock for multiple producers or consumers. */
+static cb_error_t lock_evt_handler(cb_evt_t * const evt);
+/** Replay thread function. */
+static void * replay_func(void * ptr);
+/** Orders records by timestamp. */
+static int rec_cmp(const void * a, const void * b);
+
+/**
+ * @addtogroup cb_replay
+ * @{
+ */
+
+/**
+ * @brief Loads a binary trace.
+ * @param[in] path The path to the trace.
+ * @param[out] hdr The header of the trace.
+ * @return The records of the trace, or @c NULL on error, to be freed by the caller.
+ */
+static cb_trace_rec_t * trace_load(const char * const path, cb_trace_hdr_t * const hdr);
+
+/**
+ * @brief Waits until a point in time, sleeping for long waits and spinning for short ones.
+ * @param[in] target_ns The point in time, in the time base of ::bench_now_ns.
+ * @return The time at the end of the wait.
+ */
+static uint64_t wait_until(const uint64_t target_ns);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static cb_error_t lock_evt_handler(cb_evt_t * const evt)
+{
+    if (evt->id == cb_evt_id_lock)
+    {
+        while (atomic_flag_test_and_set_explicit(&lock, memory_order_acquire))
+        {
+            (void)sched_yield();
+        }
+    }
+    else if (evt->id == cb_evt_id_unlock)
+    {
+        atomic_flag_clear_explicit(&lock, memory_order_release);
+    }
+    else
+    {
+        return cb_error_evt;
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int rec_cmp(const void * a, const void * b)
+{
+    const cb_trace_rec_t * const ra = (const cb_trace_rec_t *)a;
+    const cb_trace_rec_t * const rb = (const cb_trace_rec_t *)b;
+
+    return (ra->stamp < rb->stamp) ? (-1) : ((ra->stamp > rb->stamp) ? (1) : (0));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_trace_rec_t * trace_load(const char * const path, cb_trace_hdr_t * const hdr)
+{
+    FILE * const file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        (void)fprintf(stderr, "replay_cb: can't open trace '%s'\n", path);
+        return NULL;
+    }
+
+    cb_trace_rec_t * recs = NULL;
+    if ((fread(hdr, sizeof(*hdr), 1U, file) != 1U) || (hdr->magic != CB_TRACE_MAGIC) ||
+        (hdr->version != CB_TRACE_VERSION) || (hdr->rec_size != sizeof(cb_trace_rec_t)) ||
+        (hdr->buffer_length <= 1U) || (hdr->elem_size == 0U) || (hdr->ticks_per_sec == 0U) || (hdr->count == 0U))
+    {
+        (void)fprintf(stderr, "replay_cb: '%s' is not a valid trace or it is empty\n", path);
+    }
+    else
+    {
+        recs = malloc((size_t)hdr->count * sizeof(cb_trace_rec_t));
+        if ((recs != NULL) && (fread(recs, sizeof(cb_trace_rec_t), (size_t)hdr->count, file) != hdr->count))
+        {
+            (void)fprintf(stderr, "replay_cb: '%s' is truncated\n", path);
+            free(recs);
+            recs = NULL;
+        }
+    }
+    (void)fclose(file);
+
+    return recs;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t wait_until(const uint64_t target_ns)
+{
+    uint64_t now = bench_now_ns();
+
+    if ((target_ns > now) && ((target_ns - now) > SLEEP_MIN_NS))
+    {
+        const uint64_t sleep_ns = target_ns - now - SLEEP_MARGIN_NS;
+        const struct timespec ts = {
+            .tv_sec = (time_t)(sleep_ns / 1000000000U),
+            .tv_nsec = (long)(sleep_ns % 1000000000U),
+        };
+        (void)nanosleep(&ts, NULL);
+        now = bench_now_ns();
+    }
+    while (now < target_ns)
+    {
+        (void)sched_yield();
+        now = bench_now_ns();
+    }
+
+    return now;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * replay_func(void * ptr)
+{
+    replay_ctx_t * const ctx = (replay_ctx_t *)ptr;
+
+    (void)pthread_barrier_wait(ctx->start);
+    const uint64_t start_ns = *ctx->start_ns;
+
+    for (size_t i = 0U; i < ctx->count; i++)
+    {
+        const cb_trace_rec_t * const rec = ctx->recs[i];
+        const bool write = (rec->fn == (uint8_t)cb_fn_id_write);
+
+        // Wait until the time of the record, relative to the start of the trace, and issue the same operation.
+        if (ctx->timed)
+        {
+            const uint64_t target_ns = start_ns + (uint64_t)((double)(rec->stamp - ctx->first_stamp) * ctx->ns_per_tick);
+            const uint64_t now = wait_until(target_ns);
+            (void)cb_hist_record(&ctx->lateness, now - target_ns);
+        }
+        const cb_error_t error = (write) ? (cb_write(ctx->cb, ctx->buffer, rec->count))
+                                         : (cb_read(ctx->cb, ctx->buffer, rec->count));
+
+        replay_stats_t * const stats = &ctx->stats[(write) ? (0U) : (1U)];
+        const cb_error_t rejected = (write) ? (cb_error_full) : (cb_error_empty);
+        stats->ops++;
+        stats->elems += rec->count;
+        stats->traced_ok += (rec->result == (uint8_t)cb_error_ok) ? (1U) : (0U);
+        stats->traced_rejected += (rec->result == (uint8_t)rejected) ? (1U) : (0U);
+        stats->replayed_ok += (error == cb_error_ok) ? (1U) : (0U);
+        stats->replayed_rejected += (error == rejected) ? (1U) : (0U);
+        stats->mismatches += (rec->result != (uint8_t)error) ? (1U) : (0U);
+    }
+
+    return NULL;
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Replays a binary trace of a circular buffer, see @c cb/cb_trace.h, with the same operations, threads and
+ * timing, and reports how the results compare with those in the trace, or dumps the records of the trace.
+ * @param[in] argc The number of arguments.
+ * @param[in] argv The arguments, see ::bench_init and the additional options below.
+ * @return Zero on success, non-zero otherwise.
+ */
+int main(int argc, char ** argv)
+{
+    bench_opt_t opts[] = {
+        {"trace", "Path to the binary trace", ""},
+        {"mode", "Either 'replay' to replay the trace or 'dump' to report each of its records", "replay"},
+        {"speed", "Speed of the replay relative to the trace, or '0' to replay as fast as possible", "1"},
+    };
+    bench_t bench;
+    if (!bench_init(&bench, "replay_cb", argc, argv, opts, BENCH_ARRAY_DIM(opts)))
+    {
+        return EXIT_FAILURE;
+    }
+    const bool dump = (strcmp(opts[1U].value, "dump") == 0);
+    const double speed = strtod(opts[2U].value, NULL);
+    if ((opts[0U].value[0U] == '\0') || (!dump && (strcmp(opts[1U].value, "replay") != 0)) || (speed < 0.0))
+    {
+        (void)fprintf(stderr, "replay_cb: a trace is required, along with a valid mode and speed\n");
+        return EXIT_FAILURE;
+    }
+
+    // Load the trace, and order its records by time, records of a thread keep their order as they are never equal.
+    cb_trace_hdr_t hdr;
+    cb_trace_rec_t * const recs = trace_load(opts[0U].value, &hdr);
+    if (recs == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    const size_t count = (size_t)hdr.count;
+    qsort(recs, count, sizeof(*recs), rec_cmp);
+    const uint64_t first_stamp = recs[0U].stamp;
+    const double ns_per_tick = 1e9 / (double)hdr.ticks_per_sec;
+
+    if (dump)
+    {
+        for (size_t i = 0U; i < count; i++)
+        {
+            const bench_field_t fields[] = {
+                BENCH_F64("time_ns", (double)(recs[i].stamp - first_stamp) * ns_per_tick),
+                BENCH_U64("thread", recs[i].thread),
+                BENCH_STR("fn", (recs[i].fn == (uint8_t)cb_fn_id_write) ? ("cb_write") : ("cb_read")),
+                BENCH_U64("count", recs[i].count),
+                BENCH_U64("filled", recs[i].filled),
+                BENCH_U64("result", recs[i].result),
+            };
+            bench_report(&bench, fields, BENCH_ARRAY_DIM(fields));
+        }
+        bench_deinit(&bench);
+        free(recs);
+        return EXIT_SUCCESS;
+    }
+
+    // Assign the records to a replay thread for each traced thread.
+    static replay_ctx_t ctxs[MAX_THREADS];
+    static uint32_t ids[MAX_THREADS];
+    size_t threads = 0U;
+    size_t max_count = 1U;
+    bool writes[MAX_THREADS] = {false};
+    bool reads[MAX_THREADS] = {false};
+    const cb_trace_rec_t ** const order = malloc(count * sizeof(*order));
+    size_t * const owner = malloc(count * sizeof(*owner));
+    bool ok = (order != NULL) && (owner != NULL);
+    for (size_t i = 0U; ok && (i < count); i++)
+    {
+        size_t t = 0U;
+        for (; (t < threads) && (ids[t] != recs[i].thread); t++)
+        {
+        }
+        if (t == threads)
+        {
+            ok = (threads < MAX_THREADS);
+            ids[threads++] = recs[i].thread;
+        }
+        owner[i] = t;
+        ctxs[t].count++;
+        writes[t] = writes[t] || (recs[i].fn == (uint8_t)cb_fn_id_write);
+        reads[t] = reads[t] || (recs[i].fn == (uint8_t)cb_fn_id_read);
+        max_count = (recs[i].count > max_count) ? (recs[i].count) : (max_count);
+    }
+    if (!ok)
+    {
+        (void)fprintf(stderr, "replay_cb: out of memory or more than %u threads in the trace\n", MAX_THREADS);
+        exit(EXIT_FAILURE);
+    }
+    for (size_t t = 0U, first = 0U; t < threads; t++)
+    {
+        ctxs[t].recs = &order[first];
+        first += ctxs[t].count;
+        ctxs[t].count = 0U;
+    }
+    for (size_t i = 0U; i < count; i++)
+    {
+        ctxs[owner[i]].recs[ctxs[owner[i]].count++] = &recs[i];
+    }
+
+    // Lock the circular buffer if there are multiple producers or consumers.
+    size_t writers = 0U;
+    size_t readers = 0U;
+    for (size_t t = 0U; t < threads; t++)
+    {
+        writers += (writes[t]) ? (1U) : (0U);
+        readers += (reads[t]) ? (1U) : (0U);
+    }
+    const bool locked = (writers > 1U) || (readers > 1U);
+    uint8_t * const ring = malloc((size_t)(hdr.buffer_length * hdr.elem_size));
+    cb_t cb;
+    ok = (ring != NULL) && (cb_init(&cb,
+                                    ring,
+                                    (size_t)hdr.buffer_length,
+                                    (size_t)hdr.elem_size,
+                                    (locked) ? (lock_evt_handler) : (NULL),
+                                    (locked) ? (cb_evt_id_lock | cb_evt_id_unlock) : (cb_evt_id_none),
+                                    NULL) == cb_error_ok);
+
+    // Start all threads at the same time, along with this one.
+    pthread_barrier_t start;
+    (void)pthread_barrier_init(&start, NULL, (unsigned int)(threads + 1U));
+    static uint64_t start_ns;
+    pthread_t tids[MAX_THREADS];
+    for (size_t t = 0U; ok && (t < threads); t++)
+    {
+        ctxs[t].cb = &cb;
+        ctxs[t].start = &start;
+        ctxs[t].start_ns = &start_ns;
+        ctxs[t].first_stamp = first_stamp;
+        ctxs[t].timed = (speed > 0.0);
+        ctxs[t].ns_per_tick = (speed > 0.0) ? (ns_per_tick / speed) : (0.0);
+        ctxs[t].buffer = calloc(max_count, (size_t)hdr.elem_size);
+        ok = (ctxs[t].buffer != NULL) && (cb_hist_init(&ctxs[t].lateness) == cb_error_ok) &&
+             (pthread_create(&tids[t], NULL, replay_func, &ctxs[t]) == 0);
+    }
+    if (!ok)
+    {
+        (void)fprintf(stderr, "replay_cb: can't allocate the circular buffer or create threads\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Leave some time to all threads to reach the barrier before the first record, if replaying at its time.
+    start_ns = bench_now_ns() + ((speed > 0.0) ? (1000000U) : (0U));
+    (void)pthread_barrier_wait(&start);
+    for (size_t t = 0U; t < threads; t++)
+    {
+        (void)pthread_join(tids[t], NULL);
+    }
+    const uint64_t elapsed_ns = bench_now_ns() - start_ns;
+
+    // Report for writes and reads, with the lateness of all threads.
+    static cb_hist_t lateness;
+    (void)cb_hist_init(&lateness);
+    for (size_t t = 0U; t < threads; t++)
+    {
+        for (size_t b = 0U; b < CB_HIST_BUCKETS; b++)
+        {
+            lateness.counts[b] += ctxs[t].lateness.counts[b];
+        }
+        lateness.total += ctxs[t].lateness.total;
+        lateness.min = (ctxs[t].lateness.min < lateness.min) ? (ctxs[t].lateness.min) : (lateness.min);
+        lateness.max = (ctxs[t].lateness.max > lateness.max) ? (ctxs[t].lateness.max) : (lateness.max);
+    }
+    uint64_t p50 = 0U;
+    uint64_t p99 = 0U;
+    (void)cb_hist_percentile(&lateness, 50.0, &p50);
+    (void)cb_hist_percentile(&lateness, 99.0, &p99);
+    for (size_t op = 0U; op < 2U; op++)
+    {
+        replay_stats_t total = {0U};
+        for (size_t t = 0U; t < threads; t++)
+        {
+            total.ops += ctxs[t].stats[op].ops;
+            total.elems += ctxs[t].stats[op].elems;
+            total.traced_ok += ctxs[t].stats[op].traced_ok;
+            total.traced_rejected += ctxs[t].stats[op].traced_rejected;
+            total.replayed_ok += ctxs[t].stats[op].replayed_ok;
+            total.replayed_rejected += ctxs[t].stats[op].replayed_rejected;
+            total.mismatches += ctxs[t].stats[op].mismatches;
+        }
+        const bench_field_t fields[] = {
+            BENCH_STR("fn", (op == 0U) ? ("cb_write") : ("cb_read")),
+            BENCH_U64("threads", (op == 0U) ? (writers) : (readers)),
+            BENCH_STR("lock", (locked) ? ("spin") : ("none")),
+            BENCH_F64("speed", speed),
+            BENCH_U64("ops", total.ops),
+            BENCH_U64("elems", total.elems),
+            BENCH_U64("traced_ok", total.traced_ok),
+            BENCH_U64("traced_rejected", total.traced_rejected),
+            BENCH_U64("replayed_ok", total.replayed_ok),
+            BENCH_U64("replayed_rejected", total.replayed_rejected),
+            BENCH_U64("mismatches", total.mismatches),
+            BENCH_F64("traced_ns", (double)(recs[count - 1U].stamp - first_stamp) * ns_per_tick),
+            BENCH_U64("replayed_ns", elapsed_ns),
+            BENCH_U64("lateness_p50_ns", p50),
+            BENCH_U64("lateness_p99_ns", p99),
+        };
+        bench_report(&bench, fields, BENCH_ARRAY_DIM(fields));
+    }
+    if (hdr.dropped > 0U)
+    {
+        (void)fprintf(stderr, "replay_cb: %llu records were dropped when tracing\n", (unsigned long long)hdr.dropped);
+    }
+
+    bench_deinit(&bench);
+    (void)pthread_barrier_destroy(&start);
+    for (size_t t = 0U; t < threads; t++)
+    {
+        free(ctxs[t].buffer);
+    }
+    free(ring);
+    free(order);
+    free(owner);
+    free(recs);
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************************************END OF FILE*****/
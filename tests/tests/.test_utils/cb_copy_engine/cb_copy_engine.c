@@ -0,0 +1,278 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_copy_engine.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_copy_engine_iapi_impl Internal API implementation */
+/** @defgroup cb_copy_engine_papi_impl Public API implementation */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "cb_copy_engine/cb_copy_engine.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_iapi_impl
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_iapi_impl
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_iapi_impl
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_iapi_impl
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_iapi_impl
+ * @{
+ */
+
+/**
+ * @brief Worker thread function, performs the jobs in the queue until the copy engine is stopped.
+ * @param[in] ptr The copy engine.
+ * @return Always @c NULL.
+ */
+static void * cb_copy_engine_worker(void * ptr);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_iapi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * cb_copy_engine_worker(void * ptr)
+{
+    cb_copy_engine_t * const ce = (cb_copy_engine_t *)ptr;
+
+    while (true)
+    {
+        // Wait for a job or for the copy engine to stop.
+        pthread_mutex_lock(&ce->jobs_mutex);
+        while ((ce->head == ce->tail) && (!ce->stop))
+        {
+            pthread_cond_wait(&ce->jobs_cond, &ce->jobs_mutex);
+        }
+        if (ce->head == ce->tail)
+        {
+            pthread_mutex_unlock(&ce->jobs_mutex);
+            break;
+        }
+        const cb_copy_engine_job_t job = ce->jobs[ce->tail % CB_COPY_ENGINE_MAX_JOBS];
+        ce->tail++;
+        pthread_mutex_unlock(&ce->jobs_mutex);
+
+        // Perform the copy of the spans, outside of any lock.
+        for (size_t span = 0U; span < ARRAY_DIM(job.bytes); span++)
+        {
+            if (job.bytes[span] > 0U)
+            {
+                (void)memcpy(job.dst[span], job.src[span], job.bytes[span]);
+            }
+        }
+
+        // Signal completion, jobs completed by different workers can complete in any order.
+        if (job.id == cb_evt_id_write_async)
+        {
+            assert_int_equal(cb_write_done(ce->cb, job.seq), cb_error_ok);
+        }
+        else
+        {
+            assert_int_equal(cb_read_done(ce->cb, job.seq), cb_error_ok);
+        }
+
+        // Account for completed job.
+        pthread_mutex_lock(&ce->jobs_mutex);
+        ce->busy--;
+        pthread_cond_broadcast(&ce->jobs_cond);
+        pthread_mutex_unlock(&ce->jobs_mutex);
+    }
+
+    return NULL;
+}
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_papi_impl
+ * @{
+ */
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+bool cb_copy_engine_init(cb_copy_engine_t * const ce, cb_t * const cb, const size_t workers)
+{
+    if ((workers == 0U) || (workers > CB_COPY_ENGINE_MAX_WORKERS))
+    {
+        return false;
+    }
+
+    // Initialize copy engine.
+    (void)memset(ce, 0, sizeof(*ce));
+    ce->cb = cb;
+    pthread_mutex_init(&ce->jobs_mutex, NULL);
+    pthread_cond_init(&ce->jobs_cond, NULL);
+    pthread_mutex_init(&ce->cb_mutex, NULL);
+
+    // Start workers.
+    for (size_t i = 0U; i < workers; i++)
+    {
+        if (pthread_create(&ce->workers[i], NULL, cb_copy_engine_worker, ce) != 0)
+        {
+            cb_copy_engine_deinit(ce);
+            return false;
+        }
+        ce->worker_count++;
+    }
+
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void cb_copy_engine_wait_idle(cb_copy_engine_t * const ce)
+{
+    pthread_mutex_lock(&ce->jobs_mutex);
+    while (ce->busy > 0U)
+    {
+        pthread_cond_wait(&ce->jobs_cond, &ce->jobs_mutex);
+    }
+    pthread_mutex_unlock(&ce->jobs_mutex);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+void cb_copy_engine_deinit(cb_copy_engine_t * const ce)
+{
+    // Complete pending jobs and stop the workers.
+    cb_copy_engine_wait_idle(ce);
+    pthread_mutex_lock(&ce->jobs_mutex);
+    ce->stop = true;
+    pthread_cond_broadcast(&ce->jobs_cond);
+    pthread_mutex_unlock(&ce->jobs_mutex);
+    for (size_t i = 0U; i < ce->worker_count; i++)
+    {
+        pthread_join(ce->workers[i], NULL);
+    }
+
+    // Deinitialize copy engine.
+    pthread_mutex_destroy(&ce->cb_mutex);
+    pthread_cond_destroy(&ce->jobs_cond);
+    pthread_mutex_destroy(&ce->jobs_mutex);
+    ce->worker_count = 0U;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+cb_error_t cb_copy_engine_evt_handler(cb_evt_t * const evt)
+{
+    cb_copy_engine_t * const ce = (cb_copy_engine_t *)evt->user_data;
+    cb_copy_engine_job_t job = {.id = evt->id};
+
+    switch (evt->id)
+    {
+        case cb_evt_id_read_async:
+        {
+            const cb_evt_data_read_async_t * const data = &evt->data.read_async;
+            job.src[0U] = data->read_ptr;
+            job.dst[0U] = data->buffer;
+            job.bytes[0U] = data->bytes;
+            job.src[1U] = data->wrap_ptr;
+            job.dst[1U] = ((char *)data->buffer) + data->bytes;
+            job.bytes[1U] = data->wrap_bytes;
+            job.seq = data->seq;
+        }
+        break;
+
+        case cb_evt_id_write_async:
+        {
+            const cb_evt_data_write_async_t * const data = &evt->data.write_async;
+            job.src[0U] = data->buffer;
+            job.dst[0U] = data->write_ptr;
+            job.bytes[0U] = data->bytes;
+            job.src[1U] = ((const char *)data->buffer) + data->bytes;
+            job.dst[1U] = data->wrap_ptr;
+            job.bytes[1U] = data->wrap_bytes;
+            job.seq = data->seq;
+        }
+        break;
+
+        case cb_evt_id_lock:
+        {
+            pthread_mutex_lock(&ce->cb_mutex);
+            return cb_error_ok;
+        }
+        break;
+
+        case cb_evt_id_unlock:
+        {
+            pthread_mutex_unlock(&ce->cb_mutex);
+            return cb_error_ok;
+        }
+        break;
+
+        default:
+        {
+            return cb_error_evt;
+        }
+        break;
+    }
+
+    // Queue job, returning immediately, a worker will perform it and signal its completion.
+    pthread_mutex_lock(&ce->jobs_mutex);
+    if ((ce->head - ce->tail) >= CB_COPY_ENGINE_MAX_JOBS)
+    {
+        pthread_mutex_unlock(&ce->jobs_mutex);
+        return cb_error_evt;
+    }
+    ce->jobs[ce->head % CB_COPY_ENGINE_MAX_JOBS] = job;
+    ce->head++;
+    ce->busy++;
+    pthread_cond_signal(&ce->jobs_cond);
+    pthread_mutex_unlock(&ce->jobs_mutex);
+
+    return cb_error_ok;
+}
+
+/**
+ * @}
+ */
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,138 @@
+/**
+ ***********************************************************************************************************************
+ * @file        cb_copy_engine.h
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -----------------------------------------------------------------------------*/
+#ifndef CB_COPY_ENGINE_H
+#define CB_COPY_ENGINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @defgroup cb_copy_engine_defs Definitions */
+/** @defgroup cb_copy_engine_papi Public API */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include <pthread.h>
+#include "cb/cb.h"
+
+/** Maximum number of worker threads in a copy engine. */
+#define CB_COPY_ENGINE_MAX_WORKERS (8U)
+/** Maximum number of copy jobs queued in a copy engine, enough for all the reads and writes that can be pending. */
+#define CB_COPY_ENGINE_MAX_JOBS (2U * CB_ASYNC_MAX_OPS)
+
+/* Exported types ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_defs
+ * @{
+ */
+
+/** Copy job, an asynchronous read or write of up to two spans. */
+typedef struct
+{
+    cb_evt_id_t id; /**< The event that started the job, ::cb_evt_id_read_async or ::cb_evt_id_write_async. */
+    const void * src[2U]; /**< The source of each span. */
+    void * dst[2U]; /**< The destination of each span. */
+    size_t bytes[2U]; /**< The number of bytes of each span, the second can be zero. */
+    size_t seq; /**< The sequence number of the operation. */
+} cb_copy_engine_job_t;
+
+/**
+ * @brief Software stand-in for a copy engine, a pool of worker threads that performs asynchronous copies.
+ *
+ * Jobs are taken from the queue in order but can complete in any order, as each worker completes its own job.
+ */
+typedef struct
+{
+    cb_t * cb; /**< The circular buffer whose asynchronous events are handled. */
+    pthread_t workers[CB_COPY_ENGINE_MAX_WORKERS]; /**< The worker threads. */
+    size_t worker_count; /**< The number of worker threads. */
+    cb_copy_engine_job_t jobs[CB_COPY_ENGINE_MAX_JOBS]; /**< Queue of jobs pending to be taken by a worker. */
+    size_t head; /**< Index of the next job to queue. */
+    size_t tail; /**< Index of the next job to take. */
+    size_t busy; /**< Number of jobs queued or being performed by a worker. */
+    bool stop; /**< @c true if the workers must stop, @c false otherwise. */
+    pthread_mutex_t jobs_mutex; /**< Mutex for the job queue. */
+    pthread_cond_t jobs_cond; /**< Condition variable, signalled when the job queue changes. */
+    pthread_mutex_t cb_mutex; /**< Mutex for @c cb, used for the lock and unlock events. */
+} cb_copy_engine_t;
+
+/**
+ * @}
+ */
+
+/* Exported constants ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_defs
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Exported macro ----------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_papi
+ * @{
+ */
+
+/**
+ * @}
+ */
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @addtogroup cb_copy_engine_papi
+ * @{
+ */
+
+/**
+ * @brief Initializes a copy engine and starts its worker threads.
+ * @param[in] ce The copy engine.
+ * @param[in] cb The circular buffer, initialized with ::cb_copy_engine_evt_handler and @p ce as user data.
+ * @param[in] workers The number of worker threads, at most ::CB_COPY_ENGINE_MAX_WORKERS.
+ * @return @c true on success, @c false otherwise.
+ */
+bool cb_copy_engine_init(cb_copy_engine_t * const ce, cb_t * const cb, const size_t workers);
+
+/**
+ * @brief Waits until all the jobs queued in a copy engine have completed.
+ * @param[in] ce The copy engine.
+ */
+void cb_copy_engine_wait_idle(cb_copy_engine_t * const ce);
+
+/**
+ * @brief Waits until all the jobs queued in a copy engine have completed and stops its worker threads.
+ * @param[in] ce The copy engine.
+ */
+void cb_copy_engine_deinit(cb_copy_engine_t * const ce);
+
+/**
+ * @brief Event handler that queues asynchronous reads and writes in the copy engine in the user data.
+ *
+ * Handles ::cb_evt_id_read_async, ::cb_evt_id_write_async, ::cb_evt_id_lock and ::cb_evt_id_unlock events.
+ * @param[in] evt The event.
+ * @retval ::cb_error_ok Success.
+ * @retval ::cb_error_evt The job queue is full or the event is not handled.
+ */
+cb_error_t cb_copy_engine_evt_handler(cb_evt_t * const evt);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CB_COPY_ENGINE_H */
+
+/******************************************************************************************************END OF FILE*****/
@@ -28,12 +28,35 @@ static test_type_t ldbuf[12U];
 static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
 /** Circular buffer. */
 static cb_t cbuf;
+/** Last watermark event raised and number of watermark events raised. */
+/** @{ */
+static cb_evt_t wm_evt;
+static size_t wm_evt_count;
+/** @} */
+/** Lock and unlock events raised, encoded as @c 'L' or @c 'U' followed by the side, @c 'A', @c 'W' or @c 'R'. */
+static char lock_evts[32U];
+/**
+ * Ticks of the fake clock, and the tick at which it writes elements as a producer would, how many, and every how many
+ * ticks it writes them again, zero to write them once.
+ */
+/** @{ */
+static uint64_t ticks;
+static uint64_t ticks_write_at;
+static size_t ticks_write_count;
+static uint64_t ticks_write_every;
+/** @} */
 
 /* Private function prototypes ---------------------------------------------------------------------------------------*/
 /** Suite setup function. */
 static int setup(void ** state);
 /** Suite teardown function. */
 static int teardown(void ** state);
+/** Circular buffer event handler, records the watermark events. */
+static cb_error_t cb_evt_handler_wm(cb_evt_t * const evt);
+/** Circular buffer event handler, records the lock and unlock events. */
+static cb_error_t cb_evt_handler_lock(cb_evt_t * const evt);
+/** Fake clock, advances a tick in each call and writes elements at the tick configured. */
+static uint64_t clock_ticks(void);
 
 /**
  * @addtogroup cb_tests
@@ -50,6 +73,16 @@ static void test_cb_write_read_edge_cases(void ** state);
 static void test_cb_write_read_evt_handler_errors(void ** state);
 /** Tests for write and read errors on full and empty conditions. */
 static void test_cb_write_read_full_empty_errors(void ** state);
+/** Tests for the high and low watermark events. */
+static void test_cb_watermarks(void ** state);
+/** Tests for the sides locked with and without split locks. */
+static void test_cb_lock_split(void ** state);
+/** Tests for the lock-free queries, which match the locked ones without raising events. */
+static void test_cb_lockfree_queries(void ** state);
+/** Tests for the batch reads, between a minimum and a maximum of elements and lingering for the minimum. */
+static void test_cb_read_batch(void ** state);
+/** Tests for the partial writes and reads, which transfer as many elements as fit or exist. */
+static void test_cb_write_read_partial(void ** state);
 
 /**
  * @}
@@ -92,6 +125,47 @@ static int teardown(void ** state)
     return CMOCKA_OK;
 }
 
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_handler_wm(cb_evt_t * const evt)
+{
+    assert_true((evt->id == cb_evt_id_high_wm) || (evt->id == cb_evt_id_low_wm));
+
+    // Record event.
+    wm_evt = *evt;
+    wm_evt_count++;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_handler_lock(cb_evt_t * const evt)
+{
+    assert_true((evt->id == cb_evt_id_lock) || (evt->id == cb_evt_id_unlock));
+    assert_true(strlen(lock_evts) < (sizeof(lock_evts) - 2U));
+    assert_int_equal(evt->data.lock.unused, 0U);
+
+    // Record event.
+    const char sides[] = {'A', 'W', 'R'};
+    const size_t len = strlen(lock_evts);
+    lock_evts[len] = (evt->id == cb_evt_id_lock) ? ('L') : ('U');
+    lock_evts[len + 1U] = sides[evt->data.lock.side];
+    lock_evts[len + 2U] = '\0';
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t clock_ticks(void)
+{
+    if ((ticks == ticks_write_at) || ((ticks_write_every > 0U) && (ticks > ticks_write_at) &&
+                                      (((ticks - ticks_write_at) % ticks_write_every) == 0U)))
+    {
+        assert_int_equal(cb_write(&cbuf, lsbuf, ticks_write_count), cb_error_ok);
+    }
+
+    return ticks++;
+}
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 static void test_cb_invalid_arguments(void ** state)
 {
@@ -111,6 +185,10 @@ static void test_cb_invalid_arguments(void ** state)
                      cb_error_invalid_args);
     assert_int_equal(cb_init(cb, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_lock, NULL),
                      cb_error_invalid_args);
+#if defined(CB_USE_PACKED) && (SIZE_MAX > UINT32_MAX)
+    assert_int_equal(cb_init(cb, lcbuf, (size_t)UINT32_MAX + 1U, sizeof(*lcbuf), NULL, cb_evt_id_none, NULL),
+                     cb_error_invalid_args);
+#endif
 
     // Check invalid arguments on 'cb_write'.
     assert_int_equal(cb_write(NULL, lsbuf, ARRAY_DIM(lsbuf)), cb_error_invalid_args);
@@ -122,6 +200,12 @@ static void test_cb_invalid_arguments(void ** state)
     assert_int_equal(cb_read(cb, NULL, ARRAY_DIM(ldbuf)), cb_error_invalid_args);
     assert_int_equal(cb_read(cb, ldbuf, 0U), cb_error_invalid_args);
 
+    // Check invalid arguments on 'cb_set_watermarks'.
+    assert_int_equal(cb_set_watermarks(NULL, 1U, 2U), cb_error_invalid_args);
+    assert_int_equal(cb_set_watermarks(cb, 2U, 2U), cb_error_invalid_args);
+    assert_int_equal(cb_set_watermarks(cb, 3U, 2U), cb_error_invalid_args);
+    assert_int_equal(cb_set_watermarks(cb, 0U, ARRAY_DIM(lsbuf) + 1U), cb_error_invalid_args);
+
     // Check invalid arguments on 'cb_get_unfilled'.
     assert_int_equal(cb_get_unfilled(cb, NULL), cb_error_invalid_args);
     assert_int_equal(cb_get_unfilled(NULL, &count), cb_error_invalid_args);
@@ -317,6 +401,290 @@ static void test_cb_write_read_full_empty_errors(void ** state)
     assert_int_equal(cb_read(cb, &ldbuf[1U], ARRAY_DIM(lsbuf)), cb_error_empty);
 }
 
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_watermarks(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    const size_t low = 2U;
+    const size_t high = ARRAY_DIM(lsbuf) - 2U;
+
+    // Subscribe to watermark events and set watermarks.
+    wm_evt_count = 0U;
+    cb->evt_handler = cb_evt_handler_wm;
+    cb->evt_sub = cb_evt_id_high_wm | cb_evt_id_low_wm;
+    assert_int_equal(cb_set_watermarks(cb, low, high), cb_error_ok);
+
+    // Write below the high watermark, then reach it, the event is raised only once.
+    assert_int_equal(cb_write(cb, lsbuf, high - 3U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 0U);
+    assert_int_equal(cb_write(cb, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 1U);
+    assert_int_equal(wm_evt.id, cb_evt_id_high_wm);
+    assert_int_equal(wm_evt.data.wm.filled, high);
+    assert_true(wm_evt.cb == cb);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 1U);
+
+    // Read above the low watermark, then reach it, the event is raised only once.
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 4U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 1U);
+    assert_int_equal(cb_read(cb, &ldbuf[1U], high + 1U - 4U - low), cb_error_ok);
+    assert_int_equal(wm_evt_count, 2U);
+    assert_int_equal(wm_evt.id, cb_evt_id_low_wm);
+    assert_int_equal(wm_evt.data.wm.filled, low);
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 1U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 2U);
+
+    // Writes that fail do not raise events, the high watermark is raised again when crossed after the low one.
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lsbuf)), cb_error_full);
+    assert_int_equal(wm_evt_count, 2U);
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lsbuf) - 1U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 3U);
+    assert_int_equal(wm_evt.id, cb_evt_id_high_wm);
+    assert_int_equal(wm_evt.data.wm.filled, ARRAY_DIM(lsbuf));
+
+    // Setting the watermarks again takes into account the current number of filled slots.
+    assert_int_equal(cb_set_watermarks(cb, ARRAY_DIM(lsbuf) - 1U, ARRAY_DIM(lsbuf)), cb_error_ok);
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 1U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 4U);
+    assert_int_equal(wm_evt.id, cb_evt_id_low_wm);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_lock_split(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t count = 0U;
+    bool is_state = false;
+
+    // Subscribe to lock events.
+    cb->evt_handler = cb_evt_handler_lock;
+    cb->evt_sub = cb_evt_id_lock | cb_evt_id_unlock;
+    assert_int_equal(cb_set_lock_split(NULL, true), cb_error_invalid_args);
+
+    // Not split, everything locks the whole circular buffer.
+    lock_evts[0U] = '\0';
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 1U), cb_error_ok);
+    assert_int_equal(cb_set_watermarks(cb, 1U, 2U), cb_error_ok);
+    assert_true(strcmp(lock_evts, "LAUALAUALAUA") == 0);
+
+    // Split, writes and reads lock their side, and so do the queries on the index of that side.
+    assert_int_equal(cb_set_lock_split(cb, true), cb_error_ok);
+    lock_evts[0U] = '\0';
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 1U), cb_error_ok);
+    assert_true(strcmp(lock_evts, "LWUWLRUR") == 0);
+    lock_evts[0U] = '\0';
+    assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+    assert_int_equal(cb_is_full(cb, &is_state), cb_error_ok);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(cb_is_empty(cb, &is_state), cb_error_ok);
+    assert_true(strcmp(lock_evts, "LWUWLWUWLRURLRUR") == 0);
+
+    // Functions that access both sides lock the producer side first, and unlock in reverse order.
+    lock_evts[0U] = '\0';
+    assert_int_equal(cb_set_watermarks(cb, 1U, 2U), cb_error_ok);
+    assert_true(strcmp(lock_evts, "LWLRURUW") == 0);
+
+    // Rejected operations also unlock their side.
+    lock_evts[0U] = '\0';
+    assert_int_equal(cb_read(cb, &ldbuf[1U], ARRAY_DIM(lsbuf)), cb_error_empty);
+    assert_true(strcmp(lock_evts, "LRUR") == 0);
+
+    // Not split again.
+    assert_int_equal(cb_set_lock_split(cb, false), cb_error_ok);
+    lock_evts[0U] = '\0';
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 2U), cb_error_ok);
+    assert_true(strcmp(lock_evts, "LAUA") == 0);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_lockfree_queries(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    const size_t counts[] = {0U, 3U, 10U, 4U, 0U};
+    size_t count = 0U;
+    size_t count_lf = 0U;
+    bool is_state = false;
+    bool is_state_lf = false;
+
+    // Invalid arguments.
+    assert_int_equal(cb_get_unfilled_lockfree(NULL, &count), cb_error_invalid_args);
+    assert_int_equal(cb_get_unfilled_lockfree(cb, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_get_filled_lockfree(NULL, &count), cb_error_invalid_args);
+    assert_int_equal(cb_get_filled_lockfree(cb, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_is_empty_lockfree(NULL, &is_state), cb_error_invalid_args);
+    assert_int_equal(cb_is_empty_lockfree(cb, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_is_full_lockfree(NULL, &is_state), cb_error_invalid_args);
+    assert_int_equal(cb_is_full_lockfree(cb, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_get_readable_lockfree(NULL, &count), cb_error_invalid_args);
+    assert_int_equal(cb_get_readable_lockfree(cb, NULL), cb_error_invalid_args);
+
+    // Subscribe to lock events, to check the lock-free queries do not raise them.
+    cb->evt_handler = cb_evt_handler_lock;
+    cb->evt_sub = cb_evt_id_lock | cb_evt_id_unlock;
+
+    // Fill and empty the circular buffer wrapping around, and compare the results with the locked queries.
+    for (size_t i = 0U; i < ARRAY_DIM(counts); i++)
+    {
+        assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+        if (counts[i] > count)
+        {
+            assert_int_equal(cb_write(cb, lsbuf, counts[i] - count), cb_error_ok);
+        }
+        else if (counts[i] < count)
+        {
+            assert_int_equal(cb_read(cb, ldbuf, count - counts[i]), cb_error_ok);
+        }
+
+        lock_evts[0U] = '\0';
+        assert_int_equal(cb_get_filled_lockfree(cb, &count_lf), cb_error_ok);
+        assert_int_equal(count_lf, counts[i]);
+        assert_int_equal(cb_get_readable_lockfree(cb, &count_lf), cb_error_ok);
+        assert_int_equal(count_lf, counts[i]);
+        assert_int_equal(cb_get_unfilled_lockfree(cb, &count_lf), cb_error_ok);
+        assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+        assert_int_equal(count_lf, count);
+        assert_int_equal(cb_is_empty_lockfree(cb, &is_state_lf), cb_error_ok);
+        assert_int_equal(cb_is_empty(cb, &is_state), cb_error_ok);
+        assert_int_equal(is_state_lf, is_state);
+        assert_int_equal(cb_is_full_lockfree(cb, &is_state_lf), cb_error_ok);
+        assert_int_equal(cb_is_full(cb, &is_state), cb_error_ok);
+        assert_int_equal(is_state_lf, is_state);
+        assert_true(strcmp(lock_evts, "LAUALAUALAUA") == 0);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_read_batch(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t read = 0U;
+
+    // Invalid arguments.
+    assert_int_equal(cb_read_batch(NULL, ldbuf, 1U, 2U, &read, NULL, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_read_batch(cb, NULL, 1U, 2U, &read, NULL, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_read_batch(cb, ldbuf, 1U, 2U, NULL, NULL, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_read_batch(cb, ldbuf, 0U, 2U, &read, NULL, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_read_batch(cb, ldbuf, 3U, 2U, &read, NULL, 0U), cb_error_invalid_args);
+
+    // Without clock, what exists is read at once, fewer than the minimum or up to the maximum.
+    assert_int_equal(cb_read_batch(cb, ldbuf, 1U, 8U, &read, NULL, 0U), cb_error_empty);
+    assert_int_equal(read, 0U);
+    assert_int_equal(cb_write(cb, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_read_batch(cb, ldbuf, 4U, 8U, &read, NULL, 0U), cb_error_ok);
+    assert_int_equal(read, 3U);
+    assert_memory_equal(ldbuf, lsbuf, 3U * sizeof(*ldbuf));
+    assert_int_equal(cb_write(cb, lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_read_batch(cb, ldbuf, 1U, 8U, &read, NULL, 0U), cb_error_ok);
+    assert_int_equal(read, 8U);
+    assert_memory_equal(ldbuf, lsbuf, 8U * sizeof(*ldbuf));
+    assert_int_equal(cb_read_batch(cb, ldbuf, 1U, 8U, &read, NULL, 0U), cb_error_ok);
+    assert_int_equal(read, 2U);
+    assert_memory_equal(ldbuf, &lsbuf[8U], 2U * sizeof(*ldbuf));
+
+    // With the minimum already written, it does not linger.
+    ticks = 0U;
+    ticks_write_at = UINT64_MAX;
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_read_batch(cb, ldbuf, 2U, 8U, &read, clock_ticks, 100U), cb_error_ok);
+    assert_int_equal(read, 2U);
+    assert_true(ticks <= 2U);
+
+    // Lingers until the minimum is written, and reads it at once.
+    ticks = 0U;
+    ticks_write_at = 5U;
+    ticks_write_count = 4U;
+    assert_int_equal(cb_read_batch(cb, ldbuf, 4U, 8U, &read, clock_ticks, 100U), cb_error_ok);
+    assert_int_equal(read, 4U);
+    assert_memory_equal(ldbuf, lsbuf, 4U * sizeof(*ldbuf));
+    assert_true(ticks < 10U);
+
+    // Lingers while the minimum is written in parts, and reads it at once when the last part arrives.
+    ticks = 0U;
+    ticks_write_at = 5U;
+    ticks_write_count = 2U;
+    ticks_write_every = 5U;
+    assert_int_equal(cb_read_batch(cb, ldbuf, 4U, 8U, &read, clock_ticks, 100U), cb_error_ok);
+    assert_int_equal(read, 4U);
+    assert_memory_equal(ldbuf, lsbuf, 2U * sizeof(*ldbuf));
+    assert_memory_equal(&ldbuf[2U], lsbuf, 2U * sizeof(*ldbuf));
+    assert_true(ticks < 15U);
+
+    // Once the linger time expires, what was written in parts is read in a single transfer, without polling again.
+    ticks = 0U;
+    assert_int_equal(cb_read_batch(cb, ldbuf, 6U, 8U, &read, clock_ticks, 12U), cb_error_ok);
+    assert_int_equal(read, 4U);
+    assert_memory_equal(ldbuf, lsbuf, 2U * sizeof(*ldbuf));
+    assert_memory_equal(&ldbuf[2U], lsbuf, 2U * sizeof(*ldbuf));
+    assert_int_equal(ticks, 13U);
+    ticks_write_every = 0U;
+
+    // Lingers for the minimum until the linger time expires, and then reads fewer, or none if still empty.
+    ticks = 0U;
+    ticks_write_at = 5U;
+    ticks_write_count = 3U;
+    assert_int_equal(cb_read_batch(cb, ldbuf, 6U, 8U, &read, clock_ticks, 20U), cb_error_ok);
+    assert_int_equal(read, 3U);
+    assert_memory_equal(ldbuf, lsbuf, 3U * sizeof(*ldbuf));
+    assert_true(ticks > 20U);
+    ticks = 0U;
+    ticks_write_at = UINT64_MAX;
+    assert_int_equal(cb_read_batch(cb, ldbuf, 1U, 8U, &read, clock_ticks, 20U), cb_error_empty);
+    assert_int_equal(read, 0U);
+    assert_true(ticks > 20U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_write_read_partial(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t count = 0U;
+
+    // Invalid arguments.
+    assert_int_equal(cb_write_partial(NULL, lsbuf, 1U, &count), cb_error_invalid_args);
+    assert_int_equal(cb_write_partial(cb, NULL, 1U, &count), cb_error_invalid_args);
+    assert_int_equal(cb_write_partial(cb, lsbuf, 0U, &count), cb_error_invalid_args);
+    assert_int_equal(cb_write_partial(cb, lsbuf, 1U, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_read_partial(NULL, ldbuf, 1U, &count), cb_error_invalid_args);
+    assert_int_equal(cb_read_partial(cb, NULL, 1U, &count), cb_error_invalid_args);
+    assert_int_equal(cb_read_partial(cb, ldbuf, 0U, &count), cb_error_invalid_args);
+    assert_int_equal(cb_read_partial(cb, ldbuf, 1U, NULL), cb_error_invalid_args);
+
+    // Nothing is read when empty.
+    count = 1U;
+    assert_int_equal(cb_read_partial(cb, ldbuf, ARRAY_DIM(ldbuf), &count), cb_error_empty);
+    assert_int_equal(count, 0U);
+
+    // Writes as many as fit, and nothing when full.
+    assert_int_equal(cb_write_partial(cb, lsbuf, 6U, &count), cb_error_ok);
+    assert_int_equal(count, 6U);
+    assert_int_equal(cb_write_partial(cb, lsbuf, ARRAY_DIM(lsbuf), &count), cb_error_ok);
+    assert_int_equal(count, 4U);
+    count = 1U;
+    assert_int_equal(cb_write_partial(cb, lsbuf, 1U, &count), cb_error_full);
+    assert_int_equal(count, 0U);
+
+    // Reads up to the number requested, or as many as exist.
+    assert_int_equal(cb_read_partial(cb, ldbuf, 4U, &count), cb_error_ok);
+    assert_int_equal(count, 4U);
+    assert_memory_equal(ldbuf, lsbuf, 4U * sizeof(*ldbuf));
+    assert_int_equal(cb_read_partial(cb, ldbuf, ARRAY_DIM(ldbuf), &count), cb_error_ok);
+    assert_int_equal(count, 6U);
+    assert_memory_equal(ldbuf, &lsbuf[4U], 2U * sizeof(*ldbuf));
+    assert_memory_equal(&ldbuf[2U], lsbuf, 4U * sizeof(*ldbuf));
+
+    // Wrapping around the end of the linear buffer.
+    assert_int_equal(cb_write_partial(cb, lsbuf, ARRAY_DIM(lsbuf), &count), cb_error_ok);
+    assert_int_equal(count, ARRAY_DIM(lsbuf));
+    assert_int_equal(cb_read_partial(cb, ldbuf, ARRAY_DIM(ldbuf), &count), cb_error_ok);
+    assert_int_equal(count, ARRAY_DIM(lsbuf));
+    assert_memory_equal(ldbuf, lsbuf, sizeof(lsbuf));
+    assert_int_equal(cb_read_partial(cb, ldbuf, 1U, &count), cb_error_empty);
+    assert_int_equal(count, 0U);
+}
+
 /* Exported functions ------------------------------------------------------------------------------------------------*/
 /**
  * @brief Test runner for this suite of tests.
@@ -334,6 +702,11 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_cb_write_read_edge_cases, setup, teardown),
         cmocka_unit_test_setup_teardown(test_cb_write_read_evt_handler_errors, setup, teardown),
         cmocka_unit_test_setup_teardown(test_cb_write_read_full_empty_errors, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_watermarks, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_lock_split, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_lockfree_queries, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_read_batch, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_write_read_partial, setup, teardown),
     };
 
     // Execute the test runner.
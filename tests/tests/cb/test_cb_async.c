@@ -0,0 +1,527 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_async.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/** @defgroup cb_async_tests Tests */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include <sched.h>
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb_copy_engine/cb_copy_engine.h"
+#include "cb/cb.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of loops to perform on the producer and consumer threads. */
+#define THREAD_LOOPS      ((size_t)(1000U))
+/** Number of elements to write and read in producer and consumer threads. */
+#define THREAD_ELEM_COUNT ((size_t)(2U))
+/** Number of worker threads in the copy engine. */
+#define CE_WORKERS        ((size_t)(3U))
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer, with extra element first and last. */
+static test_type_t lcbuf[12U + 1U];
+/** Destination buffer, to be used for read operations in the circular buffer, with extra element first and last. */
+static test_type_t ldbuf[12U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Asynchronous events recorded by the event handler, pending to be performed by the tests. */
+static cb_evt_t evts[2U * CB_ASYNC_MAX_OPS];
+/** Number of asynchronous events recorded by the event handler. */
+static size_t evt_count;
+/** Copy engine. */
+static cb_copy_engine_t ce;
+/** Circular buffer. */
+static cb_t cbuf;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Circular buffer event handler, records the asynchronous events to be performed later by the tests. */
+static cb_error_t cb_evt_handler_record(cb_evt_t * const evt);
+/** Circular buffer event handler, fails to start any asynchronous operation. */
+static cb_error_t cb_evt_handler_error(cb_evt_t * const evt);
+/** Circular buffer event handler, performs the copies at once and completes them within the event handler. */
+static cb_error_t cb_evt_handler_inline(cb_evt_t * const evt);
+/** Performs the copy of a recorded asynchronous event. */
+static void evt_perform(const cb_evt_t * const evt);
+/** Producer thread function, writes asynchronously through the copy engine. */
+static void * pt_func(void * ptr);
+
+/**
+ * @addtogroup cb_async_tests
+ * @{
+ */
+
+/** Tests for invalid arguments. */
+static void test_cb_async_invalid_arguments(void ** state);
+/** Tests that writes and reads completing out of order are published in order. */
+static void test_cb_async_out_of_order(void ** state);
+/** Tests writes and reads that wrap around the end of the underlying linear buffer. */
+static void test_cb_async_wrap(void ** state);
+/** Tests the limit of operations pending completion and errors in the event handler. */
+static void test_cb_async_errors(void ** state);
+/** Tests a producer and consumer with the copy engine performing the copies in worker threads. */
+static void test_cb_async_copy_engine(void ** state);
+/** Tests operations completed within the event handler, without lock events. */
+static void test_cb_async_inline(void ** state);
+/** Tests a producer and consumer with the copies completed by a single worker thread, without lock events. */
+static void test_cb_async_completion_thread(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers and assert their sizes.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    (void)memset(evts, 0, sizeof(evts));
+    evt_count = 0U;
+    assert_int_equal(ARRAY_DIM(lsbuf) + 2U, ARRAY_DIM(ldbuf));
+    assert_int_equal(ARRAY_DIM(lsbuf) + 2U, ARRAY_DIM(lcbuf) - 1U);
+
+    // Initialize circular buffer, leave one element first and at the end for checking out of bounds writes.
+    assert_int_equal(cb_init(&cbuf,
+                             lcbuf + 1U,
+                             ARRAY_DIM(lcbuf) - 2U,
+                             sizeof(*lcbuf),
+                             cb_evt_handler_record,
+                             cb_evt_id_read_async | cb_evt_id_write_async,
+                             NULL),
+                     cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Deinitialize linear buffers.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_handler_record(cb_evt_t * const evt)
+{
+    assert_true((evt->id == cb_evt_id_read_async) || (evt->id == cb_evt_id_write_async));
+
+    // Record event, the operation is performed later, out of the event handler.
+    assert_true(evt_count < ARRAY_DIM(evts));
+    evts[evt_count++] = *evt;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_handler_error(cb_evt_t * const evt)
+{
+    assert_true((evt->id == cb_evt_id_read_async) || (evt->id == cb_evt_id_write_async));
+
+    return cb_error_evt;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_handler_inline(cb_evt_t * const evt)
+{
+    assert_true((evt->id == cb_evt_id_read_async) || (evt->id == cb_evt_id_write_async));
+
+    // Perform the copy and complete it before returning, as a copy that completes at once would.
+    evt_perform(evt);
+    if (evt->id == cb_evt_id_write_async)
+    {
+        assert_int_equal(cb_write_done(&cbuf, evt->data.write_async.seq), cb_error_ok);
+    }
+    else
+    {
+        assert_int_equal(cb_read_done(&cbuf, evt->data.read_async.seq), cb_error_ok);
+    }
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void evt_perform(const cb_evt_t * const evt)
+{
+    if (evt->id == cb_evt_id_write_async)
+    {
+        const cb_evt_data_write_async_t * const data = &evt->data.write_async;
+        (void)memcpy(data->write_ptr, data->buffer, data->bytes);
+        (void)memcpy(data->wrap_ptr, ((const char *)data->buffer) + data->bytes, data->wrap_bytes);
+    }
+    else
+    {
+        const cb_evt_data_read_async_t * const data = &evt->data.read_async;
+        (void)memcpy(data->buffer, data->read_ptr, data->bytes);
+        (void)memcpy(((char *)data->buffer) + data->bytes, data->wrap_ptr, data->wrap_bytes);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * pt_func(void * ptr)
+{
+    cb_t * const cb = (cb_t * const)ptr;
+
+    // Write the entire source buffer in each loop, yielding while full to let the copy engine progress.
+    for (size_t loop = 0U; loop < THREAD_LOOPS; loop++)
+    {
+        size_t item = 0U;
+        while (item < ARRAY_DIM(lsbuf))
+        {
+            if (cb_write(cb, &lsbuf[item], THREAD_ELEM_COUNT) == cb_error_ok)
+            {
+                item += THREAD_ELEM_COUNT;
+            }
+            else
+            {
+                (void)sched_yield();
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_async_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    cb_t cb_other;
+
+    // Check invalid arguments on 'cb_init', synchronous and asynchronous events of the same kind.
+    assert_int_equal(cb_init(&cb_other,
+                             lcbuf,
+                             ARRAY_DIM(lcbuf),
+                             sizeof(*lcbuf),
+                             cb_evt_handler_record,
+                             cb_evt_id_write | cb_evt_id_write_async,
+                             NULL),
+                     cb_error_invalid_args);
+    assert_int_equal(cb_init(&cb_other,
+                             lcbuf,
+                             ARRAY_DIM(lcbuf),
+                             sizeof(*lcbuf),
+                             cb_evt_handler_record,
+                             cb_evt_id_read | cb_evt_id_read_async,
+                             NULL),
+                     cb_error_invalid_args);
+
+    // Check invalid arguments on 'cb_write_done' and 'cb_read_done', including operations not pending completion.
+    assert_int_equal(cb_write_done(NULL, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_read_done(NULL, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_write_done(cb, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_read_done(cb, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_write_done(cb, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_write_done(cb, 0U), cb_error_ok);
+    assert_int_equal(cb_write_done(cb, 0U), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_async_out_of_order(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t count = 0U;
+
+    // Start three writes, the space is reserved but nothing is available for reading until they complete.
+    assert_int_equal(cb_write(cb, &lsbuf[0U], 2U), cb_error_ok);
+    assert_int_equal(cb_write(cb, &lsbuf[2U], 3U), cb_error_ok);
+    assert_int_equal(cb_write(cb, &lsbuf[5U], 1U), cb_error_ok);
+    assert_int_equal(evt_count, 3U);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+    assert_int_equal(count, ARRAY_DIM(lsbuf) - 6U);
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 1U), cb_error_empty);
+
+    // Complete the writes out of order, only when the first one completes they are all published.
+    for (size_t i = 0U; i < evt_count; i++)
+    {
+        assert_int_equal(evts[i].id, cb_evt_id_write_async);
+        assert_int_equal(evts[i].data.write_async.seq, i);
+        assert_int_equal(evts[i].data.write_async.wrap_bytes, 0U);
+        evt_perform(&evts[i]);
+    }
+    assert_int_equal(cb_write_done(cb, 2U), cb_error_ok);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_write_done(cb, 1U), cb_error_ok);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_write_done(cb, 0U), cb_error_ok);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 6U);
+    evt_count = 0U;
+
+    // Start two reads, the slots are not available for writing until they complete.
+    assert_int_equal(cb_read(cb, &ldbuf[1U], 4U), cb_error_ok);
+    assert_int_equal(cb_read(cb, &ldbuf[5U], 2U), cb_error_ok);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+    assert_int_equal(count, ARRAY_DIM(lsbuf) - 6U);
+
+    // Complete the reads out of order.
+    evt_perform(&evts[1U]);
+    assert_int_equal(cb_read_done(cb, 1U), cb_error_ok);
+    assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+    assert_int_equal(count, ARRAY_DIM(lsbuf) - 6U);
+    evt_perform(&evts[0U]);
+    assert_int_equal(cb_read_done(cb, 0U), cb_error_ok);
+    assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+    assert_int_equal(count, ARRAY_DIM(lsbuf));
+
+    // Check the data read and that the buffers have not been overrun.
+    assert_memory_equal(&ldbuf[1U], lsbuf, 6U * sizeof(*ldbuf));
+    assert_int_equal(ldbuf[0U], TEST_CLEAR_VALUE);
+    assert_int_equal(lcbuf[0U], TEST_CLEAR_VALUE);
+    assert_int_equal(lcbuf[ARRAY_DIM(lcbuf) - 1U], TEST_CLEAR_VALUE);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_async_wrap(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    const size_t idx = 7U;
+    const size_t fcount = cb->buffer_length - idx;
+
+    // Move the indexes to the middle of the underlying linear buffer.
+    assert_int_equal(cb_write(cb, lsbuf, idx), cb_error_ok);
+    assert_int_equal(cb_write_done(cb, 0U), cb_error_ok);
+    assert_int_equal(cb_read(cb, &ldbuf[1U], idx), cb_error_ok);
+    assert_int_equal(cb_read_done(cb, 0U), cb_error_ok);
+    evt_count = 0U;
+
+    // Write the full buffer, which wraps around the end of the underlying linear buffer.
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lsbuf)), cb_error_ok);
+    assert_int_equal(evts[0U].data.write_async.bytes, fcount * sizeof(*lcbuf));
+    assert_int_equal(evts[0U].data.write_async.wrap_bytes, (ARRAY_DIM(lsbuf) - fcount) * sizeof(*lcbuf));
+    assert_true(evts[0U].data.write_async.wrap_ptr == cb->buffer);
+    evt_perform(&evts[0U]);
+    assert_int_equal(cb_write_done(cb, 1U), cb_error_ok);
+
+    // Read the full buffer, which wraps around too.
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    assert_int_equal(cb_read(cb, &ldbuf[1U], ARRAY_DIM(lsbuf)), cb_error_ok);
+    assert_int_equal(evts[1U].data.read_async.bytes, fcount * sizeof(*lcbuf));
+    assert_int_equal(evts[1U].data.read_async.wrap_bytes, (ARRAY_DIM(lsbuf) - fcount) * sizeof(*lcbuf));
+    evt_perform(&evts[1U]);
+    assert_int_equal(cb_read_done(cb, 1U), cb_error_ok);
+
+    // Check the data read and that the buffers have not been overrun.
+    assert_memory_equal(&ldbuf[1U], lsbuf, sizeof(lsbuf));
+    assert_int_equal(ldbuf[0U], TEST_CLEAR_VALUE);
+    assert_int_equal(ldbuf[ARRAY_DIM(ldbuf) - 1U], TEST_CLEAR_VALUE);
+    assert_int_equal(lcbuf[0U], TEST_CLEAR_VALUE);
+    assert_int_equal(lcbuf[ARRAY_DIM(lcbuf) - 1U], TEST_CLEAR_VALUE);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_async_errors(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t count = 0U;
+
+    // Fill the table of pending writes, the next write fails even if there is space for it.
+    for (size_t i = 0U; i < CB_ASYNC_MAX_OPS; i++)
+    {
+        assert_int_equal(cb_write(cb, &lsbuf[i], 1U), cb_error_ok);
+    }
+    assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+    assert_true(count > 0U);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_full);
+
+    // Complete a write and retry.
+    assert_int_equal(cb_write_done(cb, 0U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+
+    // Failing to start a write does not reserve any space.
+    assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+    assert_int_equal(cb_write_done(cb, 1U), cb_error_ok);
+    cb->evt_handler = cb_evt_handler_error;
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_evt);
+    size_t count_after = 0U;
+    assert_int_equal(cb_get_unfilled(cb, &count_after), cb_error_ok);
+    assert_int_equal(count, count_after);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_async_copy_engine(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    pthread_t pt_id = 0U;
+    size_t checksum = 0U;
+
+    // Hand the asynchronous events over to the copy engine, which also provides the lock.
+    assert_true(cb_copy_engine_init(&ce, cb, CE_WORKERS));
+    cb->evt_handler = cb_copy_engine_evt_handler;
+    cb->evt_user_data = &ce;
+    cb->evt_sub = cb_evt_id_write_async | cb_evt_id_lock | cb_evt_id_unlock;
+
+    // Produce asynchronously in a thread and consume synchronously in this one.
+    assert_int_equal(pthread_create(&pt_id, NULL, pt_func, cb), 0U);
+    for (size_t loop = 0U; loop < THREAD_LOOPS; loop++)
+    {
+        size_t item = 0U;
+        while (item < ARRAY_DIM(lsbuf))
+        {
+            if (cb_read(cb, &ldbuf[item + 1U], THREAD_ELEM_COUNT) == cb_error_ok)
+            {
+                for (size_t i = 0U; i < THREAD_ELEM_COUNT; i++)
+                {
+                    checksum += ldbuf[item + 1U + i];
+                }
+                item += THREAD_ELEM_COUNT;
+            }
+            else
+            {
+                (void)sched_yield();
+            }
+        }
+    }
+    pthread_join(pt_id, NULL);
+    assert_int_equal(checksum, THREAD_LOOPS * 0x37U);
+
+    // Read asynchronously through the copy engine, each read to a different location of the destination buffer.
+    cb->evt_sub = cb_evt_id_read_async | cb_evt_id_write_async | cb_evt_id_lock | cb_evt_id_unlock;
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lsbuf)), cb_error_ok);
+    cb_copy_engine_wait_idle(&ce);
+    for (size_t item = 0U; item < ARRAY_DIM(lsbuf); item += THREAD_ELEM_COUNT)
+    {
+        assert_int_equal(cb_read(cb, &ldbuf[item + 1U], THREAD_ELEM_COUNT), cb_error_ok);
+    }
+    cb_copy_engine_wait_idle(&ce);
+    assert_memory_equal(&ldbuf[1U], lsbuf, sizeof(lsbuf));
+    bool is_empty = false;
+    assert_int_equal(cb_is_empty(cb, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+
+    // Stop copy engine.
+    cb_copy_engine_deinit(&ce);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_async_inline(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t count = 0U;
+
+    // Operations completed within the event handler are published before returning, beyond the operations tracked.
+    cb->evt_handler = cb_evt_handler_inline;
+    for (size_t i = 0U; i < (2U * CB_ASYNC_MAX_OPS); i++)
+    {
+        (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+        assert_int_equal(cb_write(cb, lsbuf, 3U), cb_error_ok);
+        assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+        assert_int_equal(count, 3U);
+        assert_int_equal(cb_read(cb, &ldbuf[1U], 3U), cb_error_ok);
+        assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+        assert_int_equal(count, 0U);
+        assert_int_equal(cb_get_unfilled(cb, &count), cb_error_ok);
+        assert_int_equal(count, ARRAY_DIM(lsbuf));
+        assert_memory_equal(&ldbuf[1U], lsbuf, 3U * sizeof(*ldbuf));
+        assert_int_equal(ldbuf[0U], TEST_CLEAR_VALUE);
+    }
+    assert_int_equal(cb_write_done(cb, 2U * CB_ASYNC_MAX_OPS), cb_error_invalid_args);
+    assert_int_equal(lcbuf[0U], TEST_CLEAR_VALUE);
+    assert_int_equal(lcbuf[ARRAY_DIM(lcbuf) - 1U], TEST_CLEAR_VALUE);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_async_completion_thread(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    pthread_t pt_id = 0U;
+    size_t checksum = 0U;
+
+    // A single worker completes the copies while the producer and consumer run, without lock events.
+    assert_true(cb_copy_engine_init(&ce, cb, 1U));
+    cb->evt_handler = cb_copy_engine_evt_handler;
+    cb->evt_user_data = &ce;
+    cb->evt_sub = cb_evt_id_write_async;
+
+    // Produce asynchronously in a thread and consume synchronously in this one.
+    assert_int_equal(pthread_create(&pt_id, NULL, pt_func, cb), 0U);
+    for (size_t loop = 0U; loop < THREAD_LOOPS; loop++)
+    {
+        size_t item = 0U;
+        while (item < ARRAY_DIM(lsbuf))
+        {
+            if (cb_read(cb, &ldbuf[item + 1U], THREAD_ELEM_COUNT) == cb_error_ok)
+            {
+                for (size_t i = 0U; i < THREAD_ELEM_COUNT; i++)
+                {
+                    checksum += ldbuf[item + 1U + i];
+                }
+                item += THREAD_ELEM_COUNT;
+            }
+            else
+            {
+                (void)sched_yield();
+            }
+        }
+    }
+    pthread_join(pt_id, NULL);
+    assert_int_equal(checksum, THREAD_LOOPS * 0x37U);
+    bool is_empty = false;
+    assert_int_equal(cb_is_empty(cb, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+
+    // Stop copy engine.
+    cb_copy_engine_deinit(&ce);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_async_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_async_out_of_order, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_async_wrap, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_async_errors, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_async_copy_engine, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_async_inline, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_async_completion_thread, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_async", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
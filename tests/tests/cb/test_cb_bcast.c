@@ -0,0 +1,340 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_bcast.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb_bcast.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of consumer threads attached from the start in the concurrency tests, another one attaches later. */
+#define CONSUMERS (2U)
+
+/** Number of elements written by the producer thread in the concurrency tests. */
+#define ELEMS (20000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the broadcast ring. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the broadcast ring. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the broadcast ring. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Broadcast ring. */
+static cb_bcast_t bcast;
+/** Number of elements written by the producer thread, in the concurrency tests. */
+static atomic_size_t written;
+/** Set when the producer thread wrote all the elements, in the concurrency tests. */
+static atomic_bool produced;
+/** Number of elements read by each consumer thread, in the concurrency tests. */
+static size_t consumed_counts[CONSUMERS + 1U];
+/** Set if a consumer thread read an element out of order, in the concurrency tests. */
+static atomic_bool out_of_order;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Producer thread, writes consecutive elements one at a time. */
+static void * producer(void * ptr);
+/** Consumer thread, reads elements one at a time with the cursor provided, until all elements were written and read. */
+static void * consumer(void * ptr);
+/** Consumer thread that attaches while the producer writes, and then reads as ::consumer. */
+static void * late_consumer(void * ptr);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the broadcast rings. */
+static void test_cb_bcast_invalid_arguments(void ** state);
+/** Tests for multiple consumers with a single thread, each reading every element and bounding the producer. */
+static void test_cb_bcast_single_thread(void ** state);
+/** Tests for a producer and multiple consumers in threads, with a consumer attaching while the producer writes. */
+static void test_cb_bcast_threads(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Initialize broadcast ring.
+    assert_int_equal(cb_bcast_init(&bcast, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf)), cb_error_ok);
+
+    // Assign broadcast ring to tests.
+    *state = &bcast;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_bcast_t * const bc = (cb_bcast_t * const)*state;
+
+    // Deinitialize broadcast ring.
+    assert_int_equal(cb_bcast_deinit(bc), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer(void * ptr)
+{
+    (void)ptr;
+
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        const test_type_t elem = (test_type_t)i;
+        while (cb_bcast_write(&bcast, &elem, 1U) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+        (void)atomic_fetch_add(&written, 1U);
+    }
+    atomic_store(&produced, true);
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * consumer(void * ptr)
+{
+    const size_t cursor = (size_t)ptr;
+    test_type_t prev = 0U;
+
+    for (;;)
+    {
+        // Check if done before reading, so the elements written before the producer finished are all read.
+        const bool done = atomic_load(&produced);
+        test_type_t elem = 0U;
+        if (cb_bcast_read(&bcast, cursor, &elem, 1U) == cb_error_ok)
+        {
+            // Every element is read in order, the first one can be any for the consumer attached later.
+            if ((consumed_counts[cursor] > 0U) && (elem != (test_type_t)(prev + 1U)))
+            {
+                atomic_store(&out_of_order, true);
+            }
+            prev = elem;
+            consumed_counts[cursor]++;
+        }
+        else if (done)
+        {
+            break;
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * late_consumer(void * ptr)
+{
+    size_t cursor = 0U;
+
+    // Let the producer start, and then attach.
+    (void)ptr;
+    while (atomic_load(&written) < (ELEMS / 4U))
+    {
+        (void)sched_yield();
+    }
+    if (cb_bcast_attach(&bcast, &cursor) != cb_error_ok)
+    {
+        atomic_store(&out_of_order, true);
+        return NULL;
+    }
+
+    return consumer((void *)cursor);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_bcast_invalid_arguments(void ** state)
+{
+    cb_bcast_t * const bc = (cb_bcast_t * const)*state;
+    size_t cursor = 0U;
+    size_t count = 0U;
+
+    // Invalid arguments on initialization.
+    assert_int_equal(cb_bcast_init(NULL, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_init(bc, NULL, ARRAY_DIM(lcbuf), sizeof(*lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_init(bc, lcbuf, 1U, sizeof(*lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_init(bc, lcbuf, ARRAY_DIM(lcbuf), 0U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_deinit(NULL), cb_error_invalid_args);
+
+    // Invalid arguments on the producer functions.
+    assert_int_equal(cb_bcast_write(NULL, lsbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_write(bc, NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_write(bc, lsbuf, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_get_unfilled(NULL, &count), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_get_unfilled(bc, NULL), cb_error_invalid_args);
+
+    // Invalid arguments on the consumer functions, including cursors not attached.
+    assert_int_equal(cb_bcast_attach(NULL, &cursor), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_attach(bc, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_detach(NULL, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_detach(bc, CB_BCAST_MAX_CURSORS), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_detach(bc, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_read(bc, 0U, ldbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_peek(bc, 0U, ldbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_get_filled(bc, 0U, &count), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_attach(bc, &cursor), cb_error_ok);
+    assert_int_equal(cb_bcast_read(NULL, cursor, ldbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_read(bc, CB_BCAST_MAX_CURSORS, ldbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_read(bc, cursor, NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_read(bc, cursor, ldbuf, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_peek(bc, cursor, NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_get_filled(NULL, cursor, &count), cb_error_invalid_args);
+    assert_int_equal(cb_bcast_get_filled(bc, cursor, NULL), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_bcast_single_thread(void ** state)
+{
+    cb_bcast_t * const bc = (cb_bcast_t * const)*state;
+    size_t cursors[CB_BCAST_MAX_CURSORS];
+    size_t count = 0U;
+
+    // Without consumers the elements are discarded, the whole capacity is available.
+    assert_int_equal(cb_bcast_write(bc, lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_bcast_write(bc, lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_bcast_get_unfilled(bc, &count), cb_error_ok);
+    assert_int_equal(count, 10U);
+
+    // Consumers attached read the elements written from then on.
+    assert_int_equal(cb_bcast_attach(bc, &cursors[0U]), cb_error_ok);
+    assert_int_equal(cb_bcast_attach(bc, &cursors[1U]), cb_error_ok);
+    assert_int_not_equal(cursors[0U], cursors[1U]);
+    assert_int_equal(cb_bcast_get_filled(bc, cursors[0U], &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_bcast_read(bc, cursors[0U], ldbuf, 1U), cb_error_empty);
+
+    // Each consumer reads every element, wrapping around, and the slowest bounds the producer.
+    assert_int_equal(cb_bcast_write(bc, lsbuf, 6U), cb_error_ok);
+    assert_int_equal(cb_bcast_read(bc, cursors[0U], ldbuf, 6U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 6U * sizeof(*ldbuf));
+    assert_int_equal(cb_bcast_peek(bc, cursors[1U], ldbuf, 3U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 3U * sizeof(*ldbuf));
+    assert_int_equal(cb_bcast_read(bc, cursors[1U], ldbuf, 2U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 2U * sizeof(*ldbuf));
+    assert_int_equal(cb_bcast_get_filled(bc, cursors[1U], &count), cb_error_ok);
+    assert_int_equal(count, 4U);
+    assert_int_equal(cb_bcast_get_unfilled(bc, &count), cb_error_ok);
+    assert_int_equal(count, 6U);
+    assert_int_equal(cb_bcast_write(bc, lsbuf, 7U), cb_error_full);
+    assert_int_equal(cb_bcast_write(bc, lsbuf, 6U), cb_error_ok);
+    assert_int_equal(cb_bcast_read(bc, cursors[0U], ldbuf, 7U), cb_error_empty);
+    assert_int_equal(cb_bcast_read(bc, cursors[0U], ldbuf, 6U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 6U * sizeof(*ldbuf));
+    assert_int_equal(cb_bcast_read(bc, cursors[1U], ldbuf, 10U), cb_error_ok);
+    assert_memory_equal(ldbuf, &lsbuf[2U], 4U * sizeof(*ldbuf));
+    assert_memory_equal(&ldbuf[4U], lsbuf, 6U * sizeof(*ldbuf));
+
+    // Detached consumers no longer bound the producer.
+    assert_int_equal(cb_bcast_write(bc, lsbuf, 5U), cb_error_ok);
+    assert_int_equal(cb_bcast_read(bc, cursors[0U], ldbuf, 5U), cb_error_ok);
+    assert_int_equal(cb_bcast_get_unfilled(bc, &count), cb_error_ok);
+    assert_int_equal(count, 5U);
+    assert_int_equal(cb_bcast_detach(bc, cursors[1U]), cb_error_ok);
+    assert_int_equal(cb_bcast_get_unfilled(bc, &count), cb_error_ok);
+    assert_int_equal(count, 10U);
+    assert_int_equal(cb_bcast_read(bc, cursors[1U], ldbuf, 1U), cb_error_invalid_args);
+
+    // Up to the maximum number of consumers can be attached.
+    for (size_t i = 1U; i < CB_BCAST_MAX_CURSORS; i++)
+    {
+        assert_int_equal(cb_bcast_attach(bc, &cursors[i]), cb_error_ok);
+    }
+    assert_int_equal(cb_bcast_attach(bc, &count), cb_error_full);
+    for (size_t i = 0U; i < CB_BCAST_MAX_CURSORS; i++)
+    {
+        assert_int_equal(cb_bcast_detach(bc, cursors[i]), cb_error_ok);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_bcast_threads(void ** state)
+{
+    cb_bcast_t * const bc = (cb_bcast_t * const)*state;
+    pthread_t producer_thread;
+    pthread_t consumer_threads[CONSUMERS + 1U];
+    size_t cursors[CONSUMERS];
+
+    atomic_init(&written, 0U);
+    atomic_init(&produced, false);
+    atomic_init(&out_of_order, false);
+    (void)memset(consumed_counts, 0, sizeof(consumed_counts));
+
+    // Attach the consumers before the producer starts, they read every element.
+    for (size_t t = 0U; t < CONSUMERS; t++)
+    {
+        assert_int_equal(cb_bcast_attach(bc, &cursors[t]), cb_error_ok);
+        assert_int_equal(cursors[t], t);
+        assert_int_equal(pthread_create(&consumer_threads[t], NULL, consumer, (void *)cursors[t]), 0);
+    }
+    assert_int_equal(pthread_create(&consumer_threads[CONSUMERS], NULL, late_consumer, NULL), 0);
+    assert_int_equal(pthread_create(&producer_thread, NULL, producer, NULL), 0);
+
+    assert_int_equal(pthread_join(producer_thread, NULL), 0);
+    for (size_t t = 0U; t <= CONSUMERS; t++)
+    {
+        assert_int_equal(pthread_join(consumer_threads[t], NULL), 0);
+    }
+
+    // Every consumer read the elements in order, all of them except the one attached later.
+    assert_false(atomic_load(&out_of_order));
+    for (size_t t = 0U; t < CONSUMERS; t++)
+    {
+        assert_int_equal(consumed_counts[t], ELEMS);
+    }
+    assert_true(consumed_counts[CONSUMERS] <= ELEMS);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_bcast_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_bcast_single_thread, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_bcast_threads, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_bcast", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
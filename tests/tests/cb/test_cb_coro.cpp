@@ -0,0 +1,230 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_coro.cpp
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+// The C++ standard library before CMocka, as its macros collide with names in the former, e.g. fail.
+#include "cb/cb_coro.hpp"
+#include <array>
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include <pthread.h>
+#include <sched.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of elements written by the producer in the concurrency tests, multiple of the batch sizes. */
+#define ELEMS (12000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Circular buffer. */
+static cb_t lcb;
+/** Number of elements read by the consumer coroutine. */
+static size_t consumed;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Producer coroutine, writes consecutive elements in batches of three. */
+static cb::task producer(cb::ring<test_type_t> & ring);
+/** Consumer coroutine, reads consecutive elements in batches of four and checks them. */
+static cb::task consumer(cb::ring<test_type_t> & ring);
+/** Producer thread, writes consecutive elements in batches of three with the C functions. */
+static void * producer_thread(void * ptr);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the coroutine reads and writes. */
+static void test_cb_coro_invalid_arguments(void ** state);
+/** Tests for a producer and a consumer coroutine in the same scheduler, suspending each other. */
+static void test_cb_coro_single_thread(void ** state);
+/** Tests for a consumer coroutine, with a producer in another thread writing with the C functions. */
+static void test_cb_coro_threads(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffer.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+
+    // Initialize circular buffer.
+    assert_int_equal(cb_init(&lcb, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL), cb_error_ok);
+    consumed = 0U;
+
+    // Assign circular buffer to tests.
+    *state = &lcb;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = static_cast<cb_t *>(*state);
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb::task producer(cb::ring<test_type_t> & ring)
+{
+    for (size_t i = 0U; i < ELEMS; i += 3U)
+    {
+        const std::array<test_type_t, 3U> elems = {static_cast<test_type_t>(i),
+                                                   static_cast<test_type_t>(i + 1U),
+                                                   static_cast<test_type_t>(i + 2U)};
+        assert_int_equal(co_await ring.write(elems), cb_error_ok);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb::task consumer(cb::ring<test_type_t> & ring)
+{
+    while (consumed < ELEMS)
+    {
+        const std::vector<test_type_t> elems = co_await ring.read(4U);
+        assert_int_equal(elems.size(), 4U);
+        for (const test_type_t elem : elems)
+        {
+            assert_int_equal(elem, static_cast<test_type_t>(consumed));
+            consumed++;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer_thread(void * ptr)
+{
+    cb_t * const cb = static_cast<cb_t *>(ptr);
+
+    for (size_t i = 0U; i < ELEMS; i += 3U)
+    {
+        const test_type_t elems[3U] = {static_cast<test_type_t>(i),
+                                       static_cast<test_type_t>(i + 1U),
+                                       static_cast<test_type_t>(i + 2U)};
+        while (cb_write(cb, elems, ARRAY_DIM(elems)) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_coro_invalid_arguments(void ** state)
+{
+    cb_t * const cb = static_cast<cb_t *>(*state);
+    cb::scheduler sched;
+    cb::ring<test_type_t> ring(*cb, sched);
+
+    // Invalid number of elements, or elements of another size, complete without suspending.
+    sched.spawn([](cb::ring<test_type_t> & r, cb_t & c, cb::scheduler & s) -> cb::task {
+        const std::array<test_type_t, 11U> elems = {};
+        assert_int_equal(co_await r.write(std::span<const test_type_t>()), cb_error_invalid_args);
+        assert_int_equal(co_await r.write(elems), cb_error_invalid_args);
+        assert_true((co_await r.read(0U)).empty());
+        assert_true((co_await r.read(11U)).empty());
+        cb::ring<uint16_t> wide(c, s);
+        cb::ring<uint8_t> narrow(c, s);
+        if (c.elem_size == sizeof(uint8_t))
+        {
+            assert_int_equal(co_await wide.write(std::array<uint16_t, 1U>{}), cb_error_invalid_args);
+            assert_true((co_await wide.read(1U)).empty());
+        }
+        else
+        {
+            assert_int_equal(co_await narrow.write(std::array<uint8_t, 1U>{}), cb_error_invalid_args);
+            assert_true((co_await narrow.read(1U)).empty());
+        }
+
+        // The maximum number of elements, as the capacity of the circular buffer.
+        assert_int_equal(co_await r.write(std::span<const test_type_t>(elems.data(), 10U)), cb_error_ok);
+        assert_int_equal((co_await r.read(10U)).size(), 10U);
+        consumed = 1U;
+    }(ring, *cb, sched));
+    sched.run();
+    assert_int_equal(consumed, 1U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_coro_single_thread(void ** state)
+{
+    cb_t * const cb = static_cast<cb_t *>(*state);
+    cb::scheduler sched;
+    cb::ring<test_type_t> ring(*cb, sched);
+
+    // The consumer suspends first on the empty circular buffer, and the producer suspends when it fills it.
+    sched.spawn(consumer(ring));
+    sched.spawn(producer(ring));
+    sched.run();
+    assert_int_equal(consumed, ELEMS);
+
+    // Nothing is left in the circular buffer.
+    bool is_empty = false;
+    assert_int_equal(cb_is_empty(cb, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_coro_threads(void ** state)
+{
+    cb_t * const cb = static_cast<cb_t *>(*state);
+    cb::scheduler sched;
+    cb::ring<test_type_t> ring(*cb, sched);
+    pthread_t thread;
+
+    // The consumer coroutine resumes as the producer thread writes.
+    assert_int_equal(pthread_create(&thread, NULL, producer_thread, cb), 0);
+    sched.spawn(consumer(ring));
+    sched.run();
+    assert_int_equal(pthread_join(thread, NULL), 0);
+    assert_int_equal(consumed, ELEMS);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_coro_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_coro_single_thread, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_coro_threads, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_coro", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
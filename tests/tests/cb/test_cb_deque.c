@@ -0,0 +1,325 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_deque.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb_deque.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of thief threads in the concurrency tests. */
+#define THIEVES (2U)
+
+/** Number of elements pushed by the owner thread in the concurrency tests. */
+#define ELEMS (20000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Linear buffers for the deque, the first one it is initialized with and the first one it grows into. */
+/** @{ */
+static test_type_t lcbuf[4U];
+static test_type_t lcbuf_grown[8U];
+/** @} */
+/** Linear buffers for the deque to grow into, doubling each time, large enough for elements of type @c size_t. */
+static size_t lcbufs_grown[CB_DEQUE_MAX_BUFFERS][4U << CB_DEQUE_MAX_BUFFERS];
+/** Source buffer, to be used for push operations in the deque. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Deque. */
+static cb_deque_t deque;
+/** Number of times each element was popped or stolen, in the concurrency tests. */
+static atomic_uint taken[ELEMS];
+/** Number of elements stolen by the thief threads, in the concurrency tests. */
+static atomic_size_t stolen;
+/** Set when the owner thread finished pushing and popping, in the concurrency tests. */
+static atomic_bool done;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Owner thread, pushes the elements in bursts, growing when full, and pops some of them in between. */
+static void * owner(void * ptr);
+/** Thief thread, steals elements until the owner finished and the deque is empty. */
+static void * thief(void * ptr);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the deques. */
+static void test_cb_deque_invalid_arguments(void ** state);
+/** Tests for the deques with a single thread, pops last in first out and steals first in first out, and growing. */
+static void test_cb_deque_single_thread(void ** state);
+/** Tests for an owner pushing and popping while thieves steal, each in its own thread. */
+static void test_cb_deque_threads(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(lcbuf_grown, 0xFFU, sizeof(lcbuf_grown));
+
+    // Initialize deque.
+    assert_int_equal(cb_deque_init(&deque, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf)), cb_error_ok);
+
+    // Assign deque to tests.
+    *state = &deque;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_deque_t * const dq = (cb_deque_t * const)*state;
+
+    // Deinitialize deque.
+    assert_int_equal(cb_deque_deinit(dq), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * owner(void * ptr)
+{
+    size_t grown = 0U;
+    size_t elem = 0U;
+
+    (void)ptr;
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        // Grow into the next linear buffer when full, and once all of them are used wait for the thieves.
+        while (cb_deque_push(&deque, &i) == cb_error_full)
+        {
+            if ((grown + 1U) < CB_DEQUE_MAX_BUFFERS)
+            {
+                (void)cb_deque_grow(&deque, lcbufs_grown[grown], 4U << (grown + 1U));
+                grown++;
+            }
+            else
+            {
+                (void)sched_yield();
+            }
+        }
+        // Pop one of every few elements, the last one pushed unless it was stolen.
+        if (((i % 3U) == 0U) && (cb_deque_pop(&deque, &elem) == cb_error_ok))
+        {
+            (void)atomic_fetch_add(&taken[elem], 1U);
+        }
+    }
+    // Pop the rest of the elements, along with the thieves.
+    while (cb_deque_pop(&deque, &elem) == cb_error_ok)
+    {
+        (void)atomic_fetch_add(&taken[elem], 1U);
+    }
+    atomic_store(&done, true);
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * thief(void * ptr)
+{
+    (void)ptr;
+
+    for (;;)
+    {
+        // Check if done before stealing, so the elements pushed before the owner finished are all taken.
+        const bool finished = atomic_load(&done);
+        size_t elem = 0U;
+        if (cb_deque_steal(&deque, &elem) == cb_error_ok)
+        {
+            (void)atomic_fetch_add(&taken[elem], 1U);
+            (void)atomic_fetch_add(&stolen, 1U);
+        }
+        else if (finished)
+        {
+            break;
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_deque_invalid_arguments(void ** state)
+{
+    cb_deque_t * const dq = (cb_deque_t * const)*state;
+    test_type_t elem = 0U;
+    size_t count = 0U;
+
+    // Invalid arguments on initialization.
+    assert_int_equal(cb_deque_init(NULL, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_deque_init(dq, NULL, ARRAY_DIM(lcbuf), sizeof(*lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_deque_init(dq, lcbuf, 1U, sizeof(*lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_deque_init(dq, lcbuf, (SIZE_MAX / 2U) + 1U, sizeof(*lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_deque_init(dq, lcbuf, ARRAY_DIM(lcbuf), 0U), cb_error_invalid_args);
+    assert_int_equal(cb_deque_deinit(NULL), cb_error_invalid_args);
+
+    // Invalid arguments on growing, including linear buffers not larger than the current one.
+    assert_int_equal(cb_deque_grow(NULL, lcbuf_grown, ARRAY_DIM(lcbuf_grown)), cb_error_invalid_args);
+    assert_int_equal(cb_deque_grow(dq, NULL, ARRAY_DIM(lcbuf_grown)), cb_error_invalid_args);
+    assert_int_equal(cb_deque_grow(dq, lcbuf_grown, ARRAY_DIM(lcbuf)), cb_error_invalid_args);
+    assert_int_equal(cb_deque_grow(dq, lcbuf_grown, (SIZE_MAX / 2U) + 1U), cb_error_invalid_args);
+
+    // Invalid arguments on the rest of the functions.
+    assert_int_equal(cb_deque_push(NULL, &elem), cb_error_invalid_args);
+    assert_int_equal(cb_deque_push(dq, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_deque_pop(NULL, &elem), cb_error_invalid_args);
+    assert_int_equal(cb_deque_pop(dq, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_deque_steal(NULL, &elem), cb_error_invalid_args);
+    assert_int_equal(cb_deque_steal(dq, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_deque_get_filled(NULL, &count), cb_error_invalid_args);
+    assert_int_equal(cb_deque_get_filled(dq, NULL), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_deque_single_thread(void ** state)
+{
+    cb_deque_t * const dq = (cb_deque_t * const)*state;
+    test_type_t elem = 0U;
+    size_t count = 0U;
+
+    // Nothing is popped or stolen while empty.
+    assert_int_equal(cb_deque_pop(dq, &elem), cb_error_empty);
+    assert_int_equal(cb_deque_steal(dq, &elem), cb_error_empty);
+    assert_int_equal(cb_deque_get_filled(dq, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+
+    // All the elements of the linear buffer are used, pops are last in first out and steals first in first out.
+    for (size_t i = 0U; i < ARRAY_DIM(lcbuf); i++)
+    {
+        assert_int_equal(cb_deque_push(dq, &lsbuf[i]), cb_error_ok);
+    }
+    assert_int_equal(cb_deque_push(dq, &lsbuf[4U]), cb_error_full);
+    assert_int_equal(cb_deque_pop(dq, &elem), cb_error_ok);
+    assert_int_equal(elem, lsbuf[3U]);
+    assert_int_equal(cb_deque_steal(dq, &elem), cb_error_ok);
+    assert_int_equal(elem, lsbuf[0U]);
+    assert_int_equal(cb_deque_get_filled(dq, &count), cb_error_ok);
+    assert_int_equal(count, 2U);
+
+    // Wrapping around the end of the linear buffer.
+    assert_int_equal(cb_deque_push(dq, &lsbuf[4U]), cb_error_ok);
+    assert_int_equal(cb_deque_push(dq, &lsbuf[5U]), cb_error_ok);
+    assert_int_equal(cb_deque_push(dq, &lsbuf[6U]), cb_error_full);
+
+    // Growing keeps the elements and their order, and the new linear buffer is used from then on.
+    assert_int_equal(cb_deque_grow(dq, lcbuf_grown, ARRAY_DIM(lcbuf_grown)), cb_error_ok);
+    for (size_t i = 6U; i < 10U; i++)
+    {
+        assert_int_equal(cb_deque_push(dq, &lsbuf[i]), cb_error_ok);
+    }
+    assert_int_equal(cb_deque_push(dq, &lsbuf[0U]), cb_error_full);
+    assert_int_equal(cb_deque_get_filled(dq, &count), cb_error_ok);
+    assert_int_equal(count, 8U);
+    const test_type_t stolen_order[] = {lsbuf[1U], lsbuf[2U], lsbuf[4U], lsbuf[5U]};
+    for (size_t i = 0U; i < ARRAY_DIM(stolen_order); i++)
+    {
+        assert_int_equal(cb_deque_steal(dq, &elem), cb_error_ok);
+        assert_int_equal(elem, stolen_order[i]);
+    }
+    for (size_t i = 9U; i >= 6U; i--)
+    {
+        assert_int_equal(cb_deque_pop(dq, &elem), cb_error_ok);
+        assert_int_equal(elem, lsbuf[i]);
+    }
+    assert_int_equal(cb_deque_pop(dq, &elem), cb_error_empty);
+    assert_int_equal(cb_deque_steal(dq, &elem), cb_error_empty);
+
+    // Up to the maximum number of linear buffers can be used.
+    for (size_t i = 2U; i < CB_DEQUE_MAX_BUFFERS; i++)
+    {
+        assert_int_equal(cb_deque_grow(dq, lcbufs_grown[i], 4U << i), cb_error_ok);
+    }
+    assert_int_equal(cb_deque_grow(dq, lcbufs_grown[0U], ARRAY_DIM(lcbufs_grown[0U])), cb_error_full);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_deque_threads(void ** state)
+{
+    cb_deque_t * const dq = (cb_deque_t * const)*state;
+    static size_t lcbuf_threads[4U];
+    pthread_t owner_thread;
+    pthread_t thief_threads[THIEVES];
+
+    // The elements are the indexes of their counters, thus the deque is initialized again for them.
+    assert_int_equal(cb_deque_deinit(dq), cb_error_ok);
+    assert_int_equal(cb_deque_init(dq, lcbuf_threads, ARRAY_DIM(lcbuf_threads), sizeof(*lcbuf_threads)), cb_error_ok);
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        atomic_init(&taken[i], 0U);
+    }
+    atomic_init(&stolen, 0U);
+    atomic_init(&done, false);
+
+    for (size_t t = 0U; t < THIEVES; t++)
+    {
+        assert_int_equal(pthread_create(&thief_threads[t], NULL, thief, NULL), 0);
+    }
+    assert_int_equal(pthread_create(&owner_thread, NULL, owner, NULL), 0);
+
+    assert_int_equal(pthread_join(owner_thread, NULL), 0);
+    for (size_t t = 0U; t < THIEVES; t++)
+    {
+        assert_int_equal(pthread_join(thief_threads[t], NULL), 0);
+    }
+
+    // Every element was taken exactly once, by the owner or by a thief.
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        assert_int_equal(atomic_load(&taken[i]), 1U);
+    }
+    assert_true(atomic_load(&stolen) > 0U);
+    size_t count = 0U;
+    assert_int_equal(cb_deque_get_filled(dq, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_deque_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_deque_single_thread, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_deque_threads, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_deque", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,294 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_eventfd.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+// For poll and eventfd, must be defined before any system header is included.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of elements written by the producer thread in the concurrency tests. */
+#define ELEMS (50000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t lcb;
+/** The readable and writable file descriptors of the circular buffer. */
+static int fds[2U] = {-1, -1};
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Reads the counter of a file descriptor, resetting it, zero if it was not signaled. */
+static uint64_t fd_take(const int fd);
+/** Sleeps until a file descriptor is signaled, and resets it. */
+static void fd_wait(const int fd);
+/** Producer thread, writes consecutive elements one at a time, sleeping on the writable file descriptor when full. */
+static void * producer(void * ptr);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the readiness file descriptors. */
+static void test_cb_eventfd_invalid_arguments(void ** state);
+/** Tests for the readiness file descriptors signaled only on the edges, with a single thread. */
+static void test_cb_eventfd_edges(void ** state);
+/** Tests for a producer and a consumer sleeping on the readiness file descriptors, each in its own thread. */
+static void test_cb_eventfd_threads(void ** state);
+/** Tests for the readable file descriptor with processing stages, signaled by the last stage instead of the writes. */
+static void test_cb_eventfd_stages(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Initialize circular buffer and its readiness file descriptors.
+    assert_int_equal(cb_init(&lcb, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL), cb_error_ok);
+    for (size_t i = 0U; i < ARRAY_DIM(fds); i++)
+    {
+        fds[i] = eventfd(0U, EFD_NONBLOCK);
+        assert_true(fds[i] >= 0);
+    }
+    assert_int_equal(cb_set_eventfd(&lcb, fds[0U], fds[1U]), cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &lcb;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer, and close the file descriptors.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+    for (size_t i = 0U; i < ARRAY_DIM(fds); i++)
+    {
+        assert_int_equal(close(fds[i]), 0);
+        fds[i] = -1;
+    }
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t fd_take(const int fd)
+{
+    uint64_t value = 0U;
+
+    return (read(fd, &value, sizeof(value)) == (ssize_t)sizeof(value)) ? (value) : (0U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void fd_wait(const int fd)
+{
+    struct pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+
+    assert_int_equal(poll(&pfd, 1U, -1), 1);
+    (void)fd_take(fd);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer(void * ptr)
+{
+    (void)ptr;
+
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        const test_type_t elem = (test_type_t)i;
+        while (cb_write(&lcb, &elem, 1U) != cb_error_ok)
+        {
+            fd_wait(fds[1U]);
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_eventfd_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Invalid arguments, and after the deinitialization the file descriptors are not set.
+    assert_int_equal(cb_set_eventfd(NULL, fds[0U], fds[1U]), cb_error_invalid_args);
+    assert_int_equal(cb->evfd_readable, fds[0U]);
+    assert_int_equal(cb->evfd_writable, fds[1U]);
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+    assert_int_equal(cb->evfd_readable, -1);
+    assert_int_equal(cb->evfd_writable, -1);
+    assert_int_equal(cb_init(cb, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL), cb_error_ok);
+    assert_int_equal(cb->evfd_readable, -1);
+    assert_int_equal(cb->evfd_writable, -1);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_eventfd_edges(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Nothing is signaled until the circular buffer is written or read.
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(fd_take(fds[1U]), 0U);
+
+    // Only the write that makes it not empty signals the readable file descriptor.
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 1U);
+    assert_int_equal(fd_take(fds[1U]), 0U);
+
+    // Reads that leave it not empty, or that find it not full before, do not signal either.
+    assert_int_equal(cb_read(cb, ldbuf, 4U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_empty);
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(fd_take(fds[1U]), 0U);
+
+    // Once drained, the next write signals the readable file descriptor again, and once full, the next read signals the
+    // writable one, writes that fail do not signal.
+    assert_int_equal(cb_write(cb, lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_full);
+    assert_int_equal(fd_take(fds[0U]), 1U);
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(fd_take(fds[1U]), 1U);
+
+    // Without file descriptors nothing is signaled, and each can be set on its own.
+    assert_int_equal(cb_set_eventfd(cb, -1, fds[1U]), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 4U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(fd_take(fds[1U]), 1U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_eventfd_threads(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    pthread_t producer_thread;
+    size_t next = 0U;
+
+    // The producer in its own thread, and the consumer in this one, sleeping on the readable file descriptor when
+    // empty, after it was reset and the circular buffer read until empty, so no signal is missed.
+    assert_int_equal(pthread_create(&producer_thread, NULL, producer, NULL), 0);
+    while (next < ELEMS)
+    {
+        fd_wait(fds[0U]);
+        size_t filled = 0U;
+        while ((cb_get_filled(cb, &filled) == cb_error_ok) && (filled > 0U))
+        {
+            filled = (filled > ARRAY_DIM(ldbuf)) ? (ARRAY_DIM(ldbuf)) : (filled);
+            assert_int_equal(cb_read(cb, ldbuf, filled), cb_error_ok);
+            for (size_t i = 0U; i < filled; i++)
+            {
+                assert_int_equal(ldbuf[i], (test_type_t)next);
+                next++;
+            }
+        }
+    }
+    assert_int_equal(pthread_join(producer_thread, NULL), 0);
+    assert_int_equal(next, ELEMS);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_eventfd_stages(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    void * elems = NULL;
+    size_t count = 0U;
+
+    // The elements written can't be read until processed, thus the writes do not signal the readable file descriptor.
+    assert_int_equal(cb_set_stages(cb, 2U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_ok);
+    assert_int_equal(cb_stage_release(cb, 0U, count), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_empty);
+
+    // The last stage signals it when it makes the elements readable, only if the consumer read all those before.
+    assert_int_equal(cb_stage_release(cb, 1U, 2U), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 1U);
+    assert_int_equal(cb_stage_release(cb, 1U, 1U), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 3U * sizeof(*ldbuf));
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_empty);
+
+    // Once drained, the next elements released by the last stage signal it again, and writes still do not.
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_ok);
+    assert_int_equal(cb_stage_release(cb, 0U, count), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 0U);
+    assert_int_equal(cb_stage_claim(cb, 1U, &elems, &count), cb_error_ok);
+    assert_int_equal(cb_stage_release(cb, 1U, count), cb_error_ok);
+    assert_int_equal(fd_take(fds[0U]), 1U);
+    assert_int_equal(cb_read(cb, ldbuf, 2U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 2U * sizeof(*ldbuf));
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_eventfd_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_eventfd_edges, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_eventfd_threads, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_eventfd_stages, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_eventfd", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,257 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_latency.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+#include "cb/cb_hist.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t cbuf;
+/** Histogram for the latencies. */
+static cb_hist_t hist;
+/** Current time returned by the clock. */
+static uint64_t now;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Clock for the latency measurements, returns the time set by the tests. */
+static uint64_t clock_now(void);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for invalid arguments in the histogram and latency functions. */
+static void test_cb_latency_invalid_arguments(void ** state);
+/** Tests for the percentiles of a histogram. */
+static void test_cb_latency_hist_percentiles(void ** state);
+/** Tests for sampled latency measurements, with reads not aligned to writes. */
+static void test_cb_latency_sampled(void ** state);
+/** Tests for latency measurements when samples wrap around and when there are too many pending. */
+static void test_cb_latency_wrap_max_samples(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers, histogram and clock.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    assert_int_equal(cb_hist_init(&hist), cb_error_ok);
+    now = 0U;
+
+    // Initialize circular buffer, with capacity for as many elements as in the source buffer.
+    assert_int_equal(cb_init(&cbuf, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL),
+                     cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t clock_now(void)
+{
+    return now;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_latency_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    uint64_t value = 0U;
+
+    // Histogram.
+    assert_int_equal(cb_hist_init(NULL), cb_error_invalid_args);
+    assert_int_equal(cb_hist_record(NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_hist_percentile(NULL, 50.0, &value), cb_error_invalid_args);
+    assert_int_equal(cb_hist_percentile(&hist, 50.0, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_hist_percentile(&hist, 0.0, &value), cb_error_invalid_args);
+    assert_int_equal(cb_hist_percentile(&hist, 100.1, &value), cb_error_invalid_args);
+    assert_int_equal(cb_hist_percentile(&hist, 50.0, &value), cb_error_empty);
+
+    // Latency measurements.
+    assert_int_equal(cb_set_latency(NULL, clock_now, &hist, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_set_latency(cb, clock_now, NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_set_latency(cb, NULL, &hist, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_set_latency(cb, clock_now, &hist, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_set_latency(cb, NULL, NULL, 0U), cb_error_ok);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_latency_hist_percentiles(void ** state)
+{
+    (void)state;
+    uint64_t value = 0U;
+
+    // Small values are recorded exactly.
+    assert_int_equal(cb_hist_record(&hist, 3U), cb_error_ok);
+    assert_int_equal(cb_hist_percentile(&hist, 50.0, &value), cb_error_ok);
+    assert_int_equal(value, 3U);
+
+    // Larger values are recorded with a bounded relative error.
+    assert_int_equal(cb_hist_init(&hist), cb_error_ok);
+    for (uint64_t i = 1U; i <= 1000U; i++)
+    {
+        assert_int_equal(cb_hist_record(&hist, i), cb_error_ok);
+    }
+    assert_int_equal(hist.total, 1000U);
+    assert_int_equal(hist.min, 1U);
+    assert_int_equal(hist.max, 1000U);
+    assert_int_equal(cb_hist_percentile(&hist, 50.0, &value), cb_error_ok);
+    assert_in_range(value, 500U, 500U + (500U >> CB_HIST_SUB_BITS));
+    assert_int_equal(cb_hist_percentile(&hist, 99.0, &value), cb_error_ok);
+    assert_in_range(value, 990U, 1000U);
+    assert_int_equal(cb_hist_percentile(&hist, 99.9, &value), cb_error_ok);
+    assert_in_range(value, 999U, 1000U);
+    assert_int_equal(cb_hist_percentile(&hist, 100.0, &value), cb_error_ok);
+    assert_int_equal(value, 1000U);
+
+    // Values out of range are recorded in the last bucket.
+    assert_int_equal(cb_hist_init(&hist), cb_error_ok);
+    assert_int_equal(cb_hist_record(&hist, UINT64_MAX), cb_error_ok);
+    assert_int_equal(hist.counts[CB_HIST_BUCKETS - 1U], 1U);
+    assert_int_equal(cb_hist_percentile(&hist, 50.0, &value), cb_error_ok);
+    assert_int_equal(value, ((uint64_t)1U << CB_HIST_MAX_BITS) - 1U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_latency_sampled(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Sample one of every two writes.
+    assert_int_equal(cb_set_latency(cb, clock_now, &hist, 2U), cb_error_ok);
+
+    // Four writes of two elements, the second and fourth are sampled.
+    now = 100U;
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    now = 110U;
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    now = 120U;
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    now = 130U;
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+
+    // The latency of a sampled write is recorded when its last element is read.
+    now = 200U;
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_int_equal(hist.total, 0U);
+    now = 210U;
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_int_equal(hist.total, 1U);
+    assert_int_equal(hist.max, 100U);
+    now = 300U;
+    assert_int_equal(cb_read(cb, ldbuf, 2U), cb_error_ok);
+    assert_int_equal(hist.total, 2U);
+    assert_int_equal(hist.min, 100U);
+    assert_int_equal(hist.max, 170U);
+
+    // Once stopped, nothing else is recorded.
+    assert_int_equal(cb_set_latency(cb, NULL, NULL, 0U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 4U), cb_error_ok);
+    assert_int_equal(hist.total, 2U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_latency_wrap_max_samples(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Sample all writes.
+    assert_int_equal(cb_set_latency(cb, clock_now, &hist, 1U), cb_error_ok);
+
+    // Move to the end of the underlying linear buffer, then write up to its last element, wrapping the write index.
+    assert_int_equal(cb_write(cb, lsbuf, 8U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 8U), cb_error_ok);
+    assert_int_equal(hist.total, 1U);
+    now = 10U;
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lcbuf) - 8U), cb_error_ok);
+    now = 25U;
+    assert_int_equal(cb_read(cb, ldbuf, ARRAY_DIM(lcbuf) - 9U), cb_error_ok);
+    assert_int_equal(hist.total, 1U);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(hist.total, 2U);
+    assert_int_equal(hist.max, 15U);
+
+    // Only as many writes as samples can be pending are sampled, the rest are not.
+    assert_int_equal(cb_hist_init(&hist), cb_error_ok);
+    for (size_t i = 0U; i < ARRAY_DIM(lsbuf); i++)
+    {
+        assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+    }
+    assert_int_equal(cb_read(cb, ldbuf, ARRAY_DIM(lsbuf)), cb_error_ok);
+    assert_int_equal(hist.total, CB_LAT_MAX_SAMPLES);
+
+    // After reading them, writes are sampled again.
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(hist.total, CB_LAT_MAX_SAMPLES + 1U);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_latency_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_latency_hist_percentiles, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_latency_sampled, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_latency_wrap_max_samples, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_latency", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,187 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_lock_prof.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+#include "cb/cb_lock_prof.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Time spent by the lock event handler, to simulate contention. */
+#define LOCK_WAIT (100U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t cbuf;
+/** Lock profiling histograms. */
+static cb_lock_prof_t prof;
+/** Current time returned by the clock. */
+static uint64_t now;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Clock for the lock profiling, advances one unit on every call. */
+static uint64_t clock_now(void);
+/** Circular buffer event handler, advances the clock on lock events to simulate contention. */
+static cb_error_t cb_evt_handler_lock(cb_evt_t * const evt);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for invalid arguments in the lock profiling functions. */
+static void test_cb_lock_prof_invalid_arguments(void ** state);
+/** Tests for the wait and hold times recorded for each function. */
+static void test_cb_lock_prof_functions(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers, histograms and clock.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    assert_int_equal(cb_lock_prof_init(&prof), cb_error_ok);
+    now = 0U;
+
+    // Initialize circular buffer, subscribed to lock events.
+    assert_int_equal(cb_init(&cbuf,
+                             lcbuf,
+                             ARRAY_DIM(lcbuf),
+                             sizeof(*lcbuf),
+                             cb_evt_handler_lock,
+                             cb_evt_id_lock | cb_evt_id_unlock,
+                             NULL),
+                     cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t clock_now(void)
+{
+    return now++;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_handler_lock(cb_evt_t * const evt)
+{
+    assert_true((evt->id == cb_evt_id_lock) || (evt->id == cb_evt_id_unlock));
+
+    now += (evt->id == cb_evt_id_lock) ? (LOCK_WAIT) : (0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_lock_prof_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    assert_int_equal(cb_lock_prof_init(NULL), cb_error_invalid_args);
+    assert_null(cb_lock_prof_fn_name(cb_fn_id_count));
+    assert_int_equal(cb_set_lock_prof(NULL, clock_now, &prof), cb_error_invalid_args);
+    assert_int_equal(cb_set_lock_prof(cb, NULL, &prof), cb_error_invalid_args);
+    assert_int_equal(cb_set_lock_prof(cb, clock_now, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_set_lock_prof(cb, NULL, NULL), cb_error_ok);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_lock_prof_functions(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t count = 0U;
+    uint64_t value = 0U;
+
+    assert_int_equal(cb_set_lock_prof(cb, clock_now, &prof), cb_error_ok);
+
+    // Each function records in its own histograms, including those that fail after locking.
+    assert_int_equal(cb_write(cb, lsbuf, 4U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lsbuf)), cb_error_full);
+    assert_int_equal(cb_read(cb, ldbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 2U);
+    assert_int_equal(prof.wait[cb_fn_id_write].total, 2U);
+    assert_int_equal(prof.hold[cb_fn_id_write].total, 2U);
+    assert_int_equal(prof.wait[cb_fn_id_read].total, 1U);
+    assert_int_equal(prof.hold[cb_fn_id_read].total, 1U);
+    assert_int_equal(prof.wait[cb_fn_id_get_filled].total, 1U);
+    assert_int_equal(prof.wait[cb_fn_id_is_empty].total, 0U);
+
+    // The wait includes the lock event handler and the clock reading, the hold only the clock reading.
+    assert_int_equal(cb_hist_percentile(&prof.wait[cb_fn_id_read], 50.0, &value), cb_error_ok);
+    assert_int_equal(value, LOCK_WAIT + 1U);
+    assert_int_equal(cb_hist_percentile(&prof.hold[cb_fn_id_get_filled], 50.0, &value), cb_error_ok);
+    assert_int_equal(value, 1U);
+
+    // Names for reports.
+    assert_true(strcmp(cb_lock_prof_fn_name(cb_fn_id_write), "cb_write") == 0);
+    assert_true(strcmp(cb_lock_prof_fn_name(cb_fn_id_reset_stats), "cb_reset_stats") == 0);
+
+    // Once stopped, nothing else is recorded.
+    assert_int_equal(cb_set_lock_prof(cb, NULL, NULL), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(prof.wait[cb_fn_id_write].total, 2U);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_lock_prof_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_lock_prof_functions, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_lock_prof", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
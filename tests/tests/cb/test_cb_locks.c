@@ -0,0 +1,317 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_locks.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+#include "cb/cb_lock.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of producer threads, and of consumer threads, in the concurrency tests. */
+#define THREADS (2U)
+
+/** Number of elements written by each producer thread in the concurrency tests. */
+#define ELEMS_PER_THREAD (2000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t cbuf;
+/** Number of lock events raised. */
+static size_t lock_count;
+/** Number of unlock events raised. */
+static size_t unlock_count;
+/** Number of elements read by the consumer threads, in the concurrency tests. */
+static atomic_size_t consumed;
+/** Set if a lock-free query returned a value out of the capacity, in the concurrency tests. */
+static atomic_bool out_of_range;
+/** Sum of the elements written by each producer thread, in the concurrency tests. */
+static size_t produced_sums[THREADS];
+/** Sum of the elements read by each consumer thread, in the concurrency tests. */
+static size_t consumed_sums[THREADS];
+
+/** Built-in lock strategies. */
+static const cb_lock_id_t lock_ids[] = {cb_lock_id_ticket, cb_lock_id_adaptive, cb_lock_id_pthread};
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Event handler that counts the lock and unlock events. */
+static cb_error_t evt_handler(cb_evt_t * const evt);
+/** Producer thread, writes one element at a time. */
+static void * producer(void * ptr);
+/** Consumer thread, reads one element at a time until all elements were read. */
+static void * consumer(void * ptr);
+/** Monitor thread, polls the lock-free queries until all elements were read. */
+static void * monitor(void * ptr);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the lock strategies. */
+static void test_cb_locks_invalid_arguments(void ** state);
+/** Tests for each built-in lock strategy with a single thread, and that the lock events are not raised with them. */
+static void test_cb_locks_single_thread(void ** state);
+/** Tests for each built-in lock strategy with multiple producers, consumers and lock-free queries, split or not. */
+static void test_cb_locks_threads(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers and events.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    lock_count = 0U;
+    unlock_count = 0U;
+
+    // Initialize circular buffer, subscribed to the lock events.
+    assert_int_equal(cb_init(&cbuf,
+                             lcbuf,
+                             ARRAY_DIM(lcbuf),
+                             sizeof(*lcbuf),
+                             evt_handler,
+                             cb_evt_id_lock | cb_evt_id_unlock,
+                             NULL),
+                     cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t evt_handler(cb_evt_t * const evt)
+{
+    lock_count += (evt->id == cb_evt_id_lock) ? (1U) : (0U);
+    unlock_count += (evt->id == cb_evt_id_unlock) ? (1U) : (0U);
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer(void * ptr)
+{
+    const size_t idx = (size_t)ptr;
+
+    for (size_t i = 0U; i < ELEMS_PER_THREAD; i++)
+    {
+        const test_type_t elem = (test_type_t)(i + idx);
+        while (cb_write(&cbuf, &elem, 1U) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+        produced_sums[idx] += elem;
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * consumer(void * ptr)
+{
+    const size_t idx = (size_t)ptr;
+
+    while (atomic_load(&consumed) < (THREADS * ELEMS_PER_THREAD))
+    {
+        test_type_t elem = 0U;
+        if (cb_read(&cbuf, &elem, 1U) == cb_error_ok)
+        {
+            consumed_sums[idx] += elem;
+            (void)atomic_fetch_add(&consumed, 1U);
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * monitor(void * ptr)
+{
+    (void)ptr;
+
+    while (atomic_load(&consumed) < (THREADS * ELEMS_PER_THREAD))
+    {
+        size_t filled = 0U;
+        size_t unfilled = 0U;
+        (void)cb_get_filled_lockfree(&cbuf, &filled);
+        (void)cb_get_unfilled_lockfree(&cbuf, &unfilled);
+        if ((filled >= ARRAY_DIM(lcbuf)) || (unfilled >= ARRAY_DIM(lcbuf)))
+        {
+            atomic_store(&out_of_range, true);
+        }
+        (void)sched_yield();
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_locks_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Invalid arguments.
+    assert_int_equal(cb_set_lock(NULL, cb_lock_id_ticket), cb_error_invalid_args);
+    assert_int_equal(cb_set_lock(cb, cb_lock_id_count), cb_error_invalid_args);
+
+    // Names of the lock strategies.
+    assert_true(strcmp(cb_lock_name(cb_lock_id_evt), "evt") == 0);
+    assert_true(strcmp(cb_lock_name(cb_lock_id_ticket), "ticket") == 0);
+    assert_true(strcmp(cb_lock_name(cb_lock_id_adaptive), "adaptive") == 0);
+    assert_true(strcmp(cb_lock_name(cb_lock_id_pthread), "pthread") == 0);
+    assert_null(cb_lock_name(cb_lock_id_count));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_locks_single_thread(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t filled = 0U;
+
+    for (size_t l = 0U; l < ARRAY_DIM(lock_ids); l++)
+    {
+        // Set the lock, the lock events are not raised with it.
+        assert_int_equal(cb_set_lock(cb, lock_ids[l]), cb_error_ok);
+        lock_count = 0U;
+        unlock_count = 0U;
+
+        // Write and read wrapping around, and rejected operations also release the lock.
+        assert_int_equal(cb_write(cb, lsbuf, 7U), cb_error_ok);
+        assert_int_equal(cb_read(cb, ldbuf, 7U), cb_error_ok);
+        assert_memory_equal(ldbuf, lsbuf, 7U * sizeof(*ldbuf));
+        assert_int_equal(cb_write(cb, lsbuf, 10U), cb_error_ok);
+        assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_full);
+        assert_int_equal(cb_get_filled(cb, &filled), cb_error_ok);
+        assert_int_equal(filled, 10U);
+        assert_int_equal(cb_read(cb, ldbuf, 10U), cb_error_ok);
+        assert_memory_equal(ldbuf, lsbuf, 10U * sizeof(*ldbuf));
+        assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_empty);
+        assert_int_equal(lock_count, 0U);
+        assert_int_equal(unlock_count, 0U);
+
+        // Setting the same lock again is allowed.
+        assert_int_equal(cb_set_lock(cb, lock_ids[l]), cb_error_ok);
+        assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+        assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    }
+
+    // Back to the lock events, raised again.
+    assert_int_equal(cb_set_lock(cb, cb_lock_id_evt), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(lock_count, 2U);
+    assert_int_equal(unlock_count, 2U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_locks_threads(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    for (size_t i = 0U; i < (2U * ARRAY_DIM(lock_ids)); i++)
+    {
+        pthread_t producers[THREADS];
+        pthread_t consumers[THREADS];
+        pthread_t monitor_thread;
+
+        // Reinitialize without events, so the built-in lock is the only lock, shared or one for each side.
+        assert_int_equal(cb_deinit(cb), cb_error_ok);
+        assert_int_equal(cb_init(cb, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL), cb_error_ok);
+        assert_int_equal(cb_set_lock(cb, lock_ids[i % ARRAY_DIM(lock_ids)]), cb_error_ok);
+        assert_int_equal(cb_set_lock_split(cb, (i >= ARRAY_DIM(lock_ids))), cb_error_ok);
+        atomic_init(&consumed, 0U);
+        atomic_init(&out_of_range, false);
+        (void)memset(produced_sums, 0, sizeof(produced_sums));
+        (void)memset(consumed_sums, 0, sizeof(consumed_sums));
+
+        // Run producers and consumers until all elements are read, while polling the lock-free queries.
+        assert_int_equal(pthread_create(&monitor_thread, NULL, monitor, NULL), 0);
+        for (size_t t = 0U; t < THREADS; t++)
+        {
+            assert_int_equal(pthread_create(&consumers[t], NULL, consumer, (void *)t), 0);
+            assert_int_equal(pthread_create(&producers[t], NULL, producer, (void *)t), 0);
+        }
+        for (size_t t = 0U; t < THREADS; t++)
+        {
+            assert_int_equal(pthread_join(producers[t], NULL), 0);
+            assert_int_equal(pthread_join(consumers[t], NULL), 0);
+        }
+        assert_int_equal(pthread_join(monitor_thread, NULL), 0);
+
+        // Every element written was read exactly once.
+        bool is_empty = false;
+        assert_int_equal(cb_is_empty(cb, &is_empty), cb_error_ok);
+        assert_true(is_empty);
+        assert_false(atomic_load(&out_of_range));
+        assert_int_equal(atomic_load(&consumed), THREADS * ELEMS_PER_THREAD);
+        assert_int_equal(produced_sums[0U] + produced_sums[1U], consumed_sums[0U] + consumed_sums[1U]);
+    }
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_locks_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_locks_single_thread, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_locks_threads, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_locks", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
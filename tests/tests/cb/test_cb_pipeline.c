@@ -0,0 +1,380 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_pipeline.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of processing stages in the concurrency tests. */
+#define STAGES (2U)
+
+/** Number of elements written by the producer thread in the concurrency tests. */
+#define ELEMS (20000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t cbuf;
+/** Set if the consumer thread read an element not processed by all the stages, in the concurrency tests. */
+static atomic_bool out_of_order;
+/** Last watermark event raised, and number of watermark events raised. */
+/** @{ */
+static cb_evt_t wm_evt;
+static size_t wm_evt_count;
+/** @} */
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Producer thread, writes consecutive elements one at a time. */
+static void * producer(void * ptr);
+/** Stage thread, adds one to each element in place for the stage provided, in batches, until all are processed. */
+static void * stage(void * ptr);
+/** Consumer thread, reads the elements one at a time and checks all the stages processed them. */
+static void * consumer(void * ptr);
+/** Circular buffer event handler, records the watermark events. */
+static cb_error_t cb_evt_handler_wm(cb_evt_t * const evt);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the processing stages. */
+static void test_cb_pipeline_invalid_arguments(void ** state);
+/** Tests for processing stages with a single thread, elements processed in place and reads gated by the last stage. */
+static void test_cb_pipeline_single_thread(void ** state);
+/** Tests for a producer, processing stages and a consumer, each in its own thread. */
+static void test_cb_pipeline_threads(void ** state);
+/** Tests for the watermarks with processing stages, counting the elements not yet processed by the last stage. */
+static void test_cb_pipeline_watermarks(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Initialize circular buffer.
+    assert_int_equal(cb_init(&cbuf, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL), cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer(void * ptr)
+{
+    (void)ptr;
+
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        const test_type_t elem = (test_type_t)i;
+        while (cb_write(&cbuf, &elem, 1U) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * stage(void * ptr)
+{
+    const size_t id = (size_t)ptr;
+    size_t processed = 0U;
+
+    while (processed < ELEMS)
+    {
+        void * elems = NULL;
+        size_t count = 0U;
+        if (cb_stage_claim(&cbuf, id, &elems, &count) == cb_error_ok)
+        {
+            test_type_t * const batch = (test_type_t *)elems;
+            for (size_t i = 0U; i < count; i++)
+            {
+                batch[i]++;
+            }
+            (void)cb_stage_release(&cbuf, id, count);
+            processed += count;
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * consumer(void * ptr)
+{
+    (void)ptr;
+
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        test_type_t elem = 0U;
+        while (cb_read(&cbuf, &elem, 1U) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+        // Each stage added one to the element written.
+        if (elem != (test_type_t)(i + STAGES))
+        {
+            atomic_store(&out_of_order, true);
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t cb_evt_handler_wm(cb_evt_t * const evt)
+{
+    assert_true((evt->id == cb_evt_id_high_wm) || (evt->id == cb_evt_id_low_wm));
+
+    // Record event.
+    wm_evt = *evt;
+    wm_evt_count++;
+
+    return cb_error_ok;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_pipeline_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    void * elems = NULL;
+    size_t count = 0U;
+
+    // Invalid arguments on setting the stages.
+    assert_int_equal(cb_set_stages(NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_set_stages(cb, CB_MAX_STAGES + 1U), cb_error_invalid_args);
+
+    // Invalid arguments on the stages, including stages not set.
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_invalid_args);
+    assert_int_equal(cb_stage_release(cb, 0U, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_set_stages(cb, 2U), cb_error_ok);
+    assert_int_equal(cb_stage_claim(NULL, 0U, &elems, &count), cb_error_invalid_args);
+    assert_int_equal(cb_stage_claim(cb, 2U, &elems, &count), cb_error_invalid_args);
+    assert_int_equal(cb_stage_claim(cb, 0U, NULL, &count), cb_error_invalid_args);
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_stage_release(NULL, 0U, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_stage_release(cb, 2U, 0U), cb_error_invalid_args);
+
+    // Releasing more elements than available for the stage.
+    assert_int_equal(cb_write(cb, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_stage_release(cb, 0U, 4U), cb_error_invalid_args);
+    assert_int_equal(cb_stage_release(cb, 1U, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_stage_release(cb, 0U, 3U), cb_error_ok);
+    assert_int_equal(cb_stage_release(cb, 1U, 4U), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_pipeline_single_thread(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    void * elems = NULL;
+    size_t count = 0U;
+
+    // The elements already written go through the stages too, and are not read until processed by the last stage.
+    assert_int_equal(cb_write(cb, lsbuf, 8U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_set_stages(cb, 2U), cb_error_ok);
+    assert_int_equal(cb_stage_claim(cb, 1U, &elems, &count), cb_error_empty);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_empty);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 6U);
+    assert_int_equal(cb_get_filled_lockfree(cb, &count), cb_error_ok);
+    assert_int_equal(count, 6U);
+    assert_int_equal(cb_get_readable_lockfree(cb, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_read_batch(cb, ldbuf, 1U, 8U, &count, NULL, 0U), cb_error_empty);
+    assert_int_equal(count, 0U);
+
+    // The first stage processes the elements in place, without copies, and hands them in batches to the second stage.
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_ok);
+    assert_true(elems == &lcbuf[2U]);
+    assert_int_equal(count, 6U);
+    for (size_t i = 0U; i < count; i++)
+    {
+        ((test_type_t *)elems)[i] = (test_type_t)(((test_type_t *)elems)[i] * 2U);
+    }
+    assert_int_equal(cb_stage_release(cb, 0U, 4U), cb_error_ok);
+    assert_int_equal(cb_stage_claim(cb, 1U, &elems, &count), cb_error_ok);
+    assert_true(elems == &lcbuf[2U]);
+    assert_int_equal(count, 4U);
+    assert_int_equal(cb_stage_release(cb, 1U, 4U), cb_error_ok);
+    assert_int_equal(cb_get_readable_lockfree(cb, &count), cb_error_ok);
+    assert_int_equal(count, 4U);
+    assert_int_equal(cb_read(cb, ldbuf, 5U), cb_error_empty);
+    assert_int_equal(cb_read(cb, ldbuf, 4U), cb_error_ok);
+    for (size_t i = 0U; i < 4U; i++)
+    {
+        assert_int_equal(ldbuf[i], lsbuf[i + 2U] * 2U);
+    }
+
+    // The stages wrap around the end of the underlying linear buffer, claiming only the contiguous elements.
+    assert_int_equal(cb_write(cb, lsbuf, 5U), cb_error_ok);
+    assert_int_equal(cb_stage_release(cb, 0U, 2U), cb_error_ok);
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_ok);
+    assert_true(elems == &lcbuf[8U]);
+    assert_int_equal(count, 3U);
+    assert_int_equal(cb_stage_release(cb, 0U, 3U), cb_error_ok);
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_ok);
+    assert_true(elems == &lcbuf[0U]);
+    assert_int_equal(count, 2U);
+    assert_int_equal(cb_stage_release(cb, 0U, 2U), cb_error_ok);
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_empty);
+    assert_int_equal(cb_stage_release(cb, 1U, 7U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 7U), cb_error_ok);
+    assert_int_equal(ldbuf[0U], lsbuf[6U] * 2U);
+    assert_int_equal(ldbuf[1U], lsbuf[7U] * 2U);
+    assert_memory_equal(&ldbuf[2U], lsbuf, 5U * sizeof(*ldbuf));
+
+    // Without stages the elements are read as soon as written again.
+    assert_int_equal(cb_set_stages(cb, 0U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 3U * sizeof(*ldbuf));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_pipeline_threads(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    pthread_t producer_thread;
+    pthread_t stage_threads[STAGES];
+    pthread_t consumer_thread;
+
+    atomic_init(&out_of_order, false);
+    assert_int_equal(cb_set_stages(cb, STAGES), cb_error_ok);
+
+    // Start from the end of the pipeline, so the elements are handed to threads already waiting for them.
+    assert_int_equal(pthread_create(&consumer_thread, NULL, consumer, NULL), 0);
+    for (size_t t = 0U; t < STAGES; t++)
+    {
+        assert_int_equal(pthread_create(&stage_threads[t], NULL, stage, (void *)t), 0);
+    }
+    assert_int_equal(pthread_create(&producer_thread, NULL, producer, NULL), 0);
+
+    assert_int_equal(pthread_join(producer_thread, NULL), 0);
+    for (size_t t = 0U; t < STAGES; t++)
+    {
+        assert_int_equal(pthread_join(stage_threads[t], NULL), 0);
+    }
+    assert_int_equal(pthread_join(consumer_thread, NULL), 0);
+
+    // Every element was read in order, after being processed by all the stages.
+    assert_false(atomic_load(&out_of_order));
+    bool is_empty = false;
+    assert_int_equal(cb_is_empty(cb, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_pipeline_watermarks(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    void * elems = NULL;
+    size_t count = 0U;
+
+    // The high watermark is reached by the writes, with the elements in the stage.
+    wm_evt_count = 0U;
+    cb->evt_handler = cb_evt_handler_wm;
+    cb->evt_sub = cb_evt_id_high_wm | cb_evt_id_low_wm;
+    assert_int_equal(cb_set_watermarks(cb, 2U, 8U), cb_error_ok);
+    assert_int_equal(cb_set_stages(cb, 1U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 8U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 1U);
+    assert_int_equal(wm_evt.id, cb_evt_id_high_wm);
+    assert_int_equal(wm_evt.data.wm.filled, 8U);
+
+    // Reading the few elements processed does not reach the low watermark, as the rest are still in the stage.
+    assert_int_equal(cb_stage_claim(cb, 0U, &elems, &count), cb_error_ok);
+    assert_int_equal(cb_stage_release(cb, 0U, 1U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 1U);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 7U);
+
+    // Once processed and read down to the low watermark, it is reached with the same fill level as reported.
+    assert_int_equal(cb_stage_release(cb, 0U, 7U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 4U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 1U);
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(wm_evt_count, 2U);
+    assert_int_equal(wm_evt.id, cb_evt_id_low_wm);
+    assert_int_equal(wm_evt.data.wm.filled, 2U);
+    assert_int_equal(cb_get_filled(cb, &count), cb_error_ok);
+    assert_int_equal(count, 2U);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_pipeline_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_pipeline_single_thread, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_pipeline_threads, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_pipeline_watermarks, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_pipeline", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
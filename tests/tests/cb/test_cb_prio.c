@@ -0,0 +1,366 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_prio.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb_prio.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of priority levels, each with a producer in the concurrency tests. */
+#define LEVELS (3U)
+
+/** Number of elements written by each producer thread in the concurrency tests. */
+#define ELEMS (20000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffers for the levels. */
+static test_type_t lcbufs[LEVELS][11U];
+/** Destination buffer, to be used for read operations in the priority rings. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the priority rings. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Levels. */
+static cb_t levels[LEVELS];
+/** Priority rings. */
+static cb_prio_t prio;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Producer thread, writes consecutive elements one at a time to the level provided. */
+static void * producer(void * ptr);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the priority rings. */
+static void test_cb_prio_invalid_arguments(void ** state);
+/** Tests for the priority rings read strictly by priority, with a single thread. */
+static void test_cb_prio_strict(void ** state);
+/** Tests for the priority rings read with weights, with a single thread. */
+static void test_cb_prio_weighted(void ** state);
+/** Tests for producers writing to each level in its own thread, and a single consumer reading with weights. */
+static void test_cb_prio_threads(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbufs, 0xFFU, sizeof(lcbufs));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Initialize levels, without locks as each has a single producer and the single consumer, and priority rings.
+    for (size_t i = 0U; i < LEVELS; i++)
+    {
+        assert_int_equal(
+            cb_init(&levels[i], lcbufs[i], ARRAY_DIM(lcbufs[i]), sizeof(*lcbufs[i]), NULL, cb_evt_id_none, NULL),
+            cb_error_ok);
+    }
+    assert_int_equal(cb_prio_init(&prio, levels, LEVELS), cb_error_ok);
+
+    // Assign priority rings to tests.
+    *state = &prio;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_prio_t * const pr = (cb_prio_t * const)*state;
+
+    // Deinitialize priority rings and levels.
+    assert_int_equal(cb_prio_deinit(pr), cb_error_ok);
+    for (size_t i = 0U; i < LEVELS; i++)
+    {
+        assert_int_equal(cb_deinit(&levels[i]), cb_error_ok);
+    }
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer(void * ptr)
+{
+    const size_t level = (size_t)ptr;
+
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        const test_type_t elem = (test_type_t)i;
+        while (cb_prio_write(&prio, level, &elem, 1U) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_prio_invalid_arguments(void ** state)
+{
+    cb_prio_t * const pr = (cb_prio_t * const)*state;
+    const size_t weights[LEVELS] = {2U, 0U, 1U};
+    size_t read = 0U;
+    bool is_empty = false;
+
+    // Invalid arguments on initialization, including levels with elements of different sizes.
+    assert_int_equal(cb_prio_init(NULL, levels, LEVELS), cb_error_invalid_args);
+    assert_int_equal(cb_prio_init(pr, NULL, LEVELS), cb_error_invalid_args);
+    assert_int_equal(cb_prio_init(pr, levels, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_prio_init(pr, levels, CB_PRIO_MAX_LEVELS + 1U), cb_error_invalid_args);
+    assert_int_equal(cb_deinit(&levels[LEVELS - 1U]), cb_error_ok);
+    assert_int_equal(cb_init(&levels[LEVELS - 1U],
+                             lcbufs[LEVELS - 1U],
+                             ARRAY_DIM(lcbufs[LEVELS - 1U]) / 2U,
+                             2U * sizeof(*lcbufs[LEVELS - 1U]),
+                             NULL,
+                             cb_evt_id_none,
+                             NULL),
+                     cb_error_ok);
+    assert_int_equal(cb_prio_init(pr, levels, LEVELS), cb_error_invalid_args);
+    assert_int_equal(cb_prio_init(pr, levels, LEVELS - 1U), cb_error_ok);
+    assert_int_equal(cb_prio_deinit(NULL), cb_error_invalid_args);
+
+    // Invalid arguments on weights, which can't be zero.
+    assert_int_equal(cb_prio_set_weights(NULL, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_prio_set_weights(pr, weights), cb_error_invalid_args);
+
+    // Invalid arguments on writes, reads and queries.
+    assert_int_equal(cb_prio_write(NULL, 0U, lsbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_prio_write(pr, LEVELS - 1U, lsbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_prio_write(pr, 0U, NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_prio_read(NULL, ldbuf, 1U, &read, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_prio_read(pr, NULL, 1U, &read, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 0U, &read, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 1U, NULL, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_prio_is_empty(NULL, &is_empty), cb_error_invalid_args);
+    assert_int_equal(cb_prio_is_empty(pr, NULL), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_prio_strict(void ** state)
+{
+    cb_prio_t * const pr = (cb_prio_t * const)*state;
+    size_t read = 0U;
+    size_t level = 0U;
+    bool is_empty = false;
+
+    // Nothing is read while all the levels are empty.
+    assert_int_equal(cb_prio_is_empty(pr, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_empty);
+    assert_int_equal(read, 0U);
+
+    // The lowest priority is written first, but the highest priority is read first, from a single level per read.
+    assert_int_equal(cb_prio_write(pr, 2U, lsbuf, 4U), cb_error_ok);
+    assert_int_equal(cb_prio_write(pr, 1U, &lsbuf[4U], 3U), cb_error_ok);
+    assert_int_equal(cb_prio_write(pr, 0U, &lsbuf[7U], 3U), cb_error_ok);
+    assert_int_equal(cb_prio_is_empty(pr, &is_empty), cb_error_ok);
+    assert_false(is_empty);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 2U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 2U);
+    assert_int_equal(level, 0U);
+    assert_memory_equal(ldbuf, &lsbuf[7U], 2U * sizeof(*ldbuf));
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(level, 0U);
+    assert_int_equal(ldbuf[0U], lsbuf[9U]);
+
+    // A higher priority written meanwhile preempts the lower priority levels.
+    assert_int_equal(cb_prio_read(pr, ldbuf, 1U, &read, &level), cb_error_ok);
+    assert_int_equal(level, 1U);
+    assert_int_equal(ldbuf[0U], lsbuf[4U]);
+    assert_int_equal(cb_prio_write(pr, 0U, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(level, 0U);
+    assert_int_equal(ldbuf[0U], lsbuf[0U]);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 2U);
+    assert_int_equal(level, 1U);
+    assert_memory_equal(ldbuf, &lsbuf[5U], 2U * sizeof(*ldbuf));
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, NULL), cb_error_ok);
+    assert_int_equal(read, 4U);
+    assert_memory_equal(ldbuf, lsbuf, 4U * sizeof(*ldbuf));
+
+    // Once drained, the occupancy bitmap is clear.
+    assert_int_equal(cb_prio_is_empty(pr, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_empty);
+
+    // Elements read from a level directly leave a stale bit, which is cleared by the next read.
+    assert_int_equal(cb_prio_write(pr, 1U, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_read(&levels[1U], ldbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_prio_is_empty(pr, &is_empty), cb_error_ok);
+    assert_false(is_empty);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_empty);
+    assert_int_equal(cb_prio_is_empty(pr, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+
+    // Levels with elements before the initialization are observed.
+    assert_int_equal(cb_prio_deinit(pr), cb_error_ok);
+    assert_int_equal(cb_write(&levels[2U], lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_prio_init(pr, levels, LEVELS), cb_error_ok);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(level, 2U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_prio_weighted(void ** state)
+{
+    cb_prio_t * const pr = (cb_prio_t * const)*state;
+    const size_t weights[LEVELS] = {3U, 2U, 1U};
+    const size_t expected_levels[] = {0U, 1U, 2U, 0U, 1U, 2U, 0U, 2U, 2U, 2U};
+    const size_t expected_reads[] = {3U, 2U, 1U, 3U, 2U, 1U, 2U, 1U, 1U, 1U};
+    size_t read = 0U;
+    size_t level = 0U;
+
+    // With all the levels full, each round reads as many elements from each level as its weight, by priority.
+    assert_int_equal(cb_prio_set_weights(pr, weights), cb_error_ok);
+    for (size_t i = 0U; i < LEVELS; i++)
+    {
+        assert_int_equal(cb_prio_write(pr, i, lsbuf, (i == 0U) ? (8U) : ((i == 1U) ? (4U) : (5U))), cb_error_ok);
+    }
+    for (size_t i = 0U; i < ARRAY_DIM(expected_levels); i++)
+    {
+        assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+        assert_int_equal(level, expected_levels[i]);
+        assert_int_equal(read, expected_reads[i]);
+    }
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_empty);
+
+    // The elements of a level are read in order across rounds, and fewer elements than the weight can be read, the
+    // level with the lowest priority is read once the others used their weight in the round.
+    assert_int_equal(cb_prio_write(pr, 0U, lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_prio_write(pr, 2U, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 2U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 2U);
+    assert_int_equal(level, 0U);
+    assert_memory_equal(ldbuf, lsbuf, 2U * sizeof(*ldbuf));
+    assert_int_equal(cb_prio_read(pr, ldbuf, 2U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(level, 0U);
+    assert_int_equal(ldbuf[0U], lsbuf[2U]);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 3U);
+    assert_int_equal(level, 0U);
+    assert_memory_equal(ldbuf, &lsbuf[3U], 3U * sizeof(*ldbuf));
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(level, 2U);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 3U);
+    assert_int_equal(level, 0U);
+    assert_memory_equal(ldbuf, &lsbuf[6U], 3U * sizeof(*ldbuf));
+
+    // Back to strict priority, the highest level is drained first.
+    assert_int_equal(cb_prio_write(pr, 0U, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_prio_write(pr, 1U, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_prio_set_weights(pr, NULL), cb_error_ok);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 4U);
+    assert_int_equal(level, 0U);
+    assert_int_equal(cb_prio_read(pr, ldbuf, 10U, &read, &level), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(level, 1U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_prio_threads(void ** state)
+{
+    cb_prio_t * const pr = (cb_prio_t * const)*state;
+    const size_t weights[LEVELS] = {4U, 2U, 1U};
+    pthread_t producer_threads[LEVELS];
+    size_t next[LEVELS] = {0U};
+    size_t consumed = 0U;
+    test_type_t batch[4U];
+
+    // A producer for each level, and the consumer in this thread, with weights so all the levels progress.
+    assert_int_equal(cb_prio_set_weights(pr, weights), cb_error_ok);
+    for (size_t t = 0U; t < LEVELS; t++)
+    {
+        assert_int_equal(pthread_create(&producer_threads[t], NULL, producer, (void *)t), 0);
+    }
+    while (consumed < (LEVELS * ELEMS))
+    {
+        size_t read = 0U;
+        size_t level = 0U;
+        if (cb_prio_read(pr, batch, ARRAY_DIM(batch), &read, &level) != cb_error_ok)
+        {
+            (void)sched_yield();
+            continue;
+        }
+        // The elements of each level are read once, and in order.
+        for (size_t i = 0U; i < read; i++)
+        {
+            assert_int_equal(batch[i], (test_type_t)next[level]);
+            next[level]++;
+        }
+        consumed += read;
+    }
+    for (size_t t = 0U; t < LEVELS; t++)
+    {
+        assert_int_equal(pthread_join(producer_threads[t], NULL), 0);
+    }
+
+    // Every element of every level was read, and the occupancy bitmap is clear once drained.
+    bool is_empty = false;
+    size_t read = 0U;
+    for (size_t i = 0U; i < LEVELS; i++)
+    {
+        assert_int_equal(next[i], ELEMS);
+    }
+    assert_int_equal(cb_prio_read(pr, batch, ARRAY_DIM(batch), &read, NULL), cb_error_empty);
+    assert_int_equal(cb_prio_is_empty(pr, &is_empty), cb_error_ok);
+    assert_true(is_empty);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_prio_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_prio_strict, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_prio_weighted, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_prio_threads, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_prio", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
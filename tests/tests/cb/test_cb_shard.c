@@ -0,0 +1,325 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_shard.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb_shard.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of shards, each with a consumer, the last one without a producer so its consumer only steals. */
+#define SHARDS (3U)
+
+/** Number of producer threads in the concurrency tests, one for each of the first shards. */
+#define PRODUCERS (SHARDS - 1U)
+
+/** Number of elements written by each producer thread in the concurrency tests. */
+#define ELEMS (20000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffers for the shards. */
+static test_type_t lcbufs[SHARDS][11U];
+/** Destination buffer, to be used for read operations in the sharded ring. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the sharded ring. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Shards. */
+static cb_t shards[SHARDS];
+/** Sharded ring. */
+static cb_shard_t shard;
+/** Number of elements read by all the consumer threads, in the concurrency tests. */
+static atomic_size_t consumed;
+/** Sum of the elements read by all the consumer threads, in the concurrency tests. */
+static atomic_size_t checksum;
+/** Number of elements stolen by the consumer threads from other shards, in the concurrency tests. */
+static atomic_size_t stolen;
+/** Set if a consumer thread read elements of a shard out of order, in the concurrency tests. */
+static atomic_bool out_of_order;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Producer thread, writes consecutive elements one at a time to the shard provided. */
+static void * producer(void * ptr);
+/** Consumer thread, reads batches with the home shard provided until all the elements were read. */
+static void * consumer(void * ptr);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the sharded rings. */
+static void test_cb_shard_invalid_arguments(void ** state);
+/** Tests for the sharded rings with a single thread, reading from the home shard first and then stealing. */
+static void test_cb_shard_single_thread(void ** state);
+/** Tests for producers writing to their local shard and consumers reading and stealing, each in its own thread. */
+static void test_cb_shard_threads(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbufs, 0xFFU, sizeof(lcbufs));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Initialize shards, locked as the home consumer and the ones stealing read at the same time, and sharded ring.
+    for (size_t i = 0U; i < SHARDS; i++)
+    {
+        assert_int_equal(
+            cb_init(&shards[i], lcbufs[i], ARRAY_DIM(lcbufs[i]), sizeof(*lcbufs[i]), NULL, cb_evt_id_none, NULL),
+            cb_error_ok);
+        assert_int_equal(cb_set_lock(&shards[i], cb_lock_id_adaptive), cb_error_ok);
+        assert_int_equal(cb_set_lock_split(&shards[i], true), cb_error_ok);
+    }
+    assert_int_equal(cb_shard_init(&shard, shards, SHARDS), cb_error_ok);
+
+    // Assign sharded ring to tests.
+    *state = &shard;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_shard_t * const sh = (cb_shard_t * const)*state;
+
+    // Deinitialize sharded ring and shards.
+    assert_int_equal(cb_shard_deinit(sh), cb_error_ok);
+    for (size_t i = 0U; i < SHARDS; i++)
+    {
+        assert_int_equal(cb_deinit(&shards[i]), cb_error_ok);
+    }
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer(void * ptr)
+{
+    const size_t local = (size_t)ptr;
+
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        const test_type_t elem = (test_type_t)i;
+        while (cb_shard_write(&shard, local, &elem, 1U) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * consumer(void * ptr)
+{
+    const size_t home = (size_t)ptr;
+    test_type_t batch[4U];
+
+    while (atomic_load(&consumed) < (PRODUCERS * ELEMS))
+    {
+        size_t read = 0U;
+        size_t from = 0U;
+        if (cb_shard_read(&shard, home, batch, ARRAY_DIM(batch), &read, &from) != cb_error_ok)
+        {
+            (void)sched_yield();
+            continue;
+        }
+        // The elements of each batch are from a single shard, and in order.
+        size_t sum = 0U;
+        for (size_t i = 0U; i < read; i++)
+        {
+            if ((i > 0U) && (batch[i] != (test_type_t)(batch[i - 1U] + 1U)))
+            {
+                atomic_store(&out_of_order, true);
+            }
+            sum += batch[i];
+        }
+        (void)atomic_fetch_add(&checksum, sum);
+        (void)atomic_fetch_add(&stolen, (from != home) ? (read) : (0U));
+        (void)atomic_fetch_add(&consumed, read);
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_shard_invalid_arguments(void ** state)
+{
+    cb_shard_t * const sh = (cb_shard_t * const)*state;
+    size_t read = 0U;
+    size_t count = 0U;
+
+    // Invalid arguments on initialization, including shards with elements of different sizes.
+    assert_int_equal(cb_shard_init(NULL, shards, SHARDS), cb_error_invalid_args);
+    assert_int_equal(cb_shard_init(sh, NULL, SHARDS), cb_error_invalid_args);
+    assert_int_equal(cb_shard_init(sh, shards, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_deinit(&shards[SHARDS - 1U]), cb_error_ok);
+    assert_int_equal(cb_init(&shards[SHARDS - 1U],
+                             lcbufs[SHARDS - 1U],
+                             ARRAY_DIM(lcbufs[SHARDS - 1U]) / 2U,
+                             2U * sizeof(*lcbufs[SHARDS - 1U]),
+                             NULL,
+                             cb_evt_id_none,
+                             NULL),
+                     cb_error_ok);
+    assert_int_equal(cb_shard_init(sh, shards, SHARDS), cb_error_invalid_args);
+    assert_int_equal(cb_shard_init(sh, shards, SHARDS - 1U), cb_error_ok);
+    assert_int_equal(cb_shard_deinit(NULL), cb_error_invalid_args);
+
+    // Invalid arguments on writes, reads and queries.
+    assert_int_equal(cb_shard_write(NULL, 0U, lsbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_shard_write(sh, SHARDS - 1U, lsbuf, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_shard_write(sh, 0U, NULL, 1U), cb_error_invalid_args);
+    assert_int_equal(cb_shard_read(NULL, 0U, ldbuf, 1U, &read, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_shard_read(sh, SHARDS - 1U, ldbuf, 1U, &read, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_shard_read(sh, 0U, NULL, 1U, &read, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_shard_read(sh, 0U, ldbuf, 0U, &read, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_shard_read(sh, 0U, ldbuf, 1U, NULL, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_shard_get_filled(NULL, &count), cb_error_invalid_args);
+    assert_int_equal(cb_shard_get_filled(sh, NULL), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_shard_single_thread(void ** state)
+{
+    cb_shard_t * const sh = (cb_shard_t * const)*state;
+    size_t read = 0U;
+    size_t from = 0U;
+    size_t count = 0U;
+
+    // Nothing is read while all the shards are empty.
+    assert_int_equal(cb_shard_read(sh, 0U, ldbuf, 10U, &read, &from), cb_error_empty);
+    assert_int_equal(read, 0U);
+
+    // Each producer writes to its local shard, and the aggregate fill level adds all of them.
+    assert_int_equal(cb_shard_write(sh, 1U, lsbuf, 6U), cb_error_ok);
+    assert_int_equal(cb_shard_write(sh, 2U, lsbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_shard_get_filled(sh, &count), cb_error_ok);
+    assert_int_equal(count, 9U);
+
+    // With the home shard empty, half of the elements of the next shard with elements are stolen, in order.
+    assert_int_equal(cb_shard_read(sh, 0U, ldbuf, 10U, &read, &from), cb_error_ok);
+    assert_int_equal(read, 3U);
+    assert_int_equal(from, 1U);
+    assert_memory_equal(ldbuf, lsbuf, 3U * sizeof(*ldbuf));
+    assert_int_equal(cb_shard_read(sh, 0U, ldbuf, 10U, &read, NULL), cb_error_ok);
+    assert_int_equal(read, 2U);
+    assert_memory_equal(ldbuf, &lsbuf[3U], 2U * sizeof(*ldbuf));
+    assert_int_equal(cb_shard_get_filled(sh, &count), cb_error_ok);
+    assert_int_equal(count, 4U);
+
+    // The home shard is drained first, up to the number of elements requested, and then the others are stolen from.
+    assert_int_equal(cb_shard_read(sh, 1U, ldbuf, 10U, &read, &from), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(from, 1U);
+    assert_int_equal(ldbuf[0U], lsbuf[5U]);
+    assert_int_equal(cb_shard_read(sh, 1U, ldbuf, 1U, &read, &from), cb_error_ok);
+    assert_int_equal(read, 1U);
+    assert_int_equal(from, 2U);
+    assert_int_equal(ldbuf[0U], lsbuf[0U]);
+    assert_int_equal(cb_shard_read(sh, 2U, ldbuf, 10U, &read, &from), cb_error_ok);
+    assert_int_equal(read, 2U);
+    assert_int_equal(from, 2U);
+    assert_memory_equal(ldbuf, &lsbuf[1U], 2U * sizeof(*ldbuf));
+    assert_int_equal(cb_shard_read(sh, 2U, ldbuf, 10U, &read, &from), cb_error_empty);
+    assert_int_equal(read, 0U);
+
+    // Writes to a full shard fail as in the circular buffer, even if other shards have space.
+    assert_int_equal(cb_shard_write(sh, 0U, lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_shard_write(sh, 0U, lsbuf, 1U), cb_error_full);
+    assert_int_equal(cb_shard_get_filled(sh, &count), cb_error_ok);
+    assert_int_equal(count, 10U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_shard_threads(void ** state)
+{
+    cb_shard_t * const sh = (cb_shard_t * const)*state;
+    pthread_t producer_threads[PRODUCERS];
+    pthread_t consumer_threads[SHARDS];
+
+    atomic_init(&consumed, 0U);
+    atomic_init(&checksum, 0U);
+    atomic_init(&stolen, 0U);
+    atomic_init(&out_of_order, false);
+
+    // A consumer for each shard, and a producer for each shard but the last one.
+    for (size_t t = 0U; t < SHARDS; t++)
+    {
+        assert_int_equal(pthread_create(&consumer_threads[t], NULL, consumer, (void *)t), 0);
+    }
+    for (size_t t = 0U; t < PRODUCERS; t++)
+    {
+        assert_int_equal(pthread_create(&producer_threads[t], NULL, producer, (void *)t), 0);
+    }
+
+    for (size_t t = 0U; t < PRODUCERS; t++)
+    {
+        assert_int_equal(pthread_join(producer_threads[t], NULL), 0);
+    }
+    for (size_t t = 0U; t < SHARDS; t++)
+    {
+        assert_int_equal(pthread_join(consumer_threads[t], NULL), 0);
+    }
+
+    // Every element was read once, in order within each batch, and the consumer without producer stole elements.
+    size_t expected = 0U;
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        expected += PRODUCERS * (size_t)(test_type_t)i;
+    }
+    assert_false(atomic_load(&out_of_order));
+    assert_int_equal(atomic_load(&consumed), PRODUCERS * ELEMS);
+    assert_int_equal(atomic_load(&checksum), expected);
+    assert_true(atomic_load(&stolen) > 0U);
+    size_t count = 0U;
+    assert_int_equal(cb_shard_get_filled(sh, &count), cb_error_ok);
+    assert_int_equal(count, 0U);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_shard_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_shard_single_thread, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_shard_threads, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_shard", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,188 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_stats.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t cbuf;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for invalid arguments in the statistics functions. */
+static void test_cb_stats_invalid_arguments(void ** state);
+/** Tests for the statistics counters on writes and reads, including errors and wraps. */
+static void test_cb_stats_counters(void ** state);
+/** Tests for the reset of the statistics counters. */
+static void test_cb_stats_reset(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Initialize circular buffer, with capacity for as many elements as in the source buffer.
+    assert_int_equal(cb_init(&cbuf, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL),
+                     cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_stats_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    cb_stats_t stats;
+
+    assert_int_equal(cb_get_stats(NULL, &stats), cb_error_invalid_args);
+    assert_int_equal(cb_get_stats(cb, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_reset_stats(NULL), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_stats_counters(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    cb_stats_t stats;
+
+    // All counters are zero after initialization.
+    assert_int_equal(cb_get_stats(cb, &stats), cb_error_ok);
+    assert_int_equal(stats.writes, 0U);
+    assert_int_equal(stats.reads, 0U);
+    assert_int_equal(stats.elems_written, 0U);
+    assert_int_equal(stats.elems_read, 0U);
+    assert_int_equal(stats.full_errors, 0U);
+    assert_int_equal(stats.empty_errors, 0U);
+    assert_int_equal(stats.wrapped_writes, 0U);
+    assert_int_equal(stats.wrapped_reads, 0U);
+    assert_int_equal(stats.peak_filled, 0U);
+
+    // Write and read without wrapping around.
+    assert_int_equal(cb_write(cb, lsbuf, 6U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 4U), cb_error_ok);
+    // Write wrapping around, from index 6 of 11, up to 9 filled slots.
+    assert_int_equal(cb_write(cb, lsbuf, 7U), cb_error_ok);
+    // Write on a full circular buffer, rejected.
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_full);
+    // Read wrapping around, until empty.
+    assert_int_equal(cb_read(cb, ldbuf, 9U), cb_error_ok);
+    assert_memory_equal(ldbuf, &lsbuf[4U], 2U * sizeof(*ldbuf));
+    assert_memory_equal(&ldbuf[2U], lsbuf, 7U * sizeof(*ldbuf));
+    // Read on an empty circular buffer, rejected.
+    assert_int_equal(cb_read(cb, ldbuf, 1U), cb_error_empty);
+
+    // Check the counters.
+    assert_int_equal(cb_get_stats(cb, &stats), cb_error_ok);
+    assert_int_equal(stats.writes, 2U);
+    assert_int_equal(stats.reads, 2U);
+    assert_int_equal(stats.elems_written, 13U);
+    assert_int_equal(stats.elems_read, 13U);
+    assert_int_equal(stats.bytes_written, 13U * sizeof(test_type_t));
+    assert_int_equal(stats.bytes_read, 13U * sizeof(test_type_t));
+    assert_int_equal(stats.full_errors, 1U);
+    assert_int_equal(stats.empty_errors, 1U);
+    assert_int_equal(stats.wrapped_writes, 1U);
+    assert_int_equal(stats.wrapped_reads, 1U);
+    assert_int_equal(stats.peak_filled, 9U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_stats_reset(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    cb_stats_t stats;
+
+    // Generate some statistics.
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lsbuf)), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_get_stats(cb, &stats), cb_error_ok);
+    assert_int_equal(stats.writes, 1U);
+    assert_int_equal(stats.peak_filled, ARRAY_DIM(lsbuf));
+
+    // Reset, the counters start again but the contents of the circular buffer are kept.
+    assert_int_equal(cb_reset_stats(cb), cb_error_ok);
+    assert_int_equal(cb_get_stats(cb, &stats), cb_error_ok);
+    assert_int_equal(stats.writes, 0U);
+    assert_int_equal(stats.reads, 0U);
+    assert_int_equal(stats.elems_written, 0U);
+    assert_int_equal(stats.peak_filled, 0U);
+    assert_int_equal(cb_read(cb, ldbuf, ARRAY_DIM(lsbuf) - 3U), cb_error_ok);
+    assert_memory_equal(ldbuf, &lsbuf[3U], (ARRAY_DIM(lsbuf) - 3U) * sizeof(*ldbuf));
+    assert_int_equal(cb_get_stats(cb, &stats), cb_error_ok);
+    assert_int_equal(stats.reads, 1U);
+    assert_int_equal(stats.elems_read, ARRAY_DIM(lsbuf) - 3U);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_stats_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_stats_counters, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_stats_reset, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_stats", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
@@ -0,0 +1,207 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_trace.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+#include "cb/cb_trace.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Identifier of the thread returned for the trace records. */
+#define THREAD_ID (7U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t cbuf;
+/** Trace recorder and its records. */
+static cb_trace_buf_t trace;
+static cb_trace_rec_t recs[4U];
+/** Current time returned by the clock. */
+static uint64_t now;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Clock for the trace records, advances ten units on every call. */
+static uint64_t clock_now(void);
+/** Identifier of the calling thread for the trace records. */
+static uint32_t thread_id(void);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for invalid arguments in the tracing functions. */
+static void test_cb_trace_invalid_arguments(void ** state);
+/** Tests for the records of writes and reads, including failed ones, and for the recorder. */
+static void test_cb_trace_records(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers, recorder and clock.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    (void)memset(recs, 0xFFU, sizeof(recs));
+    assert_int_equal(cb_trace_buf_init(&trace, recs, ARRAY_DIM(recs)), cb_error_ok);
+    now = 0U;
+
+    // Initialize circular buffer.
+    assert_int_equal(cb_init(&cbuf, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL), cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t clock_now(void)
+{
+    now += 10U;
+    return now;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint32_t thread_id(void)
+{
+    return THREAD_ID;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_trace_invalid_arguments(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    cb_trace_hdr_t hdr;
+
+    assert_int_equal(cb_trace_buf_init(NULL, recs, ARRAY_DIM(recs)), cb_error_invalid_args);
+    assert_int_equal(cb_trace_buf_init(&trace, NULL, ARRAY_DIM(recs)), cb_error_invalid_args);
+    assert_int_equal(cb_trace_buf_init(&trace, recs, 0U), cb_error_invalid_args);
+    assert_int_equal(cb_trace_buf_hdr(NULL, cb, 1000U, &hdr), cb_error_invalid_args);
+    assert_int_equal(cb_trace_buf_hdr(&trace, NULL, 1000U, &hdr), cb_error_invalid_args);
+    assert_int_equal(cb_trace_buf_hdr(&trace, cb, 0U, &hdr), cb_error_invalid_args);
+    assert_int_equal(cb_trace_buf_hdr(&trace, cb, 1000U, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_set_trace(NULL, clock_now, thread_id, cb_trace_buf_sink, &trace), cb_error_invalid_args);
+    assert_int_equal(cb_set_trace(cb, NULL, thread_id, cb_trace_buf_sink, &trace), cb_error_invalid_args);
+    assert_int_equal(cb_set_trace(cb, clock_now, thread_id, NULL, &trace), cb_error_invalid_args);
+    assert_int_equal(cb_set_trace(cb, NULL, NULL, NULL, NULL), cb_error_ok);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_trace_records(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    cb_trace_hdr_t hdr;
+
+    // The layout of the binary format is fixed.
+    assert_int_equal(sizeof(cb_trace_rec_t), 24U);
+    assert_int_equal(sizeof(cb_trace_hdr_t), 48U);
+
+    assert_int_equal(cb_set_trace(cb, clock_now, thread_id, cb_trace_buf_sink, &trace), cb_error_ok);
+
+    // Writes and reads are recorded along with their result, including those that fail.
+    assert_int_equal(cb_write(cb, lsbuf, 4U), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, ARRAY_DIM(lsbuf)), cb_error_full);
+    assert_int_equal(cb_read(cb, ldbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 2U), cb_error_empty);
+    assert_int_equal(recs[0U].stamp, 10U);
+    assert_int_equal(recs[0U].thread, THREAD_ID);
+    assert_int_equal(recs[0U].fn, cb_fn_id_write);
+    assert_int_equal(recs[0U].count, 4U);
+    assert_int_equal(recs[0U].filled, 4U);
+    assert_int_equal(recs[0U].result, cb_error_ok);
+    assert_int_equal(recs[0U].reserved, 0U);
+    assert_int_equal(recs[1U].stamp, 20U);
+    assert_int_equal(recs[1U].fn, cb_fn_id_write);
+    assert_int_equal(recs[1U].count, ARRAY_DIM(lsbuf));
+    assert_int_equal(recs[1U].filled, 4U);
+    assert_int_equal(recs[1U].result, cb_error_full);
+    assert_int_equal(recs[2U].fn, cb_fn_id_read);
+    assert_int_equal(recs[2U].count, 3U);
+    assert_int_equal(recs[2U].filled, 1U);
+    assert_int_equal(recs[2U].result, cb_error_ok);
+    assert_int_equal(recs[3U].stamp, 40U);
+    assert_int_equal(recs[3U].result, cb_error_empty);
+
+    // Invalid arguments are rejected before any work, but recorded too.
+    assert_int_equal(cb_set_trace(cb, clock_now, NULL, cb_trace_buf_sink, &trace), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 0U), cb_error_invalid_args);
+
+    // Records beyond the capacity of the recorder are dropped, and reported in the header.
+    assert_int_equal(cb_trace_buf_hdr(&trace, cb, 1000U, &hdr), cb_error_ok);
+    assert_int_equal(hdr.magic, CB_TRACE_MAGIC);
+    assert_int_equal(hdr.version, CB_TRACE_VERSION);
+    assert_int_equal(hdr.rec_size, sizeof(cb_trace_rec_t));
+    assert_int_equal(hdr.buffer_length, ARRAY_DIM(lcbuf));
+    assert_int_equal(hdr.elem_size, sizeof(*lcbuf));
+    assert_int_equal(hdr.ticks_per_sec, 1000U);
+    assert_int_equal(hdr.count, ARRAY_DIM(recs));
+    assert_int_equal(hdr.dropped, 1U);
+
+    // Once stopped, nothing else is recorded.
+    assert_int_equal(cb_trace_buf_init(&trace, recs, ARRAY_DIM(recs)), cb_error_ok);
+    assert_int_equal(cb_set_trace(cb, NULL, NULL, NULL, NULL), cb_error_ok);
+    assert_int_equal(cb_write(cb, lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_trace_buf_hdr(&trace, cb, 1000U, &hdr), cb_error_ok);
+    assert_int_equal(hdr.count, 0U);
+    assert_int_equal(hdr.dropped, 0U);
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_trace_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_trace_records, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_trace", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
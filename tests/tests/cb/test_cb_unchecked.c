@@ -0,0 +1,218 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_unchecked.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb.h"
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffer for the circular buffer. */
+static test_type_t lcbuf[11U];
+/** Destination buffer, to be used for read operations in the circular buffer. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffer. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffer. */
+static cb_t cbuf;
+/** Number of times each event was raised, indexed by the position of its bit in ::cb_evt_id_t. */
+static size_t evt_counts[16U];
+/** If @c true, the write and read events fail. */
+static bool evt_fail;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Event handler that counts the events and copies the data for write and read events. */
+static cb_error_t evt_handler(cb_evt_t * const evt);
+/** Returns the number of times an event was raised. */
+static size_t evt_count(const cb_evt_id_t id);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the unchecked writes and reads without events, in the specialized path. */
+static void test_cb_unchecked_no_events(void ** state);
+/** Tests for the unchecked writes and reads with events, which are raised as in the checked functions. */
+static void test_cb_unchecked_events(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers and events.
+    (void)memset(lcbuf, 0xFFU, sizeof(lcbuf));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+    (void)memset(evt_counts, 0U, sizeof(evt_counts));
+    evt_fail = false;
+
+    // Initialize circular buffer.
+    assert_int_equal(cb_init(&cbuf, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), NULL, cb_evt_id_none, NULL), cb_error_ok);
+
+    // Assign circular buffer to tests.
+    *state = &cbuf;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+
+    // Deinitialize circular buffer.
+    assert_int_equal(cb_deinit(cb), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static cb_error_t evt_handler(cb_evt_t * const evt)
+{
+    for (size_t i = 0U; i < ARRAY_DIM(evt_counts); i++)
+    {
+        evt_counts[i] += (((size_t)evt->id >> i) & 1U);
+    }
+
+    if (evt->id == cb_evt_id_write)
+    {
+        (void)memcpy(evt->data.write.write_ptr, evt->data.write.buffer, evt->data.write.bytes);
+    }
+    else if (evt->id == cb_evt_id_read)
+    {
+        (void)memcpy(evt->data.read.buffer, evt->data.read.read_ptr, evt->data.read.bytes);
+    }
+    else
+    {
+        return cb_error_ok;
+    }
+
+    return (evt_fail) ? (cb_error_evt) : (cb_error_ok);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t evt_count(const cb_evt_id_t id)
+{
+    size_t i = 0U;
+    for (; ((size_t)id >> i) != 1U; i++)
+    {
+    }
+
+    return evt_counts[i];
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_unchecked_no_events(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    size_t filled = 0U;
+
+    // Write and read without wrapping around.
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 4U), cb_error_ok);
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 3U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 3U * sizeof(*ldbuf));
+    assert_int_equal(cb_get_filled(cb, &filled), cb_error_ok);
+    assert_int_equal(filled, 1U);
+
+    // Write wrapping around the end of the linear buffer, and reject what does not fit.
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 9U), cb_error_ok);
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 1U), cb_error_full);
+    assert_int_equal(cb_get_filled(cb, &filled), cb_error_ok);
+    assert_int_equal(filled, 10U);
+
+    // Read wrapping around the end of the linear buffer, and reject what is not available.
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 10U), cb_error_ok);
+    assert_int_equal(ldbuf[0U], lsbuf[3U]);
+    assert_memory_equal(&ldbuf[1U], lsbuf, 9U * sizeof(*ldbuf));
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 1U), cb_error_empty);
+
+    // The checked and unchecked functions can be mixed.
+    assert_int_equal(cb_write(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 2U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 2U * sizeof(*ldbuf));
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_read(cb, ldbuf, 2U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 2U * sizeof(*ldbuf));
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_unchecked_events(void ** state)
+{
+    cb_t * const cb = (cb_t * const)*state;
+    const cb_evt_id_t sub = cb_evt_id_write | cb_evt_id_read | cb_evt_id_lock | cb_evt_id_unlock;
+
+    // Reinitialize the circular buffer with events.
+    assert_int_equal(cb_init(cb, lcbuf, ARRAY_DIM(lcbuf), sizeof(*lcbuf), evt_handler, sub, NULL), cb_error_ok);
+
+    // Each operation is locked, and the copies are done in the events, twice when wrapping around.
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 8U), cb_error_ok);
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 8U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 8U * sizeof(*ldbuf));
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 5U), cb_error_ok);
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 5U), cb_error_ok);
+    assert_memory_equal(ldbuf, lsbuf, 5U * sizeof(*ldbuf));
+    assert_int_equal(evt_count(cb_evt_id_lock), 4U);
+    assert_int_equal(evt_count(cb_evt_id_unlock), 4U);
+    assert_int_equal(evt_count(cb_evt_id_write), 3U);
+    assert_int_equal(evt_count(cb_evt_id_read), 3U);
+
+    // Rejected operations are also locked, but there are no copies.
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 1U), cb_error_empty);
+    assert_int_equal(evt_count(cb_evt_id_lock), 5U);
+    assert_int_equal(evt_count(cb_evt_id_unlock), 5U);
+    assert_int_equal(evt_count(cb_evt_id_read), 3U);
+
+    // Errors in the events are returned, and nothing is written nor read.
+    evt_fail = true;
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 1U), cb_error_evt);
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 1U), cb_error_empty);
+    evt_fail = false;
+    assert_int_equal(cb_write_unchecked(cb, lsbuf, 1U), cb_error_ok);
+    evt_fail = true;
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 1U), cb_error_evt);
+    evt_fail = false;
+    assert_int_equal(cb_read_unchecked(cb, ldbuf, 1U), cb_error_ok);
+    assert_int_equal(evt_count(cb_evt_id_lock), evt_count(cb_evt_id_unlock));
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_unchecked_no_events, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_unchecked_events, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_unchecked", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/
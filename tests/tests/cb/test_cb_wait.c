@@ -0,0 +1,388 @@
+/**
+ ***********************************************************************************************************************
+ * @file        test_cb_wait.c
+ * @author      Diego Martínez García (dmg0345@gmail.com)
+ * @date        04-11-2023 21:33:15 (UTC)
+ * @version     1.0.0
+ * @copyright   github.com/dmg0345/cb/blob/master/LICENSE
+ ***********************************************************************************************************************
+ */
+
+/* Includes ----------------------------------------------------------------------------------------------------------*/
+#include "cmocka_defs.h"
+#include "test_types.h"
+#include "cb/cb_wait.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+
+/* Private types -----------------------------------------------------------------------------------------------------*/
+/* Private define ----------------------------------------------------------------------------------------------------*/
+/** Number of circular buffers in the wait set, each with a producer in the concurrency tests. */
+#define RINGS (3U)
+
+/** Number of elements written by each producer thread in the concurrency tests. */
+#define ELEMS (20000U)
+
+/* Private macro -----------------------------------------------------------------------------------------------------*/
+/* Private variables -------------------------------------------------------------------------------------------------*/
+/** Underlying linear buffers for the circular buffers. */
+static test_type_t lcbufs[RINGS][11U];
+/** Destination buffer, to be used for read operations in the circular buffers. */
+static test_type_t ldbuf[10U];
+/** Source buffer, to be used for write operations in the circular buffers. */
+static const test_type_t lsbuf[10U] = {0x01U, 0x02U, 0x03U, 0x04U, 0x05U, 0x06U, 0x07U, 0x08U, 0x09U, 0x0AU};
+/** Circular buffers. */
+static cb_t rings[RINGS];
+/** Wait set. */
+static cb_wait_t ws;
+/** Ticks of the clock of the batches, counting the times it is read. */
+static _Atomic uint64_t ticks;
+
+/* Private function prototypes ---------------------------------------------------------------------------------------*/
+/** Suite setup function. */
+static int setup(void ** state);
+/** Suite teardown function. */
+static int teardown(void ** state);
+/** Producer thread, writes consecutive elements in bursts to the circular buffer provided. */
+static void * producer(void * ptr);
+/** Producer thread, writes a batch to the first circular buffer once the batch consumer lingered for a while. */
+static void * batch_producer(void * ptr);
+/** Clock of the batches, counting the times it is read. */
+static uint64_t clock_ticks(void);
+
+/**
+ * @addtogroup cb_tests
+ * @{
+ */
+
+/** Tests for the invalid arguments of the wait sets. */
+static void test_cb_wait_invalid_arguments(void ** state);
+/** Tests for the readiness reported by the wait sets, with a single thread. */
+static void test_cb_wait_single_thread(void ** state);
+/** Tests for a consumer sleeping on a wait set until the producers of its circular buffers write to them. */
+static void test_cb_wait_threads(void ** state);
+/** Tests for the readiness of circular buffers with processing stages, readable once processed by the last stage. */
+static void test_cb_wait_stages(void ** state);
+/** Tests for the sleeps on the wait sets, and the batch reads sleeping on them while lingering. */
+static void test_cb_wait_sleep(void ** state);
+
+/**
+ * @}
+ */
+
+/* Private functions -------------------------------------------------------------------------------------------------*/
+static int setup(void ** state)
+{
+    // Initialize linear buffers.
+    (void)memset(lcbufs, 0xFFU, sizeof(lcbufs));
+    (void)memset(ldbuf, 0xFFU, sizeof(ldbuf));
+
+    // Initialize circular buffers and wait set.
+    assert_int_equal(cb_wait_init(&ws), cb_error_ok);
+    for (size_t i = 0U; i < RINGS; i++)
+    {
+        assert_int_equal(
+            cb_init(&rings[i], lcbufs[i], ARRAY_DIM(lcbufs[i]), sizeof(*lcbufs[i]), NULL, cb_evt_id_none, NULL),
+            cb_error_ok);
+    }
+
+    // Assign wait set to tests.
+    *state = &ws;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int teardown(void ** state)
+{
+    cb_wait_t * const w = (cb_wait_t * const)*state;
+
+    // Deinitialize circular buffers, which removes them from the wait set, and wait set.
+    for (size_t i = 0U; i < RINGS; i++)
+    {
+        assert_int_equal(cb_deinit(&rings[i]), cb_error_ok);
+        assert_true(rings[i].wait == NULL);
+    }
+    assert_int_equal(cb_wait_deinit(w), cb_error_ok);
+
+    // Clear state.
+    *state = NULL;
+
+    return CMOCKA_OK;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * producer(void * ptr)
+{
+    cb_t * const cb = &rings[(size_t)ptr];
+
+    for (size_t i = 0U; i < ELEMS; i++)
+    {
+        const test_type_t elem = (test_type_t)i;
+        while (cb_write(cb, &elem, 1U) != cb_error_ok)
+        {
+            (void)sched_yield();
+        }
+        // Pause every now and then, so that the consumer drains the circular buffers and sleeps.
+        if ((i % 1000U) == 999U)
+        {
+            for (size_t y = 0U; y < 100U; y++)
+            {
+                (void)sched_yield();
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void * batch_producer(void * ptr)
+{
+    (void)ptr;
+
+    // Past the spins of the consumer, so that it sleeps on the wait set until written.
+    while (atomic_load(&ticks) < (CB_BATCH_SPINS + 10U))
+    {
+        (void)sched_yield();
+    }
+    (void)cb_write(&rings[0U], lsbuf, 4U);
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t clock_ticks(void)
+{
+    return atomic_fetch_add(&ticks, 1U);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_wait_invalid_arguments(void ** state)
+{
+    cb_wait_t * const w = (cb_wait_t * const)*state;
+    cb_wait_ready_t ready[RINGS];
+    size_t count = 0U;
+
+    // Invalid arguments on initialization.
+    assert_int_equal(cb_wait_init(NULL), cb_error_invalid_args);
+    assert_int_equal(cb_wait_deinit(NULL), cb_error_invalid_args);
+
+    // Invalid arguments on additions and removals, a circular buffer can only be in a wait set once.
+    assert_int_equal(cb_wait_add(NULL, &rings[0U], cb_wait_evt_readable, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_wait_add(w, NULL, cb_wait_evt_readable, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_wait_add(w, &rings[0U], cb_wait_evt_none, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_wait_add(w, &rings[0U], (cb_wait_evt_t)0x04U, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_wait_remove(w, &rings[0U]), cb_error_invalid_args);
+    assert_int_equal(cb_wait_add(w, &rings[0U], cb_wait_evt_readable, NULL), cb_error_ok);
+    assert_int_equal(cb_wait_add(w, &rings[0U], cb_wait_evt_readable, NULL), cb_error_invalid_args);
+    assert_int_equal(cb_wait_remove(NULL, &rings[0U]), cb_error_invalid_args);
+    assert_int_equal(cb_wait_remove(w, NULL), cb_error_invalid_args);
+
+    // Invalid arguments on waits.
+    assert_int_equal(cb_wait_wait(NULL, ready, RINGS, &count, 0), cb_error_invalid_args);
+    assert_int_equal(cb_wait_wait(w, NULL, RINGS, &count, 0), cb_error_invalid_args);
+    assert_int_equal(cb_wait_wait(w, ready, 0U, &count, 0), cb_error_invalid_args);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, NULL, 0), cb_error_invalid_args);
+    assert_int_equal(cb_wait_sleep(NULL, 0U, 0), cb_error_invalid_args);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_wait_single_thread(void ** state)
+{
+    cb_wait_t * const w = (cb_wait_t * const)*state;
+    cb_wait_ready_t ready[RINGS];
+    size_t count = 0U;
+
+    // Only the circular buffer waited on for space is ready, as all are empty.
+    for (size_t i = 0U; i < RINGS; i++)
+    {
+        const cb_wait_evt_t events = (i == (RINGS - 1U)) ? (cb_wait_evt_writable) : (cb_wait_evt_readable);
+        assert_int_equal(cb_wait_add(w, &rings[i], events, &lcbufs[i]), cb_error_ok);
+    }
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_true(ready[0U].cb == &rings[RINGS - 1U]);
+    assert_int_equal(ready[0U].events, cb_wait_evt_writable);
+    assert_true(ready[0U].user_data == &lcbufs[RINGS - 1U]);
+
+    // Once full it is no longer ready, and nothing is ready before the timeout expires.
+    assert_int_equal(cb_write(&rings[RINGS - 1U], lsbuf, 10U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_empty);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 10), cb_error_empty);
+    assert_int_equal(count, 0U);
+
+    // A write to an empty circular buffer makes it ready, and it is reported until drained.
+    assert_int_equal(cb_write(&rings[1U], lsbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, -1), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_true(ready[0U].cb == &rings[1U]);
+    assert_int_equal(ready[0U].events, cb_wait_evt_readable);
+    assert_int_equal(cb_read(&rings[1U], ldbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_true(ready[0U].cb == &rings[1U]);
+
+    // A read from a full circular buffer makes it ready, reported in the order they were added, up to the maximum.
+    assert_int_equal(cb_read(&rings[RINGS - 1U], ldbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_ok);
+    assert_int_equal(count, 2U);
+    assert_true(ready[0U].cb == &rings[1U]);
+    assert_true(ready[1U].cb == &rings[RINGS - 1U]);
+    assert_int_equal(ready[1U].events, cb_wait_evt_writable);
+    assert_int_equal(cb_wait_wait(w, ready, 1U, &count, 0), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_true(ready[0U].cb == &rings[1U]);
+    assert_int_equal(cb_read(&rings[1U], ldbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_true(ready[0U].cb == &rings[RINGS - 1U]);
+
+    // Circular buffers removed are not reported, and can be added again, ready already.
+    assert_int_equal(cb_write(&rings[0U], lsbuf, 1U), cb_error_ok);
+    assert_int_equal(cb_wait_remove(w, &rings[0U]), cb_error_ok);
+    assert_int_equal(cb_wait_remove(w, &rings[RINGS - 1U]), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_empty);
+    assert_int_equal(cb_wait_add(w, &rings[0U], cb_wait_evt_readable | cb_wait_evt_writable, NULL), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_true(ready[0U].cb == &rings[0U]);
+    assert_int_equal(ready[0U].events, cb_wait_evt_readable | cb_wait_evt_writable);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_wait_threads(void ** state)
+{
+    cb_wait_t * const w = (cb_wait_t * const)*state;
+    pthread_t producer_threads[RINGS];
+    cb_wait_ready_t ready[RINGS];
+    size_t next[RINGS] = {0U};
+    size_t consumed = 0U;
+    test_type_t batch[4U];
+
+    // A producer for each circular buffer, and the consumer in this thread, sleeping until any has elements.
+    for (size_t t = 0U; t < RINGS; t++)
+    {
+        assert_int_equal(cb_wait_add(w, &rings[t], cb_wait_evt_readable, (void *)t), cb_error_ok);
+        assert_int_equal(pthread_create(&producer_threads[t], NULL, producer, (void *)t), 0);
+    }
+    while (consumed < (RINGS * ELEMS))
+    {
+        size_t count = 0U;
+        assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, -1), cb_error_ok);
+        for (size_t r = 0U; r < count; r++)
+        {
+            // The elements of each circular buffer are read once, and in order.
+            const size_t t = (size_t)ready[r].user_data;
+            size_t filled = 0U;
+            assert_int_equal(ready[r].events, cb_wait_evt_readable);
+            assert_int_equal(cb_get_filled_lockfree(ready[r].cb, &filled), cb_error_ok);
+            assert_true(filled > 0U);
+            filled = (filled > ARRAY_DIM(batch)) ? (ARRAY_DIM(batch)) : (filled);
+            assert_int_equal(cb_read(ready[r].cb, batch, filled), cb_error_ok);
+            for (size_t i = 0U; i < filled; i++)
+            {
+                assert_int_equal(batch[i], (test_type_t)next[t]);
+                next[t]++;
+            }
+            consumed += filled;
+        }
+    }
+    for (size_t t = 0U; t < RINGS; t++)
+    {
+        assert_int_equal(pthread_join(producer_threads[t], NULL), 0);
+        assert_int_equal(next[t], ELEMS);
+    }
+
+    // Once drained, nothing is ready.
+    size_t count = 0U;
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_empty);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_wait_stages(void ** state)
+{
+    cb_wait_t * const w = (cb_wait_t * const)*state;
+    cb_wait_ready_t ready[RINGS];
+    size_t count = 0U;
+    void * elems = NULL;
+    size_t claimed = 0U;
+
+    // The elements written are not readable until processed by the last stage, thus it is not reported until then.
+    assert_int_equal(cb_set_stages(&rings[0U], 1U), cb_error_ok);
+    assert_int_equal(cb_wait_add(w, &rings[0U], cb_wait_evt_readable, NULL), cb_error_ok);
+    assert_int_equal(cb_write(&rings[0U], lsbuf, 3U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_empty);
+    assert_int_equal(count, 0U);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 10), cb_error_empty);
+
+    // The last stage signals it when releasing the elements, and it is reported until drained.
+    assert_int_equal(cb_stage_claim(&rings[0U], 0U, &elems, &claimed), cb_error_ok);
+    assert_int_equal(cb_stage_release(&rings[0U], 0U, 2U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, -1), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_true(ready[0U].cb == &rings[0U]);
+    assert_int_equal(cb_read(&rings[0U], ldbuf, 2U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_empty);
+
+    // The element left in the stage makes it ready again once released.
+    assert_int_equal(cb_stage_release(&rings[0U], 0U, 1U), cb_error_ok);
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, -1), cb_error_ok);
+    assert_int_equal(count, 1U);
+    assert_int_equal(cb_read(&rings[0U], ldbuf, 1U), cb_error_ok);
+    assert_memory_equal(ldbuf, &lsbuf[2U], sizeof(*ldbuf));
+    assert_int_equal(cb_wait_wait(w, ready, RINGS, &count, 0), cb_error_empty);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void test_cb_wait_sleep(void ** state)
+{
+    cb_wait_t * const w = (cb_wait_t * const)*state;
+    pthread_t producer_thread;
+    size_t read = 0U;
+
+    // Sleeps until the timeout expires without signals, and not at all if signaled since the signals were counted.
+    assert_int_equal(cb_wait_add(w, &rings[0U], cb_wait_evt_readable, NULL), cb_error_ok);
+    unsigned int seq = cb_wait_signals(w);
+    assert_int_equal(cb_wait_sleep(w, seq, 10), cb_error_ok);
+    assert_int_equal(cb_wait_signals(w), seq);
+    assert_int_equal(cb_write(&rings[0U], lsbuf, 1U), cb_error_ok);
+    assert_true(cb_wait_signals(w) != seq);
+    assert_int_equal(cb_wait_sleep(w, seq, -1), cb_error_ok);
+    assert_int_equal(cb_read(&rings[0U], ldbuf, 1U), cb_error_ok);
+
+    // A batch read lingering on an empty circular buffer sleeps on the wait set until written, and reads the minimum.
+    atomic_init(&ticks, 0U);
+    assert_int_equal(pthread_create(&producer_thread, NULL, batch_producer, NULL), 0);
+    assert_int_equal(cb_read_batch(&rings[0U], ldbuf, 4U, 8U, &read, clock_ticks, UINT64_MAX), cb_error_ok);
+    assert_int_equal(pthread_join(producer_thread, NULL), 0);
+    assert_int_equal(read, 4U);
+    assert_memory_equal(ldbuf, lsbuf, 4U * sizeof(*ldbuf));
+}
+
+/* Exported functions ------------------------------------------------------------------------------------------------*/
+/**
+ * @brief Test runner for this suite of tests.
+ * @return The result of the test runner.
+ */
+int main(void)
+{
+    // Initialize CMocka.
+    cmocka_init();
+
+    // The table with the tests.
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_cb_wait_invalid_arguments, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_wait_single_thread, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_wait_threads, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_wait_stages, setup, teardown),
+        cmocka_unit_test_setup_teardown(test_cb_wait_sleep, setup, teardown),
+    };
+
+    // Execute the test runner.
+    return cmocka_run_group_tests_name("cb_wait", tests, NULL, NULL);
+}
+
+/******************************************************************************************************END OF FILE*****/